@@ -62,6 +62,7 @@ struct default_packet_traits
     HasRsqrt  = 0,
     HasExp    = 0,
     HasLog    = 0,
+    HasLog1p  = 0,
     HasLog10    = 0,
     HasPow    = 0,
 
@@ -74,6 +75,7 @@ struct default_packet_traits
     HasSinh    = 0,
     HasCosh    = 0,
     HasTanh    = 0,
+    HasErf     = 0,
 
     HasRound  = 0,
     HasFloor  = 0,
@@ -192,6 +194,34 @@ pxor(const Packet& a, const Packet& b) { return a ^ b; }
 template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
 pandnot(const Packet& a, const Packet& b) { return a & (!b); }
 
+/** \internal \returns a packet with all the bits set, whatever the scalar type of \a a */
+template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
+ptrue(const Packet& /*a*/) { Packet b; memset(&b, 0xff, sizeof(b)); return b; }
+
+/** \internal \returns a bit mask set for the coefficients such that \a a <= \a b */
+template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
+pcmp_le(const Packet& a, const Packet& b) { return a<=b ? ptrue(a) : Packet(0); }
+
+/** \internal \returns a bit mask set for the coefficients such that \a a < \a b */
+template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
+pcmp_lt(const Packet& a, const Packet& b) { return a<b ? ptrue(a) : Packet(0); }
+
+/** \internal \returns a bit mask set for the coefficients such that \a a == \a b */
+template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
+pcmp_eq(const Packet& a, const Packet& b) { return a==b ? ptrue(a) : Packet(0); }
+
+/** \internal \returns the coefficients of \a a where the bit mask \a mask is set, and those of \a b elsewhere */
+template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
+pselect(const Packet& mask, const Packet& a, const Packet& b) { return pxor(b, pand(pxor(a, b), mask)); }
+
+// There are no bitwise operators on the float and double scalars used when vectorization is disabled,
+// but the mask is then either zero or all ones (a NaN).
+template<> EIGEN_DEVICE_FUNC inline float
+pselect<float>(const float& mask, const float& a, const float& b) { return mask!=0.f ? a : b; }
+
+template<> EIGEN_DEVICE_FUNC inline double
+pselect<double>(const double& mask, const double& a, const double& b) { return mask!=0. ? a : b; }
+
 /** \internal \returns a packet version of \a *from, from must be 16 bytes aligned */
 template<typename Packet> EIGEN_DEVICE_FUNC inline Packet
 pload(const typename unpacket_traits<Packet>::type* from) { return *from; }
@@ -388,6 +418,10 @@ Packet pcosh(const Packet& a) { using std::cosh; return cosh(a); }
 template<typename Packet> EIGEN_DECLARE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS
 Packet ptanh(const Packet& a) { using std::tanh; return tanh(a); }
 
+/** \internal \returns the error function of \a a (coeff-wise) */
+template<typename Packet> EIGEN_DECLARE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS
+Packet perf(const Packet& a) { using numext::erf; return erf(a); }
+
 /** \internal \returns the exp of \a a (coeff-wise) */
 template<typename Packet> EIGEN_DECLARE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS
 Packet pexp(const Packet& a) { using std::exp; return exp(a); }
@@ -396,6 +430,10 @@ Packet pexp(const Packet& a) { using std::exp; return exp(a); }
 template<typename Packet> EIGEN_DECLARE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS
 Packet plog(const Packet& a) { using std::log; return log(a); }
 
+/** \internal \returns the log of 1 plus \a a (coeff-wise) */
+template<typename Packet> EIGEN_DECLARE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS
+Packet plog1p(const Packet& a) { return numext::log1p(a); }
+
 /** \internal \returns the log10 of \a a (coeff-wise) */
 template<typename Packet> EIGEN_DECLARE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS
 Packet plog10(const Packet& a) { using std::log10; return log10(a); }
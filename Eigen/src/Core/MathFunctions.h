@@ -476,6 +476,31 @@ struct log1p_retval
   typedef Scalar type;
 };
 
+/****************************************************************************
+* Implementation of erf                                                     *
+****************************************************************************/
+
+template<typename Scalar>
+struct erf_impl
+{
+  static inline Scalar run(const Scalar& x)
+  {
+    EIGEN_STATIC_ASSERT((!NumTraits<Scalar>::IsComplex), NUMERIC_TYPE_MUST_BE_REAL)
+    #if EIGEN_HAS_CXX11_MATH
+    using std::erf;
+    #else
+    using ::erf;
+    #endif
+    return erf(x);
+  }
+};
+
+template<typename Scalar>
+struct erf_retval
+{
+  typedef Scalar type;
+};
+
 /****************************************************************************
 * Implementation of pow                                                  *
 ****************************************************************************/
@@ -773,6 +798,12 @@ inline EIGEN_MATHFUNC_RETVAL(log1p, Scalar) log1p(const Scalar& x)
   return EIGEN_MATHFUNC_IMPL(log1p, Scalar)::run(x);
 }
 
+template<typename Scalar>
+inline EIGEN_MATHFUNC_RETVAL(erf, Scalar) erf(const Scalar& x)
+{
+  return EIGEN_MATHFUNC_IMPL(erf, Scalar)::run(x);
+}
+
 template<typename Scalar>
 EIGEN_DEVICE_FUNC
 inline EIGEN_MATHFUNC_RETVAL(pow, Scalar) pow(const Scalar& x, const Scalar& y)
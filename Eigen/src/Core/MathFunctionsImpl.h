@@ -0,0 +1,191 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_MATHFUNCTIONSIMPL_H
+#define EIGEN_MATHFUNCTIONSIMPL_H
+
+namespace Eigen {
+
+namespace internal {
+
+/* This file gathers the packet math functions which can be implemented
+ * on top of the basic packet primitives (padd, pmul, pmadd, pdiv, pmin, pmax, ...)
+ * only. They are not used by default: the architecture specific files
+ * specialize the respective p* function (e.g., ptanh<Packet4f>) to call them
+ * and enable the related Has* flag of their packet_traits.
+ */
+
+/** \internal \returns the hyperbolic tangent of \a a_x (coeff-wise) for float packets.
+  * For |x| < 0.625, tanh(x) is approximated by the odd polynomial x + x^3 P(x^2), and
+  * beyond it is computed as 1 - 2/(exp(2|x|)+1). The maximal error is 2 ULP, and NaN
+  * is propagated.
+  */
+template<typename Packet>
+Packet generic_fast_tanh_float(const Packet& a_x)
+{
+  const Packet one = pset1<Packet>(1.f);
+  const Packet two = pset1<Packet>(2.f);
+  const Packet cutoff = pset1<Packet>(0.625f);
+  const Packet sign_mask = pset1<Packet>(-0.f);
+  // The minimax coefficients of P, relative to (tanh(x)-x)/x^3 over [0, 0.625].
+  const Packet alpha_0 = pset1<Packet>(-3.33333289e-01f);
+  const Packet alpha_2 = pset1<Packet>(1.33327701e-01f);
+  const Packet alpha_4 = pset1<Packet>(-5.38509534e-02f);
+  const Packet alpha_6 = pset1<Packet>(2.09973574e-02f);
+  const Packet alpha_8 = pset1<Packet>(-6.09694137e-03f);
+
+  // Small arguments: evaluate the polynomial.
+  const Packet x2 = pmul(a_x, a_x);
+  Packet p = pmadd(x2, alpha_8, alpha_6);
+  p = pmadd(x2, p, alpha_4);
+  p = pmadd(x2, p, alpha_2);
+  p = pmadd(x2, p, alpha_0);
+  p = pmul(p, x2);
+  const Packet small = pmadd(p, a_x, a_x);
+
+  // Large arguments: 2/(exp(2|x|)+1) is accurate, and vanishes for large |x|.
+  const Packet abs_x = pabs(a_x);
+  const Packet e = pexp(padd(abs_x, abs_x));
+  Packet large = psub(one, pdiv(two, padd(e, one)));
+  large = por(large, pand(a_x, sign_mask));
+
+  const Packet res = pselect(pcmp_lt(abs_x, cutoff), small, large);
+  // NaN is the only value that is not equal to itself.
+  return pselect(pcmp_eq(a_x, a_x), res, a_x);
+}
+
+/** \internal \returns the error function of \a a_x (coeff-wise) for float packets.
+  * For |x| < 1, erf(x) is approximated by the odd polynomial x P(x^2), and beyond it is
+  * computed as 1 - erfc(|x|), with erfc(x) = exp(-x^2)/x Q(1/x). The maximal error is
+  * 2 ULP, and NaN is propagated.
+  */
+template<typename Packet>
+Packet generic_fast_erf_float(const Packet& a_x)
+{
+  const Packet one = pset1<Packet>(1.f);
+  const Packet plus_4 = pset1<Packet>(4.f);
+  const Packet sign_mask = pset1<Packet>(-0.f);
+  // The minimax coefficients of P, relative to erf(x)/x over [0, 1]. The constant
+  // term is stored minus one, and x is added after the product by x.
+  const Packet alpha_0 = pset1<Packet>(1.28379166e-01f);
+  const Packet alpha_2 = pset1<Packet>(-3.76126258e-01f);
+  const Packet alpha_4 = pset1<Packet>(1.12835851e-01f);
+  const Packet alpha_6 = pset1<Packet>(-2.68538119e-02f);
+  const Packet alpha_8 = pset1<Packet>(5.18832768e-03f);
+  const Packet alpha_10 = pset1<Packet>(-8.01019357e-04f);
+  const Packet alpha_12 = pset1<Packet>(7.85386116e-05f);
+  // The minimax coefficients of Q, relative to x exp(x^2) erfc(x) over [1, 4].
+  const Packet beta_0 = pset1<Packet>(5.64238869e-01f);
+  const Packet beta_1 = pset1<Packet>(-1.53552299e-03f);
+  const Packet beta_2 = pset1<Packet>(-2.62213281e-01f);
+  const Packet beta_3 = pset1<Packet>(-1.43336284e-01f);
+  const Packet beta_4 = pset1<Packet>(1.05899774e+00f);
+  const Packet beta_5 = pset1<Packet>(-1.75668268e+00f);
+  const Packet beta_6 = pset1<Packet>(1.65112727e+00f);
+  const Packet beta_7 = pset1<Packet>(-9.52853593e-01f);
+  const Packet beta_8 = pset1<Packet>(3.16336731e-01f);
+  const Packet beta_9 = pset1<Packet>(-4.64956733e-02f);
+
+  // Small arguments: evaluate the polynomial.
+  const Packet x2 = pmul(a_x, a_x);
+  Packet p = pmadd(x2, alpha_12, alpha_10);
+  p = pmadd(x2, p, alpha_8);
+  p = pmadd(x2, p, alpha_6);
+  p = pmadd(x2, p, alpha_4);
+  p = pmadd(x2, p, alpha_2);
+  p = pmadd(x2, p, alpha_0);
+  const Packet small = pmadd(a_x, p, a_x);
+
+  // Large arguments: erfc is small compared to 1, so that its relative error is damped.
+  // Anything beyond 4 is 1 in single precision.
+  const Packet abs_x = pabs(a_x);
+  const Packet a = pmin(pmax(abs_x, one), plus_4);
+  const Packet t = pdiv(one, a);
+  Packet q = pmadd(t, beta_9, beta_8);
+  q = pmadd(t, q, beta_7);
+  q = pmadd(t, q, beta_6);
+  q = pmadd(t, q, beta_5);
+  q = pmadd(t, q, beta_4);
+  q = pmadd(t, q, beta_3);
+  q = pmadd(t, q, beta_2);
+  q = pmadd(t, q, beta_1);
+  q = pmadd(t, q, beta_0);
+  const Packet erfc = pmul(pmul(pexp(pnegate(pmul(a, a))), t), q);
+  Packet large = psub(one, erfc);
+  large = por(large, pand(a_x, sign_mask));
+
+  const Packet res = pselect(pcmp_lt(abs_x, one), small, large);
+  // NaN is the only value that is not equal to itself.
+  return pselect(pcmp_eq(a_x, a_x), res, a_x);
+}
+
+/** \internal \returns the rounding error (x-1)/(x+1) - \a q of the reduced argument \a q = (x-1)/(x+1)
+  * of the float arc tangent, to first order. The rounding errors of x-1, x+1 and of the product
+  * of \a q by x+1 are recovered exactly by error-free transformations. Adding this correction to
+  * the polynomial brings the maximal error of patan from 2.8 to 1.5 ULP, or 1.8 ULP when pmadd is fused,
+  * for x in [tan(Pi/8), tan(3Pi/8)].
+  */
+template<typename Packet>
+Packet generic_atan_reduction_error(const Packet& x, const Packet& q)
+{
+  typedef typename unpacket_traits<Packet>::type Scalar;
+  const Packet one = pset1<Packet>(Scalar(1));
+  const Packet minus_one = pset1<Packet>(Scalar(-1));
+  // x+1 = s + es and x-1 = d + ed
+  const Packet s = padd(x, one);
+  const Packet bs = psub(s, x);
+  const Packet es = padd(psub(one, bs), psub(x, psub(s, bs)));
+  const Packet d = psub(x, one);
+  const Packet bd = psub(d, x);
+  const Packet ed = padd(psub(minus_one, bd), psub(x, psub(d, bd)));
+  // q*s = p + ep
+  const Packet p = pmul(q, s);
+#ifdef __FMA__
+  const Packet ep = pmadd(q, s, pnegate(p));
+#else
+  const Packet split = pset1<Packet>(Scalar(4097));
+  Packet c = pmul(split, q);
+  const Packet qh = psub(c, psub(c, q));
+  const Packet ql = psub(q, qh);
+  c = pmul(split, s);
+  const Packet sh = psub(c, psub(c, s));
+  const Packet sl = psub(s, sh);
+  const Packet ep = padd(padd(padd(psub(pmul(qh, sh), p), pmul(qh, sl)), pmul(ql, sh)), pmul(ql, sl));
+#endif
+  // (x-1) - q*(x+1), divided by x+1
+  const Packet r = psub(padd(psub(psub(d, p), ep), ed), pmul(q, es));
+  return pdiv(r, s);
+}
+
+/** \internal \returns log(1+\a x) (coeff-wise) computed from a vectorized plog.
+  * With u = 1+x, the rounding error of u is compensated using:
+  *   log(1+x) = log(u) - ((u-1)-x)/u
+  * which adds at most half an ULP to the error of plog over the whole range, that is
+  * 1.7 ULP in float and 1.3 ULP in double with the SSE and AVX kernels, including for tiny x
+  * (for which u==1 and the result is x). The correction term is computed from
+  * clamped values such that it remains finite for x==-1 and x==+inf.
+  */
+template<typename Packet>
+Packet generic_plog1p(const Packet& x)
+{
+  typedef typename unpacket_traits<Packet>::type Scalar;
+  const Packet one = pset1<Packet>(Scalar(1));
+  // beyond this value, (1+x)-1 is exact and the correction vanishes
+  const Packet big = pset1<Packet>(Scalar(1)/NumTraits<Scalar>::epsilon());
+  const Packet tiny = pset1<Packet>((std::numeric_limits<Scalar>::min)());
+  Packet u = padd(one, x);
+  Packet xc = pmin(x, big);
+  Packet uc = padd(one, xc);
+  Packet correction = pdiv(psub(psub(uc, one), xc), pmax(uc, tiny));
+  return psub(plog(u), correction);
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_MATHFUNCTIONSIMPL_H
@@ -52,6 +52,124 @@ struct visitor_impl<Visitor, Derived, Dynamic>
   }
 };
 
+/* Vectorized traversal for the visitors providing packet operations (min/max):
+ * The coefficients are processed by chunks which are first reduced using packets.
+ * Only the chunks whose reduction improves the current result are re-visited
+ * coefficient per coefficient to find the location of the extremum. This is a
+ * single pass over the data, and the index of the first extremum is preserved.
+ * The packet min/max may return either operand when one is NaN, so the chunks
+ * holding a NaN, which are detected through the sum of their coefficients, are
+ * always re-visited: the result is then the one of the scalar traversal.
+ * Very large expressions are split among the OpenMP threads, the partial results
+ * being merged in order. Each thread starts from the first coefficient, as the
+ * sequential traversal does, so that a NaN at the start of a range is skipped.
+ */
+template<typename Visitor, typename Derived, bool Vectorize>
+struct linear_vectorized_visitor_impl
+{
+  typedef typename Derived::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum { PacketSize = packet_traits<Scalar>::size };
+
+  // the linear traversal follows a column-major order
+  static inline void visit_coeff(const Derived& mat, Visitor& visitor, Index k)
+  {
+    visitor(mat.coeff(k), k % mat.rows(), k / mat.rows());
+  }
+
+  // visits the coefficients [begin,end) of mat, visitor being already initialized
+  static void run_range(const Derived& mat, Visitor& visitor, Index begin, Index end)
+  {
+    const bool CheckNaN = !NumTraits<Scalar>::IsInteger;
+    const Index ChunkSize = 16*PacketSize;
+    Index k = begin;
+    for(; k+ChunkSize<=end; k+=ChunkSize)
+    {
+      Packet p0 = mat.template packet<Unaligned>(k);
+      Packet p1 = mat.template packet<Unaligned>(k+PacketSize);
+      Packet s0 = p0, s1 = p1;
+      for(Index i=k+2*PacketSize; i<k+ChunkSize; i+=2*PacketSize)
+      {
+        Packet q0 = mat.template packet<Unaligned>(i);
+        Packet q1 = mat.template packet<Unaligned>(i+PacketSize);
+        p0 = Visitor::packetOp(p0, q0);
+        p1 = Visitor::packetOp(p1, q1);
+        if(CheckNaN)
+        {
+          s0 = padd(s0, q0);
+          s1 = padd(s1, q1);
+        }
+      }
+      bool hasNaN = false;
+      if(CheckNaN)
+      {
+        Scalar sum = predux(padd(s0, s1));
+        hasNaN = !(sum==sum);
+      }
+      if(hasNaN || Visitor::better(Visitor::predux(Visitor::packetOp(p0,p1)), visitor.res))
+        for(Index i=k; i<k+ChunkSize; ++i)
+          visit_coeff(mat, visitor, i);
+    }
+    for(; k<end; ++k)
+      visit_coeff(mat, visitor, k);
+  }
+
+  static void run(const Derived& mat, Visitor& visitor)
+  {
+    const Index size = mat.size();
+    visitor.init(mat.coeff(0), 0, 0);
+#ifdef EIGEN_HAS_OPENMP
+    // FIXME this has to be fine tuned
+    Index threads = std::min<Index>(nbThreads(), size/(1<<16));
+    if(threads>1 && omp_get_num_threads()==1)
+    {
+      ei_declare_aligned_stack_constructed_variable(Visitor, visitors, threads, 0);
+      #pragma omp parallel for schedule(static) num_threads(int(threads))
+      for(Index t=0; t<threads; ++t)
+      {
+        Index blockSize = size/threads;
+        Index begin = t*blockSize;
+        visitors[t] = visitor;
+        run_range(mat, visitors[t], (std::max)(begin,Index(1)), t+1==threads ? size : begin+blockSize);
+      }
+      visitor = visitors[0];
+      for(Index t=1; t<threads; ++t)
+        if(Visitor::better(visitors[t].res, visitor.res))
+          visitor = visitors[t];
+      return;
+    }
+#endif
+    run_range(mat, visitor, 1, size);
+  }
+};
+
+template<typename Visitor, typename Derived>
+struct linear_vectorized_visitor_impl<Visitor, Derived, false>
+{
+  static inline void run(const Derived& mat, Visitor& visitor)
+  {
+    visitor_impl<Visitor, Derived, Dynamic>::run(mat, visitor);
+  }
+};
+
+// The PacketAccess member of functor_traits<Visitor> is optional: the visitors whose
+// functor_traits only define Cost take the scalar path.
+template<typename Traits, bool HasPacketAccess>
+struct visitor_packet_access_impl { enum { value = false }; };
+
+template<typename Traits>
+struct visitor_packet_access_impl<Traits, true> { enum { value = bool(Traits::PacketAccess) }; };
+
+template<typename Visitor>
+struct visitor_packet_access
+{
+  typedef functor_traits<Visitor> Traits;
+  template<int> struct holder {};
+  template<typename T> static char (&test(holder<int(T::PacketAccess)>*))[2];
+  template<typename T> static char test(...);
+  enum { value = visitor_packet_access_impl<Traits, sizeof(test<Traits>(0))==2>::value };
+};
+
 // evaluator adaptor
 template<typename XprType>
 class visitor_evaluator
@@ -61,10 +179,12 @@ public:
   
   typedef typename XprType::Scalar Scalar;
   typedef typename XprType::CoeffReturnType CoeffReturnType;
+  typedef typename XprType::PacketScalar PacketScalar;
   
   enum {
     RowsAtCompileTime = XprType::RowsAtCompileTime,
-    CoeffReadCost = internal::evaluator<XprType>::CoeffReadCost
+    CoeffReadCost = internal::evaluator<XprType>::CoeffReadCost,
+    Flags = internal::evaluator<XprType>::Flags
   };
   
   Index rows() const { return m_xpr.rows(); }
@@ -73,6 +193,13 @@ public:
 
   CoeffReturnType coeff(Index row, Index col) const
   { return m_evaluator.coeff(row, col); }
+
+  CoeffReturnType coeff(Index index) const
+  { return m_evaluator.coeff(index); }
+
+  template<int LoadMode>
+  PacketScalar packet(Index index) const
+  { return m_evaluator.template packet<LoadMode>(index); }
   
 protected:
   typename internal::evaluator<XprType>::nestedType m_evaluator;
@@ -108,7 +235,15 @@ void DenseBase<Derived>::visit(Visitor& visitor) const
                 &&  ThisEvaluator::CoeffReadCost != Dynamic
                 &&  (SizeAtCompileTime == 1 || internal::functor_traits<Visitor>::Cost != Dynamic)
                 &&  SizeAtCompileTime * ThisEvaluator::CoeffReadCost + (SizeAtCompileTime-1) * internal::functor_traits<Visitor>::Cost
-                <= EIGEN_UNROLLING_LIMIT };
+                <= EIGEN_UNROLLING_LIMIT,
+         // the linear traversal must match the column-major order of the default one
+         vectorize = (!unroll)
+                &&  bool(internal::visitor_packet_access<Visitor>::value)
+                &&  bool(ThisEvaluator::Flags & LinearAccessBit)
+                &&  bool(ThisEvaluator::Flags & PacketAccessBit)
+                &&  (bool(IsVectorAtCompileTime) || !(int(ThisEvaluator::Flags) & RowMajorBit)) };
+  if(vectorize && size()>=4*internal::packet_traits<Scalar>::size)
+    return internal::linear_vectorized_visitor_impl<Visitor, ThisEvaluator, vectorize>::run(thisEval, visitor);
   return internal::visitor_impl<Visitor, ThisEvaluator,
       unroll ? int(SizeAtCompileTime) : Dynamic
     >::run(thisEval, visitor);
@@ -142,6 +277,10 @@ template <typename Derived>
 struct min_coeff_visitor : coeff_visitor<Derived>
 {
   typedef typename Derived::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  static inline bool better(const Scalar& a, const Scalar& b) { return a < b; }
+  static inline Packet packetOp(const Packet& a, const Packet& b) { return internal::pmin(a,b); }
+  static inline Scalar predux(const Packet& p) { return internal::predux_min(p); }
   void operator() (const Scalar& value, Index i, Index j)
   {
     if(value < this->res)
@@ -156,7 +295,8 @@ struct min_coeff_visitor : coeff_visitor<Derived>
 template<typename Scalar>
 struct functor_traits<min_coeff_visitor<Scalar> > {
   enum {
-    Cost = NumTraits<Scalar>::AddCost
+    Cost = NumTraits<Scalar>::AddCost,
+    PacketAccess = packet_traits<typename Scalar::Scalar>::HasMin
   };
 };
 
@@ -169,6 +309,10 @@ template <typename Derived>
 struct max_coeff_visitor : coeff_visitor<Derived>
 {
   typedef typename Derived::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  static inline bool better(const Scalar& a, const Scalar& b) { return a > b; }
+  static inline Packet packetOp(const Packet& a, const Packet& b) { return internal::pmax(a,b); }
+  static inline Scalar predux(const Packet& p) { return internal::predux_max(p); }
   void operator() (const Scalar& value, Index i, Index j)
   {
     if(value > this->res)
@@ -183,7 +327,8 @@ struct max_coeff_visitor : coeff_visitor<Derived>
 template<typename Scalar>
 struct functor_traits<max_coeff_visitor<Scalar> > {
   enum {
-    Cost = NumTraits<Scalar>::AddCost
+    Cost = NumTraits<Scalar>::AddCost,
+    PacketAccess = packet_traits<typename Scalar::Scalar>::HasMax
   };
 };
 
@@ -17,6 +17,8 @@
 
 /* The sin, cos, exp, and log functions of this file are loosely derived from
  * Julien Pommier's sse math library: http://gruntthepeon.free.fr/ssemath/
+ * The double-precision sin, cos and log functions, as well as atan, are
+ * rewritings of the respective cephes functions.
  */
 
 namespace Eigen {
@@ -121,6 +123,7 @@ plog<Packet8f>(const Packet8f& _x) {
   // The smallest non denormalized float number.
   _EIGEN_DECLARE_CONST_Packet8f_FROM_INT(min_norm_pos, 0x00800000);
   _EIGEN_DECLARE_CONST_Packet8f_FROM_INT(minus_inf, 0xff800000);
+  _EIGEN_DECLARE_CONST_Packet8f_FROM_INT(plus_inf, 0x7f800000);
 
   // Polynomial coefficients.
   _EIGEN_DECLARE_CONST_Packet8f(cephes_SQRTHF, 0.707106781186547524f);
@@ -138,6 +141,7 @@ plog<Packet8f>(const Packet8f& _x) {
 
   Packet8f invalid_mask = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_NGE_UQ); // not greater equal is true if x is NaN
   Packet8f iszero_mask = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ);
+  Packet8f isinf_mask = _mm256_cmp_ps(x, p8f_plus_inf, _CMP_EQ_OQ);
 
   // Truncate input values to the minimum positive normal.
   x = pmax(x, p8f_min_norm_pos);
@@ -195,7 +199,9 @@ plog<Packet8f>(const Packet8f& _x) {
   x = padd(x, y);
   x = padd(x, y2);
 
-  // Filter out invalid inputs, i.e. negative arg will be NAN, 0 will be -INF.
+  // Filter out invalid inputs, i.e. negative arg will be NAN, 0 will be -INF,
+  // and +INF remains +INF.
+  x = _mm256_blendv_ps(x, p8f_plus_inf, isinf_mask);
   return _mm256_or_ps(
       _mm256_andnot_ps(iszero_mask, _mm256_or_ps(x, invalid_mask)),
       _mm256_and_ps(iszero_mask, p8f_minus_inf));
@@ -351,6 +357,302 @@ pexp<Packet4d>(const Packet4d& _x) {
   return pmax(pmul(x, Packet4d(e)), _x);
 }
 
+// Double-precision natural logarithm. As for the single-precision version,
+// log(x) is computed as log(2)*e + log(m) where m is in the range
+// [sqrt(1/2),sqrt(2)), but log(m) is approximated as in fdlibm, which stays
+// within 1 ULP over the whole range, including next to sqrt(1/2) and sqrt(2)
+// where the rational interpolant of cephes exceeded 2 ULP.
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet4d
+plog<Packet4d>(const Packet4d& _x) {
+  Packet4d x = _x;
+  _EIGEN_DECLARE_CONST_Packet4d(1, 1.0);
+  _EIGEN_DECLARE_CONST_Packet4d(half, 0.5);
+  _EIGEN_DECLARE_CONST_Packet4d(52, 52.0);
+  _EIGEN_DECLARE_CONST_Packet4d(1022, 1022.0);
+
+  const Packet4d p4d_2pow52 = _mm256_castsi256_pd(_mm256_set1_epi64x(0x4330000000000000LL));
+  const Packet4d p4d_inv_mant_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(~0x7ff0000000000000LL));
+
+  // The smallest non denormalized double number.
+  const Packet4d p4d_min_norm_pos = _mm256_castsi256_pd(_mm256_set1_epi64x(0x0010000000000000LL));
+  const Packet4d p4d_minus_inf = _mm256_castsi256_pd(_mm256_set1_epi64x(0xfff0000000000000LL));
+  const Packet4d p4d_plus_inf = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7ff0000000000000LL));
+
+  // The coefficients of R(z) and the split of log(2) of fdlibm. ln2_hi has
+  // 32 bits only, so that e*ln2_hi is exact.
+  _EIGEN_DECLARE_CONST_Packet4d(cephes_SQRTHF, 0.70710678118654752440);
+  _EIGEN_DECLARE_CONST_Packet4d(2, 2.0);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg1, 6.666666666666735130e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg2, 3.999999999940941908e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg3, 2.857142874366239149e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg4, 2.222219843214978396e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg5, 1.818357216161805012e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg6, 1.531383769920937332e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(log_Lg7, 1.479819860511658591e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(ln2_hi, 6.93147180369123816490e-01);
+  _EIGEN_DECLARE_CONST_Packet4d(ln2_lo, 1.90821492927058770002e-10);
+
+  Packet4d invalid_mask = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_NGE_UQ); // not greater equal is true if x is NaN
+  Packet4d iszero_mask = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ);
+  Packet4d isinf_mask = _mm256_cmp_pd(x, p4d_plus_inf, _CMP_EQ_OQ);
+
+  // Scale the denormalized inputs by 2^52 to make them normalized, and
+  // truncate the zero and negative inputs to the minimum positive normal.
+  Packet4d denorm_mask = _mm256_cmp_pd(x, p4d_min_norm_pos, _CMP_LT_OQ);
+  x = pmul(x, _mm256_blendv_pd(p4d_1, p4d_2pow52, denorm_mask));
+  x = pmax(x, p4d_min_norm_pos);
+
+  // Extract the biased exponents (no 64-bit shifts in regular AVX, so do it
+  // on the SSE halves), and convert them to doubles by inserting them into
+  // the mantissa of 2^52.
+#ifdef EIGEN_VECTORIZE_AVX2
+  Packet4d e = _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(x), 52));
+#else
+  __m128i lo = _mm_srli_epi64(_mm256_extractf128_si256(_mm256_castpd_si256(x), 0), 52);
+  __m128i hi = _mm_srli_epi64(_mm256_extractf128_si256(_mm256_castpd_si256(x), 1), 52);
+  Packet4d e = _mm256_castsi256_pd(_mm256_setr_m128(lo, hi));
+#endif
+  e = psub(_mm256_or_pd(e, p4d_2pow52), p4d_2pow52);
+  e = psub(e, p4d_1022);
+  e = psub(e, _mm256_and_pd(denorm_mask, p4d_52));
+
+  // Set the exponents to -1, i.e. x are in the range [0.5,1).
+  x = _mm256_and_pd(x, p4d_inv_mant_mask);
+  x = _mm256_or_pd(x, p4d_half);
+
+  // Shift the inputs from the range [0.5,1) to [sqrt(1/2),sqrt(2))
+  // and shift by -1.
+  Packet4d mask = _mm256_cmp_pd(x, p4d_cephes_SQRTHF, _CMP_LT_OQ);
+  Packet4d tmp = _mm256_and_pd(x, mask);
+  x = psub(x, p4d_1);
+  e = psub(e, _mm256_and_pd(p4d_1, mask));
+  x = padd(x, tmp);
+
+  // Evaluate log(1+x) = x - hfsq + s*(hfsq+R(s^2)) with hfsq = x^2/2 and
+  // s = x/(2+x), where R is of degree 7 in s^2 and split into its odd and even
+  // terms t2 and t1.
+  Packet4d s = pdiv(x, padd(p4d_2, x));
+  Packet4d z = pmul(s, s);
+  Packet4d w = pmul(z, z);
+  Packet4d t1 = pmul(w, pmadd(pmadd(p4d_log_Lg6, w, p4d_log_Lg4), w, p4d_log_Lg2));
+  Packet4d t2 = pmul(z, pmadd(pmadd(pmadd(p4d_log_Lg7, w, p4d_log_Lg5), w, p4d_log_Lg3), w, p4d_log_Lg1));
+  Packet4d hfsq = pmul(p4d_half, pmul(x, x));
+
+  // Add the logarithm of the exponent back to the result, that is
+  // e*ln2_hi - ((hfsq - (s*(hfsq+R) + e*ln2_lo)) - x).
+  Packet4d y = pmadd(s, padd(hfsq, padd(t2, t1)), pmul(e, p4d_ln2_lo));
+  y = psub(psub(hfsq, y), x);
+  x = psub(pmul(e, p4d_ln2_hi), y);
+
+  // Filter out invalid inputs, i.e. negative arg will be NAN, 0 will be -INF,
+  // and +INF remains +INF.
+  x = _mm256_blendv_pd(x, p4d_plus_inf, isinf_mask);
+  return _mm256_or_pd(
+      _mm256_andnot_pd(iszero_mask, _mm256_or_pd(x, invalid_mask)),
+      _mm256_and_pd(iszero_mask, p4d_minus_inf));
+}
+
+// Double-precision sine and cosine, a rewriting of the cephes sin and cos
+// functions. The octant of x is computed with 32-bit integers, so the
+// vectorized reduction is only used for |x| <= 2^29, and the packets holding
+// larger or non finite arguments are evaluated with the scalar functions.
+// The error of the vectorized path is below 1.5 ULP.
+template <bool ComputeSine>
+EIGEN_STRONG_INLINE Packet4d psincos_double(const Packet4d& _x) {
+  _EIGEN_DECLARE_CONST_Packet4d(sincos_max, 536870912.0);  // 2^29
+  if (_mm256_movemask_pd(_mm256_cmp_pd(pabs(_x), p4d_sincos_max, _CMP_NLE_UQ))) {
+    EIGEN_ALIGN32 double values[4];
+    pstore(values, _x);
+    for (int i = 0; i < 4; ++i)
+      values[i] = ComputeSine ? std::sin(values[i]) : std::cos(values[i]);
+    return pload<Packet4d>(values);
+  }
+
+  Packet4d x = _x;
+  _EIGEN_DECLARE_CONST_Packet4d(1, 1.0);
+  _EIGEN_DECLARE_CONST_Packet4d(half, 0.5);
+  _EIGEN_DECLARE_CONST_Packet4i(1, 1);
+  _EIGEN_DECLARE_CONST_Packet4i(not1, ~1);
+  _EIGEN_DECLARE_CONST_Packet4i(2, 2);
+  _EIGEN_DECLARE_CONST_Packet4i(4, 4);
+
+  const Packet4d p4d_sign_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x8000000000000000LL));
+
+  _EIGEN_DECLARE_CONST_Packet4d(minus_cephes_DP1, -7.85398125648498535156E-1);
+  _EIGEN_DECLARE_CONST_Packet4d(minus_cephes_DP2, -3.77489470793079817668E-8);
+  _EIGEN_DECLARE_CONST_Packet4d(minus_cephes_DP3, -2.69515142907905952645E-15);
+  _EIGEN_DECLARE_CONST_Packet4d(sincof_p0, 1.58962301576546568060E-10);
+  _EIGEN_DECLARE_CONST_Packet4d(sincof_p1, -2.50507477628578072866E-8);
+  _EIGEN_DECLARE_CONST_Packet4d(sincof_p2, 2.75573136213857245213E-6);
+  _EIGEN_DECLARE_CONST_Packet4d(sincof_p3, -1.98412698295895385996E-4);
+  _EIGEN_DECLARE_CONST_Packet4d(sincof_p4, 8.33333333332211858878E-3);
+  _EIGEN_DECLARE_CONST_Packet4d(sincof_p5, -1.66666666666666307295E-1);
+  _EIGEN_DECLARE_CONST_Packet4d(coscof_p0, -1.13585365213876817300E-11);
+  _EIGEN_DECLARE_CONST_Packet4d(coscof_p1, 2.08757008419747316778E-9);
+  _EIGEN_DECLARE_CONST_Packet4d(coscof_p2, -2.75573141792967388112E-7);
+  _EIGEN_DECLARE_CONST_Packet4d(coscof_p3, 2.48015872888517045348E-5);
+  _EIGEN_DECLARE_CONST_Packet4d(coscof_p4, -1.38888888888730564116E-3);
+  _EIGEN_DECLARE_CONST_Packet4d(coscof_p5, 4.16666666666665929218E-2);
+  _EIGEN_DECLARE_CONST_Packet4d(cephes_FOPI, 1.27323954473516268615);  // 4 / M_PI
+
+  Packet4d sign_bit = _mm256_and_pd(x, p4d_sign_mask);
+  x = pabs(x);
+
+  // Get the octant j of x, and round it up to the next even integer.
+  Packet4d y = pmul(x, p4d_cephes_FOPI);
+  __m128i emm2 = _mm256_cvttpd_epi32(y);
+  emm2 = _mm_add_epi32(emm2, p4i_1);
+  emm2 = _mm_and_si128(emm2, p4i_not1);
+  y = _mm256_cvtepi32_pd(emm2);
+
+  // Get the sign flip flag and the interpolant selection mask.
+  __m128i emm0;
+  if (ComputeSine) {
+    emm0 = _mm_and_si128(emm2, p4i_4);
+  } else {
+    emm2 = _mm_sub_epi32(emm2, p4i_2);
+    // The sign of the cosine does not depend on the sign of x.
+    sign_bit = _mm256_setzero_pd();
+    emm0 = _mm_andnot_si128(emm2, p4i_4);
+  }
+  emm0 = _mm_slli_epi32(emm0, 29);
+  emm2 = _mm_and_si128(emm2, p4i_2);
+  emm2 = _mm_cmpeq_epi32(emm2, _mm_setzero_si128());
+
+  // Expand the 32-bit flags to the 64-bit lanes of the double-precision values.
+  __m128i zero = _mm_setzero_si128();
+  Packet4d swap_sign_bit = _mm256_castsi256_pd(_mm256_setr_m128(
+      _mm_unpacklo_epi32(zero, emm0), _mm_unpackhi_epi32(zero, emm0)));
+  Packet4d poly_mask = _mm256_castsi256_pd(_mm256_setr_m128(
+      _mm_unpacklo_epi32(emm2, emm2), _mm_unpackhi_epi32(emm2, emm2)));
+  sign_bit = _mm256_xor_pd(sign_bit, swap_sign_bit);
+
+  // Extended precision modular arithmetic:
+  //   x = ((x - y * DP1) - y * DP2) - y * DP3
+  x = pmadd(y, p4d_minus_cephes_DP1, x);
+  x = pmadd(y, p4d_minus_cephes_DP2, x);
+  x = pmadd(y, p4d_minus_cephes_DP3, x);
+
+  Packet4d z = pmul(x, x);
+
+  // Evaluate the cosine interpolant on [-Pi/4,Pi/4].
+  y = p4d_coscof_p0;
+  y = pmadd(y, z, p4d_coscof_p1);
+  y = pmadd(y, z, p4d_coscof_p2);
+  y = pmadd(y, z, p4d_coscof_p3);
+  y = pmadd(y, z, p4d_coscof_p4);
+  y = pmadd(y, z, p4d_coscof_p5);
+  y = pmul(y, z);
+  y = pmul(y, z);
+  y = psub(y, pmul(z, p4d_half));
+  y = padd(y, p4d_1);
+
+  // Evaluate the sine interpolant on [-Pi/4,Pi/4].
+  Packet4d y2 = p4d_sincof_p0;
+  y2 = pmadd(y2, z, p4d_sincof_p1);
+  y2 = pmadd(y2, z, p4d_sincof_p2);
+  y2 = pmadd(y2, z, p4d_sincof_p3);
+  y2 = pmadd(y2, z, p4d_sincof_p4);
+  y2 = pmadd(y2, z, p4d_sincof_p5);
+  y2 = pmul(y2, z);
+  y2 = pmadd(y2, x, x);
+
+  // Select the correct interpolant and update the sign.
+  y = _mm256_blendv_pd(y, y2, poly_mask);
+  return _mm256_xor_pd(y, sign_bit);
+}
+
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet4d
+psin<Packet4d>(const Packet4d& x) {
+  return psincos_double<true>(x);
+}
+
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet4d
+pcos<Packet4d>(const Packet4d& x) {
+  return psincos_double<false>(x);
+}
+
+// Arc tangent, a rewriting of the cephes atanf function. The argument is
+// reduced to [0,tan(Pi/8)] using atan(x) = Pi/2 - atan(1/x) and
+// atan(x) = Pi/4 + atan((x-1)/(x+1)).
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet8f
+patan<Packet8f>(const Packet8f& _x) {
+  Packet8f x = _x;
+  _EIGEN_DECLARE_CONST_Packet8f(1, 1.0f);
+  _EIGEN_DECLARE_CONST_Packet8f(minus_1, -1.0f);
+  _EIGEN_DECLARE_CONST_Packet8f_FROM_INT(sign_mask, 0x80000000);
+  _EIGEN_DECLARE_CONST_Packet8f(cephes_T3PO8, 2.414213562373095f);  // tan(3*Pi/8)
+  _EIGEN_DECLARE_CONST_Packet8f(cephes_TPO8, 0.4142135623730950f);  // tan(Pi/8)
+  _EIGEN_DECLARE_CONST_Packet8f(cephes_PIO2, 1.5707963267948966f);
+  _EIGEN_DECLARE_CONST_Packet8f(cephes_PIO4, 0.7853981633974483f);
+  // The rounding errors of the float Pi/2 and Pi/4, added before them.
+  _EIGEN_DECLARE_CONST_Packet8f(PIO2_lo, -4.371138829e-08f);
+  _EIGEN_DECLARE_CONST_Packet8f(PIO4_lo, -2.185569414e-08f);
+  _EIGEN_DECLARE_CONST_Packet8f(atan_p0, 8.05374449538e-2f);
+  _EIGEN_DECLARE_CONST_Packet8f(atan_p1, -1.38776856032E-1f);
+  _EIGEN_DECLARE_CONST_Packet8f(atan_p2, 1.99777106478E-1f);
+  _EIGEN_DECLARE_CONST_Packet8f(atan_p3, -3.33329491539E-1f);
+
+  Packet8f sign_bit = _mm256_and_ps(x, p8f_sign_mask);
+  x = pabs(x);
+
+  // Range reduction.
+  Packet8f big_mask = _mm256_cmp_ps(x, p8f_cephes_T3PO8, _CMP_GT_OQ);
+  Packet8f mid_mask = _mm256_cmp_ps(x, p8f_cephes_TPO8, _CMP_GT_OQ);
+  Packet8f x_big = pdiv(p8f_minus_1, x);
+  Packet8f x_mid = pdiv(psub(x, p8f_1), padd(x, p8f_1));
+  Packet8f x_mid_err = _mm256_and_ps(mid_mask, generic_atan_reduction_error(x, x_mid));
+  x = _mm256_blendv_ps(x, x_mid, mid_mask);
+  x = _mm256_blendv_ps(x, x_big, big_mask);
+  Packet8f y0 = _mm256_and_ps(mid_mask, p8f_cephes_PIO4);
+  y0 = _mm256_blendv_ps(y0, p8f_cephes_PIO2, big_mask);
+  Packet8f y0_lo = _mm256_and_ps(mid_mask, p8f_PIO4_lo);
+  y0_lo = _mm256_blendv_ps(y0_lo, p8f_PIO2_lo, big_mask);
+  // atan(x_mid + x_mid_err) = atan(x_mid) + x_mid_err to first order.
+  y0_lo = padd(y0_lo, _mm256_andnot_ps(big_mask, x_mid_err));
+
+  // Evaluate the polynomial interpolant.
+  Packet8f z = pmul(x, x);
+  Packet8f y = p8f_atan_p0;
+  y = pmadd(y, z, p8f_atan_p1);
+  y = pmadd(y, z, p8f_atan_p2);
+  y = pmadd(y, z, p8f_atan_p3);
+  y = pmul(y, z);
+  y = pmadd(y, x, x);
+  y = padd(padd(y, y0_lo), y0);
+
+  // Update the sign.
+  return _mm256_xor_ps(y, sign_bit);
+}
+
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet8f
+ptanh<Packet8f>(const Packet8f& x) {
+  return generic_fast_tanh_float(x);
+}
+
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet8f
+perf<Packet8f>(const Packet8f& x) {
+  return generic_fast_erf_float(x);
+}
+
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet8f
+plog1p<Packet8f>(const Packet8f& x) {
+  return generic_plog1p(x);
+}
+
+template <>
+EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED Packet4d
+plog1p<Packet4d>(const Packet4d& x) {
+  return generic_plog1p(x);
+}
+
 // Functions for sqrt.
 // The EIGEN_FAST_MATH version uses the _mm_rsqrt_ps approximation and one step
 // of Newton's method, at a cost of 1-2 bits of precision as opposed to the
@@ -9,6 +9,15 @@
  * Julien Pommier's sse math library: http://gruntthepeon.free.fr/ssemath/
  */
 
+/* Only exp, tanh and erf are vectorized for NEON, and tanh and erf only on
+ * ARM64: on ARMv7, pdiv is a reciprocal estimate refined by a single Newton
+ * step, which is not accurate enough for their 2 ULP bound. The float atan
+ * and log1p, and the double sin, cos and log of the SSE and AVX back-ends are not ported:
+ * log1p needs a vectorized log, which NEON lacks, and the double functions
+ * rely on 64-bit integer operations on the exponents. Their HasATan, HasLog1p,
+ * HasSin, HasCos and HasLog flags are thus 0, and the scalar functions are used.
+ */
+
 #ifndef EIGEN_MATH_FUNCTIONS_NEON_H
 #define EIGEN_MATH_FUNCTIONS_NEON_H
 
@@ -84,6 +93,20 @@ Packet4f pexp<Packet4f>(const Packet4f& _x)
   return y;
 }
 
+#if EIGEN_ARCH_ARM64
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4f ptanh<Packet4f>(const Packet4f& x)
+{
+  return generic_fast_tanh_float(x);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4f perf<Packet4f>(const Packet4f& x)
+{
+  return generic_fast_erf_float(x);
+}
+#endif
+
 } // end namespace internal
 
 } // end namespace Eigen
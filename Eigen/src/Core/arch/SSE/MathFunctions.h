@@ -10,6 +10,8 @@
 
 /* The sin, cos, exp, and log functions of this file come from
  * Julien Pommier's sse math library: http://gruntthepeon.free.fr/ssemath/
+ * The double versions of sin, cos and log, as well as atan, are rewritings
+ * of the respective cephes functions following the same scheme.
  */
 
 #ifndef EIGEN_MATH_FUNCTIONS_SSE_H
@@ -32,6 +34,7 @@ Packet4f plog<Packet4f>(const Packet4f& _x)
   /* the smallest non denormalized float number */
   _EIGEN_DECLARE_CONST_Packet4f_FROM_INT(min_norm_pos,  0x00800000);
   _EIGEN_DECLARE_CONST_Packet4f_FROM_INT(minus_inf,     0xff800000);//-1.f/0.f);
+  _EIGEN_DECLARE_CONST_Packet4f_FROM_INT(plus_inf,      0x7f800000);
   
   /* natural logarithm computed for 4 simultaneous float
     return NaN for x <= 0
@@ -54,6 +57,7 @@ Packet4f plog<Packet4f>(const Packet4f& _x)
 
   Packet4f invalid_mask = _mm_cmpnge_ps(x, _mm_setzero_ps()); // not greater equal is true if x is NaN
   Packet4f iszero_mask = _mm_cmpeq_ps(x, _mm_setzero_ps());
+  Packet4f isinf_mask = _mm_cmpeq_ps(x, p4f_plus_inf);
 
   x = pmax(x, p4f_min_norm_pos);  /* cut off denormalized stuff */
   emm0 = _mm_srli_epi32(_mm_castps_si128(x), 23);
@@ -98,11 +102,110 @@ Packet4f plog<Packet4f>(const Packet4f& _x)
   y2 = pmul(e, p4f_cephes_log_q2);
   x = padd(x, y);
   x = padd(x, y2);
-  // negative arg will be NAN, 0 will be -INF
+  // negative arg will be NAN, 0 will be -INF, +INF remains +INF
+  x = _mm_or_ps(_mm_andnot_ps(isinf_mask, x), _mm_and_ps(isinf_mask, p4f_plus_inf));
   return _mm_or_ps(_mm_andnot_ps(iszero_mask, _mm_or_ps(x, invalid_mask)),
                    _mm_and_ps(iszero_mask, p4f_minus_inf));
 }
 
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet2d plog<Packet2d>(const Packet2d& _x)
+{
+  Packet2d x = _x;
+  _EIGEN_DECLARE_CONST_Packet2d(1 , 1.0);
+  _EIGEN_DECLARE_CONST_Packet2d(half, 0.5);
+  _EIGEN_DECLARE_CONST_Packet2d(52, 52.0);
+  _EIGEN_DECLARE_CONST_Packet2d(1022, 1022.0);
+
+  // 2^52, used to convert the biased exponent to a double
+  static const Packet2d p2d_2pow52 = _mm_castsi128_pd(_mm_setr_epi32(0x0,0x43300000,0x0,0x43300000));
+  static const Packet2d p2d_inv_mant_mask = _mm_castsi128_pd(_mm_setr_epi32(0xffffffff,0x800fffff,0xffffffff,0x800fffff));
+  /* the smallest non denormalized double number */
+  static const Packet2d p2d_min_norm_pos = _mm_castsi128_pd(_mm_setr_epi32(0x0,0x00100000,0x0,0x00100000));
+  static const Packet2d p2d_minus_inf = _mm_castsi128_pd(_mm_setr_epi32(0x0,0xfff00000,0x0,0xfff00000));
+  static const Packet2d p2d_plus_inf = _mm_castsi128_pd(_mm_setr_epi32(0x0,0x7ff00000,0x0,0x7ff00000));
+
+  /* natural logarithm computed for 2 simultaneous doubles
+    return NaN for x < 0, -inf for 0, and +inf for +inf
+  */
+  _EIGEN_DECLARE_CONST_Packet2d(cephes_SQRTHF, 0.70710678118654752440);
+  _EIGEN_DECLARE_CONST_Packet2d(2, 2.0);
+  /* the coefficients of R(z) and the split of log(2) of fdlibm: ln2_hi has 32 bits only,
+     so that e*ln2_hi is exact */
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg1, 6.666666666666735130e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg2, 3.999999999940941908e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg3, 2.857142874366239149e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg4, 2.222219843214978396e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg5, 1.818357216161805012e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg6, 1.531383769920937332e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(log_Lg7, 1.479819860511658591e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(ln2_hi, 6.93147180369123816490e-01);
+  _EIGEN_DECLARE_CONST_Packet2d(ln2_lo, 1.90821492927058770002e-10);
+
+  Packet2d invalid_mask = _mm_cmpnge_pd(x, _mm_setzero_pd()); // not greater equal is true if x is NaN
+  Packet2d iszero_mask = _mm_cmpeq_pd(x, _mm_setzero_pd());
+  Packet2d isinf_mask = _mm_cmpeq_pd(x, p2d_plus_inf);
+
+  /* scale the denormalized numbers by 2^52 to make them normalized */
+  Packet2d denorm_mask = _mm_cmplt_pd(x, p2d_min_norm_pos);
+  x = pmul(x, _mm_or_pd(_mm_and_pd(denorm_mask, p2d_2pow52), _mm_andnot_pd(denorm_mask, p2d_1)));
+  x = pmax(x, p2d_min_norm_pos);  /* cut off the zero and negative numbers */
+
+  /* extract the biased exponent, and convert it to a double by
+     inserting it into the mantissa of 2^52 */
+  Packet2d e = _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(x), 52));
+  e = psub(_mm_or_pd(e, p2d_2pow52), p2d_2pow52);
+  e = psub(e, p2d_1022);
+  e = psub(e, _mm_and_pd(denorm_mask, p2d_52));
+
+  /* keep only the fractional part */
+  x = _mm_and_pd(x, p2d_inv_mant_mask);
+  x = _mm_or_pd(x, p2d_half);
+
+  /* part2:
+     if( x < SQRTHF ) {
+       e -= 1;
+       x = x + x - 1.0;
+     } else { x = x - 1.0; }
+  */
+  Packet2d mask = _mm_cmplt_pd(x, p2d_cephes_SQRTHF);
+  Packet2d tmp = pand(x, mask);
+  x = psub(x, p2d_1);
+  e = psub(e, pand(p2d_1, mask));
+  x = padd(x, tmp);
+
+  /* log(1+x) = x - hfsq + s*(hfsq+R(s^2)) with hfsq = x^2/2 and s = x/(2+x), as in fdlibm.
+     Unlike the rational interpolant of cephes, this is accurate to less than 1 ULP
+     over the whole reduced range, including next to sqrt(1/2) and sqrt(2). */
+  Packet2d s = pdiv(x, padd(p2d_2, x));
+  Packet2d z = pmul(s, s);
+  Packet2d w = pmul(z, z);
+  Packet2d t1 = pmul(w, pmadd(pmadd(p2d_log_Lg6, w, p2d_log_Lg4), w, p2d_log_Lg2));
+  Packet2d t2 = pmul(z, pmadd(pmadd(pmadd(p2d_log_Lg7, w, p2d_log_Lg5), w, p2d_log_Lg3), w, p2d_log_Lg1));
+  Packet2d hfsq = pmul(p2d_half, pmul(x, x));
+
+  /* e*ln2_hi - ((hfsq - (s*(hfsq+R) + e*ln2_lo)) - x) */
+  Packet2d y = pmadd(s, padd(hfsq, padd(t2, t1)), pmul(e, p2d_ln2_lo));
+  y = psub(psub(hfsq, y), x);
+  x = psub(pmul(e, p2d_ln2_hi), y);
+  // negative arg will be NAN, 0 will be -INF, +INF remains +INF
+  x = _mm_or_pd(_mm_andnot_pd(isinf_mask, x), _mm_and_pd(isinf_mask, p2d_plus_inf));
+  return _mm_or_pd(_mm_andnot_pd(iszero_mask, _mm_or_pd(x, invalid_mask)),
+                   _mm_and_pd(iszero_mask, p2d_minus_inf));
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4f plog1p<Packet4f>(const Packet4f& x)
+{
+  return generic_plog1p(x);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet2d plog1p<Packet2d>(const Packet2d& x)
+{
+  return generic_plog1p(x);
+}
+
 template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
 Packet4f pexp<Packet4f>(const Packet4f& _x)
 {
@@ -442,6 +545,206 @@ Packet4f pcos<Packet4f>(const Packet4f& _x)
   return _mm_xor_ps(y, sign_bit);
 }
 
+/* evaluation of 2 double sines or cosines at once.
+
+   This is the rewriting of the cephes sin and cos functions for doubles,
+   following the same scheme as the float versions above. The octant is
+   selected with 32 bits integers, and the reduction loses its accuracy when
+   the integer part of x*4/Pi gets large: the packets holding an argument
+   larger than 2^29, or a non finite one, are evaluated with the scalar
+   functions. The error of the vectorized path is below 1.5 ULP.
+*/
+template<bool ComputeSine>
+EIGEN_STRONG_INLINE Packet2d psincos_double(const Packet2d& _x)
+{
+  _EIGEN_DECLARE_CONST_Packet2d(sincos_max, 536870912.0); // 2^29
+  if(_mm_movemask_pd(_mm_cmpnle_pd(pabs(_x), p2d_sincos_max)))
+  {
+    EIGEN_ALIGN16 double values[2];
+    pstore(values, _x);
+    for(int i=0; i<2; ++i)
+      values[i] = ComputeSine ? std::sin(values[i]) : std::cos(values[i]);
+    return pload<Packet2d>(values);
+  }
+
+  Packet2d x = _x;
+  _EIGEN_DECLARE_CONST_Packet2d(1 , 1.0);
+  _EIGEN_DECLARE_CONST_Packet2d(half, 0.5);
+
+  _EIGEN_DECLARE_CONST_Packet4i(1, 1);
+  _EIGEN_DECLARE_CONST_Packet4i(not1, ~1);
+  _EIGEN_DECLARE_CONST_Packet4i(2, 2);
+  _EIGEN_DECLARE_CONST_Packet4i(4, 4);
+
+  static const Packet2d p2d_sign_mask = _mm_castsi128_pd(_mm_setr_epi32(0x0,0x80000000,0x0,0x80000000));
+
+  _EIGEN_DECLARE_CONST_Packet2d(minus_cephes_DP1, -7.85398125648498535156E-1);
+  _EIGEN_DECLARE_CONST_Packet2d(minus_cephes_DP2, -3.77489470793079817668E-8);
+  _EIGEN_DECLARE_CONST_Packet2d(minus_cephes_DP3, -2.69515142907905952645E-15);
+  _EIGEN_DECLARE_CONST_Packet2d(sincof_p0,  1.58962301576546568060E-10);
+  _EIGEN_DECLARE_CONST_Packet2d(sincof_p1, -2.50507477628578072866E-8);
+  _EIGEN_DECLARE_CONST_Packet2d(sincof_p2,  2.75573136213857245213E-6);
+  _EIGEN_DECLARE_CONST_Packet2d(sincof_p3, -1.98412698295895385996E-4);
+  _EIGEN_DECLARE_CONST_Packet2d(sincof_p4,  8.33333333332211858878E-3);
+  _EIGEN_DECLARE_CONST_Packet2d(sincof_p5, -1.66666666666666307295E-1);
+  _EIGEN_DECLARE_CONST_Packet2d(coscof_p0, -1.13585365213876817300E-11);
+  _EIGEN_DECLARE_CONST_Packet2d(coscof_p1,  2.08757008419747316778E-9);
+  _EIGEN_DECLARE_CONST_Packet2d(coscof_p2, -2.75573141792967388112E-7);
+  _EIGEN_DECLARE_CONST_Packet2d(coscof_p3,  2.48015872888517045348E-5);
+  _EIGEN_DECLARE_CONST_Packet2d(coscof_p4, -1.38888888888730564116E-3);
+  _EIGEN_DECLARE_CONST_Packet2d(coscof_p5,  4.16666666666665929218E-2);
+  _EIGEN_DECLARE_CONST_Packet2d(cephes_FOPI, 1.27323954473516268615); // 4 / M_PI
+
+  Packet2d sign_bit = _mm_and_pd(x, p2d_sign_mask);
+  x = pabs(x);
+
+  /* scale by 4/Pi */
+  Packet2d y = pmul(x, p2d_cephes_FOPI);
+
+  /* get the integer part of y (in the two lower 32 bits integers) */
+  Packet4i emm2 = _mm_cvttpd_epi32(y);
+  /* j=(j+1) & (~1) (see the cephes sources) */
+  emm2 = _mm_add_epi32(emm2, p4i_1);
+  emm2 = _mm_and_si128(emm2, p4i_not1);
+  y = _mm_cvtepi32_pd(emm2);
+
+  Packet4i emm0;
+  if(ComputeSine)
+  {
+    /* get the swap sign flag */
+    emm0 = _mm_and_si128(emm2, p4i_4);
+  }
+  else
+  {
+    emm2 = _mm_sub_epi32(emm2, p4i_2);
+    /* the sign of the cosine does not depend on the sign of x */
+    sign_bit = _mm_setzero_pd();
+    emm0 = _mm_andnot_si128(emm2, p4i_4);
+  }
+  emm0 = _mm_slli_epi32(emm0, 29);
+  /* get the polynom selection mask */
+  emm2 = _mm_and_si128(emm2, p4i_2);
+  emm2 = _mm_cmpeq_epi32(emm2, _mm_setzero_si128());
+
+  /* expand the 32 bits flags of the two lower integers to 64 bits masks */
+  Packet2d swap_sign_bit = _mm_castsi128_pd(_mm_shuffle_epi32(emm0, _MM_SHUFFLE(1,3,0,3)));
+  Packet2d poly_mask = _mm_castsi128_pd(_mm_shuffle_epi32(emm2, _MM_SHUFFLE(1,1,0,0)));
+  sign_bit = _mm_xor_pd(sign_bit, swap_sign_bit);
+
+  /* The magic pass: "Extended precision modular arithmetic"
+     x = ((x - y * DP1) - y * DP2) - y * DP3; */
+  x = pmadd(y, p2d_minus_cephes_DP1, x);
+  x = pmadd(y, p2d_minus_cephes_DP2, x);
+  x = pmadd(y, p2d_minus_cephes_DP3, x);
+
+  Packet2d z = pmul(x,x);
+
+  /* Evaluate the first polynom  (0 <= x <= Pi/4) */
+  y = p2d_coscof_p0;
+  y = pmadd(y, z, p2d_coscof_p1);
+  y = pmadd(y, z, p2d_coscof_p2);
+  y = pmadd(y, z, p2d_coscof_p3);
+  y = pmadd(y, z, p2d_coscof_p4);
+  y = pmadd(y, z, p2d_coscof_p5);
+  y = pmul(y, z);
+  y = pmul(y, z);
+  y = psub(y, pmul(z, p2d_half));
+  y = padd(y, p2d_1);
+
+  /* Evaluate the second polynom  (Pi/4 <= x <= 0) */
+  Packet2d y2 = p2d_sincof_p0;
+  y2 = pmadd(y2, z, p2d_sincof_p1);
+  y2 = pmadd(y2, z, p2d_sincof_p2);
+  y2 = pmadd(y2, z, p2d_sincof_p3);
+  y2 = pmadd(y2, z, p2d_sincof_p4);
+  y2 = pmadd(y2, z, p2d_sincof_p5);
+  y2 = pmul(y2, z);
+  y2 = pmadd(y2, x, x);
+
+  /* select the correct result from the two polynoms */
+  y2 = _mm_and_pd(poly_mask, y2);
+  y  = _mm_andnot_pd(poly_mask, y);
+  y  = _mm_or_pd(y,y2);
+
+  /* update the sign */
+  return _mm_xor_pd(y, sign_bit);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet2d psin<Packet2d>(const Packet2d& x)
+{
+  return psincos_double<true>(x);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet2d pcos<Packet2d>(const Packet2d& x)
+{
+  return psincos_double<false>(x);
+}
+
+/* evaluation of 4 arc tangents at once, rewriting of the cephes atanf function:
+   the argument is reduced to [0, tan(Pi/8)] using atan(x) = Pi/2 - atan(1/x)
+   and atan(x) = Pi/4 + atan((x-1)/(x+1)). */
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4f patan<Packet4f>(const Packet4f& _x)
+{
+  Packet4f x = _x;
+  _EIGEN_DECLARE_CONST_Packet4f(1 , 1.0f);
+  _EIGEN_DECLARE_CONST_Packet4f(minus_1 , -1.0f);
+  _EIGEN_DECLARE_CONST_Packet4f_FROM_INT(sign_mask, 0x80000000);
+  _EIGEN_DECLARE_CONST_Packet4f(cephes_T3PO8, 2.414213562373095f);  // tan(3*Pi/8)
+  _EIGEN_DECLARE_CONST_Packet4f(cephes_TPO8, 0.4142135623730950f);  // tan(Pi/8)
+  _EIGEN_DECLARE_CONST_Packet4f(cephes_PIO2, 1.5707963267948966f);
+  _EIGEN_DECLARE_CONST_Packet4f(cephes_PIO4, 0.7853981633974483f);
+  // the rounding errors of the float Pi/2 and Pi/4, added before them
+  _EIGEN_DECLARE_CONST_Packet4f(PIO2_lo, -4.371138829e-08f);
+  _EIGEN_DECLARE_CONST_Packet4f(PIO4_lo, -2.185569414e-08f);
+  _EIGEN_DECLARE_CONST_Packet4f(atan_p0,  8.05374449538e-2f);
+  _EIGEN_DECLARE_CONST_Packet4f(atan_p1, -1.38776856032E-1f);
+  _EIGEN_DECLARE_CONST_Packet4f(atan_p2,  1.99777106478E-1f);
+  _EIGEN_DECLARE_CONST_Packet4f(atan_p3, -3.33329491539E-1f);
+
+  Packet4f sign_bit = _mm_and_ps(x, p4f_sign_mask);
+  x = pabs(x);
+
+  /* range reduction */
+  Packet4f big_mask = _mm_cmpgt_ps(x, p4f_cephes_T3PO8);
+  Packet4f mid_mask = _mm_andnot_ps(big_mask, _mm_cmpgt_ps(x, p4f_cephes_TPO8));
+  Packet4f x_big = pdiv(p4f_minus_1, x);
+  Packet4f x_mid = pdiv(psub(x, p4f_1), padd(x, p4f_1));
+  Packet4f x_mid_err = _mm_and_ps(mid_mask, generic_atan_reduction_error(x, x_mid));
+  x = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(big_mask, mid_mask), x),
+                _mm_or_ps(_mm_and_ps(big_mask, x_big), _mm_and_ps(mid_mask, x_mid)));
+  Packet4f y0 = _mm_or_ps(_mm_and_ps(big_mask, p4f_cephes_PIO2), _mm_and_ps(mid_mask, p4f_cephes_PIO4));
+  Packet4f y0_lo = _mm_or_ps(_mm_and_ps(big_mask, p4f_PIO2_lo), _mm_and_ps(mid_mask, p4f_PIO4_lo));
+  /* atan(x_mid + x_mid_err) = atan(x_mid) + x_mid_err to first order */
+  y0_lo = padd(y0_lo, x_mid_err);
+
+  Packet4f z = pmul(x, x);
+  Packet4f y = p4f_atan_p0;
+  y = pmadd(y, z, p4f_atan_p1);
+  y = pmadd(y, z, p4f_atan_p2);
+  y = pmadd(y, z, p4f_atan_p3);
+  y = pmul(y, z);
+  y = pmadd(y, x, x);
+  y = padd(padd(y, y0_lo), y0);
+
+  /* update the sign */
+  return _mm_xor_ps(y, sign_bit);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4f ptanh<Packet4f>(const Packet4f& x)
+{
+  return generic_fast_tanh_float(x);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4f perf<Packet4f>(const Packet4f& x)
+{
+  return generic_fast_erf_float(x);
+}
+
 #if EIGEN_FAST_MATH
 
 // This is based on Quake3's fast inverse square root.
@@ -254,6 +254,22 @@ template<typename Scalar>
 struct functor_traits<scalar_log_op<Scalar> >
 { enum { Cost = 5 * NumTraits<Scalar>::MulCost, PacketAccess = packet_traits<Scalar>::HasLog }; };
 
+/** \internal
+  *
+  * \brief Template functor to compute the logarithm of 1 plus a scalar
+  *
+  * \sa class CwiseUnaryOp, ArrayBase::log1p()
+  */
+template<typename Scalar> struct scalar_log1p_op {
+  EIGEN_EMPTY_STRUCT_CTOR(scalar_log1p_op)
+  inline const Scalar operator() (const Scalar& a) const { return numext::log1p(a); }
+  typedef typename packet_traits<Scalar>::type Packet;
+  inline Packet packetOp(const Packet& a) const { return internal::plog1p(a); }
+};
+template<typename Scalar>
+struct functor_traits<scalar_log1p_op<Scalar> >
+{ enum { Cost = 5 * NumTraits<Scalar>::MulCost, PacketAccess = packet_traits<Scalar>::HasLog1p }; };
+
 /** \internal
   *
   * \brief Template functor to compute the base-10 logarithm of a scalar
@@ -441,6 +457,25 @@ struct functor_traits<scalar_tanh_op<Scalar> >
   };
 };
 
+/** \internal
+  * \brief Template functor to compute the error function of a scalar
+  * \sa class CwiseUnaryOp, ArrayBase::erf()
+  */
+template<typename Scalar> struct scalar_erf_op {
+  EIGEN_EMPTY_STRUCT_CTOR(scalar_erf_op)
+  inline const Scalar operator() (const Scalar& a) const { return numext::erf(a); }
+  typedef typename packet_traits<Scalar>::type Packet;
+  inline Packet packetOp(const Packet& a) const { return internal::perf(a); }
+};
+template<typename Scalar>
+struct functor_traits<scalar_erf_op<Scalar> >
+{
+  enum {
+    Cost = 10 * NumTraits<Scalar>::MulCost,
+    PacketAccess = packet_traits<Scalar>::HasErf
+  };
+};
+
 /** \internal
   * \brief Template functor to compute the sinh of a scalar
   * \sa class CwiseUnaryOp, ArrayBase::sinh()
@@ -611,6 +611,103 @@ EIGEN_DONT_INLINE void general_matrix_vector_product<Index,LhsScalar,LhsMapper,R
   #undef _EIGEN_ACCUMULATE_PACKETS
 }
 
+/* Multi-threaded matrix * vector product:
+ * This is a thin layer on top of the single-threaded kernels above which splits
+ * the product among the threads returned by parallel_gemv_threads():
+ *  - by blocks of rows: each thread computes a contiguous segment of the result
+ *    from the respective horizontal panel of the lhs. This is the default for
+ *    both storage orders as it does not require any synchronization.
+ *  - by blocks of columns for short and wide col-major products (e.g., A^T*x with
+ *    a row-major A), for which the rows cannot feed all the threads: each thread
+ *    accumulates the product of a vertical panel into its own buffer, and the
+ *    partial results are then summed in parallel over segments of the result.
+ */
+template<typename Index, typename LhsScalar, typename LhsMapper, int LhsStorageOrder, bool ConjugateLhs, typename RhsScalar, typename RhsMapper, bool ConjugateRhs>
+struct parallel_general_matrix_vector_product
+{
+  typedef general_matrix_vector_product<Index,LhsScalar,LhsMapper,LhsStorageOrder,ConjugateLhs,RhsScalar,RhsMapper,ConjugateRhs> Kernel;
+  typedef typename Kernel::ResScalar ResScalar;
+  typedef typename conditional<LhsStorageOrder==ColMajor,RhsScalar,ResScalar>::type AlphaScalar;
+
+  static void run(Index rows, Index cols,
+                  const LhsMapper& lhs, const RhsMapper& rhs,
+                  ResScalar* res, Index resIncr,
+                  AlphaScalar alpha)
+  {
+#if !(defined (EIGEN_HAS_OPENMP)) || defined (EIGEN_USE_BLAS)
+    Kernel::run(rows, cols, lhs, rhs, res, resIncr, alpha);
+#else
+    Index threads = parallel_gemv_threads(rows, cols);
+    if(threads<=1)
+      return Kernel::run(rows, cols, lhs, rhs, res, resIncr, alpha);
+
+    // Blocks are multiple of 16 scalars such that the alignment of the sub-problems
+    // does not depend on the number of threads.
+    const Index granularity = 16;
+    if(LhsStorageOrder==ColMajor && rows < threads*granularity*4)
+      run_column_split(rows, cols, lhs, rhs, res, alpha, threads, granularity);
+    else
+    {
+      threads = (std::min)(threads, std::max<Index>(1,rows/granularity));
+      Eigen::initParallel();
+      #pragma omp parallel for schedule(static) num_threads(int(threads))
+      for(Index t=0; t<threads; ++t)
+      {
+        Index blockRows = ((rows/threads)/granularity)*granularity;
+        Index r0 = t*blockRows;
+        Index actualBlockRows = (t+1==threads) ? rows-r0 : blockRows;
+        Kernel::run(actualBlockRows, cols, lhs.getSubMapper(r0,0), rhs, res+r0*resIncr, resIncr, alpha);
+      }
+    }
+#endif
+  }
+
+protected:
+#if (defined (EIGEN_HAS_OPENMP)) && !defined (EIGEN_USE_BLAS)
+  static void run_column_split(Index rows, Index cols,
+                               const LhsMapper& lhs, const RhsMapper& rhs,
+                               ResScalar* res, AlphaScalar alpha,
+                               Index threads, Index granularity)
+  {
+    threads = (std::min)(threads, std::max<Index>(1,cols/granularity));
+    if(threads<=1)
+      return Kernel::run(rows, cols, lhs, rhs, res, 1, alpha);
+
+    // one buffer per thread but the first one which directly accumulates into res
+    const Index bufferStride = (rows+granularity-1)/granularity*granularity;
+    ei_declare_aligned_stack_constructed_variable(ResScalar, buffers, bufferStride*(threads-1), 0);
+    Eigen::initParallel();
+    #pragma omp parallel for schedule(static) num_threads(int(threads))
+    for(Index t=0; t<threads; ++t)
+    {
+      Index blockCols = ((cols/threads)/granularity)*granularity;
+      Index c0 = t*blockCols;
+      Index actualBlockCols = (t+1==threads) ? cols-c0 : blockCols;
+      ResScalar* dst = res;
+      if(t>0)
+      {
+        dst = buffers + (t-1)*bufferStride;
+        std::fill(dst, dst+rows, ResScalar(0));
+      }
+      Kernel::run(rows, actualBlockCols, lhs.getSubMapper(0,c0), rhs.getSubMapper(c0,0), dst, 1, alpha);
+    }
+
+    // reduction of the partial results, each thread sums a segment of all the buffers
+    Index segments = (std::min)(threads, std::max<Index>(1,rows/granularity));
+    #pragma omp parallel for schedule(static) num_threads(int(segments))
+    for(Index s=0; s<segments; ++s)
+    {
+      Index blockRows = ((rows/segments)/granularity)*granularity;
+      Index r0 = s*blockRows;
+      Index actualBlockRows = (s+1==segments) ? rows-r0 : blockRows;
+      Map<Matrix<ResScalar,Dynamic,1> > segment(res+r0, actualBlockRows);
+      for(Index t=0; t<threads-1; ++t)
+        segment += Map<const Matrix<ResScalar,Dynamic,1> >(buffers+t*bufferStride+r0, actualBlockRows);
+    }
+  }
+#endif
+};
+
 } // end namespace internal
 
 } // end namespace Eigen
@@ -152,6 +152,31 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, bool transpos
 #endif
 }
 
+/** \internal
+  * \returns the number of threads to use for a level-2 kernel (matrix-vector product
+  * or triangular solve) involving a \a rows x \a cols matrix.
+  * It returns 1 if OpenMP is disabled, if we are already in a parallel session,
+  * or if the operation is too small to be worth parallelizing.
+  */
+template<typename Index>
+Index parallel_gemv_threads(Index rows, Index cols)
+{
+#if !(defined (EIGEN_HAS_OPENMP)) || defined (EIGEN_USE_BLAS)
+  EIGEN_UNUSED_VARIABLE(rows);
+  EIGEN_UNUSED_VARIABLE(cols);
+  return 1;
+#else
+  if(omp_get_num_threads()>1)
+    return 1;
+
+  // Matrix-vector products are memory bound, so each thread must stream a
+  // large enough block of the matrix to amortize the synchronization.
+  // FIXME this has to be fine tuned
+  double max_threads = std::max<double>(1., (double(rows)*double(cols)) / double(1<<16));
+  return Index(std::min<double>(nbThreads(), max_threads));
+#endif
+}
+
 } // end namespace internal
 
 } // end namespace Eigen
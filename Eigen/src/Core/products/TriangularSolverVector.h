@@ -14,6 +14,21 @@ namespace Eigen {
 
 namespace internal {
 
+/* The substitutions below proceed by panels: the diagonal block of each panel is
+ * solved sequentially, while the remaining part of the rhs is updated by a
+ * matrix-vector product. When this product can be multi-threaded, we use much
+ * larger panels (whose diagonal blocks are recursively solved using the default
+ * narrow panels) such that each parallel product has enough work.
+ */
+template<typename Index>
+inline Index triangular_solve_vector_panel_width(Index size)
+{
+  const Index ParallelPanelWidth = 32*EIGEN_TUNE_TRIANGULAR_PANEL_WIDTH;
+  if(size>2*ParallelPanelWidth && parallel_gemv_threads(size, ParallelPanelWidth)>1)
+    return ParallelPanelWidth;
+  return EIGEN_TUNE_TRIANGULAR_PANEL_WIDTH;
+}
+
 template<typename LhsScalar, typename RhsScalar, typename Index, int Mode, bool Conjugate, int StorageOrder>
 struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheRight, Mode, Conjugate, StorageOrder>
 {
@@ -46,7 +61,7 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
                           const CwiseUnaryOp<typename internal::scalar_conjugate_op<LhsScalar>,LhsMap>,
                           const LhsMap&>
                         ::type cjLhs(lhs);
-    static const Index PanelWidth = EIGEN_TUNE_TRIANGULAR_PANEL_WIDTH;
+    const Index PanelWidth = triangular_solve_vector_panel_width(size);
     for(Index pi=IsLower ? 0 : size;
         IsLower ? pi<size : pi>0;
         IsLower ? pi+=PanelWidth : pi-=PanelWidth)
@@ -62,7 +77,7 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
         Index startRow = IsLower ? pi : pi-actualPanelWidth;
         Index startCol = IsLower ? 0 : pi;
 
-        general_matrix_vector_product<Index,LhsScalar,LhsMapper,RowMajor,Conjugate,RhsScalar,RhsMapper,false>::run(
+        parallel_general_matrix_vector_product<Index,LhsScalar,LhsMapper,RowMajor,Conjugate,RhsScalar,RhsMapper,false>::run(
           actualPanelWidth, r,
           LhsMapper(&lhs.coeffRef(startRow,startCol), lhsStride),
           RhsMapper(rhs + startCol, 1),
@@ -70,6 +85,14 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
           RhsScalar(-1));
       }
 
+      if(actualPanelWidth>EIGEN_TUNE_TRIANGULAR_PANEL_WIDTH)
+      {
+        // large diagonal block of the multi-threaded path
+        Index startRow = IsLower ? pi : pi-actualPanelWidth;
+        run(actualPanelWidth, &lhs.coeffRef(startRow,startRow), lhsStride, rhs+startRow);
+        continue;
+      }
+
       for(Index k=0; k<actualPanelWidth; ++k)
       {
         Index i = IsLower ? pi+k : pi-k-1;
@@ -101,7 +124,7 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
                                    const CwiseUnaryOp<typename internal::scalar_conjugate_op<LhsScalar>,LhsMap>,
                                    const LhsMap&
                                   >::type cjLhs(lhs);
-    static const Index PanelWidth = EIGEN_TUNE_TRIANGULAR_PANEL_WIDTH;
+    const Index PanelWidth = triangular_solve_vector_panel_width(size);
 
     for(Index pi=IsLower ? 0 : size;
         IsLower ? pi<size : pi>0;
@@ -111,7 +134,12 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
       Index startBlock = IsLower ? pi : pi-actualPanelWidth;
       Index endBlock = IsLower ? pi + actualPanelWidth : 0;
 
-      for(Index k=0; k<actualPanelWidth; ++k)
+      if(actualPanelWidth>EIGEN_TUNE_TRIANGULAR_PANEL_WIDTH)
+      {
+        // large diagonal block of the multi-threaded path
+        run(actualPanelWidth, &lhs.coeffRef(startBlock,startBlock), lhsStride, rhs+startBlock);
+      }
+      else for(Index k=0; k<actualPanelWidth; ++k)
       {
         Index i = IsLower ? pi+k : pi-k-1;
         if(!(Mode & UnitDiag))
@@ -128,7 +156,7 @@ struct triangular_solve_vector<LhsScalar, RhsScalar, Index, OnTheLeft, Mode, Con
         // let's directly call the low level product function because:
         // 1 - it is faster to compile
         // 2 - it is slighlty faster at runtime
-        general_matrix_vector_product<Index,LhsScalar,LhsMapper,ColMajor,Conjugate,RhsScalar,RhsMapper,false>::run(
+        parallel_general_matrix_vector_product<Index,LhsScalar,LhsMapper,ColMajor,Conjugate,RhsScalar,RhsMapper,false>::run(
             r, actualPanelWidth,
             LhsMapper(&lhs.coeffRef(endBlock,startBlock), lhsStride),
             RhsMapper(rhs+startBlock, 1),
@@ -282,6 +282,9 @@ template<typename Derived> class MatrixLogarithmReturnValue;
 template<typename Derived> class MatrixPowerReturnValue;
 template<typename Derived> class MatrixComplexPowerReturnValue;
 
+// products/Parallelizer.h
+inline int nbThreads();
+
 namespace internal {
 template <typename Scalar>
 struct stem_function
@@ -0,0 +1,279 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_POINT_SET_PRODUCT_H
+#define EIGEN_POINT_SET_PRODUCT_H
+
+namespace Eigen {
+
+namespace internal {
+
+// Accumulates the terms O to Width-1 of the stencil computing the Q-th packet of a group of interleaved points
+template<int Dim, int Q, int O, int Width = 2*Dim-1>
+struct point_set_stencil_unroller
+{
+  template<typename Packet, typename Scalar>
+  static EIGEN_STRONG_INLINE Packet run(const Packet (*coeffs)[Width], const Packet (*masks)[Width], const Scalar* s, const Packet& r)
+  {
+    Packet x = ploadu<Packet>(s+O);
+    if(O!=Dim-1)
+      x = pand(masks[Q][O], x);
+    return point_set_stencil_unroller<Dim,Q,O+1>::run(coeffs, masks, s, pmadd(coeffs[Q][O], x, r));
+  }
+};
+
+template<int Dim, int Q, int Width>
+struct point_set_stencil_unroller<Dim,Q,Width,Width>
+{
+  template<typename Packet, typename Scalar>
+  static EIGEN_STRONG_INLINE Packet run(const Packet (*)[Width], const Packet (*)[Width], const Scalar*, const Packet& r) { return r; }
+};
+
+// Computes the packets Q to Dim-1 of a group of interleaved points
+template<int Dim, int Q>
+struct point_set_interleaved_unroller
+{
+  template<typename Packet, typename Scalar>
+  static EIGEN_STRONG_INLINE void run(const Packet (*coeffs)[2*Dim-1], const Packet (*masks)[2*Dim-1], const Packet* offsets,
+                                      const Scalar* src, Scalar* dst)
+  {
+    enum { PacketSize = unpacket_traits<Packet>::size };
+    pstoreu(dst + Q*PacketSize,
+            point_set_stencil_unroller<Dim,Q,0>::run(coeffs, masks, src + Q*PacketSize - (Dim-1), offsets[Q]));
+    point_set_interleaved_unroller<Dim,Q+1>::run(coeffs, masks, offsets, src, dst);
+  }
+};
+
+template<int Dim>
+struct point_set_interleaved_unroller<Dim,Dim>
+{
+  template<typename Packet, typename Scalar>
+  static EIGEN_STRONG_INLINE void run(const Packet (*)[2*Dim-1], const Packet (*)[2*Dim-1], const Packet*, const Scalar*, Scalar*) {}
+};
+
+// Computes the coordinates I to Dim-1 of a packet of planar points
+template<int Dim, int I>
+struct point_set_planar_unroller
+{
+  template<typename Packet, typename Scalar>
+  static EIGEN_STRONG_INLINE void run(const Packet (*coeffs)[Dim], const Packet* offsets, const Packet* x, Scalar* dst, Index dstStride)
+  {
+    Packet r = offsets[I];
+    for(int k=0; k<Dim; ++k)
+      r = pmadd(coeffs[I][k], x[k], r);
+    pstoreu(dst + I*dstStride, r);
+    point_set_planar_unroller<Dim,I+1>::run(coeffs, offsets, x, dst, dstStride);
+  }
+};
+
+template<int Dim>
+struct point_set_planar_unroller<Dim,Dim>
+{
+  template<typename Packet, typename Scalar>
+  static EIGEN_STRONG_INLINE void run(const Packet (*)[Dim], const Packet*, const Packet*, Scalar*, Index) {}
+};
+
+/** \internal
+  * Applies the affine map x -> linear * x + translation to a large set of \a Dim dimensional points.
+  *
+  * The points are either interleaved, i.e., stored one per column of a column-major matrix as in a Matrix3Xf,
+  * or planar, i.e., stored one coordinate per row of a row-major matrix (structure of arrays).
+  * The generic matrix product handles such a product as a product with a tiny depth which cannot be vectorized
+  * efficiently, whereas here each packet carries the coordinates of several points:
+  *  - in the planar case, a packet loads the same coordinate of PacketSize consecutive points;
+  *  - in the interleaved case, Dim consecutive packets cover exactly PacketSize points and the coordinate held
+  *    by each entry only depends on the position of the packet in that group. Each output packet is thus a
+  *    stencil of 2*Dim-1 shifted unaligned loads weighted by precomputed coefficient packets. The entries of the
+  *    loads which belong to another point are masked out so that NaN or infinite coordinates do not spread to
+  *    the neighbouring points.
+  */
+template<typename Scalar, int Dim>
+class affine_point_set_kernel
+{
+    typedef typename packet_traits<Scalar>::type Packet;
+    enum {
+      PacketSize = packet_traits<Scalar>::size,
+      Width = 2*Dim-1
+    };
+  public:
+    typedef Matrix<Scalar,Dim,Dim> LinearType;
+    typedef Matrix<Scalar,Dim,1> VectorType;
+
+    affine_point_set_kernel(const LinearType& linear, const VectorType& translation)
+      : m_linear(linear), m_translation(translation)
+    {
+      for(int q=0; q<Dim; ++q)
+      {
+        for(int e=0; e<PacketSize; ++e)
+        {
+          // coordinate held by the entry e of the q-th packet of a group
+          int i = (q*PacketSize+e) % Dim;
+          for(int o=0; o<Width; ++o)
+          {
+            int k = i + o - (Dim-1);
+            bool samePoint = k>=0 && k<Dim;
+            m_coeffs[q][o][e] = samePoint ? linear(i,k) : Scalar(0);
+            std::memset(&m_masks[q][o][e], samePoint ? 0xff : 0, sizeof(Scalar));
+          }
+          m_offsets[q][e] = translation(i);
+        }
+      }
+    }
+
+    /** Transforms the interleaved points of indices \a begin to \a end-1 of a set of \a size points */
+    void runInterleaved(const Scalar* src, Scalar* dst, Index begin, Index end, Index size) const
+    {
+      Packet coeffs[Dim][Width], masks[Dim][Width], offsets[Dim];
+      for(int q=0; q<Dim; ++q)
+      {
+        for(int o=0; o<Width; ++o)
+        {
+          coeffs[q][o] = ploadu<Packet>(m_coeffs[q][o]);
+          masks[q][o] = ploadu<Packet>(m_masks[q][o]);
+        }
+        offsets[q] = ploadu<Packet>(m_offsets[q]);
+      }
+
+      Index j = begin;
+      // the loads of the first and last points would read before and past the data
+      if(j==0 && j<end)
+        runScalarInterleaved(src, dst, j++);
+      for(; j+PacketSize<=end && j+PacketSize<size; j+=PacketSize)
+      {
+        point_set_interleaved_unroller<Dim,0>::run(coeffs, masks, offsets, src + Dim*j, dst + Dim*j);
+      }
+      for(; j<end; ++j)
+        runScalarInterleaved(src, dst, j);
+    }
+
+    /** Transforms the planar points of indices \a begin to \a end-1 */
+    void runPlanar(const Scalar* src, Index srcStride, Scalar* dst, Index dstStride, Index begin, Index end) const
+    {
+      Packet coeffs[Dim][Dim], offsets[Dim];
+      for(int i=0; i<Dim; ++i)
+      {
+        for(int k=0; k<Dim; ++k)
+          coeffs[i][k] = pset1<Packet>(m_linear(i,k));
+        offsets[i] = pset1<Packet>(m_translation(i));
+      }
+
+      Index j = begin;
+      for(; j+PacketSize<=end; j+=PacketSize)
+      {
+        Packet x[Dim];
+        for(int k=0; k<Dim; ++k)
+          x[k] = ploadu<Packet>(src + k*srcStride + j);
+        point_set_planar_unroller<Dim,0>::run(coeffs, offsets, x, dst + j, dstStride);
+      }
+      for(; j<end; ++j)
+      {
+        Map<Matrix<Scalar,Dim,1>,0,InnerStride<> >(dst+j, Dim, InnerStride<>(dstStride)).noalias()
+          = m_linear * Map<const Matrix<Scalar,Dim,1>,0,InnerStride<> >(src+j, Dim, InnerStride<>(srcStride)) + m_translation;
+      }
+    }
+
+  protected:
+    void runScalarInterleaved(const Scalar* src, Scalar* dst, Index j) const
+    {
+      Map<VectorType>(dst+Dim*j).noalias() = m_linear * Map<const VectorType>(src+Dim*j) + m_translation;
+    }
+
+    LinearType m_linear;
+    VectorType m_translation;
+    Scalar m_coeffs[Dim][Width][PacketSize];
+    Scalar m_masks[Dim][Width][PacketSize];
+    Scalar m_offsets[Dim][PacketSize];
+};
+
+template<typename MatrixType, int Dim>
+struct affine_point_set_product_traits
+{
+  typedef typename traits<MatrixType>::Scalar Scalar;
+  enum {
+    Planar = (int(traits<MatrixType>::Flags)&RowMajorBit) ? 1 : 0,
+    Applicable = Dim!=Dynamic && Dim>=2 && Dim<=4
+              && int(traits<MatrixType>::RowsAtCompileTime)==Dim && int(traits<MatrixType>::ColsAtCompileTime)==Dynamic
+              && (int(traits<MatrixType>::Flags)&DirectAccessBit)
+              && packet_traits<Scalar>::Vectorizable && int(packet_traits<Scalar>::size)>1
+              && !NumTraits<Scalar>::IsComplex
+  };
+};
+
+/** \internal
+  * Computes \a dst = \a linear * \a src + \a translation (with the translation added to each column) using
+  * affine_point_set_kernel, and returns true, when \a src is a large enough set of points stored in one of the
+  * layouts supported by the kernel and \a dst is a plain matrix of the same storage order. Otherwise it returns
+  * false and leaves \a dst untouched.
+  * The points are shared among the threads for very large sets.
+  */
+template<typename MatrixType, int Dim, bool Applicable = affine_point_set_product_traits<MatrixType,Dim>::Applicable>
+struct affine_point_set_product
+{
+  template<typename Linear, typename Translation, typename Dest>
+  static bool run(const Linear&, const Translation&, const MatrixType&, Dest&) { return false; }
+};
+
+template<typename MatrixType, int Dim>
+struct affine_point_set_product<MatrixType,Dim,true>
+{
+  typedef typename traits<MatrixType>::Scalar Scalar;
+  typedef affine_point_set_kernel<Scalar,Dim> Kernel;
+  enum {
+    Planar = affine_point_set_product_traits<MatrixType,Dim>::Planar,
+    PacketSize = packet_traits<Scalar>::size
+  };
+
+  template<typename Linear, typename Translation, typename Dest>
+  static bool run(const Linear& linear, const Translation& translation, const MatrixType& src, Dest& dst)
+  {
+    Index size = src.cols();
+    if(int(Planar) != ((int(Dest::Flags)&RowMajorBit) ? 1 : 0) || size < 8*PacketSize || src.innerStride()!=1
+       || (!Planar && src.outerStride()!=Dim))
+      return false;
+    dst.resize(Dim, size);
+
+    const Kernel kernel(linear, translation);
+    const Scalar* srcData = src.data();
+    Scalar* dstData = dst.data();
+    Index srcStride = src.outerStride(), dstStride = dst.outerStride();
+
+    // chunks of points shared among the threads
+    const Index chunkSize = 1024*PacketSize;
+    Index chunks = (size+chunkSize-1)/chunkSize;
+#ifdef EIGEN_HAS_OPENMP
+    Eigen::initParallel();
+    Index threads = Eigen::nbThreads();
+    if(threads>1 && chunks>1)
+    {
+      #pragma omp parallel for schedule(static) num_threads(threads)
+      for(Index c=0; c<chunks; ++c)
+        runChunk(kernel, srcData, srcStride, dstData, dstStride, c*chunkSize, (std::min)(size,(c+1)*chunkSize), size);
+    }
+    else
+#endif
+    {
+      for(Index c=0; c<chunks; ++c)
+        runChunk(kernel, srcData, srcStride, dstData, dstStride, c*chunkSize, (std::min)(size,(c+1)*chunkSize), size);
+    }
+    return true;
+  }
+
+  static void runChunk(const Kernel& kernel, const Scalar* src, Index srcStride, Scalar* dst, Index dstStride,
+                       Index begin, Index end, Index size)
+  {
+    if(Planar)
+      kernel.runPlanar(src, srcStride, dst, dstStride, begin, end);
+    else
+      kernel.runInterleaved(src, dst, begin, end, size);
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_POINT_SET_PRODUCT_H
@@ -688,27 +688,18 @@ QuaternionBase<Derived>::angularDistance(const QuaternionBase<OtherDerived>& oth
 
  
     
-/** \returns the spherical linear interpolation between the two quaternions
-  * \c *this and \a other at the parameter \a t in [0;1].
-  * 
-  * This represents an interpolation for a constant motion between \c *this and \a other,
-  * see also http://en.wikipedia.org/wiki/Slerp.
-  */
-template <class Derived>
-template <class OtherDerived>
-Quaternion<typename internal::traits<Derived>::Scalar>
-QuaternionBase<Derived>::slerp(const Scalar& t, const QuaternionBase<OtherDerived>& other) const
+namespace internal {
+
+// computes the weights of the two quaternions, whose dot product is d, in their spherical linear interpolation at t
+template<typename Scalar>
+inline void quaternion_slerp_scales(const Scalar& t, const Scalar& d, Scalar& scale0, Scalar& scale1)
 {
   using std::acos;
   using std::sin;
   using std::abs;
   static const Scalar one = Scalar(1) - NumTraits<Scalar>::epsilon();
-  Scalar d = this->dot(other);
   Scalar absD = abs(d);
 
-  Scalar scale0;
-  Scalar scale1;
-
   if(absD>=one)
   {
     scale0 = Scalar(1) - t;
@@ -724,6 +715,24 @@ QuaternionBase<Derived>::slerp(const Scalar& t, const QuaternionBase<OtherDerive
     scale1 = sin( ( t * theta) ) / sinTheta;
   }
   if(d<Scalar(0)) scale1 = -scale1;
+}
+
+} // end namespace internal
+
+/** \returns the spherical linear interpolation between the two quaternions
+  * \c *this and \a other at the parameter \a t in [0;1].
+  * 
+  * This represents an interpolation for a constant motion between \c *this and \a other,
+  * see also http://en.wikipedia.org/wiki/Slerp.
+  */
+template <class Derived>
+template <class OtherDerived>
+Quaternion<typename internal::traits<Derived>::Scalar>
+QuaternionBase<Derived>::slerp(const Scalar& t, const QuaternionBase<OtherDerived>& other) const
+{
+  Scalar scale0;
+  Scalar scale1;
+  internal::quaternion_slerp_scales(t, this->dot(other), scale0, scale1);
 
   return Quaternion<Scalar>(scale0 * coeffs() + scale1 * other.coeffs());
 }
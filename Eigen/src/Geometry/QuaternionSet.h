@@ -0,0 +1,280 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_QUATERNION_SET_H
+#define EIGEN_QUATERNION_SET_H
+
+namespace Eigen {
+
+namespace internal {
+
+// Loads the coordinates x, y, z and w of PacketSize consecutive quaternions of a set whose coefficient (c,j) is stored
+// at data[c*coordStride + j*quatStride]: the quaternions of a planar set are contiguous, those of an interleaved set
+// (one quaternion per column of a column-major matrix) are gathered.
+template<typename Packet, typename Scalar>
+EIGEN_STRONG_INLINE void quaternion_set_load(const Scalar* data, Index coordStride, Index quatStride, Packet* q)
+{
+  for(int c=0; c<4; ++c)
+    q[c] = quatStride==1 ? ploadu<Packet>(data + c*coordStride) : pgather<Scalar,Packet>(data + c*coordStride, quatStride);
+}
+
+template<typename Packet, typename Scalar>
+EIGEN_STRONG_INLINE void quaternion_set_store(Scalar* data, Index coordStride, Index quatStride, const Packet* q)
+{
+  for(int c=0; c<4; ++c)
+  {
+    if(quatStride==1) pstoreu(data + c*coordStride, q[c]);
+    else              pscatter<Scalar,Packet>(data + c*coordStride, q[c], quatStride);
+  }
+}
+
+template<typename Derived>
+struct quaternion_set_traits
+{
+  typedef typename traits<Derived>::Scalar Scalar;
+  enum {
+    Vectorizable = int(traits<Derived>::RowsAtCompileTime)==4
+                && (int(traits<Derived>::Flags)&DirectAccessBit)
+                && packet_traits<Scalar>::Vectorizable && int(packet_traits<Scalar>::size)>1
+                && !NumTraits<Scalar>::IsComplex
+  };
+};
+
+// a.col(j) * b.col(j) -> dst.col(j)
+template<typename Lhs, typename Rhs, typename Dest>
+struct quaternion_set_product_op
+{
+  typedef typename traits<Dest>::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum {
+    Vectorizable = quaternion_set_traits<Lhs>::Vectorizable && quaternion_set_traits<Rhs>::Vectorizable
+                && quaternion_set_traits<Dest>::Vectorizable
+  };
+
+  quaternion_set_product_op(const Lhs& a, const Rhs& b, Dest& dst) : m_a(a), m_b(b), m_dst(dst) {}
+
+  void scalarOp(Index j) const
+  {
+    m_dst.col(j) = (Quaternion<Scalar>(m_a.col(j)) * Quaternion<Scalar>(m_b.col(j))).coeffs();
+  }
+
+  void packetOp(Index j) const
+  {
+    Packet a[4], b[4], r[4];
+    quaternion_set_load(m_a.data() + j*m_a.colStride(), m_a.rowStride(), m_a.colStride(), a);
+    quaternion_set_load(m_b.data() + j*m_b.colStride(), m_b.rowStride(), m_b.colStride(), b);
+    r[3] = psub(psub(psub(pmul(a[3],b[3]), pmul(a[0],b[0])), pmul(a[1],b[1])), pmul(a[2],b[2]));
+    r[0] = psub(pmadd(a[1],b[2], pmadd(a[0],b[3], pmul(a[3],b[0]))), pmul(a[2],b[1]));
+    r[1] = psub(pmadd(a[2],b[0], pmadd(a[1],b[3], pmul(a[3],b[1]))), pmul(a[0],b[2]));
+    r[2] = psub(pmadd(a[0],b[1], pmadd(a[2],b[3], pmul(a[3],b[2]))), pmul(a[1],b[0]));
+    quaternion_set_store(m_dst.data() + j*m_dst.colStride(), m_dst.rowStride(), m_dst.colStride(), r);
+  }
+
+  const Lhs& m_a;
+  const Rhs& m_b;
+  Dest& m_dst;
+};
+
+// q.col(j) / q.col(j).norm() -> q.col(j)
+template<typename Derived>
+struct quaternion_set_normalize_op
+{
+  typedef typename traits<Derived>::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum {
+    Vectorizable = quaternion_set_traits<Derived>::Vectorizable
+                && packet_traits<Scalar>::HasSqrt && packet_traits<Scalar>::HasDiv
+  };
+
+  quaternion_set_normalize_op(Derived& q) : m_q(q) {}
+
+  void scalarOp(Index j) const
+  {
+    m_q.col(j).normalize();
+  }
+
+  void packetOp(Index j) const
+  {
+    Packet q[4];
+    Scalar* data = m_q.data() + j*m_q.colStride();
+    quaternion_set_load(data, m_q.rowStride(), m_q.colStride(), q);
+    Packet norm = psqrt(pmadd(q[3],q[3], pmadd(q[2],q[2], pmadd(q[1],q[1], pmul(q[0],q[0])))));
+    for(int c=0; c<4; ++c)
+      q[c] = pdiv(q[c], norm);
+    quaternion_set_store(data, m_q.rowStride(), m_q.colStride(), q);
+  }
+
+  Derived& m_q;
+};
+
+// a.col(j).slerp(t(j), b.col(j)) -> dst.col(j)
+// The weights of the two quaternions involve an acos and two sin per quaternion, which are computed by
+// quaternion_slerp_scales as in QuaternionBase::slerp; the dot products and the weighted sums are vectorized.
+template<typename TType, typename Lhs, typename Rhs, typename Dest>
+struct quaternion_set_slerp_op
+{
+  typedef typename traits<Dest>::Scalar Scalar;
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum {
+    PacketSize = packet_traits<Scalar>::size,
+    Vectorizable = quaternion_set_traits<Lhs>::Vectorizable && quaternion_set_traits<Rhs>::Vectorizable
+                && quaternion_set_traits<Dest>::Vectorizable
+  };
+
+  quaternion_set_slerp_op(const TType& t, const Lhs& a, const Rhs& b, Dest& dst) : m_t(t), m_a(a), m_b(b), m_dst(dst) {}
+
+  void scalarOp(Index j) const
+  {
+    m_dst.col(j) = Quaternion<Scalar>(m_a.col(j)).slerp(m_t.coeff(j), Quaternion<Scalar>(m_b.col(j))).coeffs();
+  }
+
+  void packetOp(Index j) const
+  {
+    Packet a[4], b[4];
+    quaternion_set_load(m_a.data() + j*m_a.colStride(), m_a.rowStride(), m_a.colStride(), a);
+    quaternion_set_load(m_b.data() + j*m_b.colStride(), m_b.rowStride(), m_b.colStride(), b);
+    Scalar d[PacketSize], scale0[PacketSize], scale1[PacketSize];
+    pstoreu(d, pmadd(a[3],b[3], pmadd(a[2],b[2], pmadd(a[1],b[1], pmul(a[0],b[0])))));
+    for(int e=0; e<PacketSize; ++e)
+      quaternion_slerp_scales(Scalar(m_t.coeff(j+e)), d[e], scale0[e], scale1[e]);
+    Packet s0 = ploadu<Packet>(scale0), s1 = ploadu<Packet>(scale1);
+    for(int c=0; c<4; ++c)
+      a[c] = pmadd(s1, b[c], pmul(s0, a[c]));
+    quaternion_set_store(m_dst.data() + j*m_dst.colStride(), m_dst.rowStride(), m_dst.colStride(), a);
+  }
+
+  const TType& m_t;
+  const Lhs& m_a;
+  const Rhs& m_b;
+  Dest& m_dst;
+};
+
+template<typename Op, bool Vectorizable = Op::Vectorizable>
+struct quaternion_set_loop
+{
+  static void run(const Op& op, Index begin, Index end)
+  {
+    for(Index j=begin; j<end; ++j)
+      op.scalarOp(j);
+  }
+};
+
+template<typename Op>
+struct quaternion_set_loop<Op,true>
+{
+  static void run(const Op& op, Index begin, Index end)
+  {
+    enum { PacketSize = packet_traits<typename Op::Scalar>::size };
+    Index j = begin;
+    for(; j+PacketSize<=end; j+=PacketSize)
+      op.packetOp(j);
+    for(; j<end; ++j)
+      op.scalarOp(j);
+  }
+};
+
+/** \internal
+  * Applies \a op to the \a size quaternions of a set, by packets of quaternions when the operands allow it.
+  * The quaternions are shared among the threads for very large sets.
+  */
+template<typename Op>
+void quaternion_set_run(const Op& op, Index size)
+{
+  // chunks of quaternions shared among the threads
+  const Index chunkSize = 1024*packet_traits<typename Op::Scalar>::size;
+  Index chunks = (size+chunkSize-1)/chunkSize;
+#ifdef EIGEN_HAS_OPENMP
+  Eigen::initParallel();
+  Index threads = Eigen::nbThreads();
+  if(threads>1 && chunks>1)
+  {
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for(Index c=0; c<chunks; ++c)
+      quaternion_set_loop<Op>::run(op, c*chunkSize, (std::min)(size,(c+1)*chunkSize));
+  }
+  else
+#endif
+  {
+    for(Index c=0; c<chunks; ++c)
+      quaternion_set_loop<Op>::run(op, c*chunkSize, (std::min)(size,(c+1)*chunkSize));
+  }
+}
+
+} // end namespace internal
+
+/** \geometry_module \ingroup Geometry_Module
+  *
+  * Computes the products \a dst.col(j) = \a a.col(j) * \a b.col(j) of two sets of quaternions.
+  *
+  * A set of quaternions is a 4 x n matrix whose columns hold the coefficients (x,y,z,w) of the quaternions,
+  * as returned by QuaternionBase::coeffs(). The quaternions are processed by packets: the quaternions of a
+  * row-major set (one coordinate per row) are loaded contiguously, while those of a column-major set
+  * (one quaternion per column) are gathered. \a dst may be \a a or \a b.
+  *
+  * \sa Quaternion::operator*(), quaternionSetNormalize(), quaternionSetSlerp()
+  */
+template<typename Lhs, typename Rhs, typename Dest>
+void quaternionSetProduct(const MatrixBase<Lhs>& a, const MatrixBase<Rhs>& b, const MatrixBase<Dest>& dst)
+{
+  EIGEN_STATIC_ASSERT(int(Lhs::RowsAtCompileTime)==4 && int(Rhs::RowsAtCompileTime)==4, YOU_MADE_A_PROGRAMMING_MISTAKE)
+  eigen_assert(a.cols()==b.cols());
+  Dest& res = dst.const_cast_derived();
+  res.resize(4, a.cols());
+  internal::quaternion_set_product_op<Lhs,Rhs,Dest> op(a.derived(), b.derived(), res);
+  internal::quaternion_set_run(op, a.cols());
+}
+
+/** \geometry_module \ingroup Geometry_Module
+  *
+  * Normalizes in place each quaternion of the set \a q, stored as in quaternionSetProduct().
+  *
+  * \sa QuaternionBase::normalize()
+  */
+template<typename Derived>
+void quaternionSetNormalize(const MatrixBase<Derived>& q)
+{
+  EIGEN_STATIC_ASSERT(int(Derived::RowsAtCompileTime)==4, YOU_MADE_A_PROGRAMMING_MISTAKE)
+  Derived& res = q.const_cast_derived();
+  internal::quaternion_set_normalize_op<Derived> op(res);
+  internal::quaternion_set_run(op, res.cols());
+}
+
+/** \geometry_module \ingroup Geometry_Module
+  *
+  * Computes the spherical linear interpolations \a dst.col(j) between \a a.col(j) and \a b.col(j) at the
+  * parameters \a t(j) of the vector \a t, for two sets of quaternions stored as in quaternionSetProduct().
+  * \a dst may be \a a or \a b.
+  *
+  * \sa QuaternionBase::slerp()
+  */
+template<typename TType, typename Lhs, typename Rhs, typename Dest>
+void quaternionSetSlerp(const DenseBase<TType>& t, const MatrixBase<Lhs>& a, const MatrixBase<Rhs>& b,
+                        const MatrixBase<Dest>& dst)
+{
+  EIGEN_STATIC_ASSERT_VECTOR_ONLY(TType)
+  EIGEN_STATIC_ASSERT(int(Lhs::RowsAtCompileTime)==4 && int(Rhs::RowsAtCompileTime)==4, YOU_MADE_A_PROGRAMMING_MISTAKE)
+  eigen_assert(a.cols()==b.cols() && t.size()==a.cols());
+  Dest& res = dst.const_cast_derived();
+  res.resize(4, a.cols());
+  internal::quaternion_set_slerp_op<TType,Lhs,Rhs,Dest> op(t.derived(), a.derived(), b.derived(), res);
+  internal::quaternion_set_run(op, a.cols());
+}
+
+/** \geometry_module \ingroup Geometry_Module
+  *
+  * This is an overloaded function interpolating all the quaternions at the same parameter \a t.
+  */
+template<typename Lhs, typename Rhs, typename Dest>
+void quaternionSetSlerp(const typename Lhs::Scalar& t, const MatrixBase<Lhs>& a, const MatrixBase<Rhs>& b,
+                        const MatrixBase<Dest>& dst)
+{
+  quaternionSetSlerp(Matrix<typename Lhs::Scalar,1,Dynamic>::Constant(1, a.cols(), t), a, b, dst);
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_QUATERNION_SET_H
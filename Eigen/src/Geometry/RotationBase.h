@@ -100,10 +100,21 @@ namespace internal {
 template<typename RotationDerived, typename MatrixType>
 struct rotation_base_generic_product_selector<RotationDerived,MatrixType,false>
 {
-  enum { Dim = RotationDerived::Dim };
-  typedef Matrix<typename RotationDerived::Scalar,Dim,Dim> ReturnType;
+  enum {
+    Dim = RotationDerived::Dim,
+    Cols = MatrixType::ColsAtCompileTime
+  };
+  typedef typename RotationDerived::Scalar Scalar;
+  typedef Matrix<Scalar,Dim,Cols,(Cols!=1 && (int(traits<MatrixType>::Flags)&RowMajorBit)) ? RowMajor : ColMajor> ReturnType;
   static inline ReturnType run(const RotationDerived& r, const MatrixType& m)
-  { return r.toRotationMatrix() * m; }
+  {
+    Matrix<Scalar,Dim,Dim> rot = r.toRotationMatrix();
+    ReturnType res;
+    // large sets of points are rotated by packets of points
+    if(!affine_point_set_product<MatrixType,Dim>::run(rot, Matrix<Scalar,Dim,1>::Zero(), m, res))
+      res = rot * m;
+    return res;
+  }
 };
 
 template<typename RotationDerived, typename Scalar, int Dim, int MaxDim>
@@ -1322,8 +1322,13 @@ struct transform_right_product_impl< TransformType, MatrixType, 2 >
     EIGEN_STATIC_ASSERT(OtherRows==Dim, YOU_MIXED_MATRICES_OF_DIFFERENT_SIZES);
 
     typedef Block<ResultType, Dim, OtherCols, true> TopLeftLhs;
-    ResultType res(Replicate<typename TransformType::ConstTranslationPart, 1, OtherCols>(T.translation(),1,other.cols()));
-    TopLeftLhs(res, 0, 0, Dim, other.cols()).noalias() += T.linear() * other;
+    ResultType res;
+    // large sets of points are transformed by packets of points
+    if(!affine_point_set_product<MatrixType,Dim>::run(T.linear(), T.translation(), other, res))
+    {
+      res = Replicate<typename TransformType::ConstTranslationPart, 1, OtherCols>(T.translation(),1,other.cols());
+      TopLeftLhs(res, 0, 0, Dim, other.cols()).noalias() += T.linear() * other;
+    }
 
     return res;
   }
@@ -0,0 +1,392 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_ALGEBRAIC_MULTIGRID_H
+#define EIGEN_ALGEBRAIC_MULTIGRID_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal Groups the unknowns of \a A into aggregates of strongly connected unknowns, where the
+  * unknowns i and j are strongly connected if |a_ij|^2 >= theta^2 |a_ii a_jj|. On output, \a aggregate
+  * holds the aggregate of each unknown, and the number of aggregates is returned. */
+template<typename MatrixType, typename IndexVector>
+Index amg_aggregate(const MatrixType& A, const typename MatrixType::RealScalar& theta, IndexVector& aggregate)
+{
+  using std::abs;
+  typedef typename MatrixType::StorageIndex StorageIndex;
+  typedef typename MatrixType::RealScalar RealScalar;
+  Index n = A.rows();
+  const StorageIndex* outer = A.outerIndexPtr();
+  const StorageIndex* inner = A.innerIndexPtr();
+  const typename MatrixType::Scalar* values = A.valuePtr();
+
+  Matrix<RealScalar,Dynamic,1> diag(n);
+  for(Index i=0; i<n; ++i)
+    diag(i) = abs(A.coeff(i,i));
+
+  // strength of the connections, the weak ones being marked by a zero
+  Matrix<RealScalar,Dynamic,1> strength(A.nonZeros());
+  for(Index i=0; i<n; ++i)
+    for(Index p=outer[i]; p<outer[i+1]; ++p)
+    {
+      Index j = inner[p];
+      RealScalar a = numext::abs2(values[p]);
+      strength(p) = (j!=i && a>=theta*theta*diag(i)*diag(j)) ? a : RealScalar(0);
+    }
+
+  aggregate.setConstant(n, -1);
+  StorageIndex nbAggregates = 0;
+
+  // 1 - the unknowns whose strong neighbors are all free make a new aggregate with their neighbors
+  for(Index i=0; i<n; ++i)
+  {
+    if(aggregate(i)>=0)
+      continue;
+    bool free = true, isolated = true;
+    for(Index p=outer[i]; p<outer[i+1] && free; ++p)
+      if(strength(p)>RealScalar(0))
+      {
+        isolated = false;
+        free = aggregate(inner[p])<0;
+      }
+    if(!free || isolated)
+      continue;
+    aggregate(i) = nbAggregates;
+    for(Index p=outer[i]; p<outer[i+1]; ++p)
+      if(strength(p)>RealScalar(0))
+        aggregate(inner[p]) = nbAggregates;
+    ++nbAggregates;
+  }
+
+  // 2 - the remaining unknowns join the aggregate of their strongest neighbor, if any
+  IndexVector first = aggregate;
+  for(Index i=0; i<n; ++i)
+  {
+    if(aggregate(i)>=0)
+      continue;
+    RealScalar best(0);
+    for(Index p=outer[i]; p<outer[i+1]; ++p)
+      if(strength(p)>best && first(inner[p])>=0)
+      {
+        best = strength(p);
+        aggregate(i) = first(inner[p]);
+      }
+  }
+
+  // 3 - the last ones make new aggregates with their free strong neighbors
+  for(Index i=0; i<n; ++i)
+  {
+    if(aggregate(i)>=0)
+      continue;
+    aggregate(i) = nbAggregates;
+    for(Index p=outer[i]; p<outer[i+1]; ++p)
+      if(strength(p)>RealScalar(0) && aggregate(inner[p])<0)
+        aggregate(inner[p]) = nbAggregates;
+    ++nbAggregates;
+  }
+  return nbAggregates;
+}
+
+} // end namespace internal
+
+/** \ingroup IterativeLinearSolvers_Module
+  * \brief Smoothed aggregation algebraic multigrid preconditioner
+  *
+  * This class builds a hierarchy of coarser and coarser approximations of a sparse matrix A, and
+  * approximately solves A x = b by a multigrid V-cycle. The hierarchy is built as follows:
+  *  - the unknowns are grouped into aggregates of strongly connected unknowns,
+  *  - the tentative prolongation operator T interpolates each aggregate by a constant,
+  *  - T is smoothed by a weighted Jacobi iteration: P = (I - w D^-1 A) T, with w = 4/(3 rho(D^-1 A)),
+  *  - the coarse matrix is the Galerkin product P^* A P,
+  *
+  * until the size of the coarse matrix is lower than maxCoarseSize(). The coarsest system is then solved
+  * through the inverse of its dense LU decomposition, and the other levels are smoothed by weighted Jacobi
+  * iterations. If the coarsening stops before, because the aggregates do not reduce the size of the matrix
+  * enough or because maxLevels() is reached, the coarsest level is only smoothed, so that the setup never
+  * factorizes a large dense matrix.
+  *
+  * On discretized elliptic problems, such as Poisson or diffusion equations, the number of
+  * iterations of ConjugateGradient preconditioned by this class remains nearly constant
+  * as the mesh is refined:
+  * \code
+  * ConjugateGradient<SparseMatrix<double>, Lower|Upper, AlgebraicMultigridPreconditioner<double> > cg;
+  * cg.compute(A);
+  * x = cg.solve(b);
+  * \endcode
+  *
+  * The whole matrix has to be stored, and it should be symmetric positive definite, or at least
+  * close to it for BiCGSTAB. The constant vector is assumed to be a good approximation of the near
+  * null space of A, which is not the case of elasticity problems for instance.
+  *
+  * The hierarchy is stored in row-major matrices, so that the sparse matrix-vector products of the
+  * V-cycle are multi-threaded when OpenMP is enabled, as are the sparse products of the setup. The work
+  * vectors of the V-cycle are allocated by compute(), so that a same preconditioner must not be applied
+  * by several threads at once.
+  *
+  * \tparam _Scalar the type of the scalar.
+  * \tparam _StorageIndex the type of the indices of the hierarchy.
+  *
+  * \sa class ConjugateGradient, class DiagonalPreconditioner
+  */
+template <typename _Scalar, typename _StorageIndex = int>
+class AlgebraicMultigridPreconditioner : public SparseSolverBase<AlgebraicMultigridPreconditioner<_Scalar,_StorageIndex> >
+{
+  protected:
+    typedef SparseSolverBase<AlgebraicMultigridPreconditioner> Base;
+    using Base::m_isInitialized;
+  public:
+    typedef _Scalar Scalar;
+    typedef _StorageIndex StorageIndex;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    typedef Matrix<Scalar,Dynamic,1> Vector;
+    typedef Matrix<StorageIndex,Dynamic,1> IndexVector;
+    typedef SparseMatrix<Scalar,RowMajor,StorageIndex> LevelMatrixType;
+
+    // this typedef is only to export the scalar type and compile-time dimensions to solve_retval
+    typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+
+    AlgebraicMultigridPreconditioner()
+      : m_threshold(0.08), m_maxCoarseSize(200), m_maxLevels(10), m_smoothingSteps(1)
+    {}
+
+    template<typename MatType>
+    explicit AlgebraicMultigridPreconditioner(const MatType& mat)
+      : m_threshold(0.08), m_maxCoarseSize(200), m_maxLevels(10), m_smoothingSteps(1)
+    {
+      compute(mat);
+    }
+
+    Index rows() const { return m_levels.empty() ? 0 : m_levels[0].A.rows(); }
+    Index cols() const { return rows(); }
+
+    /** Sets the threshold \a theta of the strength of the connections (default is 0.08).
+      * Two unknowns i and j are strongly connected if |a_ij| >= theta sqrt(|a_ii a_jj|).
+      * This threshold is halved at each coarser level. */
+    AlgebraicMultigridPreconditioner& setStrengthThreshold(const RealScalar& theta) { m_threshold = theta; return *this; }
+
+    /** Sets the size under which the matrix is factorized rather than coarsened (default is 200).
+      * A coarsest matrix larger than this size is smoothed instead of being factorized. */
+    AlgebraicMultigridPreconditioner& setMaxCoarseSize(Index size) { m_maxCoarseSize = (std::max<Index>)(size,1); return *this; }
+
+    /** Sets the maximal number of levels of the hierarchy (default is 10). */
+    AlgebraicMultigridPreconditioner& setMaxLevels(Index levels) { m_maxLevels = (std::max<Index>)(levels,1); return *this; }
+
+    /** Sets the number of Jacobi iterations performed before and after the coarse grid correction (default is 1). */
+    AlgebraicMultigridPreconditioner& setSmoothingSteps(Index steps) { m_smoothingSteps = steps; return *this; }
+
+    /** \returns the number of levels of the hierarchy, including the coarsest one */
+    Index levels() const
+    {
+      eigen_assert(m_isInitialized && "AlgebraicMultigridPreconditioner is not initialized.");
+      return Index(m_levels.size());
+    }
+
+    /** \returns the ratio between the number of nonzeros of all the matrices of the hierarchy
+      * and the one of the input matrix */
+    RealScalar operatorComplexity() const
+    {
+      eigen_assert(m_isInitialized && "AlgebraicMultigridPreconditioner is not initialized.");
+      RealScalar nnz(0);
+      for(std::size_t l=0; l<m_levels.size(); ++l)
+        nnz += RealScalar(m_levels[l].A.nonZeros());
+      return nnz / RealScalar(m_levels[0].A.nonZeros());
+    }
+
+    /** \brief Reports whether previous computation was successful.
+      *
+      * \returns \c Success if computation was succesful,
+      *          \c NumericalIssue if the factorized coarsest matrix is singular.
+      */
+    ComputationInfo info() const
+    {
+      eigen_assert(m_isInitialized && "AlgebraicMultigridPreconditioner is not initialized.");
+      return m_info;
+    }
+
+    template<typename MatType>
+    AlgebraicMultigridPreconditioner& analyzePattern(const MatType& )
+    {
+      return *this;
+    }
+
+    /** Builds the multigrid hierarchy of \a mat. Since the aggregates depend on the values of the
+      * matrix, the whole hierarchy is rebuilt. */
+    template<typename MatType>
+    AlgebraicMultigridPreconditioner& factorize(const MatType& mat);
+
+    template<typename MatType>
+    AlgebraicMultigridPreconditioner& compute(const MatType& mat)
+    {
+      return factorize(mat);
+    }
+
+    /** \internal */
+    template<typename Rhs, typename Dest>
+    void _solve_impl(const Rhs& b, Dest& x) const
+    {
+      const Level& finest = m_levels[0];
+      for(Index j=0; j<b.cols(); ++j)
+      {
+        finest.b = b.col(j);
+        vcycle(0);
+        x.col(j) = finest.x;
+      }
+    }
+
+  protected:
+
+    struct Level
+    {
+      LevelMatrixType A;      // the matrix of this level
+      LevelMatrixType P;      // prolongation from the next level, empty on the coarsest level
+      LevelMatrixType R;      // restriction to the next level, R = P^*
+      Vector invDiag;         // w D^-1
+      mutable Vector b, x, r; // right hand side, solution and residual of the V-cycle
+    };
+
+    /** \internal Approximately solves m_levels[l].A x = b by a V-cycle, x and b being the work vectors of the level */
+    void vcycle(std::size_t l) const
+    {
+      const Level& level = m_levels[l];
+      if(l+1==m_levels.size())
+      {
+        if(m_coarseInverse.rows()==level.A.rows())
+          level.x.noalias() = m_coarseInverse * level.b;
+        else
+        {
+          level.x.setZero();
+          smooth(level, (std::max<Index>)(2*m_smoothingSteps,1));
+        }
+        return;
+      }
+      const Level& coarse = m_levels[l+1];
+      level.x.setZero();
+      smooth(level, m_smoothingSteps);
+      level.r = level.b;
+      level.r.noalias() -= level.A * level.x;
+      coarse.b.noalias() = level.R * level.r;
+      vcycle(l+1);
+      level.x.noalias() += level.P * coarse.x;
+      smooth(level, m_smoothingSteps);
+    }
+
+    /** \internal Weighted Jacobi iterations on A x = b */
+    void smooth(const Level& level, Index steps) const
+    {
+      for(Index k=0; k<steps; ++k)
+      {
+        level.r = level.b;
+        level.r.noalias() -= level.A * level.x;
+        level.x.array() += level.invDiag.array() * level.r.array();
+      }
+    }
+
+    /** \internal Sets the weighted Jacobi smoother of \a level, w = 4/(3 rho(D^-1 A)), rho being bounded
+      * by the Gershgorin circles, and allocates its work vectors */
+    static void setupSmoother(Level& level)
+    {
+      using std::abs;
+      const LevelMatrixType& A = level.A;
+      Index n = A.rows();
+      level.invDiag.resize(n);
+      RealScalar rho(0);
+      for(Index i=0; i<n; ++i)
+      {
+        Scalar d(0);
+        RealScalar sum(0);
+        for(typename LevelMatrixType::InnerIterator it(A,i); it; ++it)
+        {
+          if(it.index()==i) d = it.value();
+          sum += abs(it.value());
+        }
+        level.invDiag(i) = d==Scalar(0) ? Scalar(0) : Scalar(1)/d;
+        rho = (std::max)(rho, sum*abs(level.invDiag(i)));
+      }
+      if(rho>RealScalar(0))
+        level.invDiag *= Scalar(RealScalar(4)/(RealScalar(3)*rho));
+      level.b.resize(n);
+      level.x.resize(n);
+      level.r.resize(n);
+    }
+
+    std::vector<Level> m_levels;
+    MatrixType m_coarseInverse;
+    RealScalar m_threshold;
+    Index m_maxCoarseSize;
+    Index m_maxLevels;
+    Index m_smoothingSteps;
+    ComputationInfo m_info;
+};
+
+template<typename Scalar, typename StorageIndex>
+template<typename MatType>
+AlgebraicMultigridPreconditioner<Scalar,StorageIndex>&
+AlgebraicMultigridPreconditioner<Scalar,StorageIndex>::factorize(const MatType& mat)
+{
+  using std::sqrt;
+  eigen_assert(mat.rows()==mat.cols());
+  m_levels.clear();
+  m_levels.reserve(m_maxLevels);
+  m_levels.push_back(Level());
+  m_levels.back().A = mat;
+  m_levels.back().A.makeCompressed();
+  setupSmoother(m_levels.back());
+  IndexVector aggregate;
+  // the coarse matrices have more and weaker connections, so the threshold is halved at each level
+  RealScalar theta = m_threshold;
+  while(m_levels.back().A.rows()>m_maxCoarseSize && Index(m_levels.size())<m_maxLevels)
+  {
+    const LevelMatrixType& A = m_levels.back().A;
+    Index n = A.rows();
+    Index nc = internal::amg_aggregate(A, theta, aggregate);
+    theta /= RealScalar(2);
+    // stop if the coarsening stagnates
+    if(nc==0 || 10*nc>9*n)
+      break;
+
+    // tentative prolongation: piecewise constant, with normalized columns
+    IndexVector sizes = IndexVector::Zero(nc);
+    for(Index i=0; i<n; ++i)
+      ++sizes(aggregate(i));
+    LevelMatrixType T(n,nc);
+    T.reserve(IndexVector::Ones(n));
+    for(Index i=0; i<n; ++i)
+      T.insert(i,aggregate(i)) = Scalar(RealScalar(1)/sqrt(RealScalar(sizes(aggregate(i)))));
+    T.makeCompressed();
+
+    Level& level = m_levels.back();
+    level.P = T - level.invDiag.asDiagonal() * LevelMatrixType(A * T);
+    level.R = level.P.adjoint();
+    LevelMatrixType AP = A * level.P;
+    LevelMatrixType coarseA = level.R * AP;
+    m_levels.push_back(Level());
+    m_levels.back().A.swap(coarseA);
+    m_levels.back().A.makeCompressed();
+    setupSmoother(m_levels.back());
+  }
+
+  // the coarsest matrix is factorized only if it is small, otherwise it is smoothed
+  const LevelMatrixType& A = m_levels.back().A;
+  m_info = Success;
+  m_coarseInverse.resize(0,0);
+  if(A.rows()<=m_maxCoarseSize)
+  {
+    FullPivLU<MatrixType> lu((MatrixType(A)));
+    if(lu.isInvertible())
+      m_coarseInverse = lu.inverse();
+    else
+      m_info = NumericalIssue;
+  }
+  m_isInitialized = true;
+  return *this;
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_ALGEBRAIC_MULTIGRID_H
@@ -50,7 +50,8 @@ void conjugate_gradient(const MatrixType& mat, const Rhs& rhs, Dest& x,
     tol_error = 0;
     return;
   }
-  RealScalar threshold = tol*tol*rhsNorm2;
+  const RealScalar considerAsZero = (std::numeric_limits<RealScalar>::min)();
+  RealScalar threshold = numext::maxi(RealScalar(tol*tol*rhsNorm2),considerAsZero);
   RealScalar residualNorm2 = residual.squaredNorm();
   if (residualNorm2 < threshold)
   {
@@ -89,6 +90,118 @@ void conjugate_gradient(const MatrixType& mat, const Rhs& rhs, Dest& x,
   iters = i;
 }
 
+/** \internal Low-level conjugate gradient algorithm for several right hand sides
+  *
+  * The iterations of all the columns of \a rhs are performed together: each column has its own recurrence, as in
+  * conjugate_gradient(), but the products with the matrix are done at once for all the search directions, which
+  * reads the matrix once per iteration instead of once per column. The columns which reached the tolerance, or
+  * which cannot be improved anymore because of a breakdown, are removed from the block.
+  *
+  * \param mat The matrix A
+  * \param rhs The right hand sides B
+  * \param x On input and initial solution, on output the computed solution.
+  * \param precond A preconditioner being able to efficiently solve for an
+  *                approximation of Ax=b (regardless of b)
+  * \param iters On input the max number of iteration, on output the number of performed iterations.
+  * \param tol_error On input the tolerance error, on output an estimation of the largest relative error of the columns.
+  */
+template<typename MatrixType, typename Rhs, typename Dest, typename Preconditioner>
+EIGEN_DONT_INLINE
+void batched_conjugate_gradient(const MatrixType& mat, const Rhs& rhs, Dest& x,
+                                const Preconditioner& precond, Index& iters,
+                                typename Dest::RealScalar& tol_error)
+{
+  using std::sqrt;
+  typedef typename Dest::RealScalar RealScalar;
+  typedef typename Dest::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,Dynamic> BlockType;
+  typedef Matrix<RealScalar,Dynamic,1> RealVectorType;
+  
+  RealScalar tol = tol_error;
+  Index maxIters = iters;
+  // absolute floor of the deflation thresholds, for the right hand sides so small that tol^2*|b|^2 underflows
+  const RealScalar considerAsZero = (std::numeric_limits<RealScalar>::min)();
+  
+  Index n = mat.cols();
+  Index s = rhs.cols();
+  
+  // the columns are reordered such that the active ones come first, cols(j) being the original index of the column j
+  BlockType X = x;
+  BlockType R = rhs;
+  RealVectorType rhsNorm2 = R.colwise().squaredNorm().transpose();
+  R -= mat * X;                         //initial residual
+  Matrix<Index,Dynamic,1> cols(s);
+  for(Index j=0; j<s; ++j)
+    cols(j) = j;
+  
+  BlockType P(n,s), Z(n,s), Q(n,s);
+  RealVectorType absNew = RealVectorType::Ones(s);
+  Index active = s;
+  Index i = 0;
+  while(true)
+  {
+    // deflation of the converged columns, and of the ones having a breakdown
+    for(Index j=active-1; j>=0; --j)
+    {
+      if(rhsNorm2(j) == 0)
+      {
+        X.col(j).setZero();
+        R.col(j).setZero();
+      }
+      else if(R.col(j).squaredNorm() >= numext::maxi(RealScalar(tol*tol*rhsNorm2(j)), considerAsZero) && absNew(j) != 0)
+        continue;
+      --active;
+      if(j != active)
+      {
+        X.col(j).swap(X.col(active));
+        R.col(j).swap(R.col(active));
+        P.col(j).swap(P.col(active));
+        std::swap(rhsNorm2(j), rhsNorm2(active));
+        std::swap(absNew(j), absNew(active));
+        std::swap(cols(j), cols(active));
+      }
+    }
+    if(active == 0 || i >= maxIters)
+      break;
+    
+    for(Index j=0; j<active; ++j)
+    {
+      Z.col(j) = precond.solve(R.col(j));                      // approximately solve for "A z = residual"
+      RealScalar absOld = absNew(j);
+      absNew(j) = numext::real(R.col(j).dot(Z.col(j)));
+      if(i == 0)
+        P.col(j) = Z.col(j);
+      else
+        P.col(j) = Z.col(j) + (absNew(j) / absOld) * P.col(j);  // update search direction
+    }
+    
+    Q.leftCols(active).noalias() = mat * P.leftCols(active);   // the bottleneck of the algorithm
+    
+    for(Index j=0; j<active; ++j)
+    {
+      Scalar pq = P.col(j).dot(Q.col(j));
+      if(pq == Scalar(0))
+      {
+        absNew(j) = 0;
+        continue;
+      }
+      Scalar alpha = absNew(j) / pq;
+      X.col(j) += alpha * P.col(j);
+      R.col(j) -= alpha * Q.col(j);
+    }
+    i++;
+  }
+  
+  tol_error = 0;
+  for(Index j=0; j<s; ++j)
+  {
+    x.col(cols(j)) = X.col(j);
+    if(rhsNorm2(j) > 0)
+      tol_error = (std::max)(tol_error, sqrt(R.col(j).squaredNorm() / rhsNorm2(j)));
+  }
+  iters = i;
+}
+
 }
 
 template< typename _MatrixType, int _UpLo=Lower,
@@ -147,13 +260,18 @@ struct traits<ConjugateGradient<_MatrixType,_UpLo,_Preconditioner> >
   * By default the iterations start with x=0 as an initial guess of the solution.
   * One can control the start using the solveWithGuess() method.
   * 
+  * When \c b has several columns, their iterations are performed together: the product with the matrix is done
+  * once per iteration for all the columns, which reads the matrix only once. The columns which converged are removed
+  * from the computations. In this case iterations() is the number of iterations of the slowest column, and error()
+  * the largest relative error of the columns.
+  * 
   * \sa class LeastSquaresConjugateGradient, class SimplicialCholesky, DiagonalPreconditioner, IdentityPreconditioner
   */
 template< typename _MatrixType, int _UpLo, typename _Preconditioner>
 class ConjugateGradient : public IterativeSolverBase<ConjugateGradient<_MatrixType,_UpLo,_Preconditioner> >
 {
   typedef IterativeSolverBase<ConjugateGradient> Base;
-  using Base::mp_matrix;
+  using Base::matrix;
   using Base::m_error;
   using Base::m_iterations;
   using Base::m_info;
@@ -191,24 +309,39 @@ public:
   template<typename Rhs,typename Dest>
   void _solve_with_guess_impl(const Rhs& b, Dest& x) const
   {
-    typedef Ref<const MatrixType> MatRef;
-    typedef typename internal::conditional<UpLo==(Lower|Upper) && (!MatrixType::IsRowMajor) && (!NumTraits<Scalar>::IsComplex),
-                                           Transpose<const MatRef>, MatRef const&>::type RowMajorWrapper;
+    typedef typename Base::MatrixWrapper MatrixWrapper;
+    typedef typename Base::ActualMatrixType ActualMatrixType;
+    enum {
+      TransposeInput  =   (!MatrixWrapper::MatrixFree)
+                      &&  (UpLo==(Lower|Upper))
+                      &&  (!MatrixType::IsRowMajor)
+                      &&  (!NumTraits<Scalar>::IsComplex)
+    };
+    typedef typename internal::conditional<TransposeInput,Transpose<const ActualMatrixType>, ActualMatrixType const&>::type RowMajorWrapper;
+    EIGEN_STATIC_ASSERT(EIGEN_IMPLIES(MatrixWrapper::MatrixFree,UpLo==(Lower|Upper)),MATRIX_FREE_CONJUGATE_GRADIENT_IS_COMPATIBLE_WITH_UPPER_UNION_LOWER_MODE_ONLY);
     typedef typename internal::conditional<UpLo==(Lower|Upper),
                                            RowMajorWrapper,
-                                           typename MatRef::template ConstSelfAdjointViewReturnType<UpLo>::Type
+                                           typename MatrixWrapper::template ConstSelfAdjointViewReturnType<UpLo>::Type
                                           >::type SelfAdjointWrapper;
     m_iterations = Base::maxIterations();
     m_error = Base::m_tolerance;
 
-    for(Index j=0; j<b.cols(); ++j)
+    if(Dest::ColsAtCompileTime!=1 && b.cols()>1)
+    {
+      RowMajorWrapper row_mat(matrix());
+      internal::batched_conjugate_gradient(SelfAdjointWrapper(row_mat), b, x, Base::m_preconditioner, m_iterations, m_error);
+    }
+    else
     {
-      m_iterations = Base::maxIterations();
-      m_error = Base::m_tolerance;
+      for(Index j=0; j<b.cols(); ++j)
+      {
+        m_iterations = Base::maxIterations();
+        m_error = Base::m_tolerance;
 
-      typename Dest::ColXpr xj(x,j);
-      RowMajorWrapper row_mat(mp_matrix);
-      internal::conjugate_gradient(SelfAdjointWrapper(row_mat), b.col(j), xj, Base::m_preconditioner, m_iterations, m_error);
+        typename Dest::ColXpr xj(x,j);
+        RowMajorWrapper row_mat(matrix());
+        internal::conjugate_gradient(SelfAdjointWrapper(row_mat), b.col(j), xj, Base::m_preconditioner, m_iterations, m_error);
+      }
     }
 
     m_isInitialized = true;
@@ -80,6 +80,10 @@ Index QuickSplit(VectorV &row, VectorI &ind, Index ncut)
   * The two extreme cases are when @p droptol=0 (to keep all the @p fill*2 largest elements)
   * and when @p fill=n/2 with @p droptol being different to zero. 
   * 
+  * When OpenMP is enabled, the triangular solves performed by solve() are level scheduled and
+  * run in parallel. The levels are computed by factorize(), and only the indices of the rows sorted
+  * per level are stored.
+  * 
   * References : Yousef Saad, ILUT: A dual threshold incomplete LU factorization, 
   *              Numerical Linear Algebra with Applications, 1(4), pp 387-402, 1994.
   * 
@@ -167,8 +171,15 @@ class IncompleteLUT : public SparseSolverBase<IncompleteLUT<_Scalar, _StorageInd
     void _solve_impl(const Rhs& b, Dest& x) const
     {
       x = m_Pinv * b;  
-      x = m_lu.template triangularView<UnitLower>().solve(x);
-      x = m_lu.template triangularView<Upper>().solve(x);
+      Index threads = nbThreads();
+      if(m_lowerSchedule.isParallel(threads))
+        m_lowerSchedule.run(internal::sparse_level_row_kernel<UnitLower,Scalar,StorageIndex,Dest>(m_lu.outerIndexPtr(), m_lu.innerIndexPtr(), m_lu.valuePtr(), x), threads);
+      else
+        x = m_lu.template triangularView<UnitLower>().solve(x);
+      if(m_upperSchedule.isParallel(threads))
+        m_upperSchedule.run(internal::sparse_level_row_kernel<Upper,Scalar,StorageIndex,Dest>(m_lu.outerIndexPtr(), m_lu.innerIndexPtr(), m_lu.valuePtr(), x), threads);
+      else
+        x = m_lu.template triangularView<Upper>().solve(x);
       x = m_P * x; 
     }
 
@@ -185,6 +196,8 @@ protected:
 protected:
 
     FactorType m_lu;
+    internal::sparse_level_schedule<StorageIndex> m_lowerSchedule;  // level schedules of the solves with L and U
+    internal::sparse_level_schedule<StorageIndex> m_upperSchedule;
     RealScalar m_droptol;
     int m_fillfactor;
     bool m_analysisIsOk;
@@ -439,6 +452,18 @@ void IncompleteLUT<Scalar,StorageIndex>::factorize(const _MatrixType& amat)
   }
   m_lu.finalize();
   m_lu.makeCompressed();
+  // the levels of the factors depend on the dropped entries, they are computed once per factorization
+  // so that each solve is performed in parallel
+  m_lowerSchedule.clear();
+  m_upperSchedule.clear();
+  if(nbThreads()>1)
+  {
+    VectorI level;
+    internal::sparse_row_levels<Lower>(n, m_lu.outerIndexPtr(), m_lu.innerIndexPtr(), level);
+    m_lowerSchedule.compute(level);
+    internal::sparse_row_levels<Upper>(n, m_lu.outerIndexPtr(), m_lu.innerIndexPtr(), level);
+    m_upperSchedule.compute(level);
+  }
 
   m_factorizationIsOk = true;
   m_isInitialized = m_factorizationIsOk;
@@ -0,0 +1,329 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_PIPELINED_CONJUGATE_GRADIENT_H
+#define EIGEN_PIPELINED_CONJUGATE_GRADIENT_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal Fused vector updates of the pipelined conjugate gradient:
+  * \code
+  * z = n + beta z;  q = m + beta q;  s = w + beta s;  p = u + beta p;
+  * x += alpha p;    r -= alpha s;    u -= alpha q;    w -= alpha z;
+  * \endcode
+  * followed by the dot products (r,u), (w,u) and (r,r) of the updated vectors, computed in the same sweep.
+  */
+template<typename VectorType, typename RealScalar>
+void pipelined_cg_update(const VectorType& nv, const VectorType& m, VectorType& z, VectorType& q, VectorType& s, VectorType& p,
+                         VectorType& x, VectorType& r, VectorType& u, VectorType& w, RealScalar alpha, RealScalar beta,
+                         RealScalar& gamma, RealScalar& delta, RealScalar& residualNorm2)
+{
+  typedef typename VectorType::Scalar Scalar;
+  enum {
+    // vectors having less coefficients are updated by a single thread
+    MinParallelSize = 20000
+  };
+  const Index size = x.size();
+  const Scalar* nd = nv.data();
+  const Scalar* md = m.data();
+  Scalar *zd = z.data(), *qd = q.data(), *sd = s.data(), *pd = p.data();
+  Scalar *xd = x.data(), *rd = r.data(), *ud = u.data(), *wd = w.data();
+  RealScalar g(0), d(0), rr(0);
+#ifdef EIGEN_HAS_OPENMP
+  int threads = nbThreads();
+  #pragma omp parallel for schedule(static) reduction(+:g,d,rr) num_threads(threads) if(threads>1 && size>=Index(MinParallelSize))
+#endif
+  for(Index k=0; k<size; ++k)
+  {
+    Scalar zk = nd[k] + beta * zd[k];
+    Scalar qk = md[k] + beta * qd[k];
+    Scalar sk = wd[k] + beta * sd[k];
+    Scalar pk = ud[k] + beta * pd[k];
+    xd[k] += alpha * pk;
+    Scalar rk = rd[k] - alpha * sk;
+    Scalar uk = ud[k] - alpha * qk;
+    Scalar wk = wd[k] - alpha * zk;
+    zd[k] = zk; qd[k] = qk; sd[k] = sk; pd[k] = pk;
+    rd[k] = rk; ud[k] = uk; wd[k] = wk;
+    g  += numext::real(numext::conj(rk) * uk);
+    d  += numext::real(numext::conj(wk) * uk);
+    rr += numext::abs2(rk);
+  }
+  gamma = g;
+  delta = d;
+  residualNorm2 = rr;
+}
+
+/** \internal Low-level pipelined conjugate gradient algorithm
+  *
+  * This is the preconditioned pipelined conjugate gradient of Ghysels and Vanroose. The recurrences are rearranged
+  * such that all the dot products of an iteration are computed at once, during the sweep which updates the vectors,
+  * and such that they do not depend on the result of the product with the matrix and of the preconditioner of the
+  * same iteration. Since the recurrences accumulate more rounding errors than the ones of conjugate_gradient(), the
+  * vectors are periodically recomputed from their definitions (residual replacement).
+  *
+  * \param mat The matrix A
+  * \param rhs The right hand side vector b
+  * \param x On input and initial solution, on output the computed solution.
+  * \param precond A preconditioner being able to efficiently solve for an
+  *                approximation of Ax=b (regardless of b)
+  * \param iters On input the max number of iteration, on output the number of performed iterations.
+  * \param tol_error On input the tolerance error, on output an estimation of the relative error.
+  */
+template<typename MatrixType, typename Rhs, typename Dest, typename Preconditioner>
+EIGEN_DONT_INLINE
+void pipelined_conjugate_gradient(const MatrixType& mat, const Rhs& rhs, Dest& x,
+                                  const Preconditioner& precond, Index& iters,
+                                  typename Dest::RealScalar& tol_error)
+{
+  using std::sqrt;
+  typedef typename Dest::RealScalar RealScalar;
+  typedef typename Dest::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,1> VectorType;
+
+  RealScalar tol = tol_error;
+  Index maxIters = iters;
+
+  Index n = mat.cols();
+
+  VectorType xv = x;
+  VectorType r = rhs - mat * xv; //initial residual
+
+  RealScalar rhsNorm2 = rhs.squaredNorm();
+  if(rhsNorm2 == 0)
+  {
+    x.setZero();
+    iters = 0;
+    tol_error = 0;
+    return;
+  }
+  const RealScalar considerAsZero = (std::numeric_limits<RealScalar>::min)();
+  RealScalar threshold = numext::maxi(RealScalar(tol*tol*rhsNorm2),considerAsZero);
+  RealScalar residualNorm2 = r.squaredNorm();
+  if (residualNorm2 < threshold)
+  {
+    iters = 0;
+    tol_error = sqrt(residualNorm2 / rhsNorm2);
+    return;
+  }
+
+  VectorType u(n), w(n), m(n), nv(n);
+  VectorType z(n), q(n), s(n), p(n);
+  u = precond.solve(r);
+  w.noalias() = mat * u;
+  RealScalar gamma = numext::real(r.dot(u));
+  RealScalar delta = numext::real(w.dot(u));
+  z.setZero(); q.setZero(); s.setZero(); p.setZero();
+  RealScalar gammaOld(0), alphaOld(0);
+  // the recursive residual drifts away from the true one faster than in conjugate_gradient(), so that the true
+  // residual replaces the recursive one each time its squared norm decreased by this factor, until the tolerance is close
+  const RealScalar ReplacementFactor(1e-8);
+  RealScalar replacementNorm2 = residualNorm2 * ReplacementFactor;
+  Index i = 0;
+  while(i < maxIters)
+  {
+    if(gamma == RealScalar(0) || delta == RealScalar(0))
+      break;
+
+    m = precond.solve(w);
+    nv.noalias() = mat * m;                    // the bottleneck of the algorithm
+
+    RealScalar alpha, beta;
+    if(i == 0)
+    {
+      beta = 0;
+      alpha = gamma / delta;
+    }
+    else
+    {
+      beta = gamma / gammaOld;
+      RealScalar denom = delta - beta * gamma / alphaOld;
+      if(denom == RealScalar(0))
+        break;
+      alpha = gamma / denom;
+    }
+    gammaOld = gamma;
+    alphaOld = alpha;
+
+    pipelined_cg_update(nv, m, z, q, s, p, xv, r, u, w, alpha, beta, gamma, delta, residualNorm2);
+    i++;
+
+    if(residualNorm2 < threshold)
+      break;
+    if(residualNorm2 < replacementNorm2 && replacementNorm2 > threshold)
+    {
+      r = rhs - mat * xv;
+      residualNorm2 = r.squaredNorm();
+      if(residualNorm2 < threshold)
+        break;
+      replacementNorm2 = residualNorm2 * ReplacementFactor;
+      // residual replacement: the vectors computed by recurrences are recomputed from their definitions,
+      // while the search direction p is kept
+      u = precond.solve(r);
+      w.noalias() = mat * u;
+      s.noalias() = mat * p;
+      q = precond.solve(s);
+      z.noalias() = mat * q;
+      gamma = numext::real(r.dot(u));
+      delta = numext::real(w.dot(u));
+    }
+  }
+  x = xv;
+  tol_error = sqrt(residualNorm2 / rhsNorm2);
+  iters = i;
+}
+
+}
+
+template< typename _MatrixType, int _UpLo=Lower,
+          typename _Preconditioner = DiagonalPreconditioner<typename _MatrixType::Scalar> >
+class PipelinedConjugateGradient;
+
+namespace internal {
+
+template< typename _MatrixType, int _UpLo, typename _Preconditioner>
+struct traits<PipelinedConjugateGradient<_MatrixType,_UpLo,_Preconditioner> >
+{
+  typedef _MatrixType MatrixType;
+  typedef _Preconditioner Preconditioner;
+};
+
+}
+
+/** \ingroup IterativeLinearSolvers_Module
+  * \brief A pipelined conjugate gradient solver for sparse (or dense) self-adjoint problems
+  *
+  * This class solves for A.x = b linear problems using the pipelined variant of the conjugate gradient algorithm
+  * proposed by P. Ghysels and W. Vanroose. In exact arithmetic, it performs the same iterations as ConjugateGradient,
+  * but the dot products of an iteration are all computed within a single sweep which also performs all the vector
+  * updates. An iteration thus requires one synchronization of the threads, or one global reduction, instead of
+  * several ones, and the vectors are read once instead of once per operation. This is beneficial for large problems
+  * solved in parallel, when the cost of the reductions is significant compared to the one of the product with the
+  * matrix and of the preconditioner.
+  *
+  * In return, it stores four more vectors than ConjugateGradient and its recurrences are slightly less accurate.
+  * To keep the same accuracy as ConjugateGradient, the true residual replaces the recursive one each time the
+  * latter decreased by a factor 10^4 while the tolerance is not close, which costs three products with the matrix
+  * and two preconditioner solves. With a tolerance close to the machine precision, the recurrences may however
+  * stagnate slightly above it on badly conditioned problems.
+  *
+  * \tparam _MatrixType the type of the matrix A, can be a dense or a sparse matrix.
+  * \tparam _UpLo the triangular part that will be used for the computations. It can be Lower,
+  *               \c Upper, or \c Lower|Upper in which the full matrix entries will be considered.
+  *               Default is \c Lower, best performance is \c Lower|Upper.
+  * \tparam _Preconditioner the type of the preconditioner. Default is DiagonalPreconditioner
+  *
+  * The maximal number of iterations and tolerance value can be controlled via the setMaxIterations()
+  * and setTolerance() methods. The defaults are the size of the problem for the maximal number of iterations
+  * and NumTraits<Scalar>::epsilon() for the tolerance.
+  *
+  * This class has the same interface as ConjugateGradient:
+    \code
+    int n = 10000;
+    VectorXd x(n), b(n);
+    SparseMatrix<double> A(n,n);
+    // fill A and b
+    PipelinedConjugateGradient<SparseMatrix<double>, Lower|Upper> cg;
+    cg.compute(A);
+    x = cg.solve(b);
+    std::cout << "#iterations:     " << cg.iterations() << std::endl;
+    std::cout << "estimated error: " << cg.error()      << std::endl;
+    \endcode
+  *
+  * \sa class ConjugateGradient
+  */
+template< typename _MatrixType, int _UpLo, typename _Preconditioner>
+class PipelinedConjugateGradient : public IterativeSolverBase<PipelinedConjugateGradient<_MatrixType,_UpLo,_Preconditioner> >
+{
+  typedef IterativeSolverBase<PipelinedConjugateGradient> Base;
+  using Base::matrix;
+  using Base::m_error;
+  using Base::m_iterations;
+  using Base::m_info;
+  using Base::m_isInitialized;
+public:
+  typedef _MatrixType MatrixType;
+  typedef typename MatrixType::Scalar Scalar;
+  typedef typename MatrixType::RealScalar RealScalar;
+  typedef _Preconditioner Preconditioner;
+
+  enum {
+    UpLo = _UpLo
+  };
+
+public:
+
+  /** Default constructor. */
+  PipelinedConjugateGradient() : Base() {}
+
+  /** Initialize the solver with matrix \a A for further \c Ax=b solving.
+    *
+    * This constructor is a shortcut for the default constructor followed
+    * by a call to compute().
+    *
+    * \warning this class stores a reference to the matrix A as well as some
+    * precomputed values that depend on it. Therefore, if \a A is changed
+    * this class becomes invalid. Call compute() to update it with the new
+    * matrix A, or modify a copy of A.
+    */
+  explicit PipelinedConjugateGradient(const MatrixType& A) : Base(A) {}
+
+  ~PipelinedConjugateGradient() {}
+
+  /** \internal */
+  template<typename Rhs,typename Dest>
+  void _solve_with_guess_impl(const Rhs& b, Dest& x) const
+  {
+    typedef typename Base::MatrixWrapper MatrixWrapper;
+    typedef typename Base::ActualMatrixType ActualMatrixType;
+    enum {
+      TransposeInput  =   (!MatrixWrapper::MatrixFree)
+                      &&  (UpLo==(Lower|Upper))
+                      &&  (!MatrixType::IsRowMajor)
+                      &&  (!NumTraits<Scalar>::IsComplex)
+    };
+    typedef typename internal::conditional<TransposeInput,Transpose<const ActualMatrixType>, ActualMatrixType const&>::type RowMajorWrapper;
+    EIGEN_STATIC_ASSERT(EIGEN_IMPLIES(MatrixWrapper::MatrixFree,UpLo==(Lower|Upper)),MATRIX_FREE_CONJUGATE_GRADIENT_IS_COMPATIBLE_WITH_UPPER_UNION_LOWER_MODE_ONLY);
+    typedef typename internal::conditional<UpLo==(Lower|Upper),
+                                           RowMajorWrapper,
+                                           typename MatrixWrapper::template ConstSelfAdjointViewReturnType<UpLo>::Type
+                                          >::type SelfAdjointWrapper;
+    m_iterations = Base::maxIterations();
+    m_error = Base::m_tolerance;
+
+    for(Index j=0; j<b.cols(); ++j)
+    {
+      m_iterations = Base::maxIterations();
+      m_error = Base::m_tolerance;
+
+      typename Dest::ColXpr xj(x,j);
+      RowMajorWrapper row_mat(matrix());
+      internal::pipelined_conjugate_gradient(SelfAdjointWrapper(row_mat), b.col(j), xj, Base::m_preconditioner, m_iterations, m_error);
+    }
+
+    m_isInitialized = true;
+    m_info = m_error <= Base::m_tolerance ? Success : NoConvergence;
+  }
+
+  /** \internal */
+  using Base::_solve_impl;
+  template<typename Rhs,typename Dest>
+  void _solve_impl(const MatrixBase<Rhs>& b, Dest& x) const
+  {
+    x.setZero();
+    _solve_with_guess_impl(b.derived(),x);
+  }
+
+protected:
+
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_PIPELINED_CONJUGATE_GRADIENT_H
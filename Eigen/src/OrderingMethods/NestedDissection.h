@@ -0,0 +1,740 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_NESTED_DISSECTION_H
+#define EIGEN_NESTED_DISSECTION_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal
+  * Undirected graph with weighted vertices and edges, stored in compressed form:
+  * the neighbors of the vertex v are adjncy[xadj[v]] ... adjncy[xadj[v+1]-1], and
+  * the weights of the respective edges are stored in adjwgt.
+  */
+template<typename StorageIndex>
+struct nd_graph
+{
+  std::vector<StorageIndex> xadj, adjncy, adjwgt, vwgt;
+
+  Index size() const { return Index(xadj.size())-1; }
+
+  Index totalWeight() const
+  {
+    Index w = 0;
+    for(std::size_t v=0; v<vwgt.size(); ++v)
+      w += vwgt[v];
+    return w;
+  }
+};
+
+/** \internal Builds the adjacency graph of the symmetric pattern \a mat, ignoring its diagonal. */
+template<typename MatrixType, typename StorageIndex>
+void nd_graph_from_matrix(const MatrixType& mat, nd_graph<StorageIndex>& g)
+{
+  Index n = mat.outerSize();
+  g.xadj.assign(n+1, 0);
+  g.adjncy.clear();
+  g.adjncy.reserve(mat.nonZeros());
+  for(Index j=0; j<n; ++j)
+  {
+    for(typename MatrixType::InnerIterator it(mat, j); it; ++it)
+      if(it.index()!=j)
+        g.adjncy.push_back(StorageIndex(it.index()));
+    g.xadj[j+1] = StorageIndex(g.adjncy.size());
+  }
+  g.adjwgt.assign(g.adjncy.size(), 1);
+  g.vwgt.assign(n, 1);
+}
+
+/** \internal Extracts into \a sub the subgraph of \a g induced by the vertices v such that part[v]==p.
+  * On output, \a vertices holds the vertices of \a g corresponding to the ones of \a sub, and
+  * \a map is used as workspace. */
+template<typename StorageIndex>
+void nd_extract_subgraph(const nd_graph<StorageIndex>& g, const std::vector<char>& part, char p,
+                         nd_graph<StorageIndex>& sub, std::vector<StorageIndex>& vertices, std::vector<StorageIndex>& map)
+{
+  Index n = g.size();
+  vertices.clear();
+  for(Index v=0; v<n; ++v)
+    if(part[v]==p)
+    {
+      map[v] = StorageIndex(vertices.size());
+      vertices.push_back(StorageIndex(v));
+    }
+
+  Index m = vertices.size();
+  sub.xadj.resize(m+1);
+  sub.vwgt.resize(m);
+  sub.adjncy.clear();
+  sub.adjwgt.clear();
+  sub.xadj[0] = 0;
+  for(Index i=0; i<m; ++i)
+  {
+    StorageIndex v = vertices[i];
+    sub.vwgt[i] = g.vwgt[v];
+    for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1]; ++k)
+      if(part[g.adjncy[k]]==p)
+      {
+        sub.adjncy.push_back(map[g.adjncy[k]]);
+        sub.adjwgt.push_back(g.adjwgt[k]);
+      }
+    sub.xadj[i+1] = StorageIndex(sub.adjncy.size());
+  }
+}
+
+/** \internal Coarsens \a g by collapsing the pairs of vertices of a heavy edge matching.
+  * On output, cmap[v] is the vertex of \a coarse into which the vertex v of \a g has been collapsed.
+  * The vertices are visited in a pseudo-random order generated from \a seed. */
+template<typename StorageIndex>
+void nd_coarsen(const nd_graph<StorageIndex>& g, nd_graph<StorageIndex>& coarse, std::vector<StorageIndex>& cmap, unsigned int seed)
+{
+  Index n = g.size();
+  std::vector<StorageIndex> match(n, -1), order(n);
+  for(Index v=0; v<n; ++v)
+    order[v] = StorageIndex(v);
+  // shuffle the visiting order with a linear congruential generator such that the result is reproducible
+  for(Index v=n-1; v>0; --v)
+  {
+    seed = seed*1103515245u + 12345u;
+    std::swap(order[v], order[(seed>>8)%(v+1)]);
+  }
+
+  cmap.resize(n);
+  Index nc = 0;
+  for(Index i=0; i<n; ++i)
+  {
+    StorageIndex u = order[i];
+    if(match[u]!=-1) continue;
+    StorageIndex best = u;
+    StorageIndex bestWeight = -1;
+    for(StorageIndex k=g.xadj[u]; k<g.xadj[u+1]; ++k)
+    {
+      StorageIndex v = g.adjncy[k];
+      if(match[v]==-1 && v!=u && g.adjwgt[k]>bestWeight)
+      {
+        best = v;
+        bestWeight = g.adjwgt[k];
+      }
+    }
+    match[u] = best;
+    match[best] = u;
+    cmap[u] = cmap[best] = StorageIndex(nc++);
+  }
+
+  // build the coarse graph, merging the edges of matched vertices
+  coarse.xadj.resize(nc+1);
+  coarse.vwgt.assign(nc, 0);
+  coarse.adjncy.clear();
+  coarse.adjwgt.clear();
+  coarse.adjncy.reserve(g.adjncy.size());
+  coarse.adjwgt.reserve(g.adjncy.size());
+  std::vector<StorageIndex> pos(nc, -1);
+  coarse.xadj[0] = 0;
+  Index c = 0;
+  for(Index i=0; i<n; ++i)
+  {
+    StorageIndex u = order[i];
+    if(cmap[u]!=c) continue;  // the coarse vertices are created in the order of their first vertex
+    StorageIndex pair[2] = { u, match[u] };
+    StorageIndex start = StorageIndex(coarse.adjncy.size());
+    for(int p=0; p<(pair[1]==u ? 1 : 2); ++p)
+    {
+      StorageIndex v = pair[p];
+      coarse.vwgt[c] += g.vwgt[v];
+      for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1]; ++k)
+      {
+        StorageIndex cv = cmap[g.adjncy[k]];
+        if(cv==c) continue;
+        if(pos[cv]>=start)
+          coarse.adjwgt[pos[cv]] += g.adjwgt[k];
+        else
+        {
+          pos[cv] = StorageIndex(coarse.adjncy.size());
+          coarse.adjncy.push_back(cv);
+          coarse.adjwgt.push_back(g.adjwgt[k]);
+        }
+      }
+    }
+    ++c;
+    coarse.xadj[c] = StorageIndex(coarse.adjncy.size());
+  }
+}
+
+/** \internal \returns the weight of the edges of \a g between the two parts of the bisection \a where,
+  * and sets \a pw to the weights of the two parts. */
+template<typename StorageIndex>
+Index nd_edge_cut(const nd_graph<StorageIndex>& g, const std::vector<char>& where, Index pw[2])
+{
+  Index cut = 0;
+  pw[0] = pw[1] = 0;
+  for(Index v=0; v<g.size(); ++v)
+  {
+    pw[int(where[v])] += g.vwgt[v];
+    for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1]; ++k)
+      if(where[g.adjncy[k]]!=where[v])
+        cut += g.adjwgt[k];
+  }
+  return cut/2;
+}
+
+/** \internal Improves the bisection \a where of \a g with Fiduccia-Mattheyses passes. The weight of
+  * each part is kept lower than \a maxWeight, or reduced if it is not the case on input.
+  * \returns the weight of the edge cut */
+template<typename StorageIndex>
+Index nd_refine_bisection(const nd_graph<StorageIndex>& g, std::vector<char>& where, Index maxWeight)
+{
+  typedef std::pair<Index,StorageIndex> GainVertex;
+  Index n = g.size();
+  Index pw[2];
+  Index cut = nd_edge_cut(g, where, pw);
+
+  std::vector<Index> gain(n);
+  std::vector<char> locked(n);
+  std::vector<StorageIndex> moves;
+  // maximal number of consecutive moves without improvement
+  const Index maxBadMoves = (std::max<Index>)(25, (std::min<Index>)(n/50, 200));
+
+  for(int pass=0; pass<8; ++pass)
+  {
+    std::priority_queue<GainVertex> queues[2];
+    for(Index v=0; v<n; ++v)
+    {
+      Index ed = 0, id = 0;
+      for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1]; ++k)
+        (where[g.adjncy[k]]==where[v] ? id : ed) += g.adjwgt[k];
+      gain[v] = ed-id;
+      locked[v] = 0;
+      if(ed>0)
+        queues[int(where[v])].push(GainVertex(gain[v], StorageIndex(v)));
+    }
+
+    Index initialCut = cut, bestCut = cut;
+    Index bestImbalance = (std::max)(pw[0],pw[1]) - (std::min)(pw[0],pw[1]);
+    bool balanceReached = pw[0]<=maxWeight && pw[1]<=maxWeight;
+    Index bestMove = 0;
+    moves.clear();
+
+    while(true)
+    {
+      // pick the part from which the next vertex is moved
+      int from;
+      if(pw[0]>maxWeight)       from = 0;
+      else if(pw[1]>maxWeight)  from = 1;
+      else
+      {
+        // discard the outdated entries
+        for(int p=0; p<2; ++p)
+          while(!queues[p].empty() && (locked[queues[p].top().second] || where[queues[p].top().second]!=p
+                                       || gain[queues[p].top().second]!=queues[p].top().first))
+            queues[p].pop();
+        if(queues[0].empty() && queues[1].empty()) break;
+        if(queues[0].empty())       from = 1;
+        else if(queues[1].empty())  from = 0;
+        else                        from = queues[0].top().first>=queues[1].top().first ? 0 : 1;
+      }
+      int to = 1-from;
+
+      StorageIndex v = -1;
+      while(!queues[from].empty())
+      {
+        GainVertex top = queues[from].top();
+        queues[from].pop();
+        if(locked[top.second] || where[top.second]!=from || gain[top.second]!=top.first) continue;
+        if(pw[to]+g.vwgt[top.second]>maxWeight && pw[from]<=maxWeight) continue;
+        v = top.second;
+        break;
+      }
+      if(v==-1) break;
+
+      // move v and update the gains of its neighbors
+      cut -= gain[v];
+      pw[from] -= g.vwgt[v];
+      pw[to] += g.vwgt[v];
+      where[v] = char(to);
+      locked[v] = 1;
+      gain[v] = -gain[v];
+      moves.push_back(v);
+      for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1]; ++k)
+      {
+        StorageIndex u = g.adjncy[k];
+        gain[u] += where[u]==to ? -2*g.adjwgt[k] : 2*g.adjwgt[k];
+        if(!locked[u])
+          queues[int(where[u])].push(GainVertex(gain[u], u));
+      }
+
+      Index imbalance = (std::max)(pw[0],pw[1]) - (std::min)(pw[0],pw[1]);
+      bool balanced = pw[0]<=maxWeight && pw[1]<=maxWeight;
+      if(balanced && (cut<bestCut || (cut==bestCut && imbalance<bestImbalance) || !balanceReached))
+      {
+        bestCut = cut;
+        bestImbalance = imbalance;
+        bestMove = moves.size();
+        balanceReached = true;
+      }
+      else if(Index(moves.size())-bestMove > maxBadMoves && balanceReached)
+        break;
+    }
+
+    // rollback the moves performed after the best bisection, unless the balance could not be reached
+    if(!balanceReached)
+    {
+      bestMove = moves.size();
+      bestCut = cut;
+    }
+    for(Index i=Index(moves.size())-1; i>=bestMove; --i)
+    {
+      StorageIndex v = moves[i];
+      int to = where[v];
+      where[v] = char(1-to);
+      pw[to] -= g.vwgt[v];
+      pw[1-to] += g.vwgt[v];
+    }
+    cut = bestCut;
+    if(bestCut>=initialCut && pass>0)
+      break;
+  }
+  return cut;
+}
+
+/** \internal Computes an initial bisection of \a g by growing a part from the vertex \a seed in
+  * breadth first order until it reaches half of the total weight. */
+template<typename StorageIndex>
+void nd_grow_bisection(const nd_graph<StorageIndex>& g, StorageIndex seed, std::vector<char>& where)
+{
+  Index n = g.size();
+  Index half = g.totalWeight()/2;
+  where.assign(n, 1);
+  std::vector<StorageIndex> queue;
+  queue.reserve(n);
+  Index w = 0;
+  std::size_t head = 0;
+  Index next = 0;
+  while(w<half)
+  {
+    if(head==queue.size())
+    {
+      // start from another connected component
+      if(where[seed]==1) { where[seed] = 0; queue.push_back(seed); }
+      else
+      {
+        while(next<n && where[next]==0) ++next;
+        if(next==n) break;
+        where[next] = 0;
+        queue.push_back(StorageIndex(next));
+      }
+      w += g.vwgt[queue.back()];
+      continue;
+    }
+    StorageIndex v = queue[head++];
+    for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1] && w<half; ++k)
+    {
+      StorageIndex u = g.adjncy[k];
+      if(where[u]==1)
+      {
+        where[u] = 0;
+        w += g.vwgt[u];
+        queue.push_back(u);
+      }
+    }
+  }
+}
+
+/** \internal \returns a vertex of maximal distance to \a v in breadth first order */
+template<typename StorageIndex>
+StorageIndex nd_farthest_vertex(const nd_graph<StorageIndex>& g, StorageIndex v, std::vector<StorageIndex>& queue, std::vector<char>& visited)
+{
+  visited.assign(g.size(), 0);
+  queue.clear();
+  queue.push_back(v);
+  visited[v] = 1;
+  for(std::size_t head=0; head<queue.size(); ++head)
+  {
+    StorageIndex u = queue[head];
+    for(StorageIndex k=g.xadj[u]; k<g.xadj[u+1]; ++k)
+      if(!visited[g.adjncy[k]])
+      {
+        visited[g.adjncy[k]] = 1;
+        queue.push_back(g.adjncy[k]);
+      }
+  }
+  return queue.back();
+}
+
+/** \internal Computes a balanced bisection of \a g minimizing the edge cut with a multilevel scheme:
+  * \a g is coarsened by heavy edge matchings, the coarsest graph is bisected by graph growing from
+  * several seeds, and the bisection is projected back and refined at each level. */
+template<typename StorageIndex>
+void nd_multilevel_bisection(const nd_graph<StorageIndex>& g, std::vector<char>& where)
+{
+  const Index coarsestSize = 100;
+  std::vector<nd_graph<StorageIndex> > levels;
+  std::vector<std::vector<StorageIndex> > cmaps;
+  const nd_graph<StorageIndex>* current = &g;
+  while(current->size()>coarsestSize)
+  {
+    nd_graph<StorageIndex> coarse;
+    std::vector<StorageIndex> cmap;
+    nd_coarsen(*current, coarse, cmap, unsigned(levels.size()+1));
+    if(coarse.size() > current->size()*9/10)
+      break;
+    levels.push_back(nd_graph<StorageIndex>());
+    levels.back().xadj.swap(coarse.xadj);
+    levels.back().adjncy.swap(coarse.adjncy);
+    levels.back().adjwgt.swap(coarse.adjwgt);
+    levels.back().vwgt.swap(coarse.vwgt);
+    cmaps.push_back(std::vector<StorageIndex>());
+    cmaps.back().swap(cmap);
+    current = &levels.back();
+  }
+
+  Index total = g.totalWeight();
+  Index maxVertexWeight = *std::max_element(current->vwgt.begin(), current->vwgt.end());
+  Index maxWeight = (std::max)(total*11/20, (total+1)/2 + maxVertexWeight);
+
+  // initial bisection of the coarsest graph: keep the best of a few graph growings
+  std::vector<StorageIndex> queue;
+  std::vector<char> visited, trial;
+  StorageIndex seed = nd_farthest_vertex(*current, StorageIndex(0), queue, visited);
+  Index bestCut = -1;
+  const int nbTrials = 4;
+  for(int t=0; t<nbTrials; ++t)
+  {
+    nd_grow_bisection(*current, seed, trial);
+    Index cut = nd_refine_bisection(*current, trial, maxWeight);
+    if(bestCut<0 || cut<bestCut)
+    {
+      bestCut = cut;
+      where.swap(trial);
+    }
+    seed = t==0 ? nd_farthest_vertex(*current, seed, queue, visited)
+                : StorageIndex((Index(seed)*7919 + 1) % current->size());
+  }
+
+  // uncoarsening
+  for(Index l=Index(levels.size())-1; l>=0; --l)
+  {
+    const nd_graph<StorageIndex>& fine = l>0 ? levels[l-1] : g;
+    const std::vector<StorageIndex>& cmap = cmaps[l];
+    std::vector<char> fineWhere(fine.size());
+    for(Index v=0; v<fine.size(); ++v)
+      fineWhere[v] = where[cmap[v]];
+    where.swap(fineWhere);
+    maxVertexWeight = *std::max_element(fine.vwgt.begin(), fine.vwgt.end());
+    maxWeight = (std::max)(total*11/20, (total+1)/2 + maxVertexWeight);
+    nd_refine_bisection(fine, where, maxWeight);
+  }
+}
+
+/** \internal Converts the edge separator given by the bisection \a where of \a g into a minimal vertex
+  * separator. The vertices of the separator are the ones of a minimum vertex cover of the bipartite
+  * graph of the cut edges, which is computed from a maximum matching (Konig's theorem).
+  * On output, where[v] is 2 for the vertices of the separator. */
+template<typename StorageIndex>
+void nd_vertex_separator(const nd_graph<StorageIndex>& g, std::vector<char>& where)
+{
+  Index n = g.size();
+  std::vector<StorageIndex> mate(n, -1), dist(n), queue;
+  std::vector<StorageIndex> left;  // boundary vertices of the part 0
+  for(Index v=0; v<n; ++v)
+  {
+    if(where[v]!=0) continue;
+    for(StorageIndex k=g.xadj[v]; k<g.xadj[v+1]; ++k)
+      if(where[g.adjncy[k]]==1)
+      {
+        left.push_back(StorageIndex(v));
+        break;
+      }
+  }
+
+  // Hopcroft-Karp maximum matching between the boundary vertices of the two parts
+  const StorageIndex inf = NumTraits<StorageIndex>::highest();
+  std::vector<StorageIndex> stack, edge(n);
+  while(true)
+  {
+    // breadth first search from the free left vertices through alternating paths
+    queue.clear();
+    for(std::size_t i=0; i<left.size(); ++i)
+    {
+      StorageIndex u = left[i];
+      if(mate[u]==-1) { dist[u] = 0; queue.push_back(u); }
+      else            dist[u] = inf;
+    }
+    bool found = false;
+    for(std::size_t head=0; head<queue.size(); ++head)
+    {
+      StorageIndex u = queue[head];
+      for(StorageIndex k=g.xadj[u]; k<g.xadj[u+1]; ++k)
+      {
+        StorageIndex r = g.adjncy[k];
+        if(where[r]!=1) continue;
+        StorageIndex m = mate[r];
+        if(m==-1) found = true;
+        else if(dist[m]==inf)
+        {
+          dist[m] = dist[u]+1;
+          queue.push_back(m);
+        }
+      }
+    }
+    if(!found) break;
+
+    // depth first search of vertex disjoint shortest augmenting paths
+    Index augmented = 0;
+    for(std::size_t i=0; i<left.size(); ++i)
+    {
+      StorageIndex root = left[i];
+      if(mate[root]!=-1) continue;
+      stack.clear();
+      stack.push_back(root);
+      edge[root] = g.xadj[root];
+      while(!stack.empty())
+      {
+        StorageIndex u = stack.back();
+        if(edge[u]==g.xadj[u+1])
+        {
+          dist[u] = inf;  // dead end
+          stack.pop_back();
+          continue;
+        }
+        StorageIndex r = g.adjncy[edge[u]++];
+        if(where[r]!=1) continue;
+        StorageIndex m = mate[r];
+        if(m==-1)
+        {
+          // augment along the path stored in the stack
+          for(Index s=Index(stack.size())-1; s>=0; --s)
+          {
+            StorageIndex a = stack[s];
+            StorageIndex b = g.adjncy[edge[a]-1];
+            mate[a] = b;
+            mate[b] = a;
+          }
+          ++augmented;
+          break;
+        }
+        if(dist[m]==dist[u]+1)
+        {
+          edge[m] = g.xadj[m];
+          stack.push_back(m);
+        }
+      }
+    }
+    if(augmented==0) break;
+  }
+
+  // Konig's theorem: with Z the vertices reachable from the free left vertices through alternating
+  // paths, the minimum vertex cover is made of the left vertices not in Z and the right vertices in Z.
+  std::vector<char> inZ(n, 0);
+  queue.clear();
+  for(std::size_t i=0; i<left.size(); ++i)
+    if(mate[left[i]]==-1)
+    {
+      inZ[left[i]] = 1;
+      queue.push_back(left[i]);
+    }
+  for(std::size_t head=0; head<queue.size(); ++head)
+  {
+    StorageIndex u = queue[head];
+    for(StorageIndex k=g.xadj[u]; k<g.xadj[u+1]; ++k)
+    {
+      StorageIndex r = g.adjncy[k];
+      if(where[r]!=1 || inZ[r] || mate[u]==r) continue;
+      inZ[r] = 1;
+      StorageIndex m = mate[r];
+      if(m!=-1 && !inZ[m])
+      {
+        inZ[m] = 1;
+        queue.push_back(m);
+      }
+    }
+  }
+  for(std::size_t i=0; i<left.size(); ++i)
+    if(!inZ[left[i]])
+      where[left[i]] = 2;
+  for(Index v=0; v<n; ++v)
+    if(where[v]==1 && inZ[v])
+      where[v] = 2;
+}
+
+/** \internal Orders the vertices of the (small) graph \a g by minimum degree, or keeps their natural order
+  * if the minimum degree ordering is not available. The ordered vertices of \a g are stored in \a order. */
+template<typename StorageIndex>
+void nd_order_leaf(const nd_graph<StorageIndex>& g, StorageIndex* order)
+{
+  Index n = g.size();
+#ifndef EIGEN_MPL2_ONLY
+  if(n>2)
+  {
+    // minimum_degree_ordering postpones the vertices without a structural diagonal entry,
+    // so the diagonal is added to the pattern of the graph
+    SparseMatrix<char,ColMajor,StorageIndex> C(n,n);
+    C.resizeNonZeros(g.adjncy.size()+n);
+    StorageIndex* outer = C.outerIndexPtr();
+    StorageIndex* inner = C.innerIndexPtr();
+    outer[0] = 0;
+    for(Index v=0; v<n; ++v)
+    {
+      StorageIndex* end = std::copy(g.adjncy.begin()+g.xadj[v], g.adjncy.begin()+g.xadj[v+1], inner+outer[v]);
+      *end = StorageIndex(v);
+      outer[v+1] = StorageIndex(end+1-inner);
+    }
+    PermutationMatrix<Dynamic,Dynamic,StorageIndex> perm;
+    minimum_degree_ordering(C, perm);
+    for(Index i=0; i<n; ++i)
+      order[i] = perm.indices()(i);
+    return;
+  }
+#endif
+  for(Index i=0; i<n; ++i)
+    order[i] = StorageIndex(i);
+}
+
+/** \internal Recursive nested dissection of \a g. The vertices of \a g, whose indices in the original
+  * graph are given by \a labels, are stored into \a order in their elimination order. */
+template<typename StorageIndex>
+void nd_order(const nd_graph<StorageIndex>& g, const StorageIndex* labels, StorageIndex* order, Index leafSize)
+{
+  Index n = g.size();
+  if(n<=leafSize || g.adjncy.empty())
+  {
+    std::vector<StorageIndex> leaf(n);
+    nd_order_leaf(g, n>0 ? &leaf[0] : 0);
+    for(Index i=0; i<n; ++i)
+      order[i] = labels[leaf[i]];
+    return;
+  }
+
+  std::vector<char> where;
+  nd_multilevel_bisection(g, where);
+  nd_vertex_separator(g, where);
+
+  Index counts[3] = { 0, 0, 0 };
+  for(Index v=0; v<n; ++v)
+    ++counts[int(where[v])];
+  if(counts[0]==0 || counts[1]==0)
+  {
+    // the graph could not be split (e.g., it is almost complete)
+    std::vector<StorageIndex> leaf(n);
+    nd_order_leaf(g, &leaf[0]);
+    for(Index i=0; i<n; ++i)
+      order[i] = labels[leaf[i]];
+    return;
+  }
+
+  // the separator is eliminated last
+  Index k = counts[0]+counts[1];
+  for(Index v=0; v<n; ++v)
+    if(where[v]==2)
+      order[k++] = labels[v];
+
+  std::vector<StorageIndex> map(n);
+  Index offset = 0;
+  for(char p=0; p<2; ++p)
+  {
+    nd_graph<StorageIndex>* sub = new nd_graph<StorageIndex>;
+    std::vector<StorageIndex>* subLabels = new std::vector<StorageIndex>;
+    nd_extract_subgraph(g, where, p, *sub, *subLabels, map);
+    for(std::size_t i=0; i<subLabels->size(); ++i)
+      (*subLabels)[i] = labels[(*subLabels)[i]];
+    StorageIndex* subOrder = order+offset;
+    offset += subLabels->size();
+#if defined(EIGEN_HAS_OPENMP) && _OPENMP>=200805
+    // the two parts are independent and are thus ordered in parallel
+    #pragma omp task firstprivate(sub,subLabels,subOrder) if(sub->size()>4*leafSize)
+#endif
+    {
+      nd_order(*sub, &(*subLabels)[0], subOrder, leafSize);
+      delete sub;
+      delete subLabels;
+    }
+  }
+#if defined(EIGEN_HAS_OPENMP) && _OPENMP>=200805
+  #pragma omp taskwait
+#endif
+}
+
+} // end namespace internal
+
+/** \ingroup OrderingMethods_Module
+  * \class NestedDissectionOrdering
+  *
+  * Functor computing a \em nested \em dissection ordering
+  *
+  * The adjacency graph of the matrix is recursively split by small vertex separators, which are ordered
+  * after the two parts they separate. The separators are computed by a multilevel graph bisection
+  * (coarsening by heavy edge matchings, bisection of the coarsest graph by graph growing, and
+  * Fiduccia-Mattheyses refinement at each level), converted into minimal vertex separators.
+  * The small subgraphs are ordered by approximate minimum degree.
+  *
+  * On large 3D meshes, this ordering usually reduces the cost of the factorization compared to
+  * AMDOrdering, and the resulting elimination tree is well balanced. Its computation is however more expensive.
+  * If OpenMP is enabled, the independent subgraphs are ordered in parallel.
+  *
+  * If the matrix is not structurally symmetric, an ordering of A^T+A is computed.
+  * This ordering does not depend on the external METIS library, see MetisOrdering for this purpose.
+  *
+  * \tparam StorageIndex The type of indices of the matrix
+  * \sa AMDOrdering, MetisOrdering
+  */
+template <typename StorageIndex>
+class NestedDissectionOrdering
+{
+  public:
+    typedef PermutationMatrix<Dynamic, Dynamic, StorageIndex> PermutationType;
+
+    /** \param leafSize subgraphs having at most \a leafSize vertices are ordered by minimum degree */
+    explicit NestedDissectionOrdering(Index leafSize = 200) : m_leafSize((std::max<Index>)(leafSize,1)) {}
+
+    /** Compute the permutation vector from a sparse matrix
+     * This routine is much faster if the input matrix is column-major
+     */
+    template <typename MatrixType>
+    void operator()(const MatrixType& mat, PermutationType& perm)
+    {
+      // Compute the symmetric pattern
+      SparseMatrix<typename MatrixType::Scalar, ColMajor, StorageIndex> symm;
+      internal::ordering_helper_at_plus_a(mat,symm);
+      compute(symm, perm);
+    }
+
+    /** Compute the permutation with a selfadjoint matrix */
+    template <typename SrcType, unsigned int SrcUpLo>
+    void operator()(const SparseSelfAdjointView<SrcType, SrcUpLo>& mat, PermutationType& perm)
+    {
+      SparseMatrix<typename SrcType::Scalar, ColMajor, StorageIndex> C; C = mat;
+      compute(C, perm);
+    }
+
+  protected:
+    template <typename MatrixType>
+    void compute(const MatrixType& symm, PermutationType& perm)
+    {
+      Index n = symm.cols();
+      internal::nd_graph<StorageIndex> g;
+      internal::nd_graph_from_matrix(symm, g);
+      std::vector<StorageIndex> labels(n);
+      for(Index i=0; i<n; ++i)
+        labels[i] = StorageIndex(i);
+      perm.resize(n);
+      if(n==0)
+        return;
+#if defined(EIGEN_HAS_OPENMP) && _OPENMP>=200805
+      Eigen::initParallel();
+      #pragma omp parallel num_threads(Eigen::nbThreads())
+      #pragma omp single
+#endif
+      internal::nd_order(g, &labels[0], perm.indices().data(), m_leafSize);
+    }
+
+    Index m_leafSize;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_NESTED_DISSECTION_H
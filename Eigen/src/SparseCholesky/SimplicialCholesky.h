@@ -36,6 +36,59 @@ namespace internal {
       pmat = &input;
     }
   };
+
+  // level scheduled solve of the row k of L, whose entries are found through the row structure of L
+  template<typename Scalar, typename StorageIndex, typename Dest>
+  struct simplicial_level_lower_kernel
+  {
+    typedef Matrix<StorageIndex,Dynamic,1> VectorI;
+    simplicial_level_lower_kernel(const SparseMatrix<Scalar,ColMajor,StorageIndex>& L, const VectorI& rowOuter,
+                                  const VectorI& rowCols, const VectorI& rowPos, bool unitDiag, Dest& dst)
+      : m_L(L), m_rowOuter(rowOuter), m_rowCols(rowCols), m_rowPos(rowPos), m_unitDiag(unitDiag), m_dst(dst)
+    {}
+    void operator()(Index k) const
+    {
+      const Scalar* Lx = m_L.valuePtr();
+      for(Index col=0; col<m_dst.cols(); ++col)
+      {
+        Scalar tmp = m_dst.coeff(k,col);
+        for(Index q=m_rowOuter.coeff(k); q<m_rowOuter.coeff(k+1); ++q)
+          tmp -= Lx[m_rowPos.coeff(q)] * m_dst.coeff(m_rowCols.coeff(q),col);
+        m_dst.coeffRef(k,col) = m_unitDiag ? tmp : Scalar(tmp / Lx[m_L.outerIndexPtr()[k]]);
+      }
+    }
+    const SparseMatrix<Scalar,ColMajor,StorageIndex>& m_L;
+    const VectorI& m_rowOuter;
+    const VectorI& m_rowCols;
+    const VectorI& m_rowPos;
+    bool m_unitDiag;
+    Dest& m_dst;
+  };
+
+  // level scheduled solve of the row i of L^*, which is the column i of L
+  template<typename Scalar, typename StorageIndex, typename Dest>
+  struct simplicial_level_upper_kernel
+  {
+    simplicial_level_upper_kernel(const SparseMatrix<Scalar,ColMajor,StorageIndex>& L, bool unitDiag, Dest& dst)
+      : m_L(L), m_unitDiag(unitDiag), m_dst(dst)
+    {}
+    void operator()(Index i) const
+    {
+      const StorageIndex* Lp = m_L.outerIndexPtr();
+      const StorageIndex* Li = m_L.innerIndexPtr();
+      const Scalar* Lx = m_L.valuePtr();
+      for(Index col=0; col<m_dst.cols(); ++col)
+      {
+        Scalar tmp = m_dst.coeff(i,col);
+        for(Index p=Lp[i]+(m_unitDiag ? 0 : 1); p<Lp[i+1]; ++p)
+          tmp -= numext::conj(Lx[p]) * m_dst.coeff(Li[p],col);
+        m_dst.coeffRef(i,col) = m_unitDiag ? tmp : Scalar(tmp / numext::conj(Lx[Lp[i]]));
+      }
+    }
+    const SparseMatrix<Scalar,ColMajor,StorageIndex>& m_L;
+    bool m_unitDiag;
+    Dest& m_dst;
+  };
 } // end namespace internal
 
 /** \ingroup SparseCholesky_Module
@@ -48,6 +101,10 @@ namespace internal {
   * In order to reduce the fill-in, a symmetric permutation P is applied prior to the factorization
   * such that the factorized matrix is P A P^-1.
   *
+  * When OpenMP is enabled, the triangular solves are level scheduled and run in parallel. The levels are
+  * given by the elimination tree, and computed once by analyzePattern() together with the positions of
+  * the entries of each row of the factor.
+  *
   * \tparam _MatrixType the type of the sparse matrix A, it must be a SparseMatrix<>
   * \tparam _UpLo the triangular part that will be used for the computations. It can be Lower
   *               or Upper. Default is Lower.
@@ -164,13 +221,13 @@ class SimplicialCholeskyBase : public SparseSolverBase<Derived>
         dest = b;
 
       if(m_matrix.nonZeros()>0) // otherwise L==I
-        derived().matrixL().solveInPlace(dest);
+        solveL(dest);
 
       if(m_diag.size()>0)
         dest = m_diag.asDiagonal().inverse() * dest;
 
       if (m_matrix.nonZeros()>0) // otherwise U==I
-        derived().matrixU().solveInPlace(dest);
+        solveU(dest);
 
       if(m_P.size()>0)
         dest = m_Pinv * dest;
@@ -237,6 +294,32 @@ class SimplicialCholeskyBase : public SparseSolverBase<Derived>
     
     void ordering(const MatrixType& a, ConstCholMatrixPtr &pmat, CholMatrixType& ap);
 
+    /** \internal Solves in place with the factor L */
+    template<typename Dest>
+    void solveL(MatrixBase<Dest> &dest) const
+    {
+      Index threads = nbThreads();
+      if(m_lowerSchedule.isParallel(threads))
+        m_lowerSchedule.run(internal::simplicial_level_lower_kernel<Scalar,StorageIndex,Dest>(m_matrix, m_rowOuter, m_rowCols, m_rowPos, m_diag.size()>0, dest.derived()), threads);
+      else if(m_diag.size()>0)
+        m_matrix.template triangularView<UnitLower>().solveInPlace(dest);
+      else
+        m_matrix.template triangularView<Lower>().solveInPlace(dest);
+    }
+
+    /** \internal Solves in place with the factor L^* */
+    template<typename Dest>
+    void solveU(MatrixBase<Dest> &dest) const
+    {
+      Index threads = nbThreads();
+      if(m_upperSchedule.isParallel(threads))
+        m_upperSchedule.run(internal::simplicial_level_upper_kernel<Scalar,StorageIndex,Dest>(m_matrix, m_diag.size()>0, dest.derived()), threads);
+      else if(m_diag.size()>0)
+        m_matrix.adjoint().template triangularView<UnitUpper>().solveInPlace(dest);
+      else
+        m_matrix.adjoint().template triangularView<Upper>().solveInPlace(dest);
+    }
+
     /** keeps off-diagonal entries; drops diagonal entries */
     struct keep_diag {
       inline bool operator() (const Index& row, const Index& col, const Scalar&) const
@@ -255,6 +338,11 @@ class SimplicialCholeskyBase : public SparseSolverBase<Derived>
     VectorI m_nonZerosPerCol;
     PermutationMatrix<Dynamic,Dynamic,StorageIndex> m_P;     // the permutation
     PermutationMatrix<Dynamic,Dynamic,StorageIndex> m_Pinv;  // the inverse permutation
+    internal::sparse_level_schedule<StorageIndex> m_lowerSchedule;  // level schedules of the solves with L and L^*
+    internal::sparse_level_schedule<StorageIndex> m_upperSchedule;
+    VectorI m_rowOuter;                               // the entries of the row k of L are the columns m_rowCols[m_rowOuter[k]:m_rowOuter[k+1]-1]
+    VectorI m_rowCols;
+    VectorI m_rowPos;                                 // and the positions m_rowPos[...] in m_matrix
 
     RealScalar m_shiftOffset;
     RealScalar m_shiftScale;
@@ -593,23 +681,13 @@ public:
         dest = b;
 
       if(Base::m_matrix.nonZeros()>0) // otherwise L==I
-      {
-        if(m_LDLT)
-          LDLTTraits::getL(Base::m_matrix).solveInPlace(dest);
-        else
-          LLTTraits::getL(Base::m_matrix).solveInPlace(dest);
-      }
+        Base::solveL(dest);
 
       if(Base::m_diag.size()>0)
         dest = Base::m_diag.asDiagonal().inverse() * dest;
 
       if (Base::m_matrix.nonZeros()>0) // otherwise I==I
-      {
-        if(m_LDLT)
-          LDLTTraits::getU(Base::m_matrix).solveInPlace(dest);
-        else
-          LLTTraits::getU(Base::m_matrix).solveInPlace(dest);
-      }
+        Base::solveU(dest);
 
       if(Base::m_P.size()>0)
         dest = Base::m_Pinv * dest;
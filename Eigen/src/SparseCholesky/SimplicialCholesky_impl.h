@@ -57,8 +57,19 @@ void SimplicialCholeskyBase<Derived>::analyzePattern_preordered(const CholMatrix
 
   ei_declare_aligned_stack_constructed_variable(StorageIndex, tags, size, 0);
 
+  // with several threads, the row structure of L is recorded for the level scheduled solves:
+  // the column of each entry L(k,i) of the row k, and its rank in the column i
+  const bool levelScheduled = nbThreads()>1;
+  std::vector<StorageIndex> rowCols, rowRanks;
+  if(levelScheduled)
+    m_rowOuter.resize(size+1);
+  else
+    m_rowOuter.resize(0);
+
   for(StorageIndex k = 0; k < size; ++k)
   {
+    if(levelScheduled)
+      m_rowOuter[k] = StorageIndex(rowCols.size());
     /* L(k,:) pattern: all nodes reachable in etree from nz in A(0:k-1,k) */
     m_parent[k] = -1;             /* parent of k is not yet known */
     tags[k] = k;                  /* mark node k as visited */
@@ -74,6 +85,11 @@ void SimplicialCholeskyBase<Derived>::analyzePattern_preordered(const CholMatrix
           /* find parent of i if not yet determined */
           if (m_parent[i] == -1)
             m_parent[i] = k;
+          if(levelScheduled)
+          {
+            rowCols.push_back(i);
+            rowRanks.push_back(m_nonZerosPerCol[i]);
+          }
           m_nonZerosPerCol[i]++;        /* L (k,i) is nonzero */
           tags[i] = k;                  /* mark i as visited */
         }
@@ -89,6 +105,34 @@ void SimplicialCholeskyBase<Derived>::analyzePattern_preordered(const CholMatrix
 
   m_matrix.resizeNonZeros(Lp[size]);
 
+  // the levels of the solves with L and L^* are the height and the depth of the nodes in the elimination tree,
+  // since the entries of the row k of L are descendants of k
+  m_lowerSchedule.clear();
+  m_upperSchedule.clear();
+  m_rowCols.resize(0);
+  m_rowPos.resize(0);
+  if(levelScheduled)
+  {
+    Index nnz = rowCols.size();
+    m_rowOuter[size] = StorageIndex(nnz);
+    m_rowCols.resize(nnz);
+    m_rowPos.resize(nnz);
+    for(Index q = 0; q < nnz; ++q)
+    {
+      m_rowCols[q] = rowCols[q];
+      m_rowPos[q] = Lp[rowCols[q]] + (doLDLT ? 0 : 1) + rowRanks[q];
+    }
+
+    VectorI level = VectorI::Zero(size);
+    for(StorageIndex k = 0; k < size; ++k)
+      if(m_parent[k] != -1)
+        level[m_parent[k]] = (std::max)(level[m_parent[k]], StorageIndex(level[k]+1));
+    m_lowerSchedule.compute(level);
+    for(StorageIndex k = size-1; k >= 0; --k)
+      level[k] = m_parent[k] == -1 ? 0 : level[m_parent[k]]+1;
+    m_upperSchedule.compute(level);
+  }
+
   m_isInitialized     = true;
   m_info              = Success;
   m_analysisIsOk      = true;
@@ -14,109 +14,402 @@ namespace Eigen {
 
 namespace internal {
 
-template<typename Lhs, typename Rhs, typename ResultType>
-static void conservative_sparse_sparse_product_impl(const Lhs& lhs, const Rhs& rhs, ResultType& res, bool sortedInsertion = false)
+// Computes the columns of the sparse product lhs*rhs one after the other.
+// The j-th column of the result is the linear combination of the columns of lhs given by
+// the j-th column of rhs (the callers fake the storage orders to reach this configuration).
+//
+// Two accumulators are available:
+//  - for hypersparse products, i.e., when the number of multiply-adds is lower than the number of rows,
+//    the products are expanded in a buffer which is sorted by row indices, and then compressed by
+//    summing the duplicates. This avoids the allocation of a dense workspace larger than the product.
+//  - otherwise, they are accumulated into a dense vector of size rows, with a mask.
+template<typename Lhs, typename Rhs, typename Scalar, typename StorageIndex>
+class sparse_sparse_product_accumulator
 {
-  typedef typename remove_all<Lhs>::type::Scalar Scalar;
+    typedef typename evaluator<Lhs>::type LhsEval;
+    typedef typename evaluator<Rhs>::type RhsEval;
+    typedef typename evaluator<Lhs>::InnerIterator LhsIterator;
+    typedef typename evaluator<Rhs>::InnerIterator RhsIterator;
 
-  // make sure to call innerSize/outerSize since we fake the storage order.
-  Index rows = lhs.innerSize();
-  Index cols = rhs.outerSize();
-  eigen_assert(lhs.outerSize() == rhs.innerSize());
-  
-  ei_declare_aligned_stack_constructed_variable(bool,   mask,     rows, 0);
-  ei_declare_aligned_stack_constructed_variable(Scalar, values,   rows, 0);
-  ei_declare_aligned_stack_constructed_variable(Index,  indices,  rows, 0);
-  
-  std::memset(mask,0,sizeof(bool)*rows);
+    struct index_less
+    {
+      bool operator()(const std::pair<StorageIndex,Scalar>& a, const std::pair<StorageIndex,Scalar>& b) const
+      { return a.first < b.first; }
+    };
 
-  typename evaluator<Lhs>::type lhsEval(lhs);
-  typename evaluator<Rhs>::type rhsEval(rhs);
-  
-  // estimate the number of non zero entries
-  // given a rhs column containing Y non zeros, we assume that the respective Y columns
-  // of the lhs differs in average of one non zeros, thus the number of non zeros for
-  // the product of a rhs column with the lhs is X+Y where X is the average number of non zero
-  // per column of the lhs.
-  // Therefore, we have nnz(lhs*rhs) = nnz(lhs) + nnz(rhs)
-  Index estimated_nnz_prod = lhsEval.nonZerosEstimate() + rhsEval.nonZerosEstimate();
+  public:
+    /** \a flops is the number of multiply-adds of the columns which will be computed by this accumulator */
+    sparse_sparse_product_accumulator(const LhsEval& lhsEval, const RhsEval& rhsEval, Index rows, Index flops)
+      : m_lhsEval(lhsEval), m_rhsEval(rhsEval), m_rows(rows), m_hypersparse(flops<rows)
+    {
+      if(!m_hypersparse)
+      {
+        m_mask.setConstant(m_rows, false);
+        m_dense.resize(m_rows);
+      }
+    }
 
-  res.setZero();
-  res.reserve(Index(estimated_nnz_prod));
-  // we compute each column of the result, one after the other
-  for (Index j=0; j<cols; ++j)
-  {
+    /** Appends the nonzeros of the \a j -th column to \a dst. The values are set to zero if \a WithValues
+      * is false. The row indices are sorted if \a sorted is true.
+      * \returns the number of nonzeros of the column */
+    template<bool WithValues, typename Storage>
+    Index computeColumn(Index j, bool sorted, Storage& dst)
+    {
+      Index size = dst.size();
+      if(m_hypersparse)
+        expandSortCompress<WithValues>(j, dst);
+      else
+        denseAccumulate<WithValues>(j, sorted, dst);
+      return dst.size()-size;
+    }
 
-    res.startVec(j);
-    Index nnz = 0;
-    for (typename evaluator<Rhs>::InnerIterator rhsIt(rhsEval, j); rhsIt; ++rhsIt)
+    /** Computes the values of the \a j -th column given its sorted row indices \a pattern of size \a nnz,
+      * and stores them into \a dst. */
+    void computeValues(Index j, const StorageIndex* pattern, Index nnz, Scalar* dst)
     {
-      Scalar y = rhsIt.value();
-      Index k = rhsIt.index();
-      for (typename evaluator<Lhs>::InnerIterator lhsIt(lhsEval, k); lhsIt; ++lhsIt)
+      if(m_hypersparse)
       {
-        Index i = lhsIt.index();
-        Scalar x = lhsIt.value();
-        if(!mask[i])
+        std::fill(dst, dst+nnz, Scalar(0));
+        for(RhsIterator rhsIt(m_rhsEval, j); rhsIt; ++rhsIt)
         {
-          mask[i] = true;
-          values[i] = x * y;
-          indices[nnz] = i;
-          ++nnz;
+          Scalar y = rhsIt.value();
+          for(LhsIterator lhsIt(m_lhsEval, rhsIt.index()); lhsIt; ++lhsIt)
+          {
+            Index p = std::lower_bound(pattern, pattern+nnz, StorageIndex(lhsIt.index())) - pattern;
+            eigen_assert(p<nnz && pattern[p]==lhsIt.index() && "the structure of the operands has changed since analyzePattern()");
+            dst[p] += lhsIt.value() * y;
+          }
         }
-        else
-          values[i] += x * y;
       }
-    }
-    if(!sortedInsertion)
-    {
-      // unordered insertion
-      for(Index k=0; k<nnz; ++k)
+      else
       {
-        Index i = indices[k];
-        res.insertBackByOuterInnerUnordered(j,i) = values[i];
-        mask[i] = false;
+        for(Index k=0; k<nnz; ++k)
+          m_dense[pattern[k]] = Scalar(0);
+        for(RhsIterator rhsIt(m_rhsEval, j); rhsIt; ++rhsIt)
+        {
+          Scalar y = rhsIt.value();
+          for(LhsIterator lhsIt(m_lhsEval, rhsIt.index()); lhsIt; ++lhsIt)
+            m_dense[lhsIt.index()] += lhsIt.value() * y;
+        }
+        for(Index k=0; k<nnz; ++k)
+          dst[k] = m_dense[pattern[k]];
       }
     }
-    else
+
+  protected:
+
+    template<bool WithValues, typename Storage>
+    void expandSortCompress(Index j, Storage& dst)
     {
-      // alternative ordered insertion code:
-      const Index t200 = rows/11; // 11 == (log2(200)*1.39)
-      const Index t = (rows*100)/139;
-
-      // FIXME reserve nnz non zeros
-      // FIXME implement faster sorting algorithms for very small nnz
-      // if the result is sparse enough => use a quick sort
-      // otherwise => loop through the entire vector
-      // In order to avoid to perform an expensive log2 when the
-      // result is clearly very sparse we use a linear bound up to 200.
-      if((nnz<200 && nnz<t200) || nnz * numext::log2(int(nnz)) < t)
+      Index start = dst.size();
+      if(WithValues)
       {
-        if(nnz>1) std::sort(indices,indices+nnz);
-        for(Index k=0; k<nnz; ++k)
+        m_entries.clear();
+        for(RhsIterator rhsIt(m_rhsEval, j); rhsIt; ++rhsIt)
         {
-          Index i = indices[k];
-          res.insertBackByOuterInner(j,i) = values[i];
-          mask[i] = false;
+          Scalar y = rhsIt.value();
+          for(LhsIterator lhsIt(m_lhsEval, rhsIt.index()); lhsIt; ++lhsIt)
+            m_entries.push_back(std::make_pair(StorageIndex(lhsIt.index()), Scalar(lhsIt.value() * y)));
+        }
+        std::sort(m_entries.begin(), m_entries.end(), index_less());
+        for(std::size_t k=0; k<m_entries.size(); ++k)
+        {
+          if(dst.size()>start && dst.index(dst.size()-1)==m_entries[k].first)
+            dst.value(dst.size()-1) += m_entries[k].second;
+          else
+            dst.append(m_entries[k].second, m_entries[k].first);
         }
       }
       else
       {
-        // dense path
-        for(Index i=0; i<rows; ++i)
+        m_indices.clear();
+        for(RhsIterator rhsIt(m_rhsEval, j); rhsIt; ++rhsIt)
+          for(LhsIterator lhsIt(m_lhsEval, rhsIt.index()); lhsIt; ++lhsIt)
+            m_indices.push_back(StorageIndex(lhsIt.index()));
+        std::sort(m_indices.begin(), m_indices.end());
+        for(std::size_t k=0; k<m_indices.size(); ++k)
+          if(k==0 || m_indices[k]!=m_indices[k-1])
+            dst.append(Scalar(0), m_indices[k]);
+      }
+    }
+
+    template<bool WithValues, typename Storage>
+    void denseAccumulate(Index j, bool sorted, Storage& dst)
+    {
+      m_indices.clear();
+      for(RhsIterator rhsIt(m_rhsEval, j); rhsIt; ++rhsIt)
+      {
+        Scalar y = rhsIt.value();
+        for(LhsIterator lhsIt(m_lhsEval, rhsIt.index()); lhsIt; ++lhsIt)
         {
-          if(mask[i])
+          Index i = lhsIt.index();
+          if(!m_mask.coeff(i))
           {
-            mask[i] = false;
-            res.insertBackByOuterInner(j,i) = values[i];
+            m_mask.coeffRef(i) = true;
+            if(WithValues) m_dense.coeffRef(i) = lhsIt.value() * y;
+            m_indices.push_back(StorageIndex(i));
           }
+          else if(WithValues)
+            m_dense.coeffRef(i) += lhsIt.value() * y;
         }
       }
+
+      Index nnz = m_indices.size();
+      if(sorted)
+      {
+        // if the result is sparse enough => use a quick sort
+        // otherwise => loop through the entire vector
+        // In order to avoid to perform an expensive log2 when the
+        // result is clearly very sparse we use a linear bound up to 200.
+        const Index t200 = m_rows/11; // 11 == (log2(200)*1.39)
+        const Index t = (m_rows*100)/139;
+        if((nnz<200 && nnz<t200) || nnz * numext::log2(int(nnz)) < t)
+          std::sort(m_indices.begin(), m_indices.end());
+        else
+        {
+          m_indices.clear();
+          for(Index i=0; i<m_rows; ++i)
+            if(m_mask.coeff(i))
+              m_indices.push_back(StorageIndex(i));
+        }
+      }
+
+      for(Index k=0; k<nnz; ++k)
+      {
+        Index i = m_indices[k];
+        dst.append(WithValues ? m_dense.coeff(i) : Scalar(0), i);
+        m_mask.coeffRef(i) = false;
+      }
+    }
+
+    const LhsEval& m_lhsEval;
+    const RhsEval& m_rhsEval;
+    Index m_rows;
+    bool m_hypersparse;
+    Matrix<bool,Dynamic,1> m_mask;
+    Matrix<Scalar,Dynamic,1> m_dense;
+    std::vector<StorageIndex> m_indices;
+    std::vector<std::pair<StorageIndex,Scalar> > m_entries;
+};
+
+// Splits the columns of lhs*rhs into chunks of consecutive columns to be processed in parallel.
+// On output, the c-th chunk is made of the columns [bounds[c], bounds[c+1]) and requires chunkFlops[c]
+// multiply-adds. The chunks are balanced with respect to the flops. The number of multiply-adds of
+// each column is only needed, and stored, when several threads are used; otherwise there is a single chunk.
+template<typename Lhs, typename Rhs>
+void sparse_sparse_product_split(const typename evaluator<Lhs>::type& lhsEval, const typename evaluator<Rhs>::type& rhsEval,
+                                 Index depth, Index cols, std::vector<Index>& bounds, std::vector<Index>& chunkFlops)
+{
+  std::vector<Index> lhsNnz(depth, 0);
+  for(Index k=0; k<depth; ++k)
+    for(typename evaluator<Lhs>::InnerIterator lhsIt(lhsEval, k); lhsIt; ++lhsIt)
+      ++lhsNnz[k];
+
+  Index threads = 1;
+#ifdef EIGEN_HAS_OPENMP
+  Eigen::initParallel();
+  // do not split the product if we are already in a parallel region
+  if(omp_get_num_threads()==1)
+    threads = Eigen::nbThreads();
+#endif
+
+  if(threads==1)
+  {
+    Index totalFlops = 0;
+    for(Index j=0; j<cols; ++j)
+      for(typename evaluator<Rhs>::InnerIterator rhsIt(rhsEval, j); rhsIt; ++rhsIt)
+        totalFlops += lhsNnz[rhsIt.index()];
+    bounds.resize(2);
+    bounds[0] = 0;
+    bounds[1] = cols;
+    chunkFlops.assign(1, totalFlops);
+    return;
+  }
+
+  std::vector<Index> flops(cols+1);
+  flops[0] = 0;
+  for(Index j=0; j<cols; ++j)
+  {
+    Index f = 0;
+    for(typename evaluator<Rhs>::InnerIterator rhsIt(rhsEval, j); rhsIt; ++rhsIt)
+      f += lhsNnz[rhsIt.index()];
+    flops[j+1] = flops[j] + f;
+  }
+
+  // Like for sparse*dense products, this 20000 threshold represents the minimal amount of work
+  // to be worth it. More chunks than threads are created to balance the load between threads.
+  Index nbChunks = flops[cols] > 20000 ? (std::min)(cols, 4*threads) : 1;
+  bounds.resize(nbChunks+1);
+  chunkFlops.resize(nbChunks);
+  bounds[0] = 0;
+  for(Index c=1; c<nbChunks; ++c)
+    bounds[c] = std::lower_bound(flops.begin(), flops.end(), (flops[cols]/nbChunks)*c) - flops.begin();
+  bounds[nbChunks] = cols;
+  for(Index c=0; c<nbChunks; ++c)
+    chunkFlops[c] = flops[bounds[c+1]] - flops[bounds[c]];
+}
+
+// Computes the structure, and the values if WithValues is true, of the columns of each chunk
+// into separate buffers which are gathered afterward.
+template<typename Lhs, typename Rhs, typename Scalar, typename StorageIndex, bool WithValues>
+struct sparse_sparse_product_expand_task
+{
+  typedef sparse_sparse_product_accumulator<Lhs,Rhs,Scalar,StorageIndex> Accumulator;
+  typedef CompressedStorage<Scalar,StorageIndex> Storage;
+
+  const typename evaluator<Lhs>::type& lhsEval;
+  const typename evaluator<Rhs>::type& rhsEval;
+  Index rows;
+  bool sorted;
+  const std::vector<Index>& chunkFlops;
+  StorageIndex* colNnz;
+  Storage** buffers;
+
+  void operator()(Index c, Index start, Index end) const
+  {
+    Accumulator acc(lhsEval, rhsEval, rows, chunkFlops[c]);
+    Storage& dst = *buffers[c];
+    for(Index j=start; j<end; ++j)
+      colNnz[j] = StorageIndex(acc.template computeColumn<WithValues>(j, sorted, dst));
+  }
+};
+
+// Computes the values of the columns of each chunk given the structure of the result.
+template<typename Lhs, typename Rhs, typename Scalar, typename StorageIndex>
+struct sparse_sparse_product_values_task
+{
+  typedef sparse_sparse_product_accumulator<Lhs,Rhs,Scalar,StorageIndex> Accumulator;
+
+  const typename evaluator<Lhs>::type& lhsEval;
+  const typename evaluator<Rhs>::type& rhsEval;
+  Index rows;
+  const std::vector<Index>& chunkFlops;
+  const StorageIndex* outerIndex;
+  const StorageIndex* innerIndex;
+  Scalar* values;
+
+  void operator()(Index c, Index start, Index end) const
+  {
+    Accumulator acc(lhsEval, rhsEval, rows, chunkFlops[c]);
+    for(Index j=start; j<end; ++j)
+      acc.computeValues(j, innerIndex+outerIndex[j], outerIndex[j+1]-outerIndex[j], values+outerIndex[j]);
+  }
+};
+
+template<typename Task>
+void sparse_sparse_product_run(const Task& task, const std::vector<Index>& bounds)
+{
+  Index nbChunks = bounds.size()-1;
+#ifdef EIGEN_HAS_OPENMP
+  if(nbChunks>1)
+  {
+    #pragma omp parallel for schedule(dynamic,1) num_threads(int((std::min)(nbChunks,Index(Eigen::nbThreads()))))
+    for(Index c=0; c<nbChunks; ++c)
+      task(c, bounds[c], bounds[c+1]);
+    return;
+  }
+#endif
+  for(Index c=0; c<nbChunks; ++c)
+    task(c, bounds[c], bounds[c+1]);
+}
+
+// Computes the structure, and the values if WithValues is true, of lhs*rhs into the compressed matrix res.
+// The columns of res are computed independently, by chunks of columns processed in parallel if
+// OpenMP is enabled. The first chunk is directly computed into res, the other ones are appended afterward.
+template<bool WithValues, typename Lhs, typename Rhs, typename ResScalar, int ResOptions, typename ResStorageIndex>
+void sparse_sparse_product_expand(const Lhs& lhs, const Rhs& rhs, SparseMatrix<ResScalar,ResOptions,ResStorageIndex>& res, bool sorted)
+{
+  // make sure to call innerSize/outerSize since we fake the storage order.
+  Index rows = lhs.innerSize();
+  Index cols = rhs.outerSize();
+  eigen_assert(lhs.outerSize() == rhs.innerSize());
+  eigen_assert(res.innerSize() == rows && res.outerSize() == cols);
+
+  typename evaluator<Lhs>::type lhsEval(lhs);
+  typename evaluator<Rhs>::type rhsEval(rhs);
+
+  std::vector<Index> bounds, chunkFlops;
+  sparse_sparse_product_split<Lhs,Rhs>(lhsEval, rhsEval, lhs.outerSize(), cols, bounds, chunkFlops);
+  Index nbChunks = bounds.size()-1;
+
+  typedef sparse_sparse_product_expand_task<Lhs,Rhs,ResScalar,ResStorageIndex,WithValues> Task;
+  typedef typename Task::Storage Storage;
+
+  res.setZero();
+  // given a rhs column containing Y non zeros, we assume that the respective Y columns
+  // of the lhs differs in average of one non zeros, thus the number of non zeros for
+  // the product of a rhs column with the lhs is X+Y where X is the average number of non zero
+  // per column of the lhs.
+  // Therefore, we have nnz(lhs*rhs) = nnz(lhs) + nnz(rhs)
+  res.reserve(lhsEval.nonZerosEstimate() + rhsEval.nonZerosEstimate());
+
+  std::vector<Storage> chunkBuffers(nbChunks-1);
+  std::vector<Storage*> buffers(nbChunks);
+  buffers[0] = &res.data();
+  for(Index c=1; c<nbChunks; ++c)
+    buffers[c] = &chunkBuffers[c-1];
+
+  ResStorageIndex* outerIndex = res.outerIndexPtr();
+  Task task = { lhsEval, rhsEval, rows, sorted, chunkFlops, outerIndex+1, &buffers[0] };
+  sparse_sparse_product_run(task, bounds);
+
+  for(Index j=0; j<cols; ++j)
+    outerIndex[j+1] += outerIndex[j];
+
+  if(nbChunks>1)
+  {
+    Index offset = res.data().size();
+    res.resizeNonZeros(outerIndex[cols]);
+    for(Index c=1; c<nbChunks; ++c)
+    {
+      Index size = buffers[c]->size();
+      if(size==0) continue;
+      internal::smart_copy(&buffers[c]->index(0), &buffers[c]->index(0)+size, res.innerIndexPtr()+offset);
+      internal::smart_copy(&buffers[c]->value(0), &buffers[c]->value(0)+size, res.valuePtr()+offset);
+      offset += size;
     }
   }
-  res.finalize();
 }
 
+template<typename Lhs, typename Rhs, typename ResultType>
+static void conservative_sparse_sparse_product_impl(const Lhs& lhs, const Rhs& rhs, ResultType& res, bool sortedInsertion = false)
+{
+  typedef SparseMatrix<typename ResultType::Scalar, ResultType::IsRowMajor ? RowMajor : ColMajor,
+                       typename ResultType::StorageIndex> ResMatrix;
+  ResMatrix resMat(res.rows(), res.cols());
+  sparse_sparse_product_expand<true>(lhs, rhs, resMat, sortedInsertion);
+  res = resMat.markAsRValue();
+}
+
+// Computes the sorted structure of lhs*rhs into res, and sets its values to zero.
+template<typename Lhs, typename Rhs, typename ResultType>
+void sparse_sparse_product_symbolic(const Lhs& lhs, const Rhs& rhs, ResultType& res)
+{
+  sparse_sparse_product_expand<false>(lhs, rhs, res, true);
+}
+
+// Computes the values of lhs*rhs given the sorted structure of res computed by sparse_sparse_product_symbolic.
+template<typename Lhs, typename Rhs, typename ResultType>
+void sparse_sparse_product_numeric(const Lhs& lhs, const Rhs& rhs, ResultType& res)
+{
+  typedef typename ResultType::Scalar Scalar;
+  typedef typename ResultType::StorageIndex StorageIndex;
+
+  Index rows = lhs.innerSize();
+  Index cols = rhs.outerSize();
+  eigen_assert(lhs.outerSize() == rhs.innerSize());
+  eigen_assert(res.innerSize() == rows && res.outerSize() == cols && res.isCompressed());
+
+  typename evaluator<Lhs>::type lhsEval(lhs);
+  typename evaluator<Rhs>::type rhsEval(rhs);
+
+  std::vector<Index> bounds, chunkFlops;
+  sparse_sparse_product_split<Lhs,Rhs>(lhsEval, rhsEval, lhs.outerSize(), cols, bounds, chunkFlops);
+
+  sparse_sparse_product_values_task<Lhs,Rhs,Scalar,StorageIndex> task
+    = { lhsEval, rhsEval, rows, chunkFlops, res.outerIndexPtr(), res.innerIndexPtr(), res.valuePtr() };
+  sparse_sparse_product_run(task, bounds);
+}
 
 } // end namespace internal
 
@@ -41,12 +41,30 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, t
     Index threads = Eigen::nbThreads();
 #endif
     
-    for(Index c=0; c<rhs.cols(); ++c)
+    // the columns are processed by groups of 4, such that the matrix is read once per group
+    Index c = 0;
+    for(; c+3<rhs.cols(); c+=4)
+    {
+#ifdef EIGEN_HAS_OPENMP
+      if(threads>1 && lhsEval.nonZerosEstimate() > 20000)
+      {
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(Index i=0; i<n; ++i)
+          processRow4(lhsEval,rhs,res,alpha,i,c);
+      }
+      else
+#endif
+      {
+        for(Index i=0; i<n; ++i)
+          processRow4(lhsEval,rhs,res,alpha,i,c);
+      }
+    }
+    for(; c<rhs.cols(); ++c)
     {
 #ifdef EIGEN_HAS_OPENMP
       // This 20000 threshold has been found experimentally on 2D and 3D Poisson problems.
       // It basically represents the minimal amount of work to be done to be worth it.
-      if(threads>1 && lhs.nonZeros() > 20000)
+      if(threads>1 && lhsEval.nonZerosEstimate() > 20000)
       {
         #pragma omp parallel for schedule(static) num_threads(threads)
         for(Index i=0; i<n; ++i)
@@ -61,6 +79,23 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, t
     }
   }
   
+  static void processRow4(const LhsEval& lhsEval, const DenseRhsType& rhs, DenseResType& res, const typename Res::Scalar& alpha, Index i, Index col)
+  {
+    typename Res::Scalar tmp0(0), tmp1(0), tmp2(0), tmp3(0);
+    for(LhsInnerIterator it(lhsEval,i); it ;++it)
+    {
+      Index j = it.index();
+      tmp0 += it.value() * rhs.coeff(j,col);
+      tmp1 += it.value() * rhs.coeff(j,col+1);
+      tmp2 += it.value() * rhs.coeff(j,col+2);
+      tmp3 += it.value() * rhs.coeff(j,col+3);
+    }
+    res.coeffRef(i,col)   += alpha * tmp0;
+    res.coeffRef(i,col+1) += alpha * tmp1;
+    res.coeffRef(i,col+2) += alpha * tmp2;
+    res.coeffRef(i,col+3) += alpha * tmp3;
+  }
+  
   static void processRow(const LhsEval& lhsEval, const DenseRhsType& rhs, DenseResType& res, const typename Res::Scalar& alpha, Index i, Index col)
   {
     typename Res::Scalar tmp(0);
@@ -0,0 +1,125 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_SPARSEPRODUCTCACHE_H
+#define EIGEN_SPARSEPRODUCTCACHE_H
+
+namespace Eigen {
+
+/** \ingroup SparseCore_Module
+  * \class SparseProductCache
+  *
+  * \brief Sparse matrix product with a reusable structure
+  *
+  * \tparam _MatrixType the type of the result, a SparseMatrix
+  *
+  * This class computes the product of two sparse matrices in two phases. analyzePattern() computes the
+  * structure of the result from the structure of the operands, and computeValues() computes its values.
+  * This is useful when many products of matrices sharing the same structure have to be computed,
+  * as for instance the Galerkin products of multigrid methods, since then the structure of the
+  * result is computed only once:
+  * \code
+  * SparseProductCache<SparseMatrix<double> > prod;
+  * prod.analyzePattern(A, B);
+  * for(...)
+  * {
+  *   // update the values of A and B
+  *   const SparseMatrix<double>& C = prod.computeValues(A, B);
+  * }
+  * \endcode
+  *
+  * The structure of the result includes all the entries which are structurally nonzero, even if
+  * their value cancels out. Its inner indices are sorted.
+  *
+  * Both phases are multi-threaded through OpenMP, the columns (or rows if the result is row major)
+  * of the result being computed independently.
+  *
+  * The operands are evaluated in the storage order of the result, which implies a copy of
+  * the operands stored in the other order.
+  *
+  * \sa SparseMatrixBase::operator*()
+  */
+template<typename _MatrixType>
+class SparseProductCache
+{
+  public:
+    typedef _MatrixType MatrixType;
+    typedef typename MatrixType::Scalar Scalar;
+    typedef typename MatrixType::StorageIndex StorageIndex;
+    enum { IsRowMajor = MatrixType::IsRowMajor };
+
+  protected:
+    typedef SparseMatrix<Scalar,IsRowMajor?RowMajor:ColMajor,StorageIndex> OrderedMatrix;
+
+    template<typename Xpr> struct ordered_nested
+    {
+      typedef typename internal::conditional<bool(Xpr::IsRowMajor)==bool(IsRowMajor), const Xpr&, OrderedMatrix>::type type;
+    };
+
+  public:
+    SparseProductCache() : m_isAnalyzed(false) {}
+
+    /** Computes the structure of the product \a lhs * \a rhs, and sets its values to zero. */
+    template<typename Lhs, typename Rhs>
+    void analyzePattern(const SparseMatrixBase<Lhs>& lhs, const SparseMatrixBase<Rhs>& rhs)
+    {
+      eigen_assert(lhs.cols() == rhs.rows());
+      typename ordered_nested<Lhs>::type lhsNested(lhs.derived());
+      typename ordered_nested<Rhs>::type rhsNested(rhs.derived());
+      m_result.resize(lhs.rows(), rhs.cols());
+      // a row major product is computed as the column major product of the transposed operands
+      if(IsRowMajor) internal::sparse_sparse_product_symbolic(rhsNested, lhsNested, m_result);
+      else           internal::sparse_sparse_product_symbolic(lhsNested, rhsNested, m_result);
+      m_isAnalyzed = true;
+    }
+
+    /** Computes the values of the product \a lhs * \a rhs, whose structure must have been computed by
+      * analyzePattern() with operands having the same structure as \a lhs and \a rhs.
+      * \returns a reference to the result */
+    template<typename Lhs, typename Rhs>
+    const MatrixType& computeValues(const SparseMatrixBase<Lhs>& lhs, const SparseMatrixBase<Rhs>& rhs)
+    {
+      eigen_assert(m_isAnalyzed && "SparseProductCache is not initialized; call analyzePattern() first");
+      eigen_assert(lhs.rows() == m_result.rows() && rhs.cols() == m_result.cols() && lhs.cols() == rhs.rows());
+      typename ordered_nested<Lhs>::type lhsNested(lhs.derived());
+      typename ordered_nested<Rhs>::type rhsNested(rhs.derived());
+      if(IsRowMajor) internal::sparse_sparse_product_numeric(rhsNested, lhsNested, m_result);
+      else           internal::sparse_sparse_product_numeric(lhsNested, rhsNested, m_result);
+      return m_result;
+    }
+
+    /** Computes the structure and the values of the product \a lhs * \a rhs.
+      * \returns a reference to the result */
+    template<typename Lhs, typename Rhs>
+    const MatrixType& compute(const SparseMatrixBase<Lhs>& lhs, const SparseMatrixBase<Rhs>& rhs)
+    {
+      eigen_assert(lhs.cols() == rhs.rows());
+      typename ordered_nested<Lhs>::type lhsNested(lhs.derived());
+      typename ordered_nested<Rhs>::type rhsNested(rhs.derived());
+      m_result.resize(lhs.rows(), rhs.cols());
+      // both phases are performed at once
+      if(IsRowMajor) internal::sparse_sparse_product_expand<true>(rhsNested, lhsNested, m_result, true);
+      else           internal::sparse_sparse_product_expand<true>(lhsNested, rhsNested, m_result, true);
+      m_isAnalyzed = true;
+      return m_result;
+    }
+
+    /** \returns the result of the last call to computeValues() */
+    const MatrixType& result() const
+    {
+      eigen_assert(m_isAnalyzed && "SparseProductCache is not initialized; call analyzePattern() first");
+      return m_result;
+    }
+
+  protected:
+    MatrixType m_result;
+    bool m_isAnalyzed;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_SPARSEPRODUCTCACHE_H
@@ -0,0 +1,321 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_SPARSETRIANGULARLEVELSOLVER_H
+#define EIGEN_SPARSETRIANGULARLEVELSOLVER_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal Computes the level of each row of the triangular part \a UpLo of a compressed row major
+  * pattern, i.e., one more than the largest level of the rows it depends on. The entries outside of the
+  * strictly triangular part are ignored. */
+template<int UpLo, typename StorageIndex>
+void sparse_row_levels(Index n, const StorageIndex* outer, const StorageIndex* inner, Matrix<StorageIndex,Dynamic,1>& level)
+{
+  level.resize(n);
+  for(Index k=0; k<n; ++k)
+  {
+    Index i = UpLo==Lower ? k : n-1-k;
+    StorageIndex l = 0;
+    for(Index p=outer[i]; p<outer[i+1]; ++p)
+    {
+      Index j = inner[p];
+      if(UpLo==Lower ? j<i : j>i)
+        l = (std::max)(l, StorageIndex(level.coeff(j)+1));
+    }
+    level.coeffRef(i) = l;
+  }
+}
+
+/** \internal
+  * Level schedule of a sparse triangular solve. It only stores the rows sorted per level, so that the
+  * solve is performed on the storage of the factor by a kernel computing one row, see run(). */
+template<typename StorageIndex>
+class sparse_level_schedule
+{
+  public:
+    typedef Matrix<StorageIndex,Dynamic,1> IndexVector;
+    enum {
+      // levels having less rows are gathered and processed sequentially by a single thread
+      MinParallelLevelSize = 64
+    };
+
+    sparse_level_schedule() : m_parallelRows(0) {}
+
+    /** Sorts the rows per level, \a level holding the level of each row */
+    void compute(const IndexVector& level)
+    {
+      Index n = level.size();
+      Index nbLevels = n>0 ? Index(level.maxCoeff())+1 : 0;
+
+      // bucket sort of the rows per level
+      m_levelPtr.setZero(nbLevels+1);
+      for(Index i=0; i<n; ++i)
+        ++m_levelPtr.coeffRef(level.coeff(i)+1);
+      for(Index l=0; l<nbLevels; ++l)
+        m_levelPtr.coeffRef(l+1) += m_levelPtr.coeff(l);
+      m_rows.resize(n);
+      IndexVector pos = m_levelPtr.head(nbLevels);
+      for(Index i=0; i<n; ++i)
+        m_rows.coeffRef(pos.coeffRef(level.coeff(i))++) = StorageIndex(i);
+
+      // consecutive small levels are merged into segments processed sequentially
+      std::vector<StorageIndex> segments(1, 0);
+      m_parallelRows = 0;
+      for(Index l=0; l<nbLevels; ++l)
+      {
+        Index begin = m_levelPtr.coeff(l), end = m_levelPtr.coeff(l+1);
+        Index last = segments.size()>1 ? segments[segments.size()-2] : -1;
+        if(end-begin>=Index(MinParallelLevelSize))
+          m_parallelRows += end-begin;
+        else if(last>=0 && end-last<Index(MinParallelLevelSize))
+        {
+          // the current small level is appended to the previous small segment
+          segments.back() = StorageIndex(end);
+          continue;
+        }
+        segments.push_back(StorageIndex(end));
+      }
+      m_segmentPtr = Map<IndexVector>(&segments[0], segments.size());
+    }
+
+    /** Releases the schedule */
+    void clear()
+    {
+      m_rows.resize(0);
+      m_levelPtr.resize(0);
+      m_segmentPtr.resize(0);
+      m_parallelRows = 0;
+    }
+
+    Index rows() const { return m_rows.size(); }
+    Index levels() const { return m_levelPtr.size()>0 ? m_levelPtr.size()-1 : 0; }
+
+    /** \returns whether running the schedule with \a threads threads is worth it, i.e., whether most rows
+      * belong to large levels */
+    bool isParallel(Index threads) const { return threads>1 && rows()>0 && 2*m_parallelRows>=rows(); }
+
+    /** Calls \a kernel (i) for each row i, level after level. The rows of the large levels are processed
+      * in parallel by \a threads threads when OpenMP is enabled. */
+    template<typename Kernel>
+    void run(const Kernel& kernel, Index threads) const
+    {
+#ifdef EIGEN_HAS_OPENMP
+      if(threads>1)
+      {
+        Index nbSegments = m_segmentPtr.size()-1;
+        #pragma omp parallel num_threads(int(threads))
+        for(Index s=0; s<nbSegments; ++s)
+        {
+          Index begin = m_segmentPtr.coeff(s), end = m_segmentPtr.coeff(s+1);
+          if(end-begin>=Index(MinParallelLevelSize))
+          {
+            #pragma omp for schedule(static)
+            for(Index k=begin; k<end; ++k)
+              kernel(m_rows.coeff(k));
+          }
+          else
+          {
+            #pragma omp single
+            for(Index k=begin; k<end; ++k)
+              kernel(m_rows.coeff(k));
+          }
+        }
+        return;
+      }
+#else
+      EIGEN_UNUSED_VARIABLE(threads);
+#endif
+      for(Index k=0; k<m_rows.size(); ++k)
+        kernel(m_rows.coeff(k));
+    }
+
+  protected:
+    IndexVector m_rows;           // rows sorted by level
+    IndexVector m_levelPtr;       // the rows of level l are m_rows[m_levelPtr[l]] ... m_rows[m_levelPtr[l+1]-1]
+    IndexVector m_segmentPtr;     // the same for the segments, which are either large levels or groups of small levels
+    Index m_parallelRows;
+};
+
+/** \internal Kernel solving the row i of the triangular part \a Mode of a compressed row major matrix,
+  * the entries outside of this triangular part being skipped */
+template<int Mode, typename Scalar, typename StorageIndex, typename Dest>
+struct sparse_level_row_kernel
+{
+  enum {
+    UpLo = (Mode & Lower) ? Lower : Upper,
+    HasUnitDiag = (Mode & UnitDiag) ? 1 : 0
+  };
+
+  sparse_level_row_kernel(const StorageIndex* outer, const StorageIndex* inner, const Scalar* values, Dest& dst)
+    : m_outer(outer), m_inner(inner), m_values(values), m_dst(dst)
+  {}
+
+  void operator()(Index i) const
+  {
+    for(Index col=0; col<m_dst.cols(); ++col)
+    {
+      Scalar tmp = m_dst.coeff(i,col);
+      Scalar diag(1);
+      for(Index p=m_outer[i]; p<m_outer[i+1]; ++p)
+      {
+        Index j = m_inner[p];
+        if(int(UpLo)==int(Lower) ? j<i : j>i)
+          tmp -= m_values[p] * m_dst.coeff(j,col);
+        else if(!HasUnitDiag && j==i)
+          diag = m_values[p];
+      }
+      m_dst.coeffRef(i,col) = HasUnitDiag ? tmp : Scalar(tmp / diag);
+    }
+  }
+
+  const StorageIndex* m_outer;
+  const StorageIndex* m_inner;
+  const Scalar* m_values;
+  Dest& m_dst;
+};
+
+} // end namespace internal
+
+/** \ingroup SparseCore_Module
+  * \class SparseTriangularLevelSolver
+  *
+  * \brief Level scheduled solver for sparse triangular systems
+  *
+  * \tparam _Scalar the scalar type of the triangular matrix
+  * \tparam _Mode either \c Lower or \c Upper, possibly combined with \c UnitDiag
+  * \tparam _StorageIndex the type of the indices
+  *
+  * This class solves triangular systems with a sparse triangular factor which is used for many solves,
+  * as the factors of a preconditioner. compute() splits the unknowns into levels such that the
+  * unknowns of a given level only depend on the ones of the previous levels. Then, solveInPlace()
+  * solves the levels one after the other, the unknowns of a level being computed in parallel when OpenMP
+  * is enabled:
+  * \code
+  * SparseTriangularLevelSolver<double,Lower> lowerSolver(L);
+  * for(...)
+  *   lowerSolver.solveInPlace(x); // x = L^-1 x
+  * \endcode
+  *
+  * Only the triangular part of the matrix selected by \a _Mode is considered. If \a _Mode contains
+  * \c UnitDiag, the diagonal entries are ignored and assumed to be equal to one.
+  *
+  * The levels are computed only once, by compute(). The solver keeps a copy of the triangular factor
+  * stored by rows, which allows to compute each unknown independently. It thus has to be recomputed
+  * when the values of the factor change. The sparse solvers owning their factors, as SimplicialLDLT or
+  * IncompleteLUT, rather compute a level schedule over their own storage.
+  *
+  * \sa TriangularViewImpl::solveInPlace()
+  */
+template<typename _Scalar, int _Mode, typename _StorageIndex = int>
+class SparseTriangularLevelSolver
+{
+  public:
+    typedef _Scalar Scalar;
+    typedef _StorageIndex StorageIndex;
+    typedef SparseMatrix<Scalar,RowMajor,StorageIndex> FactorType;
+    typedef Matrix<StorageIndex,Dynamic,1> IndexVector;
+    enum {
+      Mode = _Mode,
+      UpLo = (Mode & Lower) ? Lower : Upper,
+      HasUnitDiag = (Mode & UnitDiag) ? 1 : 0
+    };
+
+    SparseTriangularLevelSolver() : m_isInitialized(false) {}
+
+    /** Computes the levels of the triangular part of \a mat */
+    template<typename MatrixType>
+    explicit SparseTriangularLevelSolver(const SparseMatrixBase<MatrixType>& mat)
+      : m_isInitialized(false)
+    {
+      compute(mat);
+    }
+
+    /** Copies the triangular part of \a mat, and computes its levels.
+      * \returns a reference to \c *this */
+    template<typename MatrixType>
+    SparseTriangularLevelSolver& compute(const SparseMatrixBase<MatrixType>& mat)
+    {
+      eigen_assert(mat.rows()==mat.cols());
+      copyFactor(FactorType(mat.derived()));
+      IndexVector level;
+      internal::sparse_row_levels<UpLo>(m_factor.rows(), m_factor.outerIndexPtr(), m_factor.innerIndexPtr(), level);
+      m_schedule.compute(level);
+      m_isInitialized = true;
+      return *this;
+    }
+
+    Index rows() const { return m_factor.rows(); }
+    Index cols() const { return m_factor.cols(); }
+
+    /** \returns the number of levels, i.e., the length of the longest chain of dependencies between the unknowns */
+    Index levels() const
+    {
+      eigen_assert(m_isInitialized && "SparseTriangularLevelSolver is not initialized.");
+      return m_schedule.levels();
+    }
+
+    /** Solves the triangular system in place: \a other is overwritten by \f$ T^{-1} \, other \f$. */
+    template<typename Dest>
+    void solveInPlace(MatrixBase<Dest>& other) const
+    {
+      eigen_assert(m_isInitialized && "SparseTriangularLevelSolver is not initialized.");
+      eigen_assert(other.rows()==rows());
+      internal::sparse_level_row_kernel<Mode,Scalar,StorageIndex,Dest>
+        kernel(m_factor.outerIndexPtr(), m_factor.innerIndexPtr(), m_factor.valuePtr(), other.derived());
+      Index threads = nbThreads();
+      // the levels are worth being solved in parallel only if most unknowns belong to large levels
+      if(m_schedule.isParallel(threads))
+        m_schedule.run(kernel, threads);
+      else if(int(UpLo)==int(Lower))
+        for(Index i=0; i<rows(); ++i)
+          kernel(i);
+      else
+        for(Index i=rows()-1; i>=0; --i)
+          kernel(i);
+    }
+
+  protected:
+
+    /** \internal Stores the triangular part of \a mat into m_factor, without the diagonal in the unit case */
+    void copyFactor(const FactorType& mat)
+    {
+      Index n = mat.rows();
+      m_factor.resize(n,n);
+      m_factor.reserve(mat.nonZeros());
+      for(Index i=0; i<n; ++i)
+      {
+        m_factor.startVec(i);
+        bool hasDiag = false;
+        for(typename FactorType::InnerIterator it(mat,i); it; ++it)
+        {
+          Index j = it.index();
+          if(j==i)
+          {
+            hasDiag = true;
+            if(!HasUnitDiag)
+              m_factor.insertBackByOuterInnerUnordered(i,j) = it.value();
+          }
+          else if(int(UpLo)==int(Lower) ? j<i : j>i)
+            m_factor.insertBackByOuterInnerUnordered(i,j) = it.value();
+        }
+        eigen_assert((HasUnitDiag || hasDiag) && "the diagonal of the triangular matrix must be stored");
+        EIGEN_UNUSED_VARIABLE(hasDiag);
+      }
+      m_factor.finalize();
+    }
+
+    FactorType m_factor;          // triangular part, stored by rows
+    internal::sparse_level_schedule<StorageIndex> m_schedule;
+    bool m_isInitialized;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_SPARSETRIANGULARLEVELSOLVER_H
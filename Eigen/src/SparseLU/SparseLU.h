@@ -54,6 +54,9 @@ template <typename MatrixLType, typename MatrixUType> struct SparseLUMatrixURetu
   * x = solver.solve(b); 
   * \endcode
   * 
+  * When several matrices sharing the same sparsity pattern are factorized, refactorize() reuses the 
+  * structure of the factors and the pivots of the last call to factorize(), and only recomputes their values. 
+  * 
   * \warning The input matrix A should be in a \b compressed and \b column-major form.
   * Otherwise an expensive copy will be made. You can call the inexpensive makeCompressed() to get a compressed matrix.
   * 
@@ -91,11 +94,11 @@ class SparseLU : public SparseSolverBase<SparseLU<_MatrixType,_OrderingType> >,
     typedef internal::SparseLUImpl<Scalar, StorageIndex> Base;
     
   public:
-    SparseLU():m_lastError(""),m_Ustore(0,0,0,0,0,0),m_symmetricmode(false),m_diagpivotthresh(1.0),m_detPermR(1)
+    SparseLU():m_lastError(""),m_Ustore(0,0,0,0,0,0),m_symmetricmode(false),m_diagpivotthresh(1.0),m_refactorpivotthresh(1e-3),m_isUSorted(false),m_detPermR(1)
     {
       initperfvalues(); 
     }
-    explicit SparseLU(const MatrixType& matrix):m_lastError(""),m_Ustore(0,0,0,0,0,0),m_symmetricmode(false),m_diagpivotthresh(1.0),m_detPermR(1)
+    explicit SparseLU(const MatrixType& matrix):m_lastError(""),m_Ustore(0,0,0,0,0,0),m_symmetricmode(false),m_diagpivotthresh(1.0),m_refactorpivotthresh(1e-3),m_isUSorted(false),m_detPermR(1)
     {
       initperfvalues(); 
       compute(matrix);
@@ -108,6 +111,7 @@ class SparseLU : public SparseSolverBase<SparseLU<_MatrixType,_OrderingType> >,
     
     void analyzePattern (const MatrixType& matrix);
     void factorize (const MatrixType& matrix);
+    void refactorize (const MatrixType& matrix);
     void simplicialfactorize(const MatrixType& matrix);
     
     /**
@@ -172,6 +176,14 @@ class SparseLU : public SparseSolverBase<SparseLU<_MatrixType,_OrderingType> >,
     {
       m_diagpivotthresh = thresh; 
     }
+    /** Set the threshold used by refactorize() to accept the pivots of the previous factorization.
+      * A pivot is rejected if its magnitude is less than \a thresh times the largest magnitude of the entries below it
+      * in its column of L, that is, if the multipliers would be larger than 1/\a thresh. The default is 1e-3.
+      */
+    void setRefactorizePivotThreshold(const RealScalar& thresh)
+    {
+      m_refactorpivotthresh = thresh;
+    }
 
 #ifdef EIGEN_PARSED_BY_DOXYGEN
     /** \returns the solution X of \f$ A X = B \f$ using the current decomposition of A.
@@ -350,6 +362,8 @@ class SparseLU : public SparseSolverBase<SparseLU<_MatrixType,_OrderingType> >,
 
   protected:
     // Functions 
+    void sortU();
+    void supernodeUpdate(Index ksupno, Index kfnz, Index segsize, ScalarVector& dense, ScalarVector& tempv);
     void initperfvalues()
     {
       m_perfv.panel_size = 16;
@@ -379,6 +393,8 @@ class SparseLU : public SparseSolverBase<SparseLU<_MatrixType,_OrderingType> >,
     // values for performance 
     internal::perfvalues m_perfv;
     RealScalar m_diagpivotthresh; // Specifies the threshold used for a diagonal entry to be an acceptable pivot
+    RealScalar m_refactorpivotthresh; // Specifies the threshold used by refactorize() to keep the previous pivots
+    bool m_isUSorted; // whether the rows of each column of U are sorted
     Index m_nnzL, m_nnzU; // Nonzeros in L and U factors
     Index m_detPermR, m_detPermC; // Determinants of the permutation matrices
   private:
@@ -689,10 +705,156 @@ void SparseLU<MatrixType, OrderingType>::factorize(const MatrixType& matrix)
   // Create the column major upper sparse matrix  U; 
   new (&m_Ustore) MappedSparseMatrix<Scalar, ColMajor, StorageIndex> ( m, n, m_nnzU, m_glu.xusub.data(), m_glu.usub.data(), m_glu.ucol.data() );
   
+  m_isUSorted = false;
   m_info = Success;
   m_factorizationIsOk = true;
 }
 
+/** 
+  * Numerical factorization reusing the structure of the factors computed by the last call to factorize().
+  * 
+  * The matrix \a matrix must have the same sparsity pattern as the matrix given to factorize(). The supernodes,
+  * the structure of L and U and the row permutation are kept, and only the numerical values of the factors
+  * are recomputed by a left-looking supernodal algorithm. The depth-first searches, the pruning of the
+  * structure of L and the memory expansions of factorize() are thus skipped, which is useful when many
+  * matrices having the same pattern are factorized:
+  * \code
+  * solver.compute(A);
+  * for(...)
+  * {
+  *   // update the values of A
+  *   solver.refactorize(A);
+  *   x = solver.solve(b);
+  * }
+  * \endcode
+  * 
+  * Since the pivots are not searched again, their stability is checked: if a pivot becomes smaller than
+  * the threshold set by setRefactorizePivotThreshold() relative to the entries below it, the matrix is factorized
+  * again from scratch by factorize(), which computes a new row permutation.
+  * If factorize() has not been successfully called before, it is called directly.
+  */
+template <typename MatrixType, typename OrderingType>
+void SparseLU<MatrixType, OrderingType>::refactorize(const MatrixType& matrix)
+{
+  using std::abs;
+  eigen_assert(m_analysisIsOk && "analyzePattern() should be called first"); 
+  eigen_assert((matrix.rows() == matrix.cols()) && "Only for squared matrices");
+  if (!m_factorizationIsOk)
+  {
+    factorize(matrix);
+    return;
+  }
+  eigen_assert(matrix.nonZeros() == m_mat.nonZeros() && "refactorize() requires the sparsity pattern of the last factorized matrix");
+  
+  // The U-segments of a column are processed by increasing rows, which is a topological order
+  if (!m_isUSorted) sortU();
+  
+  Index m = matrix.rows();
+  const IndexVector& perm_r = m_perm_r.indices();
+  PermutationType iperm_c(m_perm_c.inverse());
+  ScalarVector dense; // The current column, indexed by the rows of Pr*A
+  dense.setZero(m);
+  ScalarVector tempv;
+  tempv.setZero(m + 3 * internal::packet_traits<Scalar>::size);
+  
+  Index nsuper = m_glu.supno(matrix.cols());
+  for (Index ksupno = 0; ksupno <= nsuper; ksupno++)
+  {
+    Index fsupc = m_glu.xsup(ksupno);
+    Index nsupr = m_glu.xlsub(fsupc+1) - m_glu.xlsub(fsupc);
+    const StorageIndex* lsub = &(m_glu.lsub.data()[m_glu.xlsub(fsupc)]);
+    for (Index jcol = fsupc; jcol < m_glu.xsup(ksupno+1); jcol++)
+    {
+      // Scatter the column jcol of Pr*A*Pc^T
+      for (typename MatrixType::InnerIterator it(matrix, iperm_c.indices()(jcol)); it; ++it)
+        dense(perm_r(it.index())) = it.value();
+      
+      // Numeric updates from the supernodes of the U-segments of the column
+      Index usubEnd = m_glu.xusub(jcol+1);
+      for (Index isub = m_glu.xusub(jcol); isub < usubEnd; )
+      {
+        Index kfnz = m_glu.usub(isub);
+        Index segsize = 1;
+        while (isub+segsize < usubEnd && m_glu.supno(m_glu.usub(isub+segsize)) == m_glu.supno(kfnz)) segsize++;
+        supernodeUpdate(m_glu.supno(kfnz), kfnz, segsize, dense, tempv);
+        isub += segsize;
+      }
+      // and from the previous columns of the current supernode
+      if (jcol > fsupc)
+        supernodeUpdate(ksupno, fsupc, jcol - fsupc, dense, tempv);
+      
+      // Gather the values of the column into L and U
+      Index luptr = m_glu.xlusup(jcol);
+      for (Index i = 0; i < nsupr; i++)
+      {
+        m_glu.lusup(luptr+i) = dense(lsub[i]);
+        dense(lsub[i]) = Scalar(0);
+      }
+      for (Index isub = m_glu.xusub(jcol); isub < usubEnd; isub++)
+      {
+        m_glu.ucol(isub) = dense(m_glu.usub(isub));
+        dense(m_glu.usub(isub)) = Scalar(0);
+      }
+      
+      // Check the pivot, and scale the column of L
+      Index diag = jcol - fsupc;
+      Scalar pivot = m_glu.lusup(luptr+diag);
+      VectorBlock<ScalarVector> lcol(m_glu.lusup, luptr+diag+1, nsupr-diag-1);
+      RealScalar maxL = lcol.size() ? lcol.cwiseAbs().maxCoeff() : RealScalar(0);
+      if (pivot == Scalar(0) || abs(pivot) < m_refactorpivotthresh * maxL)
+      {
+        // The previous pivot sequence is not stable anymore
+        factorize(matrix);
+        return;
+      }
+      lcol /= pivot;
+    }
+  }
+  
+  m_info = Success;
+}
+
+/** \internal Sorts the row indices of each column of U, along with its values */
+template <typename MatrixType, typename OrderingType>
+void SparseLU<MatrixType, OrderingType>::sortU()
+{
+  std::vector<std::pair<StorageIndex,Index> > entries; // (row, position in ucol)
+  ScalarVector values;
+  for (Index jcol = 0; jcol < m_mat.cols(); jcol++)
+  {
+    Index start = m_glu.xusub(jcol), end = m_glu.xusub(jcol+1);
+    entries.resize(end-start);
+    for (Index k = start; k < end; k++)
+      entries[k-start] = std::make_pair(m_glu.usub(k), k);
+    std::sort(entries.begin(), entries.end());
+    values = m_glu.ucol.segment(start, end-start);
+    for (Index k = start; k < end; k++)
+    {
+      m_glu.usub(k) = entries[k-start].first;
+      m_glu.ucol(k) = values(entries[k-start].second - start);
+    }
+  }
+  m_isUSorted = true;
+}
+
+/** \internal Updates the column \a dense with the columns \a kfnz ... \a kfnz + \a segsize - 1 of the supernode
+  * \a ksupno, using the same kernels as factorize()
+  */
+template <typename MatrixType, typename OrderingType>
+void SparseLU<MatrixType, OrderingType>::supernodeUpdate(Index ksupno, Index kfnz, Index segsize, ScalarVector& dense, ScalarVector& tempv)
+{
+  Index fsupc = m_glu.xsup(ksupno);
+  Index lptr = m_glu.xlsub(fsupc);
+  Index luptr = m_glu.xlusup(fsupc);
+  Index lda = m_glu.xlusup(fsupc+1) - luptr; // leading dimension, including the alignment padding
+  Index no_zeros = kfnz - fsupc;
+  Index nrow = m_glu.xlsub(fsupc+1) - lptr - no_zeros - segsize;
+  if (segsize == 1)
+    internal::LU_kernel_bmod<1>::run(segsize, dense, tempv, m_glu.lusup, luptr, lda, nrow, m_glu.lsub, lptr, no_zeros);
+  else
+    internal::LU_kernel_bmod<Dynamic>::run(segsize, dense, tempv, m_glu.lusup, luptr, lda, nrow, m_glu.lsub, lptr, no_zeros);
+}
+
 template<typename MappedSupernodalType>
 struct SparseLUMatrixLReturnType : internal::no_assignment_operator
 {
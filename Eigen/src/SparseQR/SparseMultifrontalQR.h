@@ -0,0 +1,654 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_SPARSE_MULTIFRONTAL_QR_H
+#define EIGEN_SPARSE_MULTIFRONTAL_QR_H
+
+namespace Eigen {
+
+/**
+  * \ingroup SparseQR_Module
+  * \class SparseMultifrontalQR
+  * \brief Sparse multifrontal QR factorization based on dense Householder kernels
+  *
+  * This class computes the QR factorization A*P = Q*R of a sparse matrix with at least as many rows as
+  * columns. Unlike SparseQR, which eliminates one column at a time with sparse Householder reflectors,
+  * the columns are gathered into supernodes along the column elimination tree. Each supernode defines
+  * a dense frontal matrix assembled from the rows of A and from the contribution blocks of its children.
+  * The frontal matrices are factorized with the blocked dense Householder QR of the QR module,
+  * which makes this class much faster than SparseQR on large least-squares problems.
+  * When OpenMP is enabled, independent subtrees of the elimination tree are factorized in parallel.
+  *
+  * \code
+  * SparseMultifrontalQR<SparseMatrix<double>, COLAMDOrdering<int> > qr(A);
+  * VectorXd x = qr.solve(b);  // x minimizes |A x - b|
+  * \endcode
+  *
+  * Q is kept as the set of dense Householder reflectors of the frontal matrices, and is applied by solve().
+  * R is the sparse upper triangular matrix returned by matrixR(), and P the column permutation returned by
+  * colsPermutation(). It is the combination of the fill-reducing ordering and of a postordering of
+  * the elimination tree.
+  *
+  * The columns are not pivoted, so A must have full column rank: if a diagonal entry of R falls below
+  * the pivoting threshold, info() reports a \c NumericalIssue. Use SparseQR for rank-deficient problems.
+  *
+  * \tparam _MatrixType The type of the sparse matrix A, must be a column-major SparseMatrix<>
+  * \tparam _OrderingType The fill-reducing ordering method. See the \link OrderingMethods_Module
+  *  OrderingMethods \endlink module for the list of built-in and external ordering methods.
+  *
+  * \warning The input sparse matrix A must be in compressed mode (see SparseMatrix::makeCompressed()).
+  *
+  * \sa SparseQR
+  */
+template<typename _MatrixType, typename _OrderingType>
+class SparseMultifrontalQR : public SparseSolverBase<SparseMultifrontalQR<_MatrixType,_OrderingType> >
+{
+  protected:
+    typedef SparseSolverBase<SparseMultifrontalQR<_MatrixType,_OrderingType> > Base;
+    using Base::m_isInitialized;
+  public:
+    using Base::_solve_impl;
+    typedef _MatrixType MatrixType;
+    typedef _OrderingType OrderingType;
+    typedef typename MatrixType::Scalar Scalar;
+    typedef typename MatrixType::RealScalar RealScalar;
+    typedef typename MatrixType::StorageIndex StorageIndex;
+    typedef SparseMatrix<Scalar,ColMajor,StorageIndex> QRMatrixType;
+    typedef SparseMatrix<Scalar,RowMajor,StorageIndex> RowMajorMatrixType;
+    typedef Matrix<StorageIndex, Dynamic, 1> IndexVector;
+    typedef Matrix<Scalar, Dynamic, 1> ScalarVector;
+    typedef Matrix<Scalar, Dynamic, Dynamic> DenseMatrix;
+    typedef PermutationMatrix<Dynamic, Dynamic, StorageIndex> PermutationType;
+    enum {
+      // number of columns of the panels of the blocked dense QR of the frontal matrices
+      BlockSize = 48
+    };
+  public:
+    SparseMultifrontalQR() : m_analysisIsok(false), m_factorizationIsok(false), m_useDefaultThreshold(true), m_relaxation(4)
+    { }
+
+    /** Construct a QR factorization of the matrix \a mat.
+      *
+      * \warning The matrix \a mat must be in compressed mode (see SparseMatrix::makeCompressed()).
+      *
+      * \sa compute()
+      */
+    explicit SparseMultifrontalQR(const MatrixType& mat)
+      : m_analysisIsok(false), m_factorizationIsok(false), m_useDefaultThreshold(true), m_relaxation(4)
+    {
+      compute(mat);
+    }
+
+    /** Computes the QR factorization of the sparse matrix \a mat.
+      *
+      * \warning The matrix \a mat must be in compressed mode (see SparseMatrix::makeCompressed()).
+      *
+      * \sa analyzePattern(), factorize()
+      */
+    void compute(const MatrixType& mat)
+    {
+      analyzePattern(mat);
+      factorize(mat);
+    }
+    void analyzePattern(const MatrixType& mat);
+    void factorize(const MatrixType& mat);
+
+    /** \returns the number of rows of the represented matrix. */
+    inline Index rows() const { return m_pmat.rows(); }
+
+    /** \returns the number of columns of the represented matrix. */
+    inline Index cols() const { return m_pmat.cols(); }
+
+    /** \returns a const reference to the \b sparse upper triangular matrix R of the QR factorization. */
+    const QRMatrixType& matrixR() const { return m_R; }
+
+    /** \returns the number of diagonal entries of R whose magnitude is above the pivoting threshold.
+      * The factorization is successful only if it equals cols().
+      *
+      * \sa setPivotThreshold()
+      */
+    Index rank() const
+    {
+      eigen_assert(m_isInitialized && "The factorization should be called first, use compute()");
+      return m_nonzeropivots;
+    }
+
+    /** \returns the number of frontal matrices, i.e., of supernodes of the elimination tree */
+    Index fronts() const
+    {
+      eigen_assert(m_analysisIsok && "analyzePattern() should be called first");
+      return m_fronts.size();
+    }
+
+    /** \returns a const reference to the column permutation P that was applied to A such that A*P = Q*R.
+      * It is the combination of the fill-reducing permutation and of the postordering of the elimination tree.
+      */
+    const PermutationType& colsPermutation() const
+    {
+      eigen_assert(m_analysisIsok && "analyzePattern() should be called first");
+      return m_outputPerm_c;
+    }
+
+    /** \returns A string describing the type of error.
+      * This method is provided to ease debugging, not to handle errors.
+      */
+    std::string lastErrorMessage() const { return m_lastError; }
+
+    /** Sets the threshold below which a diagonal entry of R is considered to be zero.
+      * By default, it is \f$ 20 (m+n) \epsilon \max_j |A_j| \f$ as in SparseQR.
+      */
+    void setPivotThreshold(const RealScalar& threshold)
+    {
+      m_useDefaultThreshold = false;
+      m_threshold = threshold;
+    }
+
+    /** Sets the average number of explicit zeros per row of R that are allowed to merge a column with the supernode
+      * of its last child (default is 4). The columns are also merged when the zeros make up less than an eighth of
+      * the rows. Larger values give fewer and larger frontal matrices. It must be called before analyzePattern().
+      */
+    void setRelaxation(Index relaxation) { m_relaxation = relaxation; }
+
+    /** \brief Reports whether previous computation was successful.
+      *
+      * \returns \c Success if computation was successful,
+      *          \c NumericalIssue if the matrix does not have full column rank
+      */
+    ComputationInfo info() const
+    {
+      eigen_assert(m_isInitialized && "Decomposition is not initialized.");
+      return m_info;
+    }
+
+    /** \internal */
+    template<typename Rhs, typename Dest>
+    bool _solve_impl(const MatrixBase<Rhs> &B, MatrixBase<Dest> &dest) const
+    {
+      eigen_assert(m_factorizationIsok && "The factorization should be called first, use compute()");
+      eigen_assert(this->rows() == B.rows() && "SparseMultifrontalQR::solve() : invalid number of rows in the right hand side matrix");
+
+      // Compute Q^* * b, and gather the entries matching the rows of R
+      typename Dest::PlainObject y(B), c(cols(), B.cols());
+      applyQAdjoint(y);
+      for(Index k = 0; k < cols(); ++k)
+      {
+        if(m_rowsOfR(k) >= 0) c.row(k) = y.row(m_rowsOfR(k));
+        else                  c.row(k).setZero();
+      }
+
+      // Solve with the triangular matrix R and apply the column permutation
+      m_R.topLeftCorner(cols(), cols()).template triangularView<Upper>().solveInPlace(c);
+      dest = colsPermutation() * c;
+      return true;
+    }
+
+  protected:
+    // A frontal matrix along with its dense QR factorization
+    struct Front
+    {
+      IndexVector cols;                     // global (permuted) column indices, the pivots first
+      IndexVector rows;                     // the rows of A held by each row of the frontal matrix
+      DenseMatrix qr;                       // the frontal matrix, only during its factorization
+      DenseMatrix R;                        // the rows of R of the pivots
+      DenseMatrix contribution;             // the contribution block, until it is assembled into the parent
+      std::vector<DenseMatrix> reflectors;  // the Householder vectors of each panel of BlockSize columns
+      ScalarVector hCoeffs;                 // the Householder coefficients
+    };
+
+    void factorizeFront(Index f, IndexVector& colMap);
+    template<typename Dest> void applyQAdjoint(Dest& y) const;
+
+    bool m_analysisIsok;
+    bool m_factorizationIsok;
+    ComputationInfo m_info;
+    std::string m_lastError;
+    RowMajorMatrixType m_pmat;      // The permuted matrix A*P stored by rows
+    QRMatrixType m_R;               // The triangular factor matrix
+    PermutationType m_perm_c;       // Fill-reducing column permutation
+    PermutationType m_outputPerm_c; // The final column permutation
+    RealScalar m_threshold;         // Threshold to detect null diagonal entries of R
+    bool m_useDefaultThreshold;     // Use default threshold
+    Index m_relaxation;             // Amalgamation parameter of the supernodes
+    Index m_nonzeropivots;          // Number of non zero pivots found
+    std::vector<Front> m_fronts;    // The frontal matrices, in postorder
+    IndexVector m_frontPtr;         // The pivots of the front f are the columns m_frontPtr(f) ... m_frontPtr(f+1)-1
+    IndexVector m_frontParent;      // The assembly tree, -1 for the roots
+    IndexVector m_frontFirst;       // The first front of the subtree rooted at each front
+    IndexVector m_frontRows;        // Number of rows of each frontal matrix
+    IndexVector m_rowPtr;           // The rows of A assembled into the front f are
+    IndexVector m_rowIdx;           //   m_rowIdx(m_rowPtr(f)) ... m_rowIdx(m_rowPtr(f+1)-1)
+    IndexVector m_rowsOfR;          // The row of Q^* A P holding each row of R, -1 if it is structurally empty
+};
+
+/** \brief Preprocessing step of a multifrontal QR factorization
+  *
+  * In this step, the fill-reducing permutation is computed, the column elimination tree is postordered,
+  * and its columns are gathered into supernodes. The structure of each frontal matrix is then computed.
+  * Only the sparsity pattern of \a mat is exploited.
+  *
+  * \warning The matrix \a mat must be in compressed mode (see SparseMatrix::makeCompressed()).
+  */
+template <typename MatrixType, typename OrderingType>
+void SparseMultifrontalQR<MatrixType,OrderingType>::analyzePattern(const MatrixType& mat)
+{
+  eigen_assert(mat.isCompressed() && "SparseMultifrontalQR requires a sparse matrix in compressed mode. Call .makeCompressed() before passing it to SparseMultifrontalQR");
+  eigen_assert(mat.rows() >= mat.cols() && "SparseMultifrontalQR requires a matrix having at least as many rows as columns");
+  // Copy to a column major matrix if the input is rowmajor
+  typename internal::conditional<MatrixType::IsRowMajor,QRMatrixType,const MatrixType&>::type matCpy(mat);
+  StorageIndex n = StorageIndex(mat.cols());
+  StorageIndex m = StorageIndex(mat.rows());
+
+  // Compute the column fill reducing ordering
+  OrderingType ord;
+  ord(matCpy, m_perm_c);
+  if (!m_perm_c.size())
+  {
+    m_perm_c.resize(n);
+    m_perm_c.indices().setLinSpaced(n, 0, StorageIndex(n-1));
+  }
+  PermutationType perm = m_perm_c.inverse();
+
+  // Compute the column elimination tree of the permuted matrix and postorder it,
+  // such that the columns of each subtree, and thus of each supernode, are contiguous
+  IndexVector etree, firstRowElt, post;
+  internal::coletree(matCpy, etree, firstRowElt, perm.indices().data());
+  internal::treePostorder(n, etree, post);
+  m_outputPerm_c.resize(n);
+  IndexVector parent(n);
+  for (StorageIndex j = 0; j < n; ++j)
+  {
+    m_outputPerm_c.indices()(post(j)) = perm.indices()(j);
+    parent(post(j)) = etree(j) < n ? post(etree(j)) : n;
+  }
+  m_pmat = matCpy * m_outputPerm_c;
+
+  // Sort the rows by their leftmost column
+  IndexVector leftmost(m), colRowPtr(n+1);
+  colRowPtr.setZero();
+  for (StorageIndex i = 0; i < m; ++i)
+  {
+    leftmost(i) = n;
+    for (typename RowMajorMatrixType::InnerIterator it(m_pmat, i); it; ++it)
+      leftmost(i) = (std::min)(leftmost(i), StorageIndex(it.index()));
+    if (leftmost(i) < n) colRowPtr(leftmost(i)+1)++;
+  }
+  for (StorageIndex j = 0; j < n; ++j) colRowPtr(j+1) += colRowPtr(j);
+  IndexVector colRowIdx(colRowPtr(n)), pos = colRowPtr.head(n);
+  for (StorageIndex i = 0; i < m; ++i)
+    if (leftmost(i) < n) colRowIdx(pos(leftmost(i))++) = i;
+
+  // Children lists of the elimination tree
+  IndexVector firstChild(n+1), nextChild(n);
+  firstChild.setConstant(-1);
+  for (StorageIndex j = n-1; j >= 0; --j)
+  {
+    nextChild(j) = firstChild(parent(j));
+    firstChild(parent(j)) = j;
+  }
+
+  // Compute the structure of each row of R, that is the column j and the columns of the rows of A whose
+  // leftmost column is j, merged with the structures of its children. Consecutive columns are gathered
+  // into a supernode when the column j-1 is a child of j, and the rows of R of the supernode, which are stored
+  // with the structure of its last row, have on average at most m_relaxation explicit zeros, or an eighth of their size.
+  std::vector<std::vector<StorageIndex> > structure(n);
+  Index frontStructureSize = 0;   // sum of the sizes of the structures of the rows of the current supernode
+  IndexVector mark(n);
+  mark.setConstant(-1);
+  std::vector<StorageIndex> frontPtr(1, 0);
+  std::vector<std::vector<StorageIndex> > frontCols;
+  for (StorageIndex j = 0; j < n; ++j)
+  {
+    std::vector<StorageIndex>& s = structure[j];
+    s.push_back(j);
+    mark(j) = j;
+    for (StorageIndex p = colRowPtr(j); p < colRowPtr(j+1); ++p)
+      for (typename RowMajorMatrixType::InnerIterator it(m_pmat, colRowIdx(p)); it; ++it)
+        if (mark(it.index()) != j)
+        {
+          mark(it.index()) = j;
+          s.push_back(StorageIndex(it.index()));
+        }
+    for (StorageIndex c = firstChild(j); c >= 0; c = nextChild(c))
+      for (std::size_t k = 0; k < structure[c].size(); ++k)
+        if (structure[c][k] != c && mark(structure[c][k]) != j)
+        {
+          mark(structure[c][k]) = j;
+          s.push_back(structure[c][k]);
+        }
+
+    bool merge = false;
+    if (j > 0 && parent(j-1) == j)
+    {
+      Index pivots = j - frontPtr.back() + 1, size = s.size();
+      Index zeros = pivots * size + pivots * (pivots-1) / 2 - frontStructureSize - size;
+      merge = zeros <= pivots * (std::max)(m_relaxation, size/8);
+    }
+    if (j > 0 && !merge)
+    {
+      // close the supernode ending at j-1: its columns are its pivots and the structure of its last row
+      std::vector<StorageIndex> cols;
+      for (StorageIndex k = frontPtr.back(); k < j-1; ++k) cols.push_back(k);
+      cols.insert(cols.end(), structure[j-1].begin(), structure[j-1].end());
+      std::sort(cols.begin(), cols.end());
+      frontCols.push_back(cols);
+      frontPtr.push_back(j);
+      frontStructureSize = 0;
+    }
+    frontStructureSize += s.size();
+    for (StorageIndex c = firstChild(j); c >= 0; c = nextChild(c))
+      if (c != j-1 || !merge) std::vector<StorageIndex>().swap(structure[c]);
+    if (merge) std::vector<StorageIndex>().swap(structure[j-1]);
+  }
+  if (n > 0)
+  {
+    std::vector<StorageIndex> cols;
+    for (StorageIndex k = frontPtr.back(); k < n-1; ++k) cols.push_back(k);
+    cols.insert(cols.end(), structure[n-1].begin(), structure[n-1].end());
+    std::sort(cols.begin(), cols.end());
+    frontCols.push_back(cols);
+    frontPtr.push_back(n);
+  }
+
+  // Setup the assembly tree and the frontal matrices
+  Index nbFronts = frontCols.size();
+  m_fronts.clear();
+  m_fronts.resize(nbFronts);
+  m_frontPtr = Map<IndexVector>(&frontPtr[0], frontPtr.size());
+  IndexVector frontOf(n);
+  for (Index f = 0; f < nbFronts; ++f)
+  {
+    m_fronts[f].cols = Map<IndexVector>(&frontCols[f][0], frontCols[f].size());
+    frontOf.segment(m_frontPtr(f), m_frontPtr(f+1)-m_frontPtr(f)).setConstant(StorageIndex(f));
+  }
+  m_frontParent.resize(nbFronts);
+  m_frontFirst.resize(nbFronts);
+  m_rowPtr.resize(nbFronts+1);
+  m_rowIdx = colRowIdx;
+  for (Index f = 0; f < nbFronts; ++f)
+  {
+    StorageIndex last = m_frontPtr(f+1)-1;
+    m_frontParent(f) = parent(last) < n ? frontOf(parent(last)) : -1;
+    m_rowPtr(f) = colRowPtr(m_frontPtr(f));
+  }
+  // The fronts being postordered, the subtree rooted at f is made of the fronts m_frontFirst(f) ... f
+  for (Index f = 0; f < nbFronts; ++f) m_frontFirst(f) = StorageIndex(f);
+  for (Index f = 0; f < nbFronts; ++f)
+    if (m_frontParent(f) >= 0)
+      m_frontFirst(m_frontParent(f)) = (std::min)(m_frontFirst(m_frontParent(f)), m_frontFirst(f));
+  m_rowPtr(nbFronts) = colRowPtr(n);
+
+  // The number of rows of a frontal matrix is the number of its rows of A plus the number of rows of the contribution
+  // blocks of its children, which are the rows of their upper trapezoidal factor that are not rows of R
+  m_frontRows = m_rowPtr.tail(nbFronts) - m_rowPtr.head(nbFronts);
+  for (Index f = 0; f < nbFronts; ++f)
+  {
+    Index pivots = m_frontPtr(f+1) - m_frontPtr(f);
+    Index contribRows = (std::min)(Index(m_frontRows(f)), Index(m_fronts[f].cols.size())) - pivots;
+    if (m_frontParent(f) >= 0 && contribRows > 0)
+      m_frontRows(m_frontParent(f)) += StorageIndex(contribRows);
+  }
+
+  m_analysisIsok = true;
+  m_factorizationIsok = false;
+}
+
+/** \internal Assembles the frontal matrix \a f from the rows of A and the contribution blocks of its children,
+  * and computes its dense QR factorization. \a colMap is a workspace of size cols().
+  *
+  * The rows of the frontal matrix are sorted by their leftmost nonzero, such that its nonzeros form a staircase.
+  * The blocked Householder QR is then restricted to the rows below the staircase of each panel of columns.
+  */
+template <typename MatrixType, typename OrderingType>
+void SparseMultifrontalQR<MatrixType,OrderingType>::factorizeFront(Index f, IndexVector& colMap)
+{
+  typedef Block<DenseMatrix,Dynamic,Dynamic> BlockType;
+  Front& front = m_fronts[f];
+  Index nf = front.cols.size();
+  Index mf = m_frontRows(f);
+  Index size = (std::min)(mf, nf);
+  for (Index j = 0; j < nf; ++j)
+    colMap(front.cols(j)) = StorageIndex(j);
+
+  // Compute the leftmost column of each row: the rows of the contribution blocks of the children come first,
+  // in the order of the children, and then the rows of A.
+  IndexVector leftmost(mf), stair(nf+1);
+  Index r = 0;
+  for (Index c = f-1; c >= m_frontFirst(f); c = m_frontFirst(c)-1)
+  {
+    const Front& child = m_fronts[c];
+    Index pivots = m_frontPtr(c+1) - m_frontPtr(c);
+    for (Index i = 0; i < child.contribution.rows(); ++i, ++r)
+      leftmost(r) = colMap(child.cols(pivots+i));
+  }
+  for (Index p = m_rowPtr(f); p < m_rowPtr(f+1); ++p, ++r)
+  {
+    leftmost(r) = StorageIndex(nf);
+    for (typename RowMajorMatrixType::InnerIterator it(m_pmat, m_rowIdx(p)); it; ++it)
+      leftmost(r) = (std::min)(leftmost(r), colMap(it.index()));
+  }
+  eigen_internal_assert(r == mf);
+
+  // Bucket sort of the rows, the rows having their leftmost nonzero in the columns 0 ... k being stair(k+1) first
+  stair.setZero();
+  for (Index i = 0; i < mf; ++i) stair(leftmost(i)+1)++;
+  for (Index k = 0; k < nf; ++k) stair(k+1) += stair(k);
+  IndexVector pos = stair.head(nf);
+  for (Index i = 0; i < mf; ++i) leftmost(i) = pos(leftmost(i))++;
+
+  // Assemble the frontal matrix
+  front.qr.setZero(mf, nf);
+  front.rows.resize(mf);
+  r = 0;
+  for (Index c = f-1; c >= m_frontFirst(f); c = m_frontFirst(c)-1)
+  {
+    Front& child = m_fronts[c];
+    Index pivots = m_frontPtr(c+1) - m_frontPtr(c);
+    for (Index i = 0; i < child.contribution.rows(); ++i, ++r)
+    {
+      front.rows(leftmost(r)) = child.rows(pivots+i);
+      for (Index j = i; j < child.contribution.cols(); ++j)
+        front.qr(leftmost(r), colMap(child.cols(pivots+j))) = child.contribution(i, j);
+    }
+    child.contribution.resize(0, 0);
+  }
+  for (Index p = m_rowPtr(f); p < m_rowPtr(f+1); ++p, ++r)
+  {
+    front.rows(leftmost(r)) = m_rowIdx(p);
+    for (typename RowMajorMatrixType::InnerIterator it(m_pmat, m_rowIdx(p)); it; ++it)
+      front.qr(leftmost(r), colMap(it.index())) = it.value();
+  }
+
+  // Blocked Householder QR, as in HouseholderQR, except that the rows below the staircase of the panel are skipped
+  front.hCoeffs.resize(size);
+  front.reflectors.clear();
+  ScalarVector tempVector(nf);
+  for (Index k = 0; k < size; k += BlockSize)
+  {
+    Index bs = (std::min)(size-k, Index(BlockSize));
+    Index brows = (std::max)(Index(stair(k+bs)), k+bs) - k;
+    BlockType A11_21 = front.qr.block(k, k, brows, bs);
+    Block<ScalarVector,Dynamic,1> hCoeffsSegment = front.hCoeffs.segment(k, bs);
+    internal::householder_qr_inplace_unblocked(A11_21, hCoeffsSegment, tempVector.data());
+    if (nf-k-bs > 0)
+    {
+      BlockType A21_22 = front.qr.block(k, k+bs, brows, nf-k-bs);
+      internal::apply_block_householder_on_the_left(A21_22, A11_21, hCoeffsSegment, false);
+    }
+    front.reflectors.push_back(A11_21);
+  }
+
+  // Keep the rows of R, and the upper trapezoidal contribution block to be assembled into the parent
+  Index pivots = m_frontPtr(f+1) - m_frontPtr(f);
+  front.R = front.qr.topRows((std::min)(mf, pivots));
+  if (m_frontParent(f) >= 0 && size > pivots)
+    front.contribution = front.qr.block(pivots, pivots, size-pivots, nf-pivots).template triangularView<Upper>();
+  front.qr.resize(0, 0);
+}
+
+/** \brief Performs the numerical QR factorization of the input matrix
+  *
+  * The function SparseMultifrontalQR::analyzePattern(const MatrixType&) must have been called beforehand with
+  * a matrix having the same sparsity pattern than \a mat.
+  *
+  * \param mat The sparse column-major matrix
+  */
+template <typename MatrixType, typename OrderingType>
+void SparseMultifrontalQR<MatrixType,OrderingType>::factorize(const MatrixType& mat)
+{
+  using std::abs;
+  eigen_assert(m_analysisIsok && "analyzePattern() should be called before this step");
+  Index m = mat.rows();
+  Index n = mat.cols();
+  Index nbFronts = m_fronts.size();
+  {
+    typename internal::conditional<MatrixType::IsRowMajor,QRMatrixType,const MatrixType&>::type matCpy(mat);
+    m_pmat = matCpy * m_outputPerm_c;
+  }
+
+  IndexVector colMap(n);
+  Index firstSerialFront = 0;
+#ifdef EIGEN_HAS_OPENMP
+  Index threads = nbThreads();
+  if (threads > 1 && nbFronts > 1)
+  {
+    // Estimate the cost of the factorization of each subtree
+    std::vector<double> work(nbFronts, 0.);
+    double total = 0;
+    for (Index f = 0; f < nbFronts; ++f)
+    {
+      double mf = double(m_frontRows(f)), nf = double(m_fronts[f].cols.size());
+      work[f] += mf * nf * (std::min)(mf, nf);
+      total += mf * nf * (std::min)(mf, nf);
+      if (m_frontParent(f) >= 0)
+        work[m_frontParent(f)] += work[f];
+    }
+
+    // Split the tree into independent subtrees, the largest subtree being replaced by its children
+    // until all of them are small enough to balance the load over the threads
+    std::vector<Index> subtrees;
+    for (Index f = 0; f < nbFronts; ++f)
+      if (m_frontParent(f) < 0) subtrees.push_back(f);
+    for (;;)
+    {
+      Index largest = 0;
+      for (std::size_t k = 1; k < subtrees.size(); ++k)
+        if (work[subtrees[k]] > work[subtrees[largest]]) largest = k;
+      Index root = subtrees[largest];
+      if (work[root] * double(2*threads) <= total || m_frontFirst(root) == root)
+        break;
+      subtrees.erase(subtrees.begin()+largest);
+      for (Index c = root-1; c >= m_frontFirst(root); c = m_frontFirst(c)-1)
+        subtrees.push_back(c);
+    }
+
+    Index nbSubtrees = subtrees.size();
+    #pragma omp parallel num_threads(threads)
+    {
+      IndexVector localColMap(n);
+      #pragma omp for schedule(dynamic,1)
+      for (Index k = 0; k < nbSubtrees; ++k)
+        for (Index f = m_frontFirst(subtrees[k]); f <= subtrees[k]; ++f)
+          factorizeFront(f, localColMap);
+    }
+
+    // The remaining fronts, which are the ancestors of the subtrees, are factorized sequentially
+    std::vector<bool> done(nbFronts, false);
+    for (std::size_t k = 0; k < subtrees.size(); ++k)
+      for (Index f = m_frontFirst(subtrees[k]); f <= subtrees[k]; ++f)
+        done[f] = true;
+    for (Index f = 0; f < nbFronts; ++f)
+      if (!done[f]) factorizeFront(f, colMap);
+    firstSerialFront = nbFronts;
+  }
+#endif
+  for (Index f = firstSerialFront; f < nbFronts; ++f)
+    factorizeFront(f, colMap);
+
+  // Gather the rows of R from the frontal matrices, the rows of the front f being the rows of its pivots
+  RowMajorMatrixType R(m, n);
+  Index nnzR = 0;
+  for (Index f = 0; f < nbFronts; ++f)
+    nnzR += (m_frontPtr(f+1)-m_frontPtr(f)) * m_fronts[f].cols.size();
+  R.reserve(nnzR);
+  m_rowsOfR.resize(n);
+  for (Index f = 0; f < nbFronts; ++f)
+  {
+    const Front& front = m_fronts[f];
+    Index pivots = m_frontPtr(f+1) - m_frontPtr(f);
+    for (Index i = 0; i < pivots; ++i)
+    {
+      Index k = m_frontPtr(f) + i;
+      R.startVec(k);
+      if (i < front.R.rows())
+      {
+        m_rowsOfR(k) = front.rows(i);
+        for (Index j = i; j < front.R.cols(); ++j)
+          R.insertBackByOuterInner(k, front.cols(j)) = front.R(i, j);
+      }
+      else
+      {
+        // structurally rank deficient front: the row of R is empty
+        m_rowsOfR(k) = -1;
+        R.insertBackByOuterInner(k, k) = Scalar(0);
+      }
+    }
+  }
+  for (Index k = n; k < m; ++k)
+    R.startVec(k);
+  R.finalize();
+  m_R = R;
+
+  /* Compute the default threshold as in SparseQR */
+  RealScalar pivotThreshold = m_threshold;
+  if (m_useDefaultThreshold)
+  {
+    RealScalar max2Norm = 0.0;
+    for (Index j = 0; j < n; j++) max2Norm = numext::maxi(max2Norm, mat.col(j).norm());
+    if (max2Norm == RealScalar(0))
+      max2Norm = RealScalar(1);
+    pivotThreshold = 20 * (m + n) * max2Norm * NumTraits<RealScalar>::epsilon();
+  }
+  m_nonzeropivots = 0;
+  for (Index k = 0; k < n; ++k)
+    if (abs(m_R.coeff(k,k)) > pivotThreshold) m_nonzeropivots++;
+
+  m_isInitialized = true;
+  m_factorizationIsok = true;
+  if (m_nonzeropivots < n)
+  {
+    m_lastError = "The matrix does not have full column rank";
+    m_info = NumericalIssue;
+  }
+  else
+    m_info = Success;
+}
+
+/** \internal Overwrites \a y by \f$ Q^* y \f$, the Householder reflectors being applied one panel after the other */
+template <typename MatrixType, typename OrderingType>
+template <typename Dest>
+void SparseMultifrontalQR<MatrixType,OrderingType>::applyQAdjoint(Dest& y) const
+{
+  DenseMatrix w;
+  for (std::size_t f = 0; f < m_fronts.size(); ++f)
+  {
+    const Front& front = m_fronts[f];
+    w.resize(front.rows.size(), y.cols());
+    for (Index i = 0; i < w.rows(); ++i) w.row(i) = y.row(front.rows(i));
+    // Note that the matrix Q = H_0^* H_1^*... so its inverse is Q^* = (H_0 H_1 ...)^T
+    for (std::size_t p = 0; p < front.reflectors.size(); ++p)
+    {
+      const DenseMatrix& panel = front.reflectors[p];
+      Index k = p * BlockSize;
+      w.middleRows(k, panel.rows()).applyOnTheLeft(householderSequence(panel, front.hCoeffs.segment(k, panel.cols())).transpose());
+    }
+    for (Index i = 0; i < w.rows(); ++i) y.row(front.rows(i)) = w.row(i);
+  }
+}
+
+} // end namespace Eigen
+
+#endif // EIGEN_SPARSE_MULTIFRONTAL_QR_H
@@ -0,0 +1,99 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_BLAS_THREADING_H
+#define EIGEN_BLAS_THREADING_H
+
+// Multi-threading of the level-3 routines.
+//
+// The threads are created through OpenMP if the library is compiled with OpenMP support,
+// and through POSIX threads otherwise. The maximal number of threads is given by the
+// EIGEN_BLAS_NUM_THREADS environment variable, or by eigen_blas_set_num_threads(),
+// and defaults to the number of available cores.
+
+extern "C" {
+
+/** Sets the maximal number of threads used by the level-3 routines.
+  * A value lower than one restores the default. It must not be called while
+  * BLAS routines are running in other threads. */
+void eigen_blas_set_num_threads(int nbThreads);
+
+/** \returns the maximal number of threads used by the level-3 routines. */
+int eigen_blas_get_num_threads();
+
+}
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal Calls func(data,i,nb) for each i in [0,nb), each call in a different thread.
+  * The calling thread performs the call i==0. Defined in threading.cpp. */
+void blas_run_parallel(void (*func)(void*,int,int), void* data, int nb);
+
+enum { BlasSplitUniform = 0, BlasSplitUpper = 1, BlasSplitLower = 2 };
+
+/** \internal \returns the bound of the \a i -th of \a nb chunks of [0,size), such that every chunk
+  * involves the same amount of work. For BlasSplitUpper (resp. BlasSplitLower), the work of column j
+  * is proportional to j (resp. size-j), as for the columns of an upper (resp. lower) triangular matrix. */
+inline int blas_split_bound(int size, int i, int nb, int shape)
+{
+  if(i<=0)  return 0;
+  if(i>=nb) return size;
+  double r = double(i)/double(nb);
+  double b = shape==BlasSplitUpper ? std::sqrt(r)
+           : shape==BlasSplitLower ? 1. - std::sqrt(1.-r)
+           : r;
+  // keep the bounds aligned on the register blocking of the product kernels
+  return std::min(size, (int(b*size)/8)*8);
+}
+
+template<typename Kernel>
+struct blas_range_task
+{
+  const Kernel& kernel;
+  int size;
+  int shape;
+};
+
+template<typename Kernel>
+void blas_run_range_task(void* data, int i, int nb)
+{
+  const blas_range_task<Kernel>& task = *static_cast<const blas_range_task<Kernel>*>(data);
+  int start = blas_split_bound(task.size, i,   nb, task.shape);
+  int end   = blas_split_bound(task.size, i+1, nb, task.shape);
+  if(end>start)
+    task.kernel(start, end-start);
+}
+
+/** \internal Calls kernel(start,len) on a partition of [0,size) into chunks processed by different threads.
+  * The number of threads is chosen from the number of multiply-adds \a flops of the whole operation
+  * such that each thread has enough work to amortize its creation. */
+template<typename Kernel>
+void blas_parallelize(const Kernel& kernel, int size, double flops, int shape = BlasSplitUniform)
+{
+  // FIXME these thresholds have to be fine tuned
+  double max_threads = std::min(flops / double(1<<20), double(size/32));
+  int threads = std::max(1, std::min(eigen_blas_get_num_threads(), int(max_threads)));
+
+  if(threads==1)
+  {
+    if(size>0)
+      kernel(0, size);
+    return;
+  }
+
+  Eigen::initParallel();
+  blas_range_task<Kernel> task = { kernel, size, shape };
+  blas_run_parallel(&blas_run_range_task<Kernel>, &task, threads);
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_BLAS_THREADING_H
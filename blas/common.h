@@ -20,6 +20,7 @@
 #endif
 
 #include <Eigen/src/misc/blas.h>
+#include "Threading.h"
 
 
 #define NOTR    0
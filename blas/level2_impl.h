@@ -17,7 +17,7 @@ struct general_matrix_vector_product_wrapper
     typedef internal::const_blas_data_mapper<Scalar,Index,StorageOrder> LhsMapper;
     typedef internal::const_blas_data_mapper<Scalar,Index,RowMajor> RhsMapper;
     
-    internal::general_matrix_vector_product
+    internal::parallel_general_matrix_vector_product
         <Index,Scalar,LhsMapper,StorageOrder,ConjugateLhs,Scalar,RhsMapper,ConjugateRhs>::run(
         rows, cols, LhsMapper(lhs, lhsStride), RhsMapper(rhs, rhsIncr), res, resIncr, alpha);
   }
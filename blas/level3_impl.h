@@ -9,11 +9,206 @@
 
 #include "common.h"
 
+// The level-3 routines are multi-threaded by splitting the columns (or rows) of the result
+// into independent blocks, each block being computed by a sequential product kernel.
+// The kernels below compute such a block [start,start+len).
+namespace {
+
+typedef void (*gemm_functype)(DenseIndex, DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, Scalar, internal::level3_blocking<Scalar,Scalar>&, Eigen::internal::GemmParallelInfo<DenseIndex>*);
+typedef void (*trsm_functype)(DenseIndex, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, internal::level3_blocking<Scalar,Scalar>&);
+typedef void (*trmm_functype)(DenseIndex, DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, const Scalar&, internal::level3_blocking<Scalar,Scalar>&);
+typedef void (*symm_functype)(DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, const Scalar&);
+
+// columns (or rows) of c = alpha*op(a)*op(b) + c
+struct gemm_kernel
+{
+  gemm_functype func;
+  bool splitCols;
+  int opa, opb, m, n, k;
+  const Scalar *a; int lda;
+  const Scalar *b; int ldb;
+  Scalar *c; int ldc;
+  Scalar alpha;
+
+  void operator()(int start, int len) const
+  {
+    if(splitCols)
+    {
+      internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic> blocking(m,len,k,1,true);
+      func(m, len, k, a, lda, b + (opb==NOTR ? DenseIndex(start)*ldb : start), ldb, c + DenseIndex(start)*ldc, ldc, alpha, blocking, 0);
+    }
+    else
+    {
+      internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic> blocking(len,n,k,1,true);
+      func(len, n, k, a + (opa==NOTR ? start : DenseIndex(start)*lda), lda, b, ldb, c + start, ldc, alpha, blocking, 0);
+    }
+  }
+};
+
+// columns (side==LEFT) or rows (side==RIGHT) of b = alpha*op(a)^-1*b or b = alpha*b*op(a)^-1
+struct trsm_kernel
+{
+  trsm_functype func;
+  int side, m, n;
+  const Scalar *a; int lda;
+  Scalar *b; int ldb;
+  Scalar alpha;
+
+  void operator()(int start, int len) const
+  {
+    if(side==LEFT)
+    {
+      Scalar* bb = b + DenseIndex(start)*ldb;
+      internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(m,len,m,1,false);
+      func(m, len, a, lda, bb, ldb, blocking);
+      if(alpha!=Scalar(1))
+        matrix(bb,m,len,ldb) *= alpha;
+    }
+    else
+    {
+      Scalar* bb = b + start;
+      internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(len,n,n,1,false);
+      func(n, len, a, lda, bb, ldb, blocking);
+      if(alpha!=Scalar(1))
+        matrix(bb,len,n,ldb) *= alpha;
+    }
+  }
+};
+
+// columns (side==LEFT) or rows (side==RIGHT) of b = alpha*op(a)*b or b = alpha*b*op(a)
+struct trmm_kernel
+{
+  trmm_functype func;
+  int side, m, n;
+  const Scalar *a; int lda;
+  Scalar *b; int ldb;
+  Scalar alpha;
+
+  void operator()(int start, int len) const
+  {
+    // FIXME find a way to avoid this copy
+    if(side==LEFT)
+    {
+      Scalar* bb = b + DenseIndex(start)*ldb;
+      Matrix<Scalar,Dynamic,Dynamic,ColMajor> tmp = matrix(bb,m,len,ldb);
+      matrix(bb,m,len,ldb).setZero();
+      internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(m,len,m,1,false);
+      func(m, len, m, a, lda, tmp.data(), tmp.outerStride(), bb, ldb, alpha, blocking);
+    }
+    else
+    {
+      Scalar* bb = b + start;
+      Matrix<Scalar,Dynamic,Dynamic,ColMajor> tmp = matrix(bb,len,n,ldb);
+      matrix(bb,len,n,ldb).setZero();
+      internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(len,n,n,1,false);
+      func(len, n, n, tmp.data(), tmp.outerStride(), a, lda, bb, ldb, alpha, blocking);
+    }
+  }
+};
+
+// columns (side==LEFT) or rows (side==RIGHT) of c = alpha*a*b + c or c = alpha*b*a + c, with a selfadjoint
+// (or symmetric if matA is not null, in which case matA is the full symmetric matrix)
+struct symm_kernel
+{
+  symm_functype func;
+  int side, m, n;
+  const Scalar *a; int lda;
+  const Scalar *b; int ldb;
+  Scalar *c; int ldc;
+  Scalar alpha;
+  const Scalar *matA;
+
+  void operator()(int start, int len) const
+  {
+    int size = side==LEFT ? m : n;
+    if(side==LEFT)
+    {
+      const Scalar* bb = b + DenseIndex(start)*ldb;
+      Scalar* cc = c + DenseIndex(start)*ldc;
+      if(matA) matrix(cc,m,len,ldc).noalias() += alpha * matrix(const_cast<Scalar*>(matA),size,size,size) * matrix(const_cast<Scalar*>(bb),m,len,ldb);
+      else     func(m, len, a, lda, bb, ldb, cc, ldc, alpha);
+    }
+    else
+    {
+      const Scalar* bb = b + start;
+      Scalar* cc = c + start;
+      if(matA) matrix(cc,len,n,ldc).noalias() += alpha * matrix(const_cast<Scalar*>(bb),len,n,ldb) * matrix(const_cast<Scalar*>(matA),size,size,size);
+      else     func(len, n, bb, ldb, a, lda, cc, ldc, alpha);
+    }
+  }
+};
+
+// columns [start,start+len) of the UpLo triangular part of c += alpha*lhs*rhs
+template<int UpLo, typename Lhs, typename Rhs>
+void rankk_update(Scalar* c, int ldc, const Lhs& lhs, const Rhs& rhs, const Scalar& alpha, int start, int len)
+{
+  int n = int(lhs.rows());
+  MatrixType C(c,n,n,ldc);
+  if(UpLo==Upper && start>0)
+    C.block(0,start,start,len).noalias() += alpha * lhs.topRows(start) * rhs.middleCols(start,len);
+  if(UpLo==Lower && start+len<n)
+    C.block(start+len,start,n-start-len,len).noalias() += alpha * lhs.bottomRows(n-start-len) * rhs.middleCols(start,len);
+  C.block(start,start,len,len).template triangularView<UpLo>() += alpha * lhs.middleRows(start,len) * rhs.middleCols(start,len);
+}
+
+// columns of the UpLo triangular part of c += alpha*op(a)*op(b)^T (+ alpha2*op(b)*op(a)^T if rank2),
+// where ^T is replaced by ^H if Conjugate is true.
+template<int UpLo, bool Conjugate>
+struct rankk_kernel
+{
+  int op, n, k;
+  Scalar *a; int lda;
+  Scalar *b; int ldb;
+  Scalar *c; int ldc;
+  Scalar alpha;
+  bool rank2;
+  Scalar alpha2;
+
+  void update(Scalar* x, int ldx, Scalar* y, int ldy, const Scalar& s, int start, int len) const
+  {
+    if(op==NOTR)
+    {
+      if(Conjugate) rankk_update<UpLo>(c, ldc, matrix(x,n,k,ldx), matrix(y,n,k,ldy).adjoint(),   s, start, len);
+      else          rankk_update<UpLo>(c, ldc, matrix(x,n,k,ldx), matrix(y,n,k,ldy).transpose(), s, start, len);
+    }
+    else
+    {
+      if(Conjugate) rankk_update<UpLo>(c, ldc, matrix(x,k,n,ldx).adjoint(),   matrix(y,k,n,ldy), s, start, len);
+      else          rankk_update<UpLo>(c, ldc, matrix(x,k,n,ldx).transpose(), matrix(y,k,n,ldy), s, start, len);
+    }
+  }
+
+  void operator()(int start, int len) const
+  {
+    update(a, lda, b, ldb, alpha, start, len);
+    if(rank2)
+      update(b, ldb, a, lda, alpha2, start, len);
+  }
+};
+
+template<bool Conjugate>
+void parallel_rankk_update(int uplo, int op, int n, int k, Scalar* a, int lda, Scalar* b, int ldb, Scalar* c, int ldc,
+                           const Scalar& alpha, bool rank2, const Scalar& alpha2)
+{
+  double flops = (rank2 ? 1. : 0.5) * double(n) * double(n) * double(k);
+  if(uplo==UP)
+  {
+    rankk_kernel<Upper,Conjugate> kernel = { op, n, k, a, lda, b, ldb, c, ldc, alpha, rank2, alpha2 };
+    internal::blas_parallelize(kernel, n, flops, internal::BlasSplitUpper);
+  }
+  else
+  {
+    rankk_kernel<Lower,Conjugate> kernel = { op, n, k, a, lda, b, ldb, c, ldc, alpha, rank2, alpha2 };
+    internal::blas_parallelize(kernel, n, flops, internal::BlasSplitLower);
+  }
+}
+
+}
+
 int EIGEN_BLAS_FUNC(gemm)(char *opa, char *opb, int *m, int *n, int *k, RealScalar *palpha, RealScalar *pa, int *lda, RealScalar *pb, int *ldb, RealScalar *pbeta, RealScalar *pc, int *ldc)
 {
 //   std::cerr << "in gemm " << *opa << " " << *opb << " " << *m << " " << *n << " " << *k << " " << *lda << " " << *ldb << " " << *ldc << " " << *palpha << " " << *pbeta << "\n";
-  typedef void (*functype)(DenseIndex, DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, Scalar, internal::level3_blocking<Scalar,Scalar>&, Eigen::internal::GemmParallelInfo<DenseIndex>*);
-  static functype func[12];
+  static gemm_functype func[12];
 
   static bool init = false;
   if(!init)
@@ -56,18 +251,20 @@ int EIGEN_BLAS_FUNC(gemm)(char *opa, char *opb, int *m, int *n, int *k, RealScal
     else                matrix(c, *m, *n, *ldc) *= beta;
   }
 
-  internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic> blocking(*m,*n,*k,1,true);
+  if(*m==0 || *n==0)
+    return 0;
 
   int code = OP(*opa) | (OP(*opb) << 2);
-  func[code](*m, *n, *k, a, *lda, b, *ldb, c, *ldc, alpha, blocking, 0);
+  bool splitCols = *n>=*m;
+  gemm_kernel kernel = { func[code], splitCols, OP(*opa), OP(*opb), *m, *n, *k, a, *lda, b, *ldb, c, *ldc, alpha };
+  internal::blas_parallelize(kernel, splitCols ? *n : *m, double(*m)*double(*n)*double(*k));
   return 0;
 }
 
 int EIGEN_BLAS_FUNC(trsm)(char *side, char *uplo, char *opa, char *diag, int *m, int *n, RealScalar *palpha,  RealScalar *pa, int *lda, RealScalar *pb, int *ldb)
 {
 //   std::cerr << "in trsm " << *side << " " << *uplo << " " << *opa << " " << *diag << " " << *m << "," << *n << " " << *palpha << " " << *lda << " " << *ldb<< "\n";
-  typedef void (*functype)(DenseIndex, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, internal::level3_blocking<Scalar,Scalar>&);
-  static functype func[32];
+  static trsm_functype func[32];
 
   static bool init = false;
   if(!init)
@@ -128,20 +325,11 @@ int EIGEN_BLAS_FUNC(trsm)(char *side, char *uplo, char *opa, char *diag, int *m,
     return xerbla_(SCALAR_SUFFIX_UP"TRSM ",&info,6);
 
   int code = OP(*opa) | (SIDE(*side) << 2) | (UPLO(*uplo) << 3) | (DIAG(*diag) << 4);
-  
-  if(SIDE(*side)==LEFT)
-  {
-    internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(*m,*n,*m,1,false);
-    func[code](*m, *n, a, *lda, b, *ldb, blocking);
-  }
-  else
-  {
-    internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(*m,*n,*n,1,false);
-    func[code](*n, *m, a, *lda, b, *ldb, blocking);
-  }
 
-  if(alpha!=Scalar(1))
-    matrix(b,*m,*n,*ldb) *= alpha;
+  // the columns (resp. rows) of b are independent if a is on the left (resp. right)
+  trsm_kernel kernel = { func[code], SIDE(*side), *m, *n, a, *lda, b, *ldb, alpha };
+  int size = SIDE(*side)==LEFT ? *m : *n;
+  internal::blas_parallelize(kernel, SIDE(*side)==LEFT ? *n : *m, 0.5*double(*m)*double(*n)*double(size));
 
   return 0;
 }
@@ -152,8 +340,7 @@ int EIGEN_BLAS_FUNC(trsm)(char *side, char *uplo, char *opa, char *diag, int *m,
 int EIGEN_BLAS_FUNC(trmm)(char *side, char *uplo, char *opa, char *diag, int *m, int *n, RealScalar *palpha,  RealScalar *pa, int *lda, RealScalar *pb, int *ldb)
 {
 //   std::cerr << "in trmm " << *side << " " << *uplo << " " << *opa << " " << *diag << " " << *m << " " << *n << " " << *lda << " " << *ldb << " " << *palpha << "\n";
-  typedef void (*functype)(DenseIndex, DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, const Scalar&, internal::level3_blocking<Scalar,Scalar>&);
-  static functype func[32];
+  static trmm_functype func[32];
   static bool init = false;
   if(!init)
   {
@@ -216,20 +403,10 @@ int EIGEN_BLAS_FUNC(trmm)(char *side, char *uplo, char *opa, char *diag, int *m,
   if(*m==0 || *n==0)
     return 1;
 
-  // FIXME find a way to avoid this copy
-  Matrix<Scalar,Dynamic,Dynamic,ColMajor> tmp = matrix(b,*m,*n,*ldb);
-  matrix(b,*m,*n,*ldb).setZero();
-
-  if(SIDE(*side)==LEFT)
-  {
-    internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(*m,*n,*m,1,false);
-    func[code](*m, *n, *m, a, *lda, tmp.data(), tmp.outerStride(), b, *ldb, alpha, blocking);
-  }
-  else
-  {
-    internal::gemm_blocking_space<ColMajor,Scalar,Scalar,Dynamic,Dynamic,Dynamic,4> blocking(*m,*n,*n,1,false);
-    func[code](*m, *n, *n, tmp.data(), tmp.outerStride(), a, *lda, b, *ldb, alpha, blocking);
-  }
+  // the columns (resp. rows) of b are independent if a is on the left (resp. right)
+  trmm_kernel kernel = { func[code], SIDE(*side), *m, *n, a, *lda, b, *ldb, alpha };
+  int size = SIDE(*side)==LEFT ? *m : *n;
+  internal::blas_parallelize(kernel, SIDE(*side)==LEFT ? *n : *m, 0.5*double(*m)*double(*n)*double(size));
   return 1;
 }
 
@@ -266,9 +443,9 @@ int EIGEN_BLAS_FUNC(symm)(char *side, char *uplo, int *m, int *n, RealScalar *pa
     return 1;
   }
 
+  int size = (SIDE(*side)==LEFT) ? (*m) : (*n);
   #if ISCOMPLEX
   // FIXME add support for symmetric complex matrix
-  int size = (SIDE(*side)==LEFT) ? (*m) : (*n);
   Matrix<Scalar,Dynamic,Dynamic,ColMajor> matA(size,size);
   if(UPLO(*uplo)==UP)
   {
@@ -280,23 +457,23 @@ int EIGEN_BLAS_FUNC(symm)(char *side, char *uplo, int *m, int *n, RealScalar *pa
     matA.triangularView<Lower>() = matrix(a,size,size,*lda);
     matA.triangularView<Upper>() = matrix(a,size,size,*lda).transpose();
   }
-  if(SIDE(*side)==LEFT)
-    matrix(c, *m, *n, *ldc) += alpha * matA * matrix(b, *m, *n, *ldb);
-  else if(SIDE(*side)==RIGHT)
-    matrix(c, *m, *n, *ldc) += alpha * matrix(b, *m, *n, *ldb) * matA;
+  symm_functype func = 0;
+  const Scalar* pmatA = matA.data();
   #else
+  symm_functype func;
   if(SIDE(*side)==LEFT)
-    if(UPLO(*uplo)==UP)       internal::product_selfadjoint_matrix<Scalar, DenseIndex, RowMajor,true,false, ColMajor,false,false, ColMajor>::run(*m, *n, a, *lda, b, *ldb, c, *ldc, alpha);
-    else if(UPLO(*uplo)==LO)  internal::product_selfadjoint_matrix<Scalar, DenseIndex, ColMajor,true,false, ColMajor,false,false, ColMajor>::run(*m, *n, a, *lda, b, *ldb, c, *ldc, alpha);
-    else                      return 0;
-  else if(SIDE(*side)==RIGHT)
-    if(UPLO(*uplo)==UP)       internal::product_selfadjoint_matrix<Scalar, DenseIndex, ColMajor,false,false, RowMajor,true,false, ColMajor>::run(*m, *n, b, *ldb, a, *lda, c, *ldc, alpha);
-    else if(UPLO(*uplo)==LO)  internal::product_selfadjoint_matrix<Scalar, DenseIndex, ColMajor,false,false, ColMajor,true,false, ColMajor>::run(*m, *n, b, *ldb, a, *lda, c, *ldc, alpha);
-    else                      return 0;
+    if(UPLO(*uplo)==UP)       func = internal::product_selfadjoint_matrix<Scalar, DenseIndex, RowMajor,true,false, ColMajor,false,false, ColMajor>::run;
+    else                      func = internal::product_selfadjoint_matrix<Scalar, DenseIndex, ColMajor,true,false, ColMajor,false,false, ColMajor>::run;
   else
-    return 0;
+    if(UPLO(*uplo)==UP)       func = internal::product_selfadjoint_matrix<Scalar, DenseIndex, ColMajor,false,false, RowMajor,true,false, ColMajor>::run;
+    else                      func = internal::product_selfadjoint_matrix<Scalar, DenseIndex, ColMajor,false,false, ColMajor,true,false, ColMajor>::run;
+  const Scalar* pmatA = 0;
   #endif
 
+  // the columns (resp. rows) of c are independent if a is on the left (resp. right)
+  symm_kernel kernel = { func, SIDE(*side), *m, *n, a, *lda, b, *ldb, c, *ldc, alpha, pmatA };
+  internal::blas_parallelize(kernel, SIDE(*side)==LEFT ? *n : *m, double(*m)*double(*n)*double(size));
+
   return 0;
 }
 
@@ -305,28 +482,6 @@ int EIGEN_BLAS_FUNC(symm)(char *side, char *uplo, int *m, int *n, RealScalar *pa
 int EIGEN_BLAS_FUNC(syrk)(char *uplo, char *op, int *n, int *k, RealScalar *palpha, RealScalar *pa, int *lda, RealScalar *pbeta, RealScalar *pc, int *ldc)
 {
 //   std::cerr << "in syrk " << *uplo << " " << *op << " " << *n << " " << *k << " " << *palpha << " " << *lda << " " << *pbeta << " " << *ldc << "\n";
-  #if !ISCOMPLEX
-  typedef void (*functype)(DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, const Scalar&);
-  static functype func[8];
-
-  static bool init = false;
-  if(!init)
-  {
-    for(int i=0; i<8; ++i)
-      func[i] = 0;
-
-    func[NOTR  | (UP << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,ColMajor,false,Scalar,RowMajor,ColMajor,Conj, Upper>::run);
-    func[TR    | (UP << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,RowMajor,false,Scalar,ColMajor,ColMajor,Conj, Upper>::run);
-    func[ADJ   | (UP << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,RowMajor,Conj, Scalar,ColMajor,ColMajor,false,Upper>::run);
-
-    func[NOTR  | (LO << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,ColMajor,false,Scalar,RowMajor,ColMajor,Conj, Lower>::run);
-    func[TR    | (LO << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,RowMajor,false,Scalar,ColMajor,ColMajor,Conj, Lower>::run);
-    func[ADJ   | (LO << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,RowMajor,Conj, Scalar,ColMajor,ColMajor,false,Lower>::run);
-
-    init = true;
-  }
-  #endif
-
   Scalar* a = reinterpret_cast<Scalar*>(pa);
   Scalar* c = reinterpret_cast<Scalar*>(pc);
   Scalar alpha = *reinterpret_cast<Scalar*>(palpha);
@@ -352,26 +507,8 @@ int EIGEN_BLAS_FUNC(syrk)(char *uplo, char *op, int *n, int *k, RealScalar *palp
       else                matrix(c, *n, *n, *ldc).triangularView<Lower>() *= beta;
   }
 
-  #if ISCOMPLEX
-  // FIXME add support for symmetric complex matrix
-  if(UPLO(*uplo)==UP)
-  {
-    if(OP(*op)==NOTR)
-      matrix(c, *n, *n, *ldc).triangularView<Upper>() += alpha * matrix(a,*n,*k,*lda) * matrix(a,*n,*k,*lda).transpose();
-    else
-      matrix(c, *n, *n, *ldc).triangularView<Upper>() += alpha * matrix(a,*k,*n,*lda).transpose() * matrix(a,*k,*n,*lda);
-  }
-  else
-  {
-    if(OP(*op)==NOTR)
-      matrix(c, *n, *n, *ldc).triangularView<Lower>() += alpha * matrix(a,*n,*k,*lda) * matrix(a,*n,*k,*lda).transpose();
-    else
-      matrix(c, *n, *n, *ldc).triangularView<Lower>() += alpha * matrix(a,*k,*n,*lda).transpose() * matrix(a,*k,*n,*lda);
-  }
-  #else
-  int code = OP(*op) | (UPLO(*uplo) << 2);
-  func[code](*n, *k, a, *lda, a, *lda, c, *ldc, alpha);
-  #endif
+  if(*k>0)
+    parallel_rankk_update<false>(UPLO(*uplo), OP(*op), *n, *k, a, *lda, a, *lda, c, *ldc, alpha, false, Scalar(0));
 
   return 0;
 }
@@ -410,30 +547,7 @@ int EIGEN_BLAS_FUNC(syr2k)(char *uplo, char *op, int *n, int *k, RealScalar *pal
   if(*k==0)
     return 1;
 
-  if(OP(*op)==NOTR)
-  {
-    if(UPLO(*uplo)==UP)
-    {
-      matrix(c, *n, *n, *ldc).triangularView<Upper>()
-        += alpha *matrix(a, *n, *k, *lda)*matrix(b, *n, *k, *ldb).transpose()
-        +  alpha*matrix(b, *n, *k, *ldb)*matrix(a, *n, *k, *lda).transpose();
-    }
-    else if(UPLO(*uplo)==LO)
-      matrix(c, *n, *n, *ldc).triangularView<Lower>()
-        += alpha*matrix(a, *n, *k, *lda)*matrix(b, *n, *k, *ldb).transpose()
-        +  alpha*matrix(b, *n, *k, *ldb)*matrix(a, *n, *k, *lda).transpose();
-  }
-  else if(OP(*op)==TR || OP(*op)==ADJ)
-  {
-    if(UPLO(*uplo)==UP)
-      matrix(c, *n, *n, *ldc).triangularView<Upper>()
-        += alpha*matrix(a, *k, *n, *lda).transpose()*matrix(b, *k, *n, *ldb)
-        +  alpha*matrix(b, *k, *n, *ldb).transpose()*matrix(a, *k, *n, *lda);
-    else if(UPLO(*uplo)==LO)
-      matrix(c, *n, *n, *ldc).triangularView<Lower>()
-        += alpha*matrix(a, *k, *n, *lda).transpose()*matrix(b, *k, *n, *ldb)
-        +  alpha*matrix(b, *k, *n, *ldb).transpose()*matrix(a, *k, *n, *lda);
-  }
+  parallel_rankk_update<false>(UPLO(*uplo), OP(*op), *n, *k, a, *lda, b, *ldb, c, *ldc, alpha, true, alpha);
 
   return 0;
 }
@@ -472,27 +586,23 @@ int EIGEN_BLAS_FUNC(hemm)(char *side, char *uplo, int *m, int *n, RealScalar *pa
     return 1;
   }
 
+  symm_functype func;
   if(SIDE(*side)==LEFT)
   {
-    if(UPLO(*uplo)==UP)       internal::product_selfadjoint_matrix<Scalar,DenseIndex,RowMajor,true,Conj,  ColMajor,false,false, ColMajor>
-                                ::run(*m, *n, a, *lda, b, *ldb, c, *ldc, alpha);
-    else if(UPLO(*uplo)==LO)  internal::product_selfadjoint_matrix<Scalar,DenseIndex,ColMajor,true,false, ColMajor,false,false, ColMajor>
-                                ::run(*m, *n, a, *lda, b, *ldb, c, *ldc, alpha);
-    else                      return 0;
-  }
-  else if(SIDE(*side)==RIGHT)
-  {
-    if(UPLO(*uplo)==UP)       matrix(c,*m,*n,*ldc) += alpha * matrix(b,*m,*n,*ldb) * matrix(a,*n,*n,*lda).selfadjointView<Upper>();/*internal::product_selfadjoint_matrix<Scalar,DenseIndex,ColMajor,false,false, RowMajor,true,Conj,  ColMajor>
-                                ::run(*m, *n, b, *ldb, a, *lda, c, *ldc, alpha);*/
-    else if(UPLO(*uplo)==LO)  internal::product_selfadjoint_matrix<Scalar,DenseIndex,ColMajor,false,false, ColMajor,true,false, ColMajor>
-                                ::run(*m, *n, b, *ldb, a, *lda, c, *ldc, alpha);
-    else                      return 0;
+    if(UPLO(*uplo)==UP)       func = internal::product_selfadjoint_matrix<Scalar,DenseIndex,RowMajor,true,Conj,  ColMajor,false,false, ColMajor>::run;
+    else                      func = internal::product_selfadjoint_matrix<Scalar,DenseIndex,ColMajor,true,false, ColMajor,false,false, ColMajor>::run;
   }
   else
   {
-    return 0;
+    if(UPLO(*uplo)==UP)       func = internal::product_selfadjoint_matrix<Scalar,DenseIndex,ColMajor,false,false, RowMajor,true,Conj,  ColMajor>::run;
+    else                      func = internal::product_selfadjoint_matrix<Scalar,DenseIndex,ColMajor,false,false, ColMajor,true,false, ColMajor>::run;
   }
 
+  // the columns (resp. rows) of c are independent if a is on the left (resp. right)
+  int size = (SIDE(*side)==LEFT) ? (*m) : (*n);
+  symm_kernel kernel = { func, SIDE(*side), *m, *n, a, *lda, b, *ldb, c, *ldc, alpha, 0 };
+  internal::blas_parallelize(kernel, SIDE(*side)==LEFT ? *n : *m, double(*m)*double(*n)*double(size));
+
   return 0;
 }
 
@@ -500,24 +610,6 @@ int EIGEN_BLAS_FUNC(hemm)(char *side, char *uplo, int *m, int *n, RealScalar *pa
 // c = alpha*conj(a')*a + beta*c  for op  = 'C'or'c'
 int EIGEN_BLAS_FUNC(herk)(char *uplo, char *op, int *n, int *k, RealScalar *palpha, RealScalar *pa, int *lda, RealScalar *pbeta, RealScalar *pc, int *ldc)
 {
-  typedef void (*functype)(DenseIndex, DenseIndex, const Scalar *, DenseIndex, const Scalar *, DenseIndex, Scalar *, DenseIndex, const Scalar&);
-  static functype func[8];
-
-  static bool init = false;
-  if(!init)
-  {
-    for(int i=0; i<8; ++i)
-      func[i] = 0;
-
-    func[NOTR  | (UP << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,ColMajor,false,Scalar,RowMajor,Conj, ColMajor,Upper>::run);
-    func[ADJ   | (UP << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,RowMajor,Conj, Scalar,ColMajor,false,ColMajor,Upper>::run);
-
-    func[NOTR  | (LO << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,ColMajor,false,Scalar,RowMajor,Conj, ColMajor,Lower>::run);
-    func[ADJ   | (LO << 2)] = (internal::general_matrix_matrix_triangular_product<DenseIndex,Scalar,RowMajor,Conj, Scalar,ColMajor,false,ColMajor,Lower>::run);
-
-    init = true;
-  }
-
   Scalar* a = reinterpret_cast<Scalar*>(pa);
   Scalar* c = reinterpret_cast<Scalar*>(pc);
   RealScalar alpha = *palpha;
@@ -535,8 +627,6 @@ int EIGEN_BLAS_FUNC(herk)(char *uplo, char *op, int *n, int *k, RealScalar *palp
   if(info)
     return xerbla_(SCALAR_SUFFIX_UP"HERK ",&info,6);
 
-  int code = OP(*op) | (UPLO(*uplo) << 2);
-
   if(beta!=RealScalar(1))
   {
     if(UPLO(*uplo)==UP)
@@ -555,7 +645,7 @@ int EIGEN_BLAS_FUNC(herk)(char *uplo, char *op, int *n, int *k, RealScalar *palp
 
   if(*k>0 && alpha!=RealScalar(0))
   {
-    func[code](*n, *k, a, *lda, a, *lda, c, *ldc, alpha);
+    parallel_rankk_update<true>(UPLO(*uplo), OP(*op), *n, *k, a, *lda, a, *lda, c, *ldc, Scalar(alpha), false, Scalar(0));
     matrix(c, *n, *n, *ldc).diagonal().imag().setZero();
   }
   return 0;
@@ -603,30 +693,7 @@ int EIGEN_BLAS_FUNC(her2k)(char *uplo, char *op, int *n, int *k, RealScalar *pal
   if(*k==0)
     return 1;
 
-  if(OP(*op)==NOTR)
-  {
-    if(UPLO(*uplo)==UP)
-    {
-      matrix(c, *n, *n, *ldc).triangularView<Upper>()
-        +=            alpha *matrix(a, *n, *k, *lda)*matrix(b, *n, *k, *ldb).adjoint()
-        +  numext::conj(alpha)*matrix(b, *n, *k, *ldb)*matrix(a, *n, *k, *lda).adjoint();
-    }
-    else if(UPLO(*uplo)==LO)
-      matrix(c, *n, *n, *ldc).triangularView<Lower>()
-        += alpha*matrix(a, *n, *k, *lda)*matrix(b, *n, *k, *ldb).adjoint()
-        +  numext::conj(alpha)*matrix(b, *n, *k, *ldb)*matrix(a, *n, *k, *lda).adjoint();
-  }
-  else if(OP(*op)==ADJ)
-  {
-    if(UPLO(*uplo)==UP)
-      matrix(c, *n, *n, *ldc).triangularView<Upper>()
-        +=             alpha*matrix(a, *k, *n, *lda).adjoint()*matrix(b, *k, *n, *ldb)
-        +  numext::conj(alpha)*matrix(b, *k, *n, *ldb).adjoint()*matrix(a, *k, *n, *lda);
-    else if(UPLO(*uplo)==LO)
-      matrix(c, *n, *n, *ldc).triangularView<Lower>()
-        +=             alpha*matrix(a, *k, *n, *lda).adjoint()*matrix(b, *k, *n, *ldb)
-        +  numext::conj(alpha)*matrix(b, *k, *n, *ldb).adjoint()*matrix(a, *k, *n, *lda);
-  }
+  parallel_rankk_update<true>(UPLO(*uplo), OP(*op), *n, *k, a, *lda, b, *ldb, c, *ldc, alpha, true, numext::conj(alpha));
 
   return 1;
 }
@@ -0,0 +1,116 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstdlib>
+#include <vector>
+
+#if defined(_OPENMP)
+  #include <omp.h>
+#elif defined(__unix__) || defined(__unix) || defined(__APPLE__)
+  #include <unistd.h>
+  #include <pthread.h>
+  #define EIGEN_BLAS_USE_PTHREADS
+#endif
+
+// number of threads set by eigen_blas_set_num_threads(), zero for the default
+static int eigen_blas_nb_threads = 0;
+
+static int eigen_blas_query_num_threads()
+{
+  if(const char* env = std::getenv("EIGEN_BLAS_NUM_THREADS"))
+  {
+    int n = std::atoi(env);
+    if(n>0)
+      return n;
+  }
+#if defined(_OPENMP)
+  return omp_get_max_threads();
+#elif defined(EIGEN_BLAS_USE_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n>0 ? int(n) : 1;
+#else
+  return 1;
+#endif
+}
+
+static int eigen_blas_default_num_threads()
+{
+  // the initialization of a function-local static is performed once, even if several threads call the BLAS concurrently
+  static const int nb = eigen_blas_query_num_threads();
+  return nb;
+}
+
+extern "C" void eigen_blas_set_num_threads(int nbThreads)
+{
+  eigen_blas_nb_threads = nbThreads>0 ? nbThreads : 0;
+}
+
+extern "C" int eigen_blas_get_num_threads()
+{
+  int nb = eigen_blas_nb_threads;
+  return nb>0 ? nb : eigen_blas_default_num_threads();
+}
+
+namespace Eigen {
+
+namespace internal {
+
+#ifdef EIGEN_BLAS_USE_PTHREADS
+struct blas_thread_data
+{
+  void (*func)(void*,int,int);
+  void* data;
+  int i;
+  int nb;
+};
+
+static void* blas_thread_main(void* p)
+{
+  blas_thread_data* d = static_cast<blas_thread_data*>(p);
+  d->func(d->data, d->i, d->nb);
+  return 0;
+}
+#endif
+
+void blas_run_parallel(void (*func)(void*,int,int), void* data, int nb)
+{
+#if defined(_OPENMP)
+  // do not create nested threads if we are already in a parallel region
+  if(omp_in_parallel())
+  {
+    for(int i=0; i<nb; ++i)
+      func(data, i, nb);
+    return;
+  }
+  #pragma omp parallel for num_threads(nb) schedule(static,1)
+  for(int i=0; i<nb; ++i)
+    func(data, i, nb);
+#elif defined(EIGEN_BLAS_USE_PTHREADS)
+  std::vector<blas_thread_data> args(nb);
+  std::vector<pthread_t> threads(nb);
+  std::vector<bool> created(nb, false);
+  for(int i=1; i<nb; ++i)
+  {
+    blas_thread_data d = { func, data, i, nb };
+    args[i] = d;
+    created[i] = pthread_create(&threads[i], 0, blas_thread_main, &args[i])==0;
+  }
+  func(data, 0, nb);
+  for(int i=1; i<nb; ++i)
+  {
+    if(created[i]) pthread_join(threads[i], 0);
+    else           func(data, i, nb);   // fallback if the thread could not be created
+  }
+#else
+  for(int i=0; i<nb; ++i)
+    func(data, i, nb);
+#endif
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
@@ -15,4 +15,7 @@
 
 #include "cholesky.cpp"
 #include "lu.cpp"
+#include "qr.cpp"
+#include "ldlt.cpp"
+#include "triangular.cpp"
 #include "svd.cpp"
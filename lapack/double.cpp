@@ -14,5 +14,8 @@
 
 #include "cholesky.cpp"
 #include "lu.cpp"
+#include "qr.cpp"
+#include "ldlt.cpp"
+#include "triangular.cpp"
 #include "eigenvalues.cpp"
 #include "svd.cpp"
@@ -10,10 +10,71 @@
 #include "lapack_common.h"
 #include <Eigen/Eigenvalues>
 
+// reduces the selfadjoint matrix stored in the lower part of mat to a tridiagonal matrix, whose diagonal
+// is stored in diag, and subdiagonal in subdiag; the Householder coefficients are stored in hcoeffs
+template<typename MatrixType>
+static RealScalar lapack_tridiagonalize(MatrixType& mat, CompactVectorType& diag, CompactVectorType& subdiag, CompactVectorType& hcoeffs)
+{
+  // map the matrix coefficients to [-1:1] to avoid over- and underflow
+  RealScalar scale(0);
+  for(Index j=0; j<mat.cols(); ++j)
+    scale = std::max(scale, mat.col(j).tail(mat.rows()-j).cwiseAbs().maxCoeff());
+  if(scale==RealScalar(0)) scale = RealScalar(1);
+  mat.template triangularView<Lower>() /= scale;
+  internal::tridiagonalization_inplace(mat, hcoeffs);
+  diag = mat.diagonal();
+  subdiag = mat.template diagonal<-1>();
+  return scale;
+}
+
+// computes the eigenvalues w, and optionally the eigenvectors, of the selfadjoint matrix stored in the uplo part of a.
+// The computation is done in place: if computeVectors is true, a is overwritten by the eigenvectors, otherwise the
+// uplo part of a is destroyed. The workspace work must hold 2*n-2 scalars, and 3*n-2 to compute the eigenvectors.
+static bool lapack_selfadjoint_eigen(char uplo, int n, Scalar* a, int lda, Scalar* w, Scalar* work, bool computeVectors)
+{
+  MatrixType mat(a, n, n, OuterStride<>(lda));
+  CompactVectorType diag(w, n);
+  if(n==1)
+  {
+    diag(0) = mat(0,0);
+    if(computeVectors)
+      mat(0,0) = Scalar(1);
+    return true;
+  }
+
+  CompactVectorType subdiag(work, n-1);
+  CompactVectorType hcoeffs(work+n-1, n-1);
+  RealScalar scale;
+  if(computeVectors)
+  {
+    // a is overwritten anyway, so that the lower part is used
+    if(UPLO(uplo)==UP)
+      for(int j=0; j<n-1; ++j)
+        mat.col(j).tail(n-j-1) = mat.row(j).tail(n-j-1).transpose();
+    scale = lapack_tridiagonalize(mat, diag, subdiag, hcoeffs);
+    // form Q in place
+    CompactVectorType workspace(work+2*n-2, n);
+    HouseholderSequence<MatrixType,CompactVectorType>(mat, hcoeffs).setLength(n-1).setShift(1).evalTo(mat, workspace);
+  }
+  else if(UPLO(uplo)==UP)
+  {
+    Transpose<MatrixType> matT(mat);
+    scale = lapack_tridiagonalize(matT, diag, subdiag, hcoeffs);
+  }
+  else
+  {
+    scale = lapack_tridiagonalize(mat, diag, subdiag, hcoeffs);
+  }
+
+  ComputationInfo info = internal::computeFromTridiagonal_impl(diag, subdiag, SelfAdjointEigenSolver<PlainMatrixType>::m_maxIterations,
+                                                               computeVectors, mat);
+  diag *= scale;
+  return info!=NoConvergence;
+}
+
 // computes eigen values and vectors of a general N-by-N matrix A
-EIGEN_LAPACK_FUNC(syev,(char *jobz, char *uplo, int* n, Scalar* a, int *lda, Scalar* w, Scalar* /*work*/, int* lwork, int *info))
+EIGEN_LAPACK_FUNC(syev,(char *jobz, char *uplo, int* n, Scalar* a, int *lda, Scalar* w, Scalar* work, int* lwork, int *info))
 {
-  // TODO exploit the work buffer
   bool query_size = *lwork==-1;
   
   *info = 0;
@@ -31,21 +92,16 @@ EIGEN_LAPACK_FUNC(syev,(char *jobz, char *uplo, int* n, Scalar* a, int *lda, Sca
   
   if(query_size)
   {
-    *lwork = 0;
+    work[0] = Scalar(std::max(1,3**n-1));
     return 0;
   }
   
   if(*n==0)
     return 0;
   
-  PlainMatrixType mat(*n,*n);
-  if(UPLO(*uplo)==UP) mat = matrix(a,*n,*n,*lda).adjoint();
-  else                mat = matrix(a,*n,*n,*lda);
-  
   bool computeVectors = *jobz=='V' || *jobz=='v';
-  SelfAdjointEigenSolver<PlainMatrixType> eig(mat,computeVectors?ComputeEigenvectors:EigenvaluesOnly);
   
-  if(eig.info()==NoConvergence)
+  if(!lapack_selfadjoint_eigen(*uplo, *n, a, *lda, w, work, computeVectors))
   {
     make_vector(w,*n).setZero();
     if(computeVectors)
@@ -54,9 +110,328 @@ EIGEN_LAPACK_FUNC(syev,(char *jobz, char *uplo, int* n, Scalar* a, int *lda, Sca
     return 0;
   }
   
-  make_vector(w,*n) = eig.eigenvalues();
-  if(computeVectors)
-    matrix(a,*n,*n,*lda) = eig.eigenvectors();
+  return 0;
+}
+
+// computes eigen values and vectors of a symmetric N-by-N matrix A.
+// The reference implementation uses a divide-and-conquer algorithm; here the same
+// tridiagonal QR iterations as in SYEV are used, only the workspace requirements differ.
+EIGEN_LAPACK_FUNC(syevd,(char *jobz, char *uplo, int* n, Scalar* a, int *lda, Scalar* w, Scalar* work, int* lwork,
+                         int* iwork, int* liwork, int *info))
+{
+  bool query_size = *lwork==-1 || *liwork==-1;
+  bool computeVectors = *jobz=='V' || *jobz=='v';
+  int lwmin  = *n<=1 ? 1 : computeVectors ? 1 + 6**n + 2**n**n : 2**n+1;
+  int liwmin = *n<=1 || !computeVectors ? 1 : 3 + 5**n;
+  
+  *info = 0;
+        if(*jobz!='N' && *jobz!='V')                    *info = -1;
+  else  if(UPLO(*uplo)==INVALID)                        *info = -2;
+  else  if(*n<0)                                        *info = -3;
+  else  if(*lda<std::max(1,*n))                         *info = -5;
+  else  if((!query_size) && *lwork<lwmin)               *info = -8;
+  else  if((!query_size) && *liwork<liwmin)             *info = -10;
+    
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"SYEVD", &e, 6);
+  }
+  
+  if(query_size)
+  {
+    work[0] = Scalar(lwmin);
+    iwork[0] = liwmin;
+    return 0;
+  }
+  
+  if(*n==0)
+    return 0;
+  
+  if(!lapack_selfadjoint_eigen(*uplo, *n, a, *lda, w, work, computeVectors))
+    *info = 1;
+  
+  return 0;
+}
+
+// factorizes T - lambda*I = P*L*U with partial pivoting, where T is the symmetric tridiagonal matrix of diagonal diag
+// and subdiagonal subdiag (as LAPACK's LAGTF): on output u0, u1 and u2 hold the diagonal and the two superdiagonals of U,
+// l holds the multipliers of L, and piv[k] is 1 when the rows k and k+1 have been interchanged.
+static void lapack_tridiagonal_lu(const CompactVectorType& diag, const CompactVectorType& subdiag, Scalar lambda,
+                                  CompactVectorType& u0, CompactVectorType& u1, CompactVectorType& u2, CompactVectorType& l, int* piv)
+{
+  using std::abs;
+  Index n = diag.size();
+  u0 = diag.array() - lambda;
+  u1 = subdiag;
+  u2.setZero();
+  l = subdiag;
+  for(Index k=0; k<n-1; ++k)
+  {
+    if(abs(u0(k))>=abs(l(k)))
+    {
+      piv[k] = 0;
+      if(u0(k)!=Scalar(0))
+        l(k) /= u0(k);
+      u0(k+1) -= l(k)*u1(k);
+    }
+    else
+    {
+      piv[k] = 1;
+      Scalar mult = u0(k)/l(k);
+      Scalar tmp = u0(k+1);
+      u0(k) = l(k);
+      u0(k+1) = u1(k) - mult*tmp;
+      if(k<n-2)
+      {
+        u2(k) = u1(k+1);
+        u1(k+1) = -mult*u2(k);
+      }
+      u1(k) = tmp;
+      l(k) = mult;
+    }
+  }
+}
+
+// solves in place (T - lambda*I) x = y from the factorization of lapack_tridiagonal_lu, where the pivots of U smaller
+// than tol are replaced by +/-tol (as LAPACK's LAGTS for the inverse iteration)
+template<typename VectorType>
+static void lapack_tridiagonal_solve(const CompactVectorType& u0, const CompactVectorType& u1, const CompactVectorType& u2,
+                                     const CompactVectorType& l, const int* piv, RealScalar tol, VectorType& y)
+{
+  using std::abs;
+  Index n = u0.size();
+  for(Index k=0; k<n-1; ++k)
+  {
+    if(piv[k]==0)
+      y(k+1) -= l(k)*y(k);
+    else
+    {
+      Scalar tmp = y(k);
+      y(k) = y(k+1);
+      y(k+1) = tmp - l(k)*y(k);
+    }
+  }
+  for(Index k=n-1; k>=0; --k)
+  {
+    Scalar tmp = y(k);
+    if(k<n-1) tmp -= u1(k)*y(k+1);
+    if(k<n-2) tmp -= u2(k)*y(k+2);
+    Scalar pivot = u0(k);
+    if(abs(pivot)<tol)
+      pivot = pivot<Scalar(0) ? Scalar(-tol) : Scalar(tol);
+    y(k) = tmp/pivot;
+  }
+}
+
+// computes in the columns of z the eigenvectors of the symmetric tridiagonal matrix T of diagonal diag and subdiagonal
+// subdiag, n>1, associated to its increasingly sorted eigenvalues ev, by inverse iteration as LAPACK's STEIN: the
+// eigenvectors of close eigenvalues are orthogonalized against each other. The workspace work must hold 4*n scalars,
+// and iwork n integers. Returns the number of eigenvectors which did not converge.
+static int lapack_tridiagonal_eigenvectors(const CompactVectorType& diag, const CompactVectorType& subdiag, const Scalar* ev,
+                                           MatrixType& z, Scalar* work, int* iwork)
+{
+  using std::abs;
+  using std::sqrt;
+  const int maxIterations = 5, extraIterations = 2;
+  Index n = diag.size();
+  CompactVectorType u0(work,n), u1(work+n,n-1), u2(work+2*n-1,n-2), l(work+3*n-3,n-1);
+
+  RealScalar norm1 = abs(diag(0)) + abs(subdiag(0));
+  for(Index i=1; i<n; ++i)
+    norm1 = (std::max)(norm1, abs(subdiag(i-1)) + abs(diag(i)) + (i<n-1 ? abs(subdiag(i)) : RealScalar(0)));
+  if(norm1==RealScalar(0))
+    norm1 = RealScalar(1);
+  const RealScalar eps = NumTraits<Scalar>::epsilon();
+  const RealScalar orthoTol = RealScalar(1e-3)*norm1;
+  const RealScalar growthTol = sqrt(RealScalar(0.1)/RealScalar(n));
+
+  int failures = 0;
+  unsigned int seed = 1;
+  Index group = 0;
+  Scalar lambda = 0;
+  for(Index j=0; j<z.cols(); ++j)
+  {
+    // separate the eigenvalues which are too close, and gather the close ones in the same group
+    Scalar prev = lambda;
+    lambda = ev[j];
+    if(j>0)
+    {
+      RealScalar perturbation = RealScalar(10)*abs(eps*lambda);
+      if(lambda-prev<perturbation)
+        lambda = prev + perturbation;
+      if(lambda-prev>orthoTol)
+        group = j;
+    }
+
+    lapack_tridiagonal_lu(diag, subdiag, lambda, u0, u1, u2, l, iwork);
+    RealScalar tol = (std::max)(u0.cwiseAbs().maxCoeff(), u1.cwiseAbs().maxCoeff());
+    if(n>2) tol = (std::max)(tol, u2.cwiseAbs().maxCoeff());
+    tol = tol==RealScalar(0) ? eps : eps*tol;
+
+    // pseudo-random starting vector, with entries in [-1:1]
+    MatrixType::ColXpr x = z.col(j);
+    for(Index i=0; i<n; ++i)
+    {
+      seed = seed*1103515245u + 12345u;
+      x(i) = Scalar((seed>>16)&0x7fff)/Scalar(16383.5) - Scalar(1);
+    }
+
+    int converged = 0;
+    Index jmax = 0;
+    for(int it=0; it<maxIterations && converged<=extraIterations; ++it)
+    {
+      x *= RealScalar(n)*norm1*(std::max)(eps,abs(u0(n-1)))/x.cwiseAbs().maxCoeff();
+      lapack_tridiagonal_solve(u0, u1, u2, l, iwork, tol, x);
+      for(Index k=group; k<j; ++k)
+        x -= z.col(k).dot(x)*z.col(k);
+      // the growth of the solution tells that lambda is an accurate eigenvalue, iterate twice more after it
+      if(x.cwiseAbs().maxCoeff(&jmax)>=growthTol)
+        ++converged;
+    }
+    if(converged<=extraIterations)
+      ++failures;
+    x /= x(jmax)<Scalar(0) ? -x.norm() : x.norm();
+  }
+  return failures;
+}
+
+// computes in z the eigenvectors associated to the eigenvalues w of a selfadjoint matrix A, when mat holds the reduction
+// of A to the tridiagonal matrix of diagonal diag and subdiagonal subdiag, computed by lapack_tridiagonalize.
+// When all the n eigenpairs are selected, the eigenvalues are recomputed along with the eigenvectors, directly in z.
+// subdiag is destroyed, and the workspace work must hold 4*n scalars, and iwork n integers.
+template<typename VectorsType>
+static bool lapack_selected_eigenvectors(VectorsType& mat, const CompactVectorType& hcoeffs, const CompactVectorType& diag,
+                                         CompactVectorType& subdiag, CompactVectorType& w, MatrixType& z, Scalar* work, int* iwork)
+{
+  Index n = mat.rows(), m = z.cols();
+  HouseholderSequence<VectorsType,CompactVectorType> Q(mat, hcoeffs);
+  Q.setLength(n-1).setShift(1);
+  if(m==n)
+  {
+    CompactVectorType workspace(work, n);
+    Q.evalTo(z, workspace);
+    w = diag;
+    return internal::computeFromTridiagonal_impl(w, subdiag, SelfAdjointEigenSolver<PlainMatrixType>::m_maxIterations,
+                                                 true, z) != NoConvergence;
+  }
+  int failures = lapack_tridiagonal_eigenvectors(diag, subdiag, w.data(), z, work, iwork);
+  Map<Matrix<Scalar,1,Dynamic> > workspace(work, m);
+  Q.applyThisOnTheLeft(z, workspace);
+  return failures==0;
+}
+
+// computes selected eigen values and, optionally, eigen vectors of a symmetric N-by-N matrix A.
+// The eigenvalues can be selected by a range of values (vl,vu] or of indices il..iu.
+// All eigenvalues are computed by tridiagonal QR iterations, and the selected eigenvectors by inverse iteration,
+// unless all of them are selected.
+EIGEN_LAPACK_FUNC(syevr,(char *jobz, char *range, char *uplo, int* n, Scalar* a, int *lda, Scalar *vl, Scalar *vu, int *il, int *iu,
+                         Scalar* /*abstol*/, int *m, Scalar* w, Scalar* z, int *ldz, int* isuppz, Scalar* work, int* lwork,
+                         int* iwork, int* liwork, int *info))
+{
+  bool query_size = *lwork==-1 || *liwork==-1;
+  bool computeVectors = *jobz=='V' || *jobz=='v';
+  bool allEig   = *range=='A' || *range=='a';
+  bool valEig   = *range=='V' || *range=='v';
+  bool indEig   = *range=='I' || *range=='i';
+  int lwmin  = std::max(1,26**n);
+  int liwmin = std::max(1,10**n);
+  
+  *info = 0;
+        if(*jobz!='N' && *jobz!='V')                              *info = -1;
+  else  if(!(allEig || valEig || indEig))                         *info = -2;
+  else  if(UPLO(*uplo)==INVALID)                                  *info = -3;
+  else  if(*n<0)                                                  *info = -4;
+  else  if(*lda<std::max(1,*n))                                   *info = -6;
+  else  if(valEig && *n>0 && *vu<=*vl)                            *info = -8;
+  else  if(indEig && (*il<1 || *il>std::max(1,*n)))               *info = -9;
+  else  if(indEig && (*iu<std::min(*n,*il) || *iu>*n))            *info = -10;
+  else  if(*ldz<1 || (computeVectors && *ldz<*n))                 *info = -15;
+  else  if((!query_size) && *lwork<lwmin)                         *info = -18;
+  else  if((!query_size) && *liwork<liwmin)                       *info = -20;
+    
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"SYEVR", &e, 6);
+  }
+  
+  if(query_size)
+  {
+    work[0] = Scalar(lwmin);
+    iwork[0] = liwmin;
+    return 0;
+  }
+  
+  *m = 0;
+  if(*n==0)
+    return 0;
+  
+  // Only the uplo part of a is destroyed: it holds the reduction to a tridiagonal matrix, whose eigenvalues are computed
+  // in w from a copy of its diagonal and subdiagonal, and the selected ones are shifted to the front of w.
+  // The selected eigenvectors are then computed directly in z, and all the workspaces are taken from work and iwork.
+  if(*n==1)
+  {
+    w[0] = a[0];
+    if(valEig && (w[0]<=*vl || w[0]>*vu))
+      return 0;
+    *m = 1;
+    if(computeVectors)
+    {
+      z[0] = Scalar(1);
+      isuppz[0] = isuppz[1] = 1;
+    }
+    return 0;
+  }
+  
+  MatrixType mat(a,*n,*n,*lda);
+  Transpose<MatrixType> matT(mat);
+  CompactVectorType hcoeffs(work, *n-1), diag(work+*n-1, *n), subdiag(work+2**n-1, *n-1), e(work+3**n-2, *n-1);
+  CompactVectorType eivalues(w, *n);
+  RealScalar scale = UPLO(*uplo)==UP ? lapack_tridiagonalize(matT, diag, subdiag, hcoeffs)
+                                     : lapack_tridiagonalize(mat, diag, subdiag, hcoeffs);
+  eivalues = diag;
+  e = subdiag;
+  if(internal::computeFromTridiagonal_impl(eivalues, e, SelfAdjointEigenSolver<PlainMatrixType>::m_maxIterations,
+                                           false, mat) == NoConvergence)
+  {
+    *info = 1;
+    return 0;
+  }
+  
+  // eigenvalues are sorted in increasing order
+  int first = 0, last = *n;
+  if(valEig)
+  {
+    while(first<*n && scale*w[first]<=*vl) ++first;
+    last = first;
+    while(last<*n && scale*w[last]<=*vu) ++last;
+  }
+  else if(indEig)
+  {
+    first = *il-1;
+    last = *iu;
+  }
+  *m = last-first;
+  
+  for(int i=0; i<*m; ++i)
+    w[i] = w[first+i];
+  if(computeVectors && *m>0)
+  {
+    MatrixType vecs(z,*n,*m,*ldz);
+    CompactVectorType selected(w,*m);
+    bool ok = UPLO(*uplo)==UP ? lapack_selected_eigenvectors(matT, hcoeffs, diag, subdiag, selected, vecs, work+4**n-3, iwork)
+                              : lapack_selected_eigenvectors(mat, hcoeffs, diag, subdiag, selected, vecs, work+4**n-3, iwork);
+    if(!ok)
+      *info = 1;
+    // the eigenvectors are not assumed to be sparse
+    for(int i=0; i<*m; ++i)
+    {
+      isuppz[2*i]   = 1;
+      isuppz[2*i+1] = *n;
+    }
+  }
+  make_vector(w,*m) *= scale;
   
   return 0;
 }
@@ -0,0 +1,494 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "lapack_common.h"
+#include <Eigen/Cholesky>
+
+// The factorizations computed by SYTRF are the Bunch-Kaufman diagonal pivoting
+// factorizations A = L*D*L^T (or A = U*D*U^T) where D is block diagonal with 1x1 and 2x2
+// blocks, as required by the LAPACK interface. Eigen's LDLT only performs 1x1 diagonal
+// pivoting with a different pivot storage, so the algorithm is implemented here using
+// Eigen's level-2 and level-3 kernels. Only the lower case is implemented; the upper case
+// is reduced to it by reversing the rows and columns of A. Note that the matrix is
+// symmetric, and not selfadjoint, in the complex case.
+
+namespace {
+
+inline RealScalar abs1(const Scalar& x)
+{
+  using std::abs;
+  return abs(numext::real(x)) + abs(numext::imag(x));
+}
+
+// returns the largest value of abs1 over the vector v and its position in imax
+template<typename VectorType>
+RealScalar abs1_max(const VectorType& v, int& imax)
+{
+  RealScalar res = -1;
+  for(int i=0; i<int(v.size()); ++i)
+  {
+    RealScalar a = abs1(v.coeff(i));
+    if(a>res) { res = a; imax = i; }
+  }
+  return res;
+}
+
+inline RealScalar bunch_kaufman_alpha()
+{
+  return (RealScalar(1) + std::sqrt(RealScalar(17))) / RealScalar(8);
+}
+
+// Unblocked factorization A = L*D*L^T of the lower triangular part of A (similar to xSYTF2).
+// Returns the LAPACK info code. The ipiv entries are 1-based and relative to A.
+int sytrf_lower_unblocked(MatrixType& A, int* ipiv)
+{
+  const RealScalar alpha = bunch_kaufman_alpha();
+  const int n = int(A.rows());
+  int info = 0;
+  Matrix<Scalar,Dynamic,2> W;
+
+  int k = 0;
+  while(k<n)
+  {
+    int kstep = 1;
+    int kp = k;
+    RealScalar absakk = abs1(A(k,k));
+    int imax = k;
+    RealScalar colmax = 0;
+    if(k<n-1)
+    {
+      colmax = abs1_max(A.col(k).tail(n-k-1), imax);
+      imax += k+1;
+    }
+
+    if(numext::maxi(absakk,colmax)==RealScalar(0))
+    {
+      // column k is zero: set info and continue
+      if(info==0) info = k+1;
+    }
+    else
+    {
+      if(absakk<alpha*colmax)
+      {
+        // largest off-diagonal entry in row imax
+        int jmax;
+        RealScalar rowmax = abs1_max(A.row(imax).segment(k,imax-k), jmax);
+        if(imax<n-1)
+          rowmax = numext::maxi(rowmax, abs1_max(A.col(imax).tail(n-imax-1), jmax));
+
+        if(absakk>=alpha*colmax*(colmax/rowmax))        kp = k;
+        else if(abs1(A(imax,imax))>=alpha*rowmax)       kp = imax;
+        else                                            { kp = imax; kstep = 2; }
+      }
+
+      int kk = k + kstep - 1;
+      if(kp!=kk)
+      {
+        // interchange rows and columns kk and kp in the trailing submatrix
+        if(kp<n-1)
+          A.col(kk).tail(n-kp-1).swap(A.col(kp).tail(n-kp-1));
+        A.col(kk).segment(kk+1,kp-kk-1).swap(A.row(kp).segment(kk+1,kp-kk-1).transpose());
+        std::swap(A(kk,kk), A(kp,kp));
+        if(kstep==2)
+          std::swap(A(k+1,k), A(kp,k));
+      }
+
+      if(kstep==1)
+      {
+        // rank-1 update of the trailing submatrix and column k of L
+        if(k<n-1)
+        {
+          int rs = n-k-1;
+          Scalar r1 = Scalar(1)/A(k,k);
+          A.bottomRightCorner(rs,rs).triangularView<Lower>() -= r1 * A.col(k).tail(rs) * A.col(k).tail(rs).transpose();
+          A.col(k).tail(rs) *= r1;
+        }
+      }
+      else
+      {
+        // rank-2 update of the trailing submatrix and columns k and k+1 of L
+        if(k<n-2)
+        {
+          int rs = n-k-2;
+          if(W.rows()==0)
+            W.resize(n,2);
+          Scalar d21 = A(k+1,k);
+          Scalar d11 = A(k+1,k+1) / d21;
+          Scalar d22 = A(k,k) / d21;
+          Scalar t = Scalar(1) / (d11*d22 - Scalar(1));
+          d21 = t / d21;
+          Block<MatrixType> C(A, k+2, k, rs, 2);
+          W.col(0).head(rs) = d21 * (d11 * C.col(0) - C.col(1));
+          W.col(1).head(rs) = d21 * (d22 * C.col(1) - C.col(0));
+          A.bottomRightCorner(rs,rs).triangularView<Lower>() -= C * W.topRows(rs).transpose();
+          C = W.topRows(rs);
+        }
+      }
+    }
+
+    if(kstep==1)
+      ipiv[k] = kp+1;
+    else
+      ipiv[k] = ipiv[k+1] = -(kp+1);
+    k += kstep;
+  }
+  return info;
+}
+
+// Factorizes at most nb-1 columns of A using the left-looking Bunch-Kaufman algorithm (similar to xLASYF),
+// and updates the trailing submatrix using a level-3 product. W is a n-by-nb workspace.
+// The number of factorized columns is returned in kb.
+int sytrf_lower_panel(MatrixType& A, int nb, int* ipiv, MatrixType& W, int& kb)
+{
+  const RealScalar alpha = bunch_kaufman_alpha();
+  const int n = int(A.rows());
+  int info = 0;
+
+  int k = 0;
+  while(k<nb-1 && k<n)
+  {
+    int kstep = 1;
+    int kp = k;
+
+    // update column k
+    W.col(k).tail(n-k) = A.col(k).tail(n-k);
+    W.col(k).tail(n-k).noalias() -= A.block(k,0,n-k,k) * W.row(k).head(k).transpose();
+
+    RealScalar absakk = abs1(W(k,k));
+    int imax = k;
+    RealScalar colmax = 0;
+    if(k<n-1)
+    {
+      colmax = abs1_max(W.col(k).tail(n-k-1), imax);
+      imax += k+1;
+    }
+
+    if(numext::maxi(absakk,colmax)==RealScalar(0))
+    {
+      // column k is zero: set info and continue
+      if(info==0) info = k+1;
+      A.col(k).tail(n-k) = W.col(k).tail(n-k);
+    }
+    else
+    {
+      if(absakk<alpha*colmax)
+      {
+        // copy column imax to column k+1 of W and update it
+        W.col(k+1).segment(k,imax-k) = A.row(imax).segment(k,imax-k).transpose();
+        W.col(k+1).tail(n-imax) = A.col(imax).tail(n-imax);
+        W.col(k+1).tail(n-k).noalias() -= A.block(k,0,n-k,k) * W.row(imax).head(k).transpose();
+
+        // largest off-diagonal entry in row imax
+        int jmax;
+        RealScalar rowmax = abs1_max(W.col(k+1).segment(k,imax-k), jmax);
+        if(imax<n-1)
+          rowmax = numext::maxi(rowmax, abs1_max(W.col(k+1).tail(n-imax-1), jmax));
+
+        if(absakk>=alpha*colmax*(colmax/rowmax))
+        {
+          kp = k;
+        }
+        else if(abs1(W(imax,k+1))>=alpha*rowmax)
+        {
+          kp = imax;
+          W.col(k).tail(n-k) = W.col(k+1).tail(n-k);
+        }
+        else
+        {
+          kp = imax;
+          kstep = 2;
+        }
+      }
+
+      int kk = k + kstep - 1;
+      if(kp!=kk)
+      {
+        // copy the non-updated column kk to column kp
+        A(kp,kp) = A(kk,kk);
+        A.row(kp).segment(kk+1,kp-kk-1) = A.col(kk).segment(kk+1,kp-kk-1).transpose();
+        if(kp<n-1)
+          A.col(kp).tail(n-kp-1) = A.col(kk).tail(n-kp-1);
+        // interchange rows kk and kp in the first k columns of A and the first kk+1 columns of W
+        A.row(kk).head(k).swap(A.row(kp).head(k));
+        W.row(kk).head(kk+1).swap(W.row(kp).head(kk+1));
+      }
+
+      if(kstep==1)
+      {
+        A.col(k).tail(n-k) = W.col(k).tail(n-k);
+        if(k<n-1)
+          A.col(k).tail(n-k-1) *= Scalar(1)/A(k,k);
+      }
+      else
+      {
+        if(k<n-2)
+        {
+          int rs = n-k-2;
+          Scalar d21 = W(k+1,k);
+          Scalar d11 = W(k+1,k+1) / d21;
+          Scalar d22 = W(k,k) / d21;
+          Scalar t = Scalar(1) / (d11*d22 - Scalar(1));
+          d21 = t / d21;
+          A.col(k).tail(rs)   = d21 * (d11 * W.col(k).tail(rs) - W.col(k+1).tail(rs));
+          A.col(k+1).tail(rs) = d21 * (d22 * W.col(k+1).tail(rs) - W.col(k).tail(rs));
+        }
+        A(k,k)     = W(k,k);
+        A(k+1,k)   = W(k+1,k);
+        A(k+1,k+1) = W(k+1,k+1);
+      }
+    }
+
+    if(kstep==1)
+      ipiv[k] = kp+1;
+    else
+      ipiv[k] = ipiv[k+1] = -(kp+1);
+    k += kstep;
+  }
+  kb = k;
+
+  // update the lower triangle of the trailing submatrix
+  int rs = n-kb;
+  if(rs>0)
+    A.bottomRightCorner(rs,rs).triangularView<Lower>() -= A.block(kb,0,rs,kb) * W.block(kb,0,rs,kb).transpose();
+
+  // put L21 in the LAPACK form by partially undoing the interchanges of the first kb columns
+  int j = kb-1;
+  while(j>=0)
+  {
+    int jj = j;
+    int jp = ipiv[j];
+    if(jp<0)
+    {
+      jp = -jp;
+      --j;
+    }
+    --jp;
+    --j;
+    if(jp!=jj && j>=0)
+      A.row(jp).head(j+1).swap(A.row(jj).head(j+1));
+  }
+
+  return info;
+}
+
+// Blocked Bunch-Kaufman factorization of the lower triangular part of A (similar to xSYTRF).
+// work must hold n*nb scalars, nb<2 means unblocked.
+int sytrf_lower(MatrixType& A, int* ipiv, Scalar* work, int nb)
+{
+  const int n = int(A.rows());
+  int info = 0;
+  int k = 0;
+  while(k<n)
+  {
+    int kb, iinfo;
+    MatrixType A22(&A.coeffRef(k,k), n-k, n-k, OuterStride<>(A.outerStride()));
+    if(nb>=2 && n-k>nb)
+    {
+      MatrixType W(work, n-k, nb, OuterStride<>(n-k));
+      iinfo = sytrf_lower_panel(A22, nb, ipiv+k, W, kb);
+    }
+    else
+    {
+      iinfo = sytrf_lower_unblocked(A22, ipiv+k);
+      kb = n-k;
+    }
+    if(info==0 && iinfo>0)
+      info = iinfo + k;
+
+    // adjust the pivot indices
+    for(int j=k; j<k+kb; ++j)
+      ipiv[j] += ipiv[j]>0 ? k : -k;
+    k += kb;
+  }
+  return info;
+}
+
+// solves D*X = B in place for the 2x2 diagonal block D = [d11 d21; d21 d22] and the two rows X of B
+template<typename RowsType>
+void sytrs_solve_2x2(const Scalar& d11, const Scalar& d21, const Scalar& d22, RowsType X)
+{
+  Scalar akm1 = d11 / d21;
+  Scalar ak = d22 / d21;
+  Scalar denom = akm1*ak - Scalar(1);
+  for(int j=0; j<int(X.cols()); ++j)
+  {
+    Scalar bkm1 = X(0,j) / d21;
+    Scalar bk = X(1,j) / d21;
+    X(0,j) = (ak*bkm1 - bk) / denom;
+    X(1,j) = (akm1*bk - bkm1) / denom;
+  }
+}
+
+}
+
+// SYTRF computes the factorization of a symmetric matrix A using the Bunch-Kaufman diagonal pivoting method:
+//    A = U*D*U^T  or  A = L*D*L^T
+EIGEN_LAPACK_FUNC(sytrf,(char *uplo, int *n, Scalar *a, int *lda, int *ipiv, Scalar *work, int *lwork, int *info))
+{
+  const int blockSize = 64;
+  bool query_size = *lwork==-1;
+
+  *info = 0;
+        if(UPLO(*uplo)==INVALID)              *info = -1;
+  else  if(*n<0)                              *info = -2;
+  else  if(*lda<std::max(1,*n))               *info = -4;
+  else  if((!query_size) && *lwork<1)         *info = -7;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"SYTRF", &e, 6);
+  }
+
+  if(query_size)
+  {
+    work[0] = Scalar(std::max(1,*n*blockSize));
+    return 0;
+  }
+
+  if(*n==0)
+    return 0;
+
+  // use the largest block size allowed by the provided workspace
+  int nb = std::min(blockSize, *lwork / *n);
+
+  MatrixType A(a,*n,*n,*lda);
+  if(UPLO(*uplo)==LO)
+  {
+    *info = sytrf_lower(A, ipiv, work, nb);
+  }
+  else
+  {
+    // U*D*U^T = J*(L*D*L^T)*J where J is the reversal permutation and L*D*L^T the
+    // factorization of J*A*J whose lower triangular part is the upper part of A.
+    A.reverseInPlace();
+    int ret = sytrf_lower(A, ipiv, work, nb);
+    A.reverseInPlace();
+
+    make_vector(ipiv,*n).reverseInPlace();
+    for(int i=0; i<*n; ++i)
+      ipiv[i] = ipiv[i]>0 ? *n+1-ipiv[i] : -(*n+1+ipiv[i]);
+    if(ret>0)
+      *info = *n+1-ret;
+  }
+
+  return 0;
+}
+
+// SYTRS solves a system of linear equations A*X = B with a symmetric matrix A using the factorization
+// A = U*D*U^T or A = L*D*L^T computed by SYTRF.
+EIGEN_LAPACK_FUNC(sytrs,(char *uplo, int *n, int *nrhs, Scalar *a, int *lda, int *ipiv, Scalar *b, int *ldb, int *info))
+{
+  *info = 0;
+        if(UPLO(*uplo)==INVALID)              *info = -1;
+  else  if(*n<0)                              *info = -2;
+  else  if(*nrhs<0)                           *info = -3;
+  else  if(*lda<std::max(1,*n))               *info = -5;
+  else  if(*ldb<std::max(1,*n))               *info = -8;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"SYTRS", &e, 6);
+  }
+
+  if(*n==0 || *nrhs==0)
+    return 0;
+
+  const int N = *n;
+  MatrixType A(a,N,N,*lda);
+  MatrixType B(b,N,*nrhs,*ldb);
+
+  if(UPLO(*uplo)==UP)
+  {
+    // solve U*D*X = B
+    int k = N-1;
+    while(k>=0)
+    {
+      if(ipiv[k]>0)
+      {
+        int kp = ipiv[k]-1;
+        if(kp!=k) B.row(k).swap(B.row(kp));
+        B.topRows(k).noalias() -= A.col(k).head(k) * B.row(k);
+        B.row(k) /= A(k,k);
+        k -= 1;
+      }
+      else
+      {
+        int kp = -ipiv[k]-1;
+        if(kp!=k-1) B.row(k-1).swap(B.row(kp));
+        B.topRows(k-1).noalias() -= A.block(0,k-1,k-1,2) * B.middleRows(k-1,2);
+        sytrs_solve_2x2(A(k-1,k-1), A(k-1,k), A(k,k), B.middleRows(k-1,2));
+        k -= 2;
+      }
+    }
+
+    // solve U^T*X = B
+    k = 0;
+    while(k<N)
+    {
+      if(ipiv[k]>0)
+      {
+        B.row(k).noalias() -= A.col(k).head(k).transpose() * B.topRows(k);
+        int kp = ipiv[k]-1;
+        if(kp!=k) B.row(k).swap(B.row(kp));
+        k += 1;
+      }
+      else
+      {
+        B.middleRows(k,2).noalias() -= A.block(0,k,k,2).transpose() * B.topRows(k);
+        int kp = -ipiv[k]-1;
+        if(kp!=k) B.row(k).swap(B.row(kp));
+        k += 2;
+      }
+    }
+  }
+  else
+  {
+    // solve L*D*X = B
+    int k = 0;
+    while(k<N)
+    {
+      if(ipiv[k]>0)
+      {
+        int kp = ipiv[k]-1;
+        if(kp!=k) B.row(k).swap(B.row(kp));
+        B.bottomRows(N-k-1).noalias() -= A.col(k).tail(N-k-1) * B.row(k);
+        B.row(k) /= A(k,k);
+        k += 1;
+      }
+      else
+      {
+        int kp = -ipiv[k]-1;
+        if(kp!=k+1) B.row(k+1).swap(B.row(kp));
+        B.bottomRows(N-k-2).noalias() -= A.block(k+2,k,N-k-2,2) * B.middleRows(k,2);
+        sytrs_solve_2x2(A(k,k), A(k+1,k), A(k+1,k+1), B.middleRows(k,2));
+        k += 2;
+      }
+    }
+
+    // solve L^T*X = B
+    k = N-1;
+    while(k>=0)
+    {
+      if(ipiv[k]>0)
+      {
+        B.row(k).noalias() -= A.col(k).tail(N-k-1).transpose() * B.bottomRows(N-k-1);
+        int kp = ipiv[k]-1;
+        if(kp!=k) B.row(k).swap(B.row(kp));
+        k -= 1;
+      }
+      else
+      {
+        B.middleRows(k-1,2).noalias() -= A.block(k+1,k-1,N-k-1,2).transpose() * B.bottomRows(N-k-1);
+        int kp = -ipiv[k]-1;
+        if(kp!=k) B.row(k).swap(B.row(kp));
+        k -= 2;
+      }
+    }
+  }
+
+  return 0;
+}
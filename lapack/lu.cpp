@@ -87,3 +87,28 @@ EIGEN_LAPACK_FUNC(getrs,(char *trans, int *n, int *nrhs, RealScalar *pa, int *ld
 
   return 0;
 }
+
+// GESV computes the solution to a system of linear equations A * X = B,
+// where A is an N-by-N matrix, using the LU decomposition with partial pivoting.
+EIGEN_LAPACK_FUNC(gesv,(int *n, int *nrhs, RealScalar *pa, int *lda, int *ipiv, RealScalar *pb, int *ldb, int *info))
+{
+  *info = 0;
+        if(*n<0)                         *info = -1;
+  else  if(*nrhs<0)                      *info = -2;
+  else  if(*lda<std::max(1,*n))          *info = -4;
+  else  if(*ldb<std::max(1,*n))          *info = -7;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"GESV ", &e, 6);
+  }
+
+  EIGEN_BLAS_FUNC(getrf)(n, n, pa, lda, ipiv, info);
+  if(*info==0)
+  {
+    char trans = 'N';
+    EIGEN_BLAS_FUNC(getrs)(&trans, n, nrhs, pa, lda, ipiv, pb, ldb, info);
+  }
+
+  return 0;
+}
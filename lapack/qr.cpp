@@ -0,0 +1,229 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "lapack_common.h"
+#include <Eigen/QR>
+
+// Computes in place the blocked Householder QR factorization of A.
+// On output, the Householder coefficients follow the LAPACK convention, that is
+// Q = H(1) H(2) ... H(k) with H(i) = I - tau(i) v v^H.
+// tempData must be able to hold A.cols() scalars.
+template<typename MatrixQR>
+static void lapack_householder_qr(MatrixQR& A, CompactVectorType& tau, Scalar* tempData)
+{
+  internal::householder_qr_inplace_blocked<MatrixQR,CompactVectorType>::run(A, tau, 48, tempData);
+  // Eigen's coefficients are the conjugates of LAPACK ones
+  if(IsComplex)
+    tau = tau.conjugate();
+}
+
+// Overwrites dst with Q*dst or Q^H*dst where Q = H(1) H(2) ... H(k) is given by the Householder
+// vectors and coefficients in the LAPACK convention. workspace must be able to hold dst.cols() scalars.
+template<typename VectorsType, typename Dest>
+static void lapack_apply_householder_on_the_left(const VectorsType& vectors, const CompactVectorType& tau, bool adjoint,
+                                                 Dest& dst, Scalar* workspace)
+{
+  Map<Matrix<Scalar,1,Dynamic> > ws(workspace, dst.cols());
+  // Note that HouseholderSequence::transpose() only reverses the order of the reflectors
+  if(adjoint) householderSequence(vectors, tau.conjugate()).transpose().applyThisOnTheLeft(dst, ws);
+  else        householderSequence(vectors, tau).applyThisOnTheLeft(dst, ws);
+}
+
+// GEQRF computes a QR factorization of a general M-by-N matrix A: A = Q * R.
+EIGEN_LAPACK_FUNC(geqrf,(int *m, int *n, Scalar *a, int *lda, Scalar *tau, Scalar *work, int *lwork, int *info))
+{
+  bool query_size = *lwork==-1;
+
+  *info = 0;
+        if(*m<0)                                        *info = -1;
+  else  if(*n<0)                                        *info = -2;
+  else  if(*lda<std::max(1,*m))                         *info = -4;
+  else  if((!query_size) && *lwork<std::max(1,*n))      *info = -7;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"GEQRF", &e, 6);
+  }
+
+  if(query_size)
+  {
+    work[0] = Scalar(std::max(1,*n));
+    return 0;
+  }
+
+  int size = std::min(*m,*n);
+  if(size==0)
+    return 0;
+
+  MatrixType A(a,*m,*n,*lda);
+  CompactVectorType hcoeffs(tau,size);
+  lapack_householder_qr(A, hcoeffs, work);
+
+  return 0;
+}
+
+// Overwrites the general M-by-N matrix C with Q*C, Q^H*C, C*Q or C*Q^H,
+// where Q is the product of the K elementary reflectors returned by GEQRF.
+static int lapack_apply_qr_q(char *side, char *trans, int *m, int *n, int *k, Scalar *a, int *lda, Scalar *tau,
+                             Scalar *c, int *ldc, Scalar *work, int *lwork, int *info, const char* name)
+{
+  bool query_size = *lwork==-1;
+  int nq = SIDE(*side)==LEFT ? *m : *n;
+  int nw = SIDE(*side)==LEFT ? *n : *m;
+
+  *info = 0;
+        if(SIDE(*side)==INVALID)                                    *info = -1;
+  else  if(OP(*trans)==INVALID || (OP(*trans)==TR && IsComplex)
+                               || (OP(*trans)==ADJ && !IsComplex))  *info = -2;
+  else  if(*m<0)                                                    *info = -3;
+  else  if(*n<0)                                                    *info = -4;
+  else  if(*k<0 || *k>nq)                                           *info = -5;
+  else  if(*lda<std::max(1,nq))                                     *info = -7;
+  else  if(*ldc<std::max(1,*m))                                     *info = -10;
+  else  if((!query_size) && *lwork<std::max(1,nw))                  *info = -12;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(name, &e, 6);
+  }
+
+  if(query_size)
+  {
+    work[0] = Scalar(std::max(1,nw));
+    return 0;
+  }
+
+  if(*m==0 || *n==0 || *k==0)
+    return 0;
+
+  MatrixType A(a,nq,*k,*lda);
+  MatrixType C(c,*m,*n,*ldc);
+  CompactVectorType hcoeffs(tau,*k);
+
+  if(SIDE(*side)==LEFT)
+  {
+    lapack_apply_householder_on_the_left(A, hcoeffs, OP(*trans)!=NOTR, C, work);
+  }
+  else
+  {
+    // C * op(Q) = (op(Q)^H * C^H)^H
+    if(IsComplex) C = C.conjugate();
+    Transpose<MatrixType> Ch(C);
+    lapack_apply_householder_on_the_left(A, hcoeffs, OP(*trans)==NOTR, Ch, work);
+    if(IsComplex) C = C.conjugate();
+  }
+
+  return 0;
+}
+
+#if ISCOMPLEX
+// UNMQR overwrites the general M-by-N matrix C with Q*C, Q^H*C, C*Q or C*Q^H.
+EIGEN_LAPACK_FUNC(unmqr,(char *side, char *trans, int *m, int *n, int *k, Scalar *a, int *lda, Scalar *tau,
+                         Scalar *c, int *ldc, Scalar *work, int *lwork, int *info))
+{
+  return lapack_apply_qr_q(side, trans, m, n, k, a, lda, tau, c, ldc, work, lwork, info, SCALAR_SUFFIX_UP"UNMQR");
+}
+#else
+// ORMQR overwrites the general M-by-N matrix C with Q*C, Q^T*C, C*Q or C*Q^T.
+EIGEN_LAPACK_FUNC(ormqr,(char *side, char *trans, int *m, int *n, int *k, Scalar *a, int *lda, Scalar *tau,
+                         Scalar *c, int *ldc, Scalar *work, int *lwork, int *info))
+{
+  return lapack_apply_qr_q(side, trans, m, n, k, a, lda, tau, c, ldc, work, lwork, info, SCALAR_SUFFIX_UP"ORMQR");
+}
+#endif
+
+// Solves the least squares or minimum norm problem for the p-by-q matrix M (p>=q),
+// where M is either A or A^H. If overdetermined is true, then B is overwritten by the
+// solution of min || M X - B ||, otherwise B is overwritten by the minimum norm solution of M^H X = B.
+template<typename MatrixQR>
+static int lapack_gels_impl(MatrixQR& M, bool overdetermined, Scalar *b, int ldb, int nrhs, Scalar *work)
+{
+  int p = int(M.rows());
+  int q = int(M.cols());
+  CompactVectorType tau(work,q);
+  MatrixType B(b,p,nrhs,ldb);
+
+  lapack_householder_qr(M, tau, work+q);
+
+  for(int i=0; i<q; ++i)
+    if(M(i,i)==Scalar(0))
+      return i+1;
+
+  if(overdetermined)
+  {
+    lapack_apply_householder_on_the_left(M, tau, true, B, work+q);
+    M.topLeftCorner(q,q).template triangularView<Upper>().solveInPlace(B.topRows(q));
+  }
+  else
+  {
+    M.topLeftCorner(q,q).template triangularView<Upper>().adjoint().solveInPlace(B.topRows(q));
+    B.bottomRows(p-q).setZero();
+    lapack_apply_householder_on_the_left(M, tau, false, B, work+q);
+  }
+  return 0;
+}
+
+// GELS solves overdetermined or underdetermined linear systems involving an M-by-N matrix A,
+// or its (conjugate-)transpose, using a QR or LQ factorization of A.
+// It is assumed that A has full rank. On exit, A holds the factorization as returned by GEQRF
+// if M>=N, and by GELQF otherwise.
+EIGEN_LAPACK_FUNC(gels,(char *trans, int *m, int *n, int *nrhs, Scalar *a, int *lda, Scalar *b, int *ldb,
+                        Scalar *work, int *lwork, int *info))
+{
+  bool query_size = *lwork==-1;
+  int mn = std::min(*m,*n);
+  int wsize = std::max(1, mn + std::max(mn,*nrhs));
+
+  *info = 0;
+        if(OP(*trans)==INVALID || (OP(*trans)==TR && IsComplex)
+                               || (OP(*trans)==ADJ && !IsComplex))  *info = -1;
+  else  if(*m<0)                                                    *info = -2;
+  else  if(*n<0)                                                    *info = -3;
+  else  if(*nrhs<0)                                                 *info = -4;
+  else  if(*lda<std::max(1,*m))                                     *info = -6;
+  else  if(*ldb<std::max(1,std::max(*m,*n)))                        *info = -8;
+  else  if((!query_size) && *lwork<wsize)                           *info = -10;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"GELS ", &e, 6);
+  }
+
+  if(query_size)
+  {
+    work[0] = Scalar(wsize);
+    return 0;
+  }
+
+  if(mn==0 || *nrhs==0)
+  {
+    matrix(b,std::max(*m,*n),*nrhs,*ldb).setZero();
+    return 0;
+  }
+
+  bool notrans = OP(*trans)==NOTR;
+  if(*m>=*n)
+  {
+    // QR factorization of A
+    MatrixType A(a,*m,*n,*lda);
+    *info = lapack_gels_impl(A, notrans, b, *ldb, *nrhs, work);
+  }
+  else
+  {
+    // QR factorization of A^H, that is the LQ factorization of A,
+    // which is computed in place through a row-major view of A.
+    // Conjugating back leaves A in the layout of GELQF: L in the lower triangle, and the
+    // conjugates of the Householder vectors of Q = H(k)^H ... H(1)^H in the rows above it.
+    typedef Map<Matrix<Scalar,Dynamic,Dynamic,RowMajor>, 0, OuterStride<> > RowMajorMatrixType;
+    RowMajorMatrixType Ah(a,*n,*m,OuterStride<>(*lda));
+    if(IsComplex) Ah = Ah.conjugate();
+    *info = lapack_gels_impl(Ah, !notrans, b, *ldb, *nrhs, work);
+    if(IsComplex) Ah = Ah.conjugate();
+  }
+
+  return 0;
+}
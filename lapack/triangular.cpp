@@ -0,0 +1,68 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "lapack_common.h"
+
+template<int Mode>
+static void lapack_triangular_solve(const MatrixType& A, int op, MatrixType& B)
+{
+  if(op==NOTR)      A.triangularView<Mode>().solveInPlace(B);
+  else if(op==TR)   A.triangularView<Mode>().transpose().solveInPlace(B);
+  else              A.triangularView<Mode>().adjoint().solveInPlace(B);
+}
+
+// TRTRS solves a triangular system of the form A * X = B, A^T * X = B or A^H * X = B,
+// where A is a triangular matrix of order N.
+EIGEN_LAPACK_FUNC(trtrs,(char *uplo, char *trans, char *diag, int *n, int *nrhs, Scalar *a, int *lda, Scalar *b, int *ldb, int *info))
+{
+  *info = 0;
+        if(UPLO(*uplo)==INVALID)          *info = -1;
+  else  if(OP(*trans)==INVALID)           *info = -2;
+  else  if(DIAG(*diag)==INVALID)          *info = -3;
+  else  if(*n<0)                          *info = -4;
+  else  if(*nrhs<0)                       *info = -5;
+  else  if(*lda<std::max(1,*n))           *info = -7;
+  else  if(*ldb<std::max(1,*n))           *info = -9;
+  if(*info!=0)
+  {
+    int e = -*info;
+    return xerbla_(SCALAR_SUFFIX_UP"TRTRS", &e, 6);
+  }
+
+  if(*n==0)
+    return 0;
+
+  MatrixType A(a,*n,*n,*lda);
+  MatrixType B(b,*n,*nrhs,*ldb);
+
+  // check for singularity
+  if(DIAG(*diag)==NUNIT)
+  {
+    for(int i=0; i<*n; ++i)
+    {
+      if(A(i,i)==Scalar(0))
+      {
+        *info = i+1;
+        return 0;
+      }
+    }
+  }
+
+  int op = OP(*trans);
+  if(UPLO(*uplo)==UP)
+  {
+    if(DIAG(*diag)==UNIT) lapack_triangular_solve<UnitUpper>(A, op, B);
+    else                  lapack_triangular_solve<Upper>(A, op, B);
+  }
+  else
+  {
+    if(DIAG(*diag)==UNIT) lapack_triangular_solve<UnitLower>(A, op, B);
+    else                  lapack_triangular_solve<Lower>(A, op, B);
+  }
+
+  return 0;
+}
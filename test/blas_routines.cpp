@@ -0,0 +1,184 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Tests of the multi-threaded level-3 routines of Eigen's BLAS library against the Eigen products.
+// The problems are large enough to be split between several threads.
+
+#include "main.h"
+
+typedef std::complex<double> dcomplex;
+
+extern "C" {
+void eigen_blas_set_num_threads(int nbThreads);
+int eigen_blas_get_num_threads();
+int dgemm_(char *opa, char *opb, int *m, int *n, int *k, double *alpha, double *a, int *lda, double *b, int *ldb,
+           double *beta, double *c, int *ldc);
+int zgemm_(char *opa, char *opb, int *m, int *n, int *k, dcomplex *alpha, dcomplex *a, int *lda, dcomplex *b, int *ldb,
+           dcomplex *beta, dcomplex *c, int *ldc);
+int dsymm_(char *side, char *uplo, int *m, int *n, double *alpha, double *a, int *lda, double *b, int *ldb,
+           double *beta, double *c, int *ldc);
+int zhemm_(char *side, char *uplo, int *m, int *n, dcomplex *alpha, dcomplex *a, int *lda, dcomplex *b, int *ldb,
+           dcomplex *beta, dcomplex *c, int *ldc);
+int dsyrk_(char *uplo, char *op, int *n, int *k, double *alpha, double *a, int *lda, double *beta, double *c, int *ldc);
+int zherk_(char *uplo, char *op, int *n, int *k, double *alpha, dcomplex *a, int *lda, double *beta, dcomplex *c, int *ldc);
+int dsyr2k_(char *uplo, char *op, int *n, int *k, double *alpha, double *a, int *lda, double *b, int *ldb,
+            double *beta, double *c, int *ldc);
+int dtrmm_(char *side, char *uplo, char *opa, char *diag, int *m, int *n, double *alpha, double *a, int *lda, double *b, int *ldb);
+int ztrsm_(char *side, char *uplo, char *opa, char *diag, int *m, int *n, dcomplex *alpha, dcomplex *a, int *lda, dcomplex *b, int *ldb);
+}
+
+int gemm(char opa, char opb, int m, int n, int k, double alpha, double *a, int lda, double *b, int ldb, double beta, double *c, int ldc)
+{ return dgemm_(&opa, &opb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc); }
+int gemm(char opa, char opb, int m, int n, int k, dcomplex alpha, dcomplex *a, int lda, dcomplex *b, int ldb, dcomplex beta, dcomplex *c, int ldc)
+{ return zgemm_(&opa, &opb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc); }
+
+template<typename MatrixType>
+MatrixType op(const MatrixType& a, char op)
+{
+  if(op=='N') return a;
+  if(op=='T') return a.transpose();
+  return a.adjoint();
+}
+
+int random_size() { return internal::random<int>(200,300); }
+
+template<int N> char random_char(const char (&chars)[N]) { return chars[internal::random<int>(0,N-2)]; }
+
+template<typename Scalar> void blas_gemm()
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  int m = random_size(), n = random_size(), k = random_size();
+  char opa = NumTraits<Scalar>::IsComplex ? random_char("NTC") : random_char("NT");
+  char opb = NumTraits<Scalar>::IsComplex ? random_char("NTC") : random_char("NT");
+  Scalar alpha = internal::random<Scalar>(), beta = internal::random<Scalar>();
+  // the leading dimensions are larger than the number of rows
+  MatrixType a = MatrixType::Random(opa=='N' ? m+3 : k+3, opa=='N' ? k : m);
+  MatrixType b = MatrixType::Random(opb=='N' ? k+2 : n+2, opb=='N' ? n : k);
+  MatrixType c = MatrixType::Random(m+1, n);
+  MatrixType ref = c;
+  ref.topRows(m) = alpha * op(MatrixType(a.topRows(a.rows()-3)),opa) * op(MatrixType(b.topRows(b.rows()-2)),opb) + beta * c.topRows(m);
+  VERIFY_IS_EQUAL(gemm(opa, opb, m, n, k, alpha, a.data(), int(a.rows()), b.data(), int(b.rows()), beta, c.data(), int(c.rows())), 0);
+  VERIFY_IS_APPROX(c, ref);
+}
+
+template<typename Scalar> void blas_symm_hemm()
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  int m = random_size(), n = random_size();
+  char side = random_char("LR"), uplo = random_char("UL");
+  int size = side=='L' ? m : n;
+  Scalar alpha = internal::random<Scalar>(), beta = internal::random<Scalar>();
+  MatrixType a = MatrixType::Random(size, size), b = MatrixType::Random(m, n), c = MatrixType::Random(m, n);
+  a.diagonal() = a.diagonal().real().template cast<Scalar>();
+  MatrixType sa = uplo=='U' ? MatrixType(a.template selfadjointView<Upper>()) : MatrixType(a.template selfadjointView<Lower>());
+  MatrixType ref = (side=='L' ? MatrixType(alpha * sa * b) : MatrixType(alpha * b * sa)) + beta * c;
+  int lda = size, ldb = m, ldc = m;
+  if(NumTraits<Scalar>::IsComplex)
+    zhemm_(&side, &uplo, &m, &n, reinterpret_cast<dcomplex*>(&alpha), reinterpret_cast<dcomplex*>(a.data()), &lda,
+           reinterpret_cast<dcomplex*>(b.data()), &ldb, reinterpret_cast<dcomplex*>(&beta), reinterpret_cast<dcomplex*>(c.data()), &ldc);
+  else
+    dsymm_(&side, &uplo, &m, &n, reinterpret_cast<double*>(&alpha), reinterpret_cast<double*>(a.data()), &lda,
+           reinterpret_cast<double*>(b.data()), &ldb, reinterpret_cast<double*>(&beta), reinterpret_cast<double*>(c.data()), &ldc);
+  VERIFY_IS_APPROX(c, ref);
+}
+
+// checks the triangle uplo of c against ref, and that the other triangle is untouched
+template<typename MatrixType>
+void check_triangle(char uplo, const MatrixType& c, const MatrixType& ref, const MatrixType& c0)
+{
+  if(uplo=='U')
+  {
+    VERIFY_IS_APPROX(MatrixType(c.template triangularView<Upper>()), MatrixType(ref.template triangularView<Upper>()));
+    VERIFY_IS_EQUAL(MatrixType(c.template triangularView<StrictlyLower>()), MatrixType(c0.template triangularView<StrictlyLower>()));
+  }
+  else
+  {
+    VERIFY_IS_APPROX(MatrixType(c.template triangularView<Lower>()), MatrixType(ref.template triangularView<Lower>()));
+    VERIFY_IS_EQUAL(MatrixType(c.template triangularView<StrictlyUpper>()), MatrixType(c0.template triangularView<StrictlyUpper>()));
+  }
+}
+
+void blas_rankk()
+{
+  int n = random_size(), k = random_size();
+  char uplo = random_char("UL"), trans = random_char("NT");
+  double alpha = internal::random<double>(), beta = internal::random<double>();
+  MatrixXd a = trans=='N' ? MatrixXd::Random(n,k) : MatrixXd::Random(k,n);
+  MatrixXd b = MatrixXd::Random(a.rows(), a.cols());
+  MatrixXd c0 = MatrixXd::Random(n,n), c = c0;
+  int lda = int(a.rows()), ldc = n;
+
+  // syrk
+  MatrixXd ref = alpha * op(a,trans) * op(a,trans).transpose() + beta * c0;
+  dsyrk_(&uplo, &trans, &n, &k, &alpha, a.data(), &lda, &beta, c.data(), &ldc);
+  check_triangle(uplo, c, ref, c0);
+
+  // syr2k
+  c = c0;
+  ref = alpha * (op(a,trans) * op(b,trans).transpose() + op(b,trans) * op(a,trans).transpose()) + beta * c0;
+  dsyr2k_(&uplo, &trans, &n, &k, &alpha, a.data(), &lda, b.data(), &lda, &beta, c.data(), &ldc);
+  check_triangle(uplo, c, ref, c0);
+
+  // herk
+  trans = random_char("NC");
+  MatrixXcd za = trans=='N' ? MatrixXcd::Random(n,k) : MatrixXcd::Random(k,n);
+  MatrixXcd zc0 = MatrixXcd::Random(n,n);
+  zc0.diagonal().imag().setZero();
+  MatrixXcd zc = zc0;
+  MatrixXcd zref = alpha * op(za,trans) * op(za,trans).adjoint() + beta * zc0;
+  lda = int(za.rows());
+  zherk_(&uplo, &trans, &n, &k, &alpha, za.data(), &lda, &beta, zc.data(), &ldc);
+  check_triangle(uplo, zc, zref, zc0);
+}
+
+void blas_trmm_trsm()
+{
+  int m = random_size(), n = random_size();
+  char side = random_char("LR"), uplo = random_char("UL"), trans = random_char("NT"), diag = random_char("NU");
+  int size = side=='L' ? m : n, lda = size, ldb = m;
+  double alpha = internal::random<double>();
+
+  // trmm
+  MatrixXd a = MatrixXd::Random(size, size), b = MatrixXd::Random(m, n);
+  MatrixXd t = uplo=='U' ? MatrixXd(a.triangularView<Upper>()) : MatrixXd(a.triangularView<Lower>());
+  if(diag=='U')
+    t.diagonal().setOnes();
+  MatrixXd ref = side=='L' ? MatrixXd(alpha * op(t,trans) * b) : MatrixXd(alpha * b * op(t,trans));
+  dtrmm_(&side, &uplo, &trans, &diag, &m, &n, &alpha, a.data(), &lda, b.data(), &ldb);
+  VERIFY_IS_APPROX(b, ref);
+
+  // trsm, with a well conditioned triangular matrix
+  trans = random_char("NTC");
+  dcomplex zalpha = internal::random<dcomplex>();
+  MatrixXcd za = MatrixXcd::Random(size, size) / double(size);
+  za.diagonal().array() += dcomplex(1);
+  MatrixXcd zb = MatrixXcd::Random(m, n), zb0 = zb;
+  ztrsm_(&side, &uplo, &trans, &diag, &m, &n, &zalpha, za.data(), &lda, zb.data(), &ldb);
+  MatrixXcd zt = uplo=='U' ? MatrixXcd(za.triangularView<Upper>()) : MatrixXcd(za.triangularView<Lower>());
+  if(diag=='U')
+    zt.diagonal().setOnes();
+  MatrixXcd zres = side=='L' ? MatrixXcd(op(zt,trans) * zb) : MatrixXcd(zb * op(zt,trans));
+  VERIFY_IS_APPROX(zres, zalpha * zb0);
+}
+
+void test_blas_routines()
+{
+  // an odd number of threads, and more threads than cores
+  int threads = eigen_blas_get_num_threads();
+  eigen_blas_set_num_threads(internal::random<int>(0,1) ? 3 : 4);
+  for(int i = 0; i < g_repeat; i++)
+  {
+    CALL_SUBTEST_1( blas_gemm<double>() );
+    CALL_SUBTEST_1( blas_gemm<dcomplex>() );
+    CALL_SUBTEST_2( blas_symm_hemm<double>() );
+    CALL_SUBTEST_2( blas_symm_hemm<dcomplex>() );
+    CALL_SUBTEST_3( blas_rankk() );
+    CALL_SUBTEST_4( blas_trmm_trsm() );
+  }
+  eigen_blas_set_num_threads(0);
+  VERIFY_IS_EQUAL(eigen_blas_get_num_threads(), threads);
+}
@@ -18,17 +18,161 @@ template<typename T, typename I> void test_conjugate_gradient_T()
   ConjugateGradient<SparseMatrixType, Lower|Upper> cg_colmajor_loup_diag;
   ConjugateGradient<SparseMatrixType, Lower, IdentityPreconditioner> cg_colmajor_lower_I;
   ConjugateGradient<SparseMatrixType, Upper, IdentityPreconditioner> cg_colmajor_upper_I;
+  ConjugateGradient<SparseMatrixType, Lower|Upper, AlgebraicMultigridPreconditioner<T,I> > cg_colmajor_loup_amg;
+  PipelinedConjugateGradient<SparseMatrixType, Lower      > pcg_colmajor_lower_diag;
+  PipelinedConjugateGradient<SparseMatrixType, Lower|Upper> pcg_colmajor_loup_diag;
+  PipelinedConjugateGradient<SparseMatrixType, Upper, IdentityPreconditioner> pcg_colmajor_upper_I;
+  // the pipelined recurrences may stagnate slightly above the machine precision
+  pcg_colmajor_lower_diag.setTolerance(NumTraits<T>::dummy_precision());
+  pcg_colmajor_loup_diag.setTolerance(NumTraits<T>::dummy_precision());
+  pcg_colmajor_upper_I.setTolerance(NumTraits<T>::dummy_precision());
+  // enforce the construction of several levels
+  cg_colmajor_loup_amg.preconditioner().setMaxCoarseSize(10);
 
   CALL_SUBTEST( check_sparse_spd_solving(cg_colmajor_lower_diag)  );
   CALL_SUBTEST( check_sparse_spd_solving(cg_colmajor_upper_diag)  );
   CALL_SUBTEST( check_sparse_spd_solving(cg_colmajor_loup_diag)   );
   CALL_SUBTEST( check_sparse_spd_solving(cg_colmajor_lower_I)     );
   CALL_SUBTEST( check_sparse_spd_solving(cg_colmajor_upper_I)     );
+  CALL_SUBTEST( check_sparse_spd_solving(cg_colmajor_loup_amg)    );
+  CALL_SUBTEST( check_sparse_spd_solving(pcg_colmajor_lower_diag) );
+  CALL_SUBTEST( check_sparse_spd_solving(pcg_colmajor_loup_diag)  );
+  CALL_SUBTEST( check_sparse_spd_solving(pcg_colmajor_upper_I)    );
+}
+
+template<typename T> void test_conjugate_gradient_multiple_rhs()
+{
+  typedef SparseMatrix<T> SparseMatrixType;
+  typedef Matrix<T,Dynamic,Dynamic> DenseMatrix;
+  
+  SparseMatrixType A, halfA;
+  DenseMatrix dA;
+  ConjugateGradient<SparseMatrixType, Lower|Upper> cg;
+  Index size = generate_sparse_spd_problem(cg, A, halfA, dA, 300);
+  cg.setTolerance(typename NumTraits<T>::Real(1e-8));
+  cg.compute(A);
+  
+  // the columns are solved together, including a zero column and a duplicated one which are deflated
+  Index cols = internal::random<Index>(2,12);
+  DenseMatrix b = DenseMatrix::Random(size, cols);
+  b.col(0).setZero();
+  b.col(cols-1) = b.col(1);
+  DenseMatrix x = cg.solve(b);
+  VERIFY(cg.info() == Success);
+  VERIFY(x.col(0).isZero());
+  for(Index j=1; j<cols; ++j)
+  {
+    VERIFY((A*x.col(j)-b.col(j)).norm() <= typename NumTraits<T>::Real(1e-6)*b.col(j).norm());
+    Matrix<T,Dynamic,1> xj = cg.solve(b.col(j));
+    VERIFY_IS_APPROX(x.col(j), xj);
+  }
+
+  // tiny right hand sides, for which tol^2*|b|^2 underflows: the residuals are compared to an absolute floor
+  typedef typename NumTraits<T>::Real RealScalar;
+  const RealScalar considerAsZero = (std::numeric_limits<RealScalar>::min)();
+  cg.setTolerance(NumTraits<RealScalar>::epsilon());
+  DenseMatrix bs(size, cols);
+  for(Index j=0; j<cols; ++j)
+    bs.col(j) = RealScalar(1e-150) * b.col(1+j%(cols-1)).normalized();
+  DenseMatrix xs = cg.solve(bs);
+  VERIFY(cg.iterations() < cg.maxIterations());
+  for(Index j=0; j<cols; ++j)
+    VERIFY((A*xs.col(j)-bs.col(j)).squaredNorm() < considerAsZero);
+  // below the floor, the zero initial guess is already a solution
+  bs *= RealScalar(1e-5);
+  xs = cg.solve(bs);
+  VERIFY_IS_EQUAL(cg.iterations(), 0);
+  VERIFY(xs.isZero(0));
+}
+
+template<typename T> void test_conjugate_gradient_amg_poisson()
+{
+  typedef SparseMatrix<T> SparseMatrixType;
+  typedef Matrix<T,Dynamic,1> VectorType;
+  typedef typename NumTraits<T>::Real RealScalar;
+  typedef Triplet<T> TripletType;
+
+  // 5-point Laplacian on grids of growing size: the number of iterations should not grow with the size
+  for(Index m=16; m<=128; m*=2)
+  {
+    Index n = m*m;
+    std::vector<TripletType> triplets;
+    triplets.reserve(5*n);
+    for(Index i=0; i<m; ++i)
+      for(Index j=0; j<m; ++j)
+      {
+        Index k = i*m+j;
+        triplets.push_back(TripletType(k,k,T(4)));
+        if(i>0)   triplets.push_back(TripletType(k,k-m,T(-1)));
+        if(i<m-1) triplets.push_back(TripletType(k,k+m,T(-1)));
+        if(j>0)   triplets.push_back(TripletType(k,k-1,T(-1)));
+        if(j<m-1) triplets.push_back(TripletType(k,k+1,T(-1)));
+      }
+    SparseMatrixType A(n,n);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+
+    ConjugateGradient<SparseMatrixType, Lower|Upper, AlgebraicMultigridPreconditioner<T> > cg;
+    cg.setTolerance(RealScalar(1e-8));
+    cg.compute(A);
+    VERIFY(cg.info() == Success);
+    VectorType b = VectorType::Random(n);
+    VectorType x = cg.solve(b);
+    VERIFY(cg.info() == Success);
+    VERIFY((A*x-b).norm() <= RealScalar(1e-7)*b.norm());
+    VERIFY(cg.iterations() <= 25);
+  }
+
+  // without strong connections, the coarsening stops at once and the large coarsest level is only smoothed
+  Index n = 1000;
+  SparseMatrixType A(n,n);
+  A.reserve(VectorXi::Constant(n,3));
+  for(Index i=0; i<n; ++i)
+  {
+    A.insert(i,i) = T(internal::random<RealScalar>(1,2));
+    if(i>0)   A.insert(i,i-1) = T(0.01);
+    if(i<n-1) A.insert(i,i+1) = T(0.01);
+  }
+  ConjugateGradient<SparseMatrixType, Lower|Upper, AlgebraicMultigridPreconditioner<T> > cg(A);
+  VERIFY(cg.info() == Success);
+  VERIFY(cg.preconditioner().levels() == 1);
+  VectorType b = VectorType::Random(n);
+  VectorType x = cg.solve(b);
+  VERIFY(cg.info() == Success);
+  VERIFY((A*x-b).norm() <= RealScalar(1e-6)*b.norm());
+}
+
+template<typename T> void test_pipelined_conjugate_gradient_tiny_rhs()
+{
+  typedef SparseMatrix<T> SparseMatrixType;
+  typedef Matrix<T,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<T,Dynamic,1> DenseVector;
+  typedef typename NumTraits<T>::Real RealScalar;
+  using std::sqrt;
+
+  SparseMatrixType A, halfA;
+  DenseMatrix dA;
+  PipelinedConjugateGradient<SparseMatrixType, Lower|Upper> pcg;
+  Index size = generate_sparse_spd_problem(pcg, A, halfA, dA, 300);
+  pcg.setTolerance(RealScalar(1e-8));
+  pcg.compute(A);
+
+  // tol^2*|b|^2 underflows to zero, while |b|^2 is already below the absolute floor:
+  // the zero initial guess is a solution
+  const RealScalar considerAsZero = (std::numeric_limits<RealScalar>::min)();
+  DenseVector b = sqrt(considerAsZero) * RealScalar(1e-3) * DenseVector::Random(size).normalized();
+  DenseVector x = pcg.solve(b);
+  VERIFY_IS_EQUAL(pcg.iterations(), 0);
+  VERIFY(x.isZero(0));
 }
 
 void test_conjugate_gradient()
 {
   CALL_SUBTEST_1(( test_conjugate_gradient_T<double,int>() ));
+  CALL_SUBTEST_1(( test_conjugate_gradient_multiple_rhs<double>() ));
+  CALL_SUBTEST_1(( test_conjugate_gradient_amg_poisson<double>() ));
   CALL_SUBTEST_2(( test_conjugate_gradient_T<std::complex<double>, int>() ));
+  CALL_SUBTEST_2(( test_conjugate_gradient_multiple_rhs<std::complex<double> >() ));
+  CALL_SUBTEST_1(( test_pipelined_conjugate_gradient_tiny_rhs<double>() ));
+  CALL_SUBTEST_2(( test_pipelined_conjugate_gradient_tiny_rhs<std::complex<double> >() ));
   CALL_SUBTEST_3(( test_conjugate_gradient_T<double,long int>() ));
 }
@@ -253,6 +253,80 @@ template<typename Scalar> void quaternionAlignment(void){
   #endif
 }
 
+template<typename Scalar> void quaternionSets(Index n)
+{
+  typedef Quaternion<Scalar> Quaternionx;
+  typedef Matrix<Scalar,4,Dynamic> Quaternions;
+  typedef Matrix<Scalar,4,Dynamic,RowMajor> PlanarQuaternions;
+  typedef Matrix<Scalar,Dynamic,1> VectorX;
+
+  Quaternions a = Quaternions::Random(4,n), b = Quaternions::Random(4,n);
+  VectorX t = (VectorX::Random(n).array()+Scalar(1))/Scalar(2);
+  Scalar t0 = internal::random<Scalar>(0,1);
+  // close and opposite quaternions take the other branches of slerp
+  b.col(0) = a.col(0);
+  if(n>1) b.col(1) = -a.col(1);
+
+  Quaternions prod(4,n), normalized = a, slerp(4,n), slerp0(4,n);
+  for(Index j=0; j<n; ++j)
+  {
+    Quaternionx qa(a.col(j)), qb(b.col(j));
+    prod.col(j) = (qa*qb).coeffs();
+    normalized.col(j) = qa.normalized().coeffs();
+    Quaternionx na = qa.normalized(), nb = qb.normalized();
+    slerp.col(j) = na.slerp(t(j), nb).coeffs();
+    slerp0.col(j) = na.slerp(t0, nb).coeffs();
+  }
+
+  // one quaternion per column, and one coordinate per row
+  Quaternions res;
+  quaternionSetProduct(a, b, res);
+  VERIFY_IS_APPROX(res, prod);
+  PlanarQuaternions pa = a, pb = b, pres(4,n);
+  quaternionSetProduct(pa, pb, pres);
+  VERIFY_IS_APPROX(Quaternions(pres), prod);
+  quaternionSetProduct(a.rightCols(n/2), b.rightCols(n/2), res);
+  VERIFY_IS_APPROX(res, prod.rightCols(n/2));
+  // expressions without direct access, and a product in place
+  quaternionSetProduct(a*Scalar(1), b, res);
+  VERIFY_IS_APPROX(res, prod);
+  res = a;
+  quaternionSetProduct(res, b, res);
+  VERIFY_IS_APPROX(res, prod);
+
+  res = a;
+  quaternionSetNormalize(res);
+  VERIFY_IS_APPROX(res, normalized);
+  pres = a;
+  quaternionSetNormalize(pres);
+  VERIFY_IS_APPROX(Quaternions(pres), normalized);
+  res = a;
+  quaternionSetNormalize(res.leftCols(n/2));
+  VERIFY_IS_APPROX(res.leftCols(n/2), normalized.leftCols(n/2));
+  VERIFY_IS_EQUAL(res.rightCols(n-n/2), a.rightCols(n-n/2));
+
+  Quaternions na = normalized, nb = b;
+  quaternionSetNormalize(nb);
+  quaternionSetSlerp(t, na, nb, res);
+  VERIFY_IS_APPROX(res, slerp);
+  PlanarQuaternions pna = na, pnb = nb;
+  quaternionSetSlerp(t, pna, pnb, pres);
+  VERIFY_IS_APPROX(Quaternions(pres), slerp);
+  quaternionSetSlerp(t0, na, nb, res);
+  VERIFY_IS_APPROX(res, slerp0);
+  quaternionSetSlerp(t.transpose(), na, nb, na);
+  VERIFY_IS_APPROX(na, slerp);
+}
+
+// the sets of more than 1024 packets of quaternions are split between the threads
+template<typename Scalar> void quaternionSetsParallel(void)
+{
+  const int nbThreads = Eigen::nbThreads();
+  Eigen::setNbThreads(4);
+  quaternionSets<Scalar>(internal::random<Index>(20000,30000));
+  Eigen::setNbThreads(nbThreads);
+}
+
 template<typename PlainObjectType> void check_const_correctness(const PlainObjectType&)
 {
   // there's a lot that we can't test here while still having this test compile!
@@ -280,5 +354,9 @@ void test_geo_quaternion()
     CALL_SUBTEST_6(( quaternionAlignment<double>() ));
     CALL_SUBTEST_1( mapQuaternion<float>() );
     CALL_SUBTEST_2( mapQuaternion<double>() );
+    CALL_SUBTEST_1( quaternionSets<float>(internal::random<Index>(1,300)) );
+    CALL_SUBTEST_2( quaternionSets<double>(internal::random<Index>(1,300)) );
   }
+  CALL_SUBTEST_1( quaternionSetsParallel<float>() );
+  CALL_SUBTEST_2( quaternionSetsParallel<double>() );
 }
@@ -486,6 +486,73 @@ template<typename Scalar, int Dim, int Options> void transform_products()
   VERIFY_IS_APPROX((ac*p).matrix(), a_m*p_m);
 }
 
+template<typename Scalar, int Dim> void transform_point_sets(Index n)
+{
+  typedef Matrix<Scalar,Dim,Dynamic> Points;
+  typedef Matrix<Scalar,Dim,Dynamic,RowMajor> PlanarPoints;
+  typedef Transform<Scalar,Dim,Affine> Aff;
+  typedef Transform<Scalar,Dim,AffineCompact> AffC;
+
+  Aff a; a.linear().setRandom(); a.translation().setRandom();
+  AffC ac = a;
+  Points pts = Points::Random(Dim,n);
+  Points ref = (a.linear()*pts).colwise() + a.translation();
+
+  // interleaved (one point per column) and planar (one coordinate per row) storages
+  VERIFY_IS_APPROX(Points(a*pts), ref);
+  VERIFY_IS_APPROX(Points(ac*pts), ref);
+  PlanarPoints planar = pts;
+  PlanarPoints planarRes = a*planar;
+  VERIFY_IS_APPROX(Points(planarRes), ref);
+  VERIFY_IS_APPROX(Points(a*pts.leftCols(n/2)), ref.leftCols(n/2));
+
+  // points which are not contiguous
+  Matrix<Scalar,Dim+1,Dynamic> padded(Dim+1,n);
+  padded.template topRows<Dim>() = pts;
+  Map<Points,0,OuterStride<> > mapped(padded.data(), Dim, n, OuterStride<>(Dim+1));
+  VERIFY_IS_APPROX(Points(a*mapped), ref);
+
+  // a NaN point must not spread to its neighbours
+  Index k = internal::random<Index>(0,n-1);
+  pts.col(k).setConstant(std::numeric_limits<Scalar>::quiet_NaN());
+  Points res = a*pts;
+  VERIFY((res.col(k).array()!=res.col(k).array()).all());
+  res.col(k) = ref.col(k);
+  VERIFY_IS_APPROX(res, ref);
+}
+
+template<typename Scalar> void rotate_point_sets(Index n)
+{
+  typedef Matrix<Scalar,3,Dynamic> Points;
+  typedef Matrix<Scalar,3,Dynamic,RowMajor> PlanarPoints;
+
+  Quaternion<Scalar> q(Matrix<Scalar,4,1>::Random().normalized());
+  AngleAxis<Scalar> aa(q);
+  Points pts = Points::Random(3,n);
+  Points ref = q.toRotationMatrix()*pts;
+  PlanarPoints planar = pts;
+
+  VERIFY_IS_APPROX(Points(q*pts), ref);
+  VERIFY_IS_APPROX(Points(aa*pts), ref);
+  PlanarPoints planarRes = q*planar;
+  VERIFY_IS_APPROX(Points(planarRes), ref);
+  VERIFY_IS_APPROX(Points(q*pts.rightCols(n/2)), ref.rightCols(n/2));
+  Matrix<Scalar,3,3> m = pts.template leftCols<3>();
+  Matrix<Scalar,3,3> rotated = q*m;
+  VERIFY_IS_APPROX(rotated, ref.template leftCols<3>());
+}
+
+// the sets of more than 1024 packets of points are split between the threads
+template<typename Scalar> void point_sets_parallel()
+{
+  const int nbThreads = Eigen::nbThreads();
+  Eigen::setNbThreads(4);
+  transform_point_sets<Scalar,3>(internal::random<Index>(20000,30000));
+  transform_point_sets<Scalar,2>(internal::random<Index>(20000,30000));
+  rotate_point_sets<Scalar>(internal::random<Index>(20000,30000));
+  Eigen::setNbThreads(nbThreads);
+}
+
 void test_geo_transformations()
 {
   for(int i = 0; i < g_repeat; i++) {
@@ -512,5 +579,12 @@ void test_geo_transformations()
 
     CALL_SUBTEST_7(( transform_products<double,3,RowMajor|AutoAlign>() ));
     CALL_SUBTEST_7(( transform_products<float,2,AutoAlign>() ));
+
+    CALL_SUBTEST_8(( transform_point_sets<float,3>(internal::random<Index>(1,300)) ));
+    CALL_SUBTEST_8(( transform_point_sets<double,2>(internal::random<Index>(1,300)) ));
+    CALL_SUBTEST_8(( rotate_point_sets<float>(internal::random<Index>(3,300)) ));
+    CALL_SUBTEST_8(( rotate_point_sets<double>(internal::random<Index>(3,300)) ));
   }
+  CALL_SUBTEST_8(( point_sets_parallel<float>() ));
+  CALL_SUBTEST_8(( point_sets_parallel<double>() ));
 }
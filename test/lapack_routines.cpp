@@ -0,0 +1,490 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Tests of Eigen's LAPACK library against the Eigen decompositions
+
+#include "main.h"
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+
+typedef std::complex<double> dcomplex;
+
+extern "C" {
+int dgeqrf_(int *m, int *n, double *a, int *lda, double *tau, double *work, int *lwork, int *info);
+int zgeqrf_(int *m, int *n, dcomplex *a, int *lda, dcomplex *tau, dcomplex *work, int *lwork, int *info);
+int dormqr_(char *side, char *trans, int *m, int *n, int *k, double *a, int *lda, double *tau,
+            double *c, int *ldc, double *work, int *lwork, int *info);
+int zunmqr_(char *side, char *trans, int *m, int *n, int *k, dcomplex *a, int *lda, dcomplex *tau,
+            dcomplex *c, int *ldc, dcomplex *work, int *lwork, int *info);
+int dsyev_(char *jobz, char *uplo, int *n, double *a, int *lda, double *w, double *work, int *lwork, int *info);
+int dsyevd_(char *jobz, char *uplo, int *n, double *a, int *lda, double *w, double *work, int *lwork,
+            int *iwork, int *liwork, int *info);
+int dsyevr_(char *jobz, char *range, char *uplo, int *n, double *a, int *lda, double *vl, double *vu, int *il, int *iu,
+            double *abstol, int *m, double *w, double *z, int *ldz, int *isuppz, double *work, int *lwork,
+            int *iwork, int *liwork, int *info);
+int dsytrf_(char *uplo, int *n, double *a, int *lda, int *ipiv, double *work, int *lwork, int *info);
+int zsytrf_(char *uplo, int *n, dcomplex *a, int *lda, int *ipiv, dcomplex *work, int *lwork, int *info);
+int dsytrs_(char *uplo, int *n, int *nrhs, double *a, int *lda, int *ipiv, double *b, int *ldb, int *info);
+int zsytrs_(char *uplo, int *n, int *nrhs, dcomplex *a, int *lda, int *ipiv, dcomplex *b, int *ldb, int *info);
+int dgesv_(int *n, int *nrhs, double *a, int *lda, int *ipiv, double *b, int *ldb, int *info);
+int zgesv_(int *n, int *nrhs, dcomplex *a, int *lda, int *ipiv, dcomplex *b, int *ldb, int *info);
+int dtrtrs_(char *uplo, char *trans, char *diag, int *n, int *nrhs, double *a, int *lda, double *b, int *ldb, int *info);
+int ztrtrs_(char *uplo, char *trans, char *diag, int *n, int *nrhs, dcomplex *a, int *lda, dcomplex *b, int *ldb, int *info);
+int dgels_(char *trans, int *m, int *n, int *nrhs, double *a, int *lda, double *b, int *ldb, double *work, int *lwork, int *info);
+int zgels_(char *trans, int *m, int *n, int *nrhs, dcomplex *a, int *lda, dcomplex *b, int *ldb, dcomplex *work, int *lwork, int *info);
+}
+
+int geqrf(int m, int n, double *a, int lda, double *tau, double *work, int lwork)
+{ int info; dgeqrf_(&m, &n, a, &lda, tau, work, &lwork, &info); return info; }
+int geqrf(int m, int n, dcomplex *a, int lda, dcomplex *tau, dcomplex *work, int lwork)
+{ int info; zgeqrf_(&m, &n, a, &lda, tau, work, &lwork, &info); return info; }
+int unmqr(char side, char trans, int m, int n, int k, double *a, int lda, double *tau, double *c, int ldc, double *work, int lwork)
+{ int info; dormqr_(&side, &trans, &m, &n, &k, a, &lda, tau, c, &ldc, work, &lwork, &info); return info; }
+int unmqr(char side, char trans, int m, int n, int k, dcomplex *a, int lda, dcomplex *tau, dcomplex *c, int ldc, dcomplex *work, int lwork)
+{ int info; zunmqr_(&side, &trans, &m, &n, &k, a, &lda, tau, c, &ldc, work, &lwork, &info); return info; }
+int sytrf(char uplo, int n, double *a, int lda, int *ipiv, double *work, int lwork)
+{ int info; dsytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info); return info; }
+int sytrf(char uplo, int n, dcomplex *a, int lda, int *ipiv, dcomplex *work, int lwork)
+{ int info; zsytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info); return info; }
+int sytrs(char uplo, int n, int nrhs, double *a, int lda, int *ipiv, double *b, int ldb)
+{ int info; dsytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info); return info; }
+int sytrs(char uplo, int n, int nrhs, dcomplex *a, int lda, int *ipiv, dcomplex *b, int ldb)
+{ int info; zsytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info); return info; }
+int gesv(int n, int nrhs, double *a, int lda, int *ipiv, double *b, int ldb)
+{ int info; dgesv_(&n, &nrhs, a, &lda, ipiv, b, &ldb, &info); return info; }
+int gesv(int n, int nrhs, dcomplex *a, int lda, int *ipiv, dcomplex *b, int ldb)
+{ int info; zgesv_(&n, &nrhs, a, &lda, ipiv, b, &ldb, &info); return info; }
+int trtrs(char uplo, char trans, char diag, int n, int nrhs, double *a, int lda, double *b, int ldb)
+{ int info; dtrtrs_(&uplo, &trans, &diag, &n, &nrhs, a, &lda, b, &ldb, &info); return info; }
+int trtrs(char uplo, char trans, char diag, int n, int nrhs, dcomplex *a, int lda, dcomplex *b, int ldb)
+{ int info; ztrtrs_(&uplo, &trans, &diag, &n, &nrhs, a, &lda, b, &ldb, &info); return info; }
+int gels(char trans, int m, int n, int nrhs, double *a, int lda, double *b, int ldb, double *work, int lwork)
+{ int info; dgels_(&trans, &m, &n, &nrhs, a, &lda, b, &ldb, work, &lwork, &info); return info; }
+int gels(char trans, int m, int n, int nrhs, dcomplex *a, int lda, dcomplex *b, int ldb, dcomplex *work, int lwork)
+{ int info; zgels_(&trans, &m, &n, &nrhs, a, &lda, b, &ldb, work, &lwork, &info); return info; }
+
+// checks the products with Q computed by ORMQR/UNMQR against the explicitly formed Q
+template<typename Scalar> void lapack_unmqr(int m, int k)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  typedef Matrix<Scalar,Dynamic,1> VectorType;
+  const char adj = NumTraits<Scalar>::IsComplex ? 'C' : 'T';
+  const int lda = m+2, n = internal::random<int>(1,10);
+
+  MatrixType A = MatrixType::Random(lda,k), A0 = A.topRows(m);
+  VectorType tau(k), work((std::max)(m,n)*64);
+  VERIFY_IS_EQUAL(geqrf(m, k, A.data(), lda, tau.data(), work.data(), int(work.size())), 0);
+
+  // Q = H(1) H(2) ... H(k), with H(i) = I - tau(i) v(i) v(i)^H
+  MatrixType Q = MatrixType::Identity(m,m);
+  for(int i=0; i<k; ++i)
+  {
+    VectorType v = VectorType::Zero(m);
+    v(i) = Scalar(1);
+    v.tail(m-i-1) = A.col(i).segment(i+1,m-i-1);
+    Q = Q * (MatrixType::Identity(m,m) - tau(i) * v * v.adjoint());
+  }
+  VERIFY_IS_APPROX(Q.adjoint()*Q, MatrixType::Identity(m,m));
+  MatrixType R = A.topRows(m).template triangularView<Upper>();
+  VERIFY_IS_APPROX(Q*R, A0);
+
+  const char sides[] = { 'L', 'R' };
+  const char transs[] = { 'N', adj };
+  for(int s=0; s<2; ++s)
+    for(int t=0; t<2; ++t)
+    {
+      int rows = sides[s]=='L' ? m : n;
+      int cols = sides[s]=='L' ? n : m;
+      MatrixType C = MatrixType::Random(rows+1,cols), C0 = C.topRows(rows);
+      VERIFY_IS_EQUAL(unmqr(sides[s], transs[t], rows, cols, k, A.data(), lda, tau.data(), C.data(), rows+1,
+                            work.data(), int(work.size())), 0);
+      MatrixType opQ = transs[t]=='N' ? Q : MatrixType(Q.adjoint());
+      MatrixType ref = sides[s]=='L' ? MatrixType(opQ*C0) : MatrixType(C0*opQ);
+      VERIFY_IS_APPROX(MatrixType(C.topRows(rows)), ref);
+    }
+}
+
+// checks SYEV, SYEVD and SYEVR with the minimal workspaces, in both storages of the matrix
+void lapack_syev(int n)
+{
+  typedef Matrix<double,Dynamic,Dynamic> MatrixType;
+  typedef Matrix<double,Dynamic,1> VectorType;
+  int lda = n+3;
+  MatrixType S = MatrixType::Random(n,n);
+  S = (S + S.transpose()).eval();
+  SelfAdjointEigenSolver<MatrixType> eig(S);
+
+  for(int u=0; u<2; ++u)
+  {
+    char uplo = u==0 ? 'L' : 'U';
+    for(int v=0; v<2; ++v)
+    {
+      char jobz = v==0 ? 'N' : 'V';
+      // the unreferenced parts of a are set to values which must be left unchanged
+      MatrixType A0 = MatrixType::Random(lda,n);
+      if(uplo=='L') A0.topRows(n).triangularView<Lower>() = S;
+      else          A0.topRows(n).triangularView<Upper>() = S;
+      VectorType w(n);
+      int info;
+
+      // SYEV
+      {
+        MatrixType A = A0;
+        int lwork = (std::max)(1,3*n-1);
+        VectorType work(lwork);
+        dsyev_(&jobz, &uplo, &n, A.data(), &lda, w.data(), work.data(), &lwork, &info);
+        VERIFY_IS_EQUAL(info, 0);
+        VERIFY_IS_APPROX(w, eig.eigenvalues());
+        VERIFY_IS_EQUAL(MatrixType(A.bottomRows(lda-n)), MatrixType(A0.bottomRows(lda-n)));
+        if(jobz=='V')
+        {
+          MatrixType V = A.topRows(n);
+          VERIFY_IS_APPROX(V.transpose()*V, MatrixType::Identity(n,n));
+          VERIFY_IS_APPROX(S*V, V*w.asDiagonal());
+        }
+        else if(uplo=='L')
+          VERIFY_IS_EQUAL(MatrixType(A.topRows(n).triangularView<StrictlyUpper>()),
+                          MatrixType(A0.topRows(n).triangularView<StrictlyUpper>()));
+        else
+          VERIFY_IS_EQUAL(MatrixType(A.topRows(n).triangularView<StrictlyLower>()),
+                          MatrixType(A0.topRows(n).triangularView<StrictlyLower>()));
+      }
+
+      // SYEVD
+      {
+        MatrixType A = A0;
+        int lwork = -1, liwork = -1, iworkSize;
+        double workSize;
+        dsyevd_(&jobz, &uplo, &n, A.data(), &lda, w.data(), &workSize, &lwork, &iworkSize, &liwork, &info);
+        lwork = int(workSize);
+        liwork = iworkSize;
+        VectorType work(lwork);
+        VectorXi iwork(liwork);
+        dsyevd_(&jobz, &uplo, &n, A.data(), &lda, w.data(), work.data(), &lwork, iwork.data(), &liwork, &info);
+        VERIFY_IS_EQUAL(info, 0);
+        VERIFY_IS_APPROX(w, eig.eigenvalues());
+        VERIFY_IS_EQUAL(MatrixType(A.bottomRows(lda-n)), MatrixType(A0.bottomRows(lda-n)));
+        if(jobz=='V')
+          VERIFY_IS_APPROX(S*A.topRows(n), A.topRows(n)*w.asDiagonal());
+      }
+
+      // SYEVR, selecting all the eigenvalues, the ones in (vl,vu], or the ones of indices il..iu,
+      // with the minimal workspaces and a Z which has only the columns of the selected eigenvectors
+      for(int r=0; r<3; ++r)
+      {
+        MatrixType A = A0;
+        char range = "AVI"[r];
+        int il = internal::random<int>(1,n), iu = internal::random<int>(il,n), m;
+        int first = 0, count = n;
+        double vl = 0, vu = 0, abstol = 0;
+        if(range=='I')
+        {
+          first = il-1;
+          count = iu-il+1;
+        }
+        else if(range=='V')
+        {
+          // bounds halfway between consecutive eigenvalues
+          vl = il==1 ? eig.eigenvalues()(0)-1 : (eig.eigenvalues()(il-2)+eig.eigenvalues()(il-1))/2;
+          vu = iu==n ? eig.eigenvalues()(n-1)+1 : (eig.eigenvalues()(iu-1)+eig.eigenvalues()(iu))/2;
+          first = il-1;
+          count = iu-il+1;
+        }
+        int lwork = (std::max)(1,26*n), liwork = (std::max)(1,10*n), ldz = n+2;
+        VectorType work(lwork);
+        VectorXi iwork(liwork), isuppz(2*n);
+        MatrixType Z = MatrixType::Random(ldz,count), Z0 = Z;
+        dsyevr_(&jobz, &range, &uplo, &n, A.data(), &lda, &vl, &vu, &il, &iu, &abstol, &m, w.data(),
+                Z.data(), &ldz, isuppz.data(), work.data(), &lwork, iwork.data(), &liwork, &info);
+        VERIFY_IS_EQUAL(info, 0);
+        VERIFY_IS_EQUAL(m, count);
+        VERIFY_IS_APPROX(VectorType(w.head(m)), VectorType(eig.eigenvalues().segment(first,m)));
+        if(jobz=='V')
+        {
+          MatrixType V = Z.topRows(n);
+          VERIFY_IS_APPROX(V.transpose()*V, MatrixType::Identity(m,m));
+          VERIFY_IS_APPROX(S*V, V*w.head(m).asDiagonal());
+          VERIFY_IS_EQUAL(MatrixType(Z.bottomRows(ldz-n)), MatrixType(Z0.bottomRows(ldz-n)));
+        }
+        // only the uplo triangle of A may be destroyed
+        VERIFY_IS_EQUAL(MatrixType(A.bottomRows(lda-n)), MatrixType(A0.bottomRows(lda-n)));
+        if(uplo=='L')
+          VERIFY_IS_EQUAL(MatrixType(A.topRows(n).triangularView<StrictlyUpper>()),
+                          MatrixType(A0.topRows(n).triangularView<StrictlyUpper>()));
+        else
+          VERIFY_IS_EQUAL(MatrixType(A.topRows(n).triangularView<StrictlyLower>()),
+                          MatrixType(A0.topRows(n).triangularView<StrictlyLower>()));
+      }
+    }
+  }
+}
+
+// checks the eigenvectors of SYEVR selected by indices for a matrix with multiple eigenvalues,
+// which must be orthogonalized against each other
+void lapack_syevr_multiple(int n)
+{
+  typedef Matrix<double,Dynamic,Dynamic> MatrixType;
+  typedef Matrix<double,Dynamic,1> VectorType;
+  MatrixType Q = HouseholderQR<MatrixType>(MatrixType::Random(n,n)).householderQ();
+  VectorType d(n);
+  for(int i=0; i<n; ++i)
+    d(i) = double(i/3);
+  MatrixType S = Q*d.asDiagonal()*Q.transpose(), A = S;
+
+  char jobz = 'V', range = 'I', uplo = 'L';
+  int il = internal::random<int>(1,n), iu = internal::random<int>(il,n), m, info;
+  int lwork = 26*n, liwork = 10*n;
+  double vl = 0, vu = 0, abstol = 0;
+  VectorType w(n), work(lwork);
+  VectorXi iwork(liwork), isuppz(2*n);
+  MatrixType Z(n,iu-il+1);
+  dsyevr_(&jobz, &range, &uplo, &n, A.data(), &n, &vl, &vu, &il, &iu, &abstol, &m, w.data(),
+          Z.data(), &n, isuppz.data(), work.data(), &lwork, iwork.data(), &liwork, &info);
+  VERIFY_IS_EQUAL(info, 0);
+  VERIFY_IS_EQUAL(m, iu-il+1);
+  VERIFY((w.head(m)-d.segment(il-1,m)).cwiseAbs().maxCoeff() < test_precision<double>());
+  VERIFY_IS_APPROX(Z.transpose()*Z, MatrixType::Identity(m,m));
+  VERIFY((S*Z-Z*w.head(m).asDiagonal()).norm() < test_precision<double>());
+}
+
+// checks the Bunch-Kaufman factorization of SYTRF by reconstructing P*L*D*L^T*P^T (or P*U*D*U^T*P^T),
+// with the unblocked, the blocked and the queried workspaces, and the solutions of SYTRS
+template<typename Scalar> void lapack_sytrf(int n)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  typedef Matrix<Scalar,Dynamic,1> VectorType;
+  const int lda = n+2, nrhs = internal::random<int>(1,4), ldb = n+1;
+
+  // A is symmetric, and not selfadjoint, in the complex case
+  MatrixType S = MatrixType::Random(n,n);
+  S = (S + S.transpose()).eval();
+
+  for(int u=0; u<2; ++u)
+  {
+    char uplo = u==0 ? 'L' : 'U';
+    const int lworks[] = { 1, n*internal::random<int>(2,8), -1 };
+    for(int l=0; l<3; ++l)
+    {
+      MatrixType A0 = MatrixType::Random(lda,n);
+      if(uplo=='L') A0.topRows(n).template triangularView<Lower>() = S;
+      else          A0.topRows(n).template triangularView<Upper>() = S;
+      MatrixType A = A0;
+      VectorXi ipiv(n);
+      int lwork = lworks[l];
+      if(lwork==-1)
+      {
+        Scalar workSize;
+        VERIFY_IS_EQUAL(sytrf(uplo, n, A.data(), lda, ipiv.data(), &workSize, -1), 0);
+        lwork = int(numext::real(workSize));
+        VERIFY(lwork>=n);
+      }
+      VectorType work(lwork);
+      VERIFY_IS_EQUAL(sytrf(uplo, n, A.data(), lda, ipiv.data(), work.data(), lwork), 0);
+
+      // the other triangle and the rows below the matrix are left unchanged
+      VERIFY_IS_EQUAL(MatrixType(A.bottomRows(lda-n)), MatrixType(A0.bottomRows(lda-n)));
+      if(uplo=='L')
+        VERIFY_IS_EQUAL(MatrixType(A.topRows(n).template triangularView<StrictlyUpper>()),
+                        MatrixType(A0.topRows(n).template triangularView<StrictlyUpper>()));
+      else
+        VERIFY_IS_EQUAL(MatrixType(A.topRows(n).template triangularView<StrictlyLower>()),
+                        MatrixType(A0.topRows(n).template triangularView<StrictlyLower>()));
+
+      // L = P(1)*L(1)*P(2)*L(2)*... and U = P(n)*U(n)*P(n-1)*U(n-1)*..., where P(k) is the interchange
+      // of the row k (or k+1, resp. k-1, for a 2x2 block) with the row |ipiv(k)|, and L(k) (resp. U(k))
+      // is the identity but for the columns of the block, below (resp. above) the block.
+      std::vector<int> starts, sizes;
+      for(int k = uplo=='L' ? 0 : n-1; k>=0 && k<n; )
+      {
+        int s = ipiv(k)>0 ? 1 : 2;
+        if(s==2)
+        {
+          int k2 = uplo=='L' ? k+1 : k-1;
+          VERIFY(k2>=0 && k2<n && ipiv(k2)==ipiv(k));
+        }
+        starts.push_back(uplo=='L' ? k : k-s+1);
+        sizes.push_back(s);
+        k += uplo=='L' ? s : -s;
+      }
+
+      MatrixType D = MatrixType::Zero(n,n);
+      for(size_t b=0; b<starts.size(); ++b)
+      {
+        int k = starts[b], s = sizes[b];
+        D.block(k,k,s,s) = A.block(k,k,s,s);
+        if(s==2)
+        {
+          if(uplo=='L') D(k,k+1) = A(k+1,k);
+          else          D(k+1,k) = A(k,k+1);
+        }
+      }
+
+      MatrixType R = D;
+      for(int b=int(starts.size())-1; b>=0; --b)
+      {
+        int k = starts[b], s = sizes[b];
+        MatrixType Lk = MatrixType::Identity(n,n);
+        if(uplo=='L') Lk.block(k+s,k,n-k-s,s) = A.block(k+s,k,n-k-s,s);
+        else          Lk.block(0,k,k,s) = A.block(0,k,k,s);
+        R = (Lk * R * Lk.transpose()).eval();
+        int kk = uplo=='L' && s==2 ? k+1 : k;
+        int kp = std::abs(ipiv(kk))-1;
+        R.row(kk).swap(R.row(kp));
+        R.col(kk).swap(R.col(kp));
+      }
+      VERIFY_IS_APPROX(R, S);
+
+      // SYTRS
+      MatrixType B = MatrixType::Random(ldb,nrhs), Borig = B;
+      VERIFY_IS_EQUAL(sytrs(uplo, n, nrhs, A.data(), lda, ipiv.data(), B.data(), ldb), 0);
+      VERIFY_IS_APPROX(MatrixType(S*B.topRows(n)), MatrixType(Borig.topRows(n)));
+      VERIFY_IS_EQUAL(MatrixType(B.bottomRows(ldb-n)), MatrixType(Borig.bottomRows(ldb-n)));
+    }
+  }
+}
+
+// checks the residuals of GESV and TRTRS
+template<typename Scalar> void lapack_linear_solve(int n)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+  const int lda = n+2, ldb = n+1, nrhs = internal::random<int>(1,4);
+
+  // GESV
+  {
+    MatrixType A = MatrixType::Random(lda,n), A0 = A.topRows(n);
+    MatrixType B = MatrixType::Random(ldb,nrhs), Borig = B.topRows(n);
+    VectorXi ipiv(n);
+    VERIFY_IS_EQUAL(gesv(n, nrhs, A.data(), lda, ipiv.data(), B.data(), ldb), 0);
+    VERIFY_IS_APPROX(MatrixType(A0*B.topRows(n)), Borig);
+  }
+
+  // TRTRS
+  const char uplos[] = { 'U', 'L' };
+  const char transs[] = { 'N', 'T', 'C' };
+  const char diags[] = { 'N', 'U' };
+  for(int u=0; u<2; ++u)
+    for(int t=0; t<3; ++t)
+      for(int d=0; d<2; ++d)
+      {
+        // the diagonal and the other triangle are filled with values which must not be referenced for a unit diagonal
+        MatrixType A = MatrixType::Random(lda,n);
+        A.topRows(n).diagonal().array() += Scalar(RealScalar(n));
+        MatrixType T = A.topRows(n);
+        if(diags[d]=='U') T.diagonal().setOnes();
+        if(uplos[u]=='U') T = MatrixType(T.template triangularView<Upper>());
+        else              T = MatrixType(T.template triangularView<Lower>());
+        MatrixType opT = transs[t]=='N' ? T : transs[t]=='T' ? MatrixType(T.transpose()) : MatrixType(T.adjoint());
+
+        MatrixType B = MatrixType::Random(ldb,nrhs), Borig = B.topRows(n);
+        VERIFY_IS_EQUAL(trtrs(uplos[u], transs[t], diags[d], n, nrhs, A.data(), lda, B.data(), ldb), 0);
+        VERIFY_IS_APPROX(MatrixType(opT*B.topRows(n)), Borig);
+      }
+}
+
+// checks GELS against the least-squares solutions (more equations than unknowns) and the minimum norm
+// solutions (fewer equations than unknowns) computed by Eigen, for both op(A)=A and op(A)=A^H
+template<typename Scalar> void lapack_gels(int m, int n)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  typedef Matrix<Scalar,Dynamic,1> VectorType;
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+  const bool isComplex = NumTraits<Scalar>::IsComplex;
+  const int lda = m+2, mn = (std::max)(m,n), ldb = mn+1, nrhs = internal::random<int>(1,4);
+
+  const char transs[] = { 'N', isComplex ? 'C' : 'T' };
+  for(int t=0; t<2; ++t)
+  {
+    MatrixType A = MatrixType::Random(lda,n), Aorig = A, A0 = A.topRows(m);
+    MatrixType opA = transs[t]=='N' ? A0 : MatrixType(A0.adjoint());
+    int rows = int(opA.rows()), cols = int(opA.cols());
+
+    MatrixType B = MatrixType::Random(ldb,nrhs), Borig = B.topRows(rows);
+    Scalar workSize;
+    VERIFY_IS_EQUAL(gels(transs[t], m, n, nrhs, A.data(), lda, B.data(), ldb, &workSize, -1), 0);
+    VectorType work(int(numext::real(workSize)));
+    VERIFY_IS_EQUAL(gels(transs[t], m, n, nrhs, A.data(), lda, B.data(), ldb, work.data(), int(work.size())), 0);
+    MatrixType X = B.topRows(cols);
+
+    if(rows>=cols)
+    {
+      // least-squares solution, the rows cols+1..rows of B hold the residuals in the basis of Q
+      MatrixType ref = opA.householderQr().solve(Borig);
+      VERIFY_IS_APPROX(X, ref);
+      for(int j=0; j<nrhs; ++j)
+        VERIFY_IS_APPROX(B.col(j).segment(cols,rows-cols).norm() + RealScalar(1), (opA*X.col(j)-Borig.col(j)).norm() + RealScalar(1));
+    }
+    else
+    {
+      // minimum norm solution
+      MatrixType ref = opA.adjoint() * (opA*opA.adjoint()).eval().llt().solve(Borig);
+      VERIFY_IS_APPROX(MatrixType(opA*X), Borig);
+      VERIFY_IS_APPROX(X, ref);
+    }
+
+    // on exit, A holds the QR factorization of A as returned by GEQRF if m>=n, and otherwise the LQ
+    // factorization of A as returned by GELQF: L in the lower triangle and, in the rows above the
+    // diagonal, the conjugates of the Householder vectors of Q = H(k)^H ... H(1)^H.
+    // The later is the (conjugate-)transpose of the QR factorization of A^H.
+    VectorType tau((std::min)(m,n)), qrwork(mn*64);
+    if(m>=n)
+    {
+      MatrixType QR = A0;
+      VERIFY_IS_EQUAL(geqrf(m, n, QR.data(), m, tau.data(), qrwork.data(), int(qrwork.size())), 0);
+      VERIFY_IS_APPROX(MatrixType(A.topRows(m)), QR);
+    }
+    else
+    {
+      MatrixType QR = A0.adjoint();
+      VERIFY_IS_EQUAL(geqrf(n, m, QR.data(), n, tau.data(), qrwork.data(), int(qrwork.size())), 0);
+      VERIFY_IS_APPROX(MatrixType(A.topRows(m)), MatrixType(QR.adjoint()));
+
+      // A = L * Q
+      MatrixType Q = MatrixType::Identity(n,n);
+      for(int i=0; i<m; ++i)
+      {
+        VectorType v = VectorType::Zero(n);
+        v(i) = Scalar(1);
+        v.tail(n-i-1) = A.row(i).tail(n-i-1).adjoint();
+        Q = ((MatrixType::Identity(n,n) - numext::conj(tau(i)) * v * v.adjoint()) * Q).eval();
+      }
+      MatrixType L = A.topLeftCorner(m,m).template triangularView<Lower>();
+      VERIFY_IS_APPROX(MatrixType(L*Q.topRows(m)), A0);
+    }
+    VERIFY_IS_EQUAL(MatrixType(A.bottomRows(lda-m)), MatrixType(Aorig.bottomRows(lda-m)));
+  }
+
+  // like the reference implementation, the transpose of a complex matrix and the adjoint of a real one are not supported
+  {
+    char trans = isComplex ? 'T' : 'C';
+    MatrixType A = MatrixType::Random(lda,n), B = MatrixType::Random(ldb,nrhs);
+    VectorType work(mn*64);
+    VERIFY_IS_EQUAL(gels(trans, m, n, nrhs, A.data(), lda, B.data(), ldb, work.data(), int(work.size())), -1);
+  }
+}
+
+void test_lapack_routines()
+{
+  for(int i = 0; i < g_repeat; i++) {
+    int m = internal::random<int>(1,EIGEN_TEST_MAX_SIZE/4);
+    int k = internal::random<int>(1,m);
+    CALL_SUBTEST_1( lapack_unmqr<double>(m, k) );
+    CALL_SUBTEST_2( lapack_unmqr<dcomplex>(m, k) );
+    CALL_SUBTEST_3( lapack_syev(internal::random<int>(1,EIGEN_TEST_MAX_SIZE/4)) );
+    CALL_SUBTEST_3( lapack_syev(1) );
+    CALL_SUBTEST_3( lapack_syevr_multiple(internal::random<int>(2,EIGEN_TEST_MAX_SIZE/4)) );
+    int n = internal::random<int>(1,EIGEN_TEST_MAX_SIZE/4);
+    CALL_SUBTEST_4( lapack_sytrf<double>(n) );
+    CALL_SUBTEST_5( lapack_sytrf<dcomplex>(n) );
+    CALL_SUBTEST_6( lapack_linear_solve<double>(n) );
+    CALL_SUBTEST_6( lapack_linear_solve<dcomplex>(n) );
+    CALL_SUBTEST_7( lapack_gels<double>(m, k) );
+    CALL_SUBTEST_7( lapack_gels<double>(k, m) );
+    CALL_SUBTEST_8( lapack_gels<dcomplex>(m, k) );
+    CALL_SUBTEST_8( lapack_gels<dcomplex>(k, m) );
+  }
+}
@@ -298,6 +298,48 @@ template<typename Scalar> void packetmath_real()
   CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasSin, std::sin, internal::psin);
   CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasCos, std::cos, internal::pcos);
   CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasTan, std::tan, internal::ptan);
+  CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasATan, std::atan, internal::patan);
+  CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasTanh, std::tanh, internal::ptanh);
+  CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasErf, numext::erf, internal::perf);
+  {
+    data1[0] = -std::numeric_limits<Scalar>::infinity();
+    packet_helper<internal::packet_traits<Scalar>::HasTanh,Packet> h;
+    h.store(data2, internal::ptanh(h.load(data1)));
+    VERIFY_IS_EQUAL(Scalar(-1), data2[0]);
+    packet_helper<internal::packet_traits<Scalar>::HasATan,Packet> h2;
+    h2.store(data2, internal::patan(h2.load(data1)));
+    VERIFY_IS_APPROX(Scalar(-EIGEN_PI/2), data2[0]);
+  }
+
+  if(internal::is_same<Scalar,double>::value)
+  {
+    // large arguments, for which the range reduction cannot be vectorized
+    for (int i=0; i<size; ++i)
+    {
+      data1[i] = internal::random<Scalar>(-1,1) * std::pow(Scalar(10), internal::random<Scalar>(0,300));
+      data2[i] = internal::random<Scalar>(-1,1) * std::pow(Scalar(10), internal::random<Scalar>(6,10));
+    }
+    data1[0] = Scalar(1e10);
+    data1[1] = Scalar(3e9);
+    CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasSin, std::sin, internal::psin);
+    CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasCos, std::cos, internal::pcos);
+    for (int i=0; i<size; ++i)
+      data1[i] = data2[i];
+    CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasSin, std::sin, internal::psin);
+    CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasCos, std::cos, internal::pcos);
+
+    // one lane at a time, since a packet may hold a single scalar
+    for (int k=0; k<2; ++k)
+    {
+      data1[0] = k==0 ? std::numeric_limits<Scalar>::quiet_NaN() : std::numeric_limits<Scalar>::infinity();
+      packet_helper<internal::packet_traits<Scalar>::HasSin,Packet> h;
+      h.store(data2, internal::psin(h.load(data1)));
+      VERIFY((numext::isnan)(data2[0]));
+      packet_helper<internal::packet_traits<Scalar>::HasCos,Packet> h2;
+      h2.store(data2, internal::pcos(h2.load(data1)));
+      VERIFY((numext::isnan)(data2[0]));
+    }
+  }
   
   for (int i=0; i<size; ++i)
   {
@@ -375,10 +417,58 @@ template<typename Scalar> void packetmath_real()
     //    VERIFY_IS_EQUAL(std::log(std::numeric_limits<Scalar>::denorm_min()), data2[0]);
     //    VERIFY(std::isnan(data2[1]));
 
+    if(internal::is_same<Scalar,double>::value)
+    {
+      // denormalized numbers
+      data1[0] = std::numeric_limits<Scalar>::denorm_min();
+      data1[1] = Scalar(1e-310);
+      h.store(data2, internal::plog(h.load(data1)));
+      VERIFY_IS_APPROX(std::log(data1[0]), data2[0]);
+      VERIFY_IS_APPROX(std::log(data1[1]), data2[1]);
+      data1[0] = (std::numeric_limits<Scalar>::min)() * Scalar(0.75);
+      data1[1] = (std::numeric_limits<Scalar>::min)() * Scalar(1.5);
+      h.store(data2, internal::plog(h.load(data1)));
+      VERIFY_IS_APPROX(std::log(data1[0]), data2[0]);
+      VERIFY_IS_APPROX(std::log(data1[1]), data2[1]);
+    }
+
     data1[0] = -1.0f;
     h.store(data2, internal::plog(h.load(data1)));
     VERIFY(std::isnan(data2[0]));
+
+    data1[0] = std::numeric_limits<Scalar>::infinity();
+    h.store(data2, internal::plog(h.load(data1)));
+    VERIFY((numext::isinf)(data2[0]) && data2[0]>0);
+    data1[0] = 0;
+    h.store(data2, internal::plog(h.load(data1)));
+    VERIFY((numext::isinf)(data2[0]) && data2[0]<0);
+  }
+
+  for (int i=0; i<size; ++i)
+  {
+    data1[i] = internal::random<Scalar>(-1,1) * std::pow(Scalar(10), internal::random<Scalar>(-6,6));
+    data2[i] = internal::random<Scalar>(-1,1) * std::pow(Scalar(10), internal::random<Scalar>(-6,6));
+    if(data1[i]<=Scalar(-1)) data1[i] = -data1[i];
+  }
+  CHECK_CWISE1_IF(internal::packet_traits<Scalar>::HasLog1p, numext::log1p, internal::plog1p);
+  {
+    packet_helper<internal::packet_traits<Scalar>::HasLog1p,Packet> h;
+    data1[0] = -std::numeric_limits<Scalar>::epsilon() * Scalar(1e-3);
+    h.store(data2, internal::plog1p(h.load(data1)));
+    VERIFY_IS_APPROX(data1[0], data2[0]);
+
+    data1[0] = Scalar(-1);
+    h.store(data2, internal::plog1p(h.load(data1)));
+    VERIFY((numext::isinf)(data2[0]) && data2[0]<0);
+
+    data1[0] = std::numeric_limits<Scalar>::infinity();
+    h.store(data2, internal::plog1p(h.load(data1)));
+    VERIFY((numext::isinf)(data2[0]) && data2[0]>0);
+  }
+  {
+    data1[0] = -1.0f;
 #if !EIGEN_FAST_MATH
+    packet_helper<internal::packet_traits<Scalar>::HasLog,Packet> h;
     h.store(data2, internal::psqrt(h.load(data1)));
     VERIFY(numext::isnan(data2[0]));
     VERIFY(numext::isnan(data2[1]));
@@ -511,6 +601,169 @@ template<typename Scalar> void packetmath_scatter_gather() {
   }
 }
 
+// \returns the error of the float \a value in ULP, relative to the double precision \a ref
+double ulp_error(float value, double ref)
+{
+  int exponent;
+  std::frexp(float(ref), &exponent);
+  double ulp = std::ldexp(1.0, (std::max)(exponent - 24, -149));
+  return std::abs(double(value) - ref) / ulp;
+}
+
+// \returns the error of the double \a value in ULP, relative to the extended precision \a ref
+double ulp_error(double value, long double ref)
+{
+  int exponent;
+  std::frexp(double(ref), &exponent);
+  long double ulp = std::ldexp((long double)(1), (std::max)(exponent - 53, -1074));
+  return double(std::abs((long double)(value) - ref) / ulp);
+}
+
+template<typename Packet, typename RefScalar>
+double max_ulp_error(Packet (*pop)(const Packet&), RefScalar (*refop)(RefScalar),
+                     const typename internal::unpacket_traits<Packet>::type* data, int size)
+{
+  typedef typename internal::unpacket_traits<Packet>::type Scalar;
+  const int PacketSize = internal::unpacket_traits<Packet>::size;
+  EIGEN_ALIGN_DEFAULT Scalar res[internal::unpacket_traits<Packet>::size];
+  double error = 0;
+  for(int j=0; j+PacketSize<=size; j+=PacketSize)
+  {
+    internal::pstore(res, pop(internal::ploadu<Packet>(data+j)));
+    for(int i=0; i<PacketSize; ++i)
+      error = (std::max)(error, ulp_error(res[i], refop(RefScalar(data[j+i]))));
+  }
+  return error;
+}
+
+// the packet type of Scalar when the function tested has its Has* flag Cond set, and Scalar itself otherwise,
+// so that the functions which are not vectorized are tested through their scalar fallback
+template<bool Cond, typename Scalar> struct packet_if { typedef typename internal::packet_traits<Scalar>::type type; };
+template<typename Scalar> struct packet_if<false,Scalar> { typedef Scalar type; };
+
+double ref_tanh(double x) { return std::tanh(x); }
+double ref_erf(double x) { return numext::erf(x); }
+double ref_atan(double x) { return std::atan(x); }
+double ref_log1p(double x) { return numext::log1p(x); }
+long double ref_sin(long double x) { return std::sin(x); }
+long double ref_cos(long double x) { return std::cos(x); }
+long double ref_log(long double x) { return std::log(x); }
+long double ref_log1p_ld(long double x) { return numext::log1p(x); }
+
+void packetmath_float_ulp()
+{
+  typedef internal::packet_traits<float> Traits;
+  typedef packet_if<Traits::HasTanh,float>::type TanhPacket;
+  typedef packet_if<Traits::HasErf,float>::type ErfPacket;
+  typedef packet_if<Traits::HasATan,float>::type ATanPacket;
+  typedef packet_if<Traits::HasLog1p,float>::type Log1pPacket;
+  const int size = 4096;
+  std::vector<float> data(size);
+  for(int i=0; i<size; ++i)
+    data[i] = internal::random<float>(-1,1) * std::pow(10.f, internal::random<float>(-6,1));
+  // the switches between the approximations
+  data[0] = 0.625f; data[1] = -0.625f; data[2] = 1.f; data[3] = -1.f;
+  data[4] = 4.f; data[5] = 9.f; data[6] = 1e-30f; data[7] = 0.f;
+
+  VERIFY(max_ulp_error<TanhPacket>(internal::ptanh<TanhPacket>, ref_tanh, &data[0], size) <= 2.);
+  VERIFY(max_ulp_error<ErfPacket>(internal::perf<ErfPacket>, ref_erf, &data[0], size) <= 2.);
+
+  // atan, with the switches of the range reduction at tan(Pi/8) and tan(3Pi/8)
+  for(int i=0; i<size; ++i)
+    data[i] = internal::random<float>(-1,1) * std::pow(10.f, internal::random<float>(-6,6));
+  for(int i=0; i<16; ++i)
+    data[i] = internal::random<float>(0.4f,0.5f);
+  data[16] = 0.41421356f; data[17] = -0.41421356f; data[18] = 2.41421356f; data[19] = -2.41421356f;
+  data[20] = std::numeric_limits<float>::denorm_min(); data[21] = 1e30f;
+  VERIFY(max_ulp_error<ATanPacket>(internal::patan<ATanPacket>, ref_atan, &data[0], size) <= 2.);
+
+  // log1p, down to the denormalized numbers and up to -1
+  for(int i=0; i<size; ++i)
+  {
+    data[i] = internal::random<float>(0,1) * std::pow(10.f, internal::random<float>(-6,6));
+    if(i%2) data[i] = -(std::min)(data[i], 0.999f);
+  }
+  data[0] = std::numeric_limits<float>::denorm_min(); data[1] = -std::numeric_limits<float>::denorm_min();
+  data[2] = 1e-30f; data[3] = -1e-30f; data[4] = -0.999999f; data[5] = 1e30f;
+  VERIFY(max_ulp_error<Log1pPacket>(internal::plog1p<Log1pPacket>, ref_log1p, &data[0], size) <= 2.);
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float inf = std::numeric_limits<float>::infinity();
+  for(int i=0; i<size; ++i)
+    data[i] = (i%4==0) ? nan : (i%4==1) ? inf : (i%4==2) ? -inf : float(i);
+  std::vector<float> res(size);
+  const int TanhPacketSize = internal::unpacket_traits<TanhPacket>::size;
+  for(int j=0; j+TanhPacketSize<=size; j+=TanhPacketSize)
+    internal::pstoreu(&res[j], internal::ptanh(internal::ploadu<TanhPacket>(&data[j])));
+  for(int i=0; i<size; ++i)
+    VERIFY((numext::isnan)(data[i]) ? (numext::isnan)(res[i]) : res[i]==std::tanh(data[i]));
+  const int ErfPacketSize = internal::unpacket_traits<ErfPacket>::size;
+  for(int j=0; j+ErfPacketSize<=size; j+=ErfPacketSize)
+    internal::pstoreu(&res[j], internal::perf(internal::ploadu<ErfPacket>(&data[j])));
+  for(int i=0; i<size; ++i)
+    VERIFY((numext::isnan)(data[i]) ? (numext::isnan)(res[i]) : res[i]==numext::erf(data[i]));
+}
+
+void packetmath_double_ulp()
+{
+  // the reference values need more precision than double
+  if(std::numeric_limits<long double>::digits<64)
+    return;
+
+  typedef internal::packet_traits<double> Traits;
+  typedef packet_if<Traits::HasSin,double>::type SinPacket;
+  typedef packet_if<Traits::HasCos,double>::type CosPacket;
+  typedef packet_if<Traits::HasLog,double>::type LogPacket;
+  typedef packet_if<Traits::HasLog1p,double>::type Log1pPacket;
+  const int size = 4096;
+  std::vector<double> data(size);
+
+  // sin and cos, with the arguments for which the range reduction is vectorized, those close to
+  // multiples of Pi/2, and the large arguments which fall back to the scalar functions
+  for(int i=0; i<size; ++i)
+    data[i] = internal::random<double>(-1,1) * std::pow(10., internal::random<double>(-6,5));
+  for(int i=0; i<32; ++i)
+    data[i] = double(internal::random<int>(-200,200)) * (EIGEN_PI/2) + internal::random<double>(-1e-3,1e-3);
+  for(int i=32; i<64; ++i)
+    data[i] = internal::random<double>(-1,1) * std::pow(10., internal::random<double>(6,300));
+  data[64] = 0; data[65] = std::numeric_limits<double>::denorm_min(); data[66] = 1e10; data[67] = 3e9;
+  VERIFY(max_ulp_error<SinPacket>(internal::psin<SinPacket>, ref_sin, &data[0], size) <= 2.);
+  VERIFY(max_ulp_error<CosPacket>(internal::pcos<CosPacket>, ref_cos, &data[0], size) <= 2.);
+
+  // log, around 1 and sqrt(1/2) where the reduction switches, and down to the denormalized numbers
+  for(int i=0; i<size; ++i)
+    data[i] = internal::random<double>(0,1) * std::pow(10., internal::random<double>(-300,300));
+  for(int i=0; i<2048; ++i)
+    data[i] = i%4==0 ? internal::random<double>(0.5,2.) : i%4==1 ? internal::random<double>(0.70,0.72) : internal::random<double>(1.40,1.43);
+  for(int i=2048; i<2112; ++i)
+    data[i] = internal::random<double>(0,1) * (std::numeric_limits<double>::min)() * std::pow(10., internal::random<double>(-15,0));
+  data[2112] = std::numeric_limits<double>::denorm_min(); data[2113] = (std::numeric_limits<double>::min)();
+  data[2114] = 0.70710678118654752; data[2115] = 1.4142135623730950; data[2116] = 1.; data[2117] = (std::numeric_limits<double>::max)();
+  VERIFY(max_ulp_error<LogPacket>(internal::plog<LogPacket>, ref_log, &data[0], size) <= 2.);
+
+  // log1p, around the switches of plog at 1+x = sqrt(1/2) and sqrt(2), and down to -1
+  for(int i=0; i<size; ++i)
+  {
+    data[i] = internal::random<double>(0,1) * std::pow(10., internal::random<double>(-20,20));
+    if(i%2) data[i] = -(std::min)(data[i], 0.999);
+  }
+  for(int i=0; i<1024; ++i)
+    data[i] = i%2 ? internal::random<double>(-0.30,-0.28) : internal::random<double>(0.40,0.43);
+  data[1024] = std::numeric_limits<double>::denorm_min(); data[1025] = -std::numeric_limits<double>::denorm_min();
+  data[1026] = 1e-300; data[1027] = -0.999999999; data[1028] = 1e300;
+  VERIFY(max_ulp_error<Log1pPacket>(internal::plog1p<Log1pPacket>, ref_log1p_ld, &data[0], size) <= 2.);
+}
+
+// the comparisons and selections also compile and work with the scalar fallback of the packet functions
+template<typename Scalar> void packetmath_scalar_select()
+{
+  Scalar a = internal::random<Scalar>(), b = internal::random<Scalar>();
+  VERIFY_IS_EQUAL(internal::pselect(internal::pcmp_lt(a, b), a, b), a<b ? a : b);
+  VERIFY_IS_EQUAL(internal::pselect(internal::pcmp_le(a, b), a, b), a<=b ? a : b);
+  VERIFY_IS_EQUAL(internal::pselect(internal::pcmp_eq(a, a), a, b), a);
+  VERIFY_IS_EQUAL(internal::pselect(internal::pcmp_eq(a, Scalar(a+Scalar(1))), a, b), b);
+}
+
 void test_packetmath()
 {
   for(int i = 0; i < g_repeat; i++) {
@@ -526,6 +779,11 @@ void test_packetmath()
     
     CALL_SUBTEST_1( packetmath_real<float>() );
     CALL_SUBTEST_2( packetmath_real<double>() );
+    CALL_SUBTEST_1( packetmath_float_ulp() );
+    CALL_SUBTEST_2( packetmath_double_ulp() );
+    CALL_SUBTEST_1( packetmath_scalar_select<float>() );
+    CALL_SUBTEST_2( packetmath_scalar_select<double>() );
+    CALL_SUBTEST_3( packetmath_scalar_select<int>() );
 
     CALL_SUBTEST_4( packetmath_complex<std::complex<float> >() );
     CALL_SUBTEST_5( packetmath_complex<std::complex<double> >() );
@@ -61,6 +61,31 @@ void test_product_large()
     MatrixXf r2 = mat1.row(2)*mat2;
     VERIFY_IS_APPROX(r2, (mat1.row(2)*mat2).eval());
   }
+
+  {
+    // test large matrix-vector products and triangular solves (multi-threaded if OpenMP is enabled)
+    int rows = internal::random<int>(500,800), cols = internal::random<int>(500,800);
+    MatrixXd A = MatrixXd::Random(rows,cols);
+    Matrix<double,Dynamic,Dynamic,RowMajor> Ar = A;
+    VectorXd x = VectorXd::Random(cols), y = VectorXd::Random(rows);
+    VERIFY_IS_APPROX((A*x).eval(), A.lazyProduct(x));
+    VERIFY_IS_APPROX((Ar*x).eval(), A.lazyProduct(x));
+    VERIFY_IS_APPROX((A.transpose()*y).eval(), A.transpose().lazyProduct(y));
+    VERIFY_IS_APPROX((y.transpose()*Ar).eval(), y.transpose().lazyProduct(A));
+
+    // short and wide products
+    MatrixXf W = MatrixXf::Random(internal::random<int>(1,40), internal::random<int>(5000,8000));
+    VectorXf z = VectorXf::Random(W.cols());
+    VERIFY_IS_APPROX((W*z).eval(), W.lazyProduct(z));
+
+    MatrixXd T = MatrixXd::Random(rows,rows) + rows * MatrixXd::Identity(rows,rows);
+    Matrix<double,Dynamic,Dynamic,RowMajor> Tr = T;
+    VectorXd b = VectorXd::Random(rows);
+    VERIFY_IS_APPROX(T.triangularView<Lower>() * T.triangularView<Lower>().solve(b), b);
+    VERIFY_IS_APPROX(T.triangularView<Upper>() * T.triangularView<Upper>().solve(b), b);
+    VERIFY_IS_APPROX(Tr.triangularView<Lower>() * Tr.triangularView<Lower>().solve(b), b);
+    VERIFY_IS_APPROX(Tr.triangularView<Upper>() * Tr.triangularView<Upper>().solve(b), b);
+  }
 #endif
 
   // Regression test for bug 714:
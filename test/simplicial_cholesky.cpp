@@ -20,6 +20,8 @@ template<typename T, typename I> void test_simplicial_cholesky_T()
   SimplicialLDLT<    SparseMatrixType, Upper> ldlt_colmajor_upper_amd;
   SimplicialLDLT<    SparseMatrixType, Lower, NaturalOrdering<I> > ldlt_colmajor_lower_nat;
   SimplicialLDLT<    SparseMatrixType, Upper, NaturalOrdering<I> > ldlt_colmajor_upper_nat;
+  SimplicialLLT<     SparseMatrixType, Lower, NestedDissectionOrdering<I> > llt_colmajor_lower_nd;
+  SimplicialLDLT<    SparseMatrixType, Upper, NestedDissectionOrdering<I> > ldlt_colmajor_upper_nd;
 
   check_sparse_spd_solving(chol_colmajor_lower_amd);
   check_sparse_spd_solving(chol_colmajor_upper_amd);
@@ -37,6 +39,10 @@ template<typename T, typename I> void test_simplicial_cholesky_T()
   
   check_sparse_spd_solving(ldlt_colmajor_lower_nat, 300, 1000);
   check_sparse_spd_solving(ldlt_colmajor_upper_nat, 300, 1000);
+
+  check_sparse_spd_solving(llt_colmajor_lower_nd, 600, 1000);
+  check_sparse_spd_solving(ldlt_colmajor_upper_nd, 600, 1000);
+  check_sparse_spd_determinant(llt_colmajor_lower_nd);
 }
 
 void test_simplicial_cholesky()
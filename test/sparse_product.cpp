@@ -154,7 +154,33 @@ template<typename SparseMatrixType> void sparse_product()
     }
 
     VERIFY_IS_APPROX(m6=m6*m6, refMat6=refMat6*refMat6);
-    
+
+    // sparse * sparse with a reusable structure
+    {
+      SparseProductCache<SparseMatrixType> prod;
+      prod.analyzePattern(m2, m3);
+      VERIFY_IS_EQUAL(prod.result().nonZeros(), SparseMatrixType(m2*m3).nonZeros());
+      VERIFY_IS_APPROX(prod.computeValues(m2, m3), refMat2*refMat3);
+      SparseMatrixType m2s = m2*s1, m3s = m3*s2;
+      VERIFY_IS_APPROX(prod.computeValues(m2s, m3s), (s1*s2)*refMat2*refMat3);
+      VERIFY_IS_APPROX(prod.compute(m2t.transpose(), m3t.transpose()), refMat2t.transpose()*refMat3t.transpose());
+      VERIFY_IS_APPROX(prod.computeValues(m2t.transpose(), m3t.transpose()*s1), refMat2t.transpose()*refMat3t.transpose()*s1);
+      VERIFY(prod.result().isCompressed());
+    }
+
+    // hypersparse product
+    {
+      Index n2 = 40*n;
+      SparseMatrixType a(n2, depth), b(depth, cols), c;
+      DenseMatrix refA = DenseMatrix::Zero(n2, depth), refB = DenseMatrix::Zero(depth, cols);
+      initSparse(2./n2, refA, a);
+      initSparse(density, refB, b);
+      VERIFY_IS_APPROX(c=a*b, refA*refB);
+      SparseProductCache<SparseMatrixType> prod;
+      prod.analyzePattern(a, b);
+      VERIFY_IS_APPROX(prod.computeValues(a, b), refA*refB);
+    }
+
     // sparse matrix * sparse vector
     ColSpVector cv0(cols), cv1;
     DenseVector dcv0(cols), dcv1;
@@ -263,6 +289,59 @@ template<typename SparseMatrixType> void sparse_product()
   }
 }
 
+// compares the multi-threaded sparse * sparse products with the sequential ones
+template<typename SparseMatrixType> void sparse_product_parallel()
+{
+  typedef typename SparseMatrixType::Scalar Scalar;
+  typedef typename SparseMatrixType::Index Index;
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+
+  const int nbThreads = Eigen::nbThreads();
+  Index n = internal::random<Index>(200,300);
+  // the tall case, which is too large for a dense reference, leads to hypersparse chunks
+  // when several threads are used while the sequential product uses the dense accumulator
+  Index rows[2] = { n, 200*n };
+  for(int k=0; k<2; ++k)
+  {
+    SparseMatrixType a(rows[k], n), b(n, n);
+    DenseMatrix refA, refB = DenseMatrix::Zero(n, n);
+    if(k==0)
+    {
+      refA = DenseMatrix::Zero(n, n);
+      initSparse(0.05, refA, a);
+    }
+    else
+    {
+      std::vector<Triplet<Scalar,Index> > triplets;
+      for(Index j=0; j<n; ++j)
+        for(int l=0; l<50; ++l)
+          triplets.push_back(Triplet<Scalar,Index>(internal::random<Index>(0,rows[k]-1), j, internal::random<Scalar>()));
+      a.setFromTriplets(triplets.begin(), triplets.end());
+    }
+    initSparse(0.05, refB, b);
+
+    Eigen::setNbThreads(1);
+    SparseMatrixType serial = a*b;
+    SparseProductCache<SparseMatrixType> serialCache;
+    serialCache.compute(a, b);
+
+    Eigen::setNbThreads(4);
+    SparseMatrixType parallel = a*b;
+    SparseProductCache<SparseMatrixType> cache;
+    cache.analyzePattern(a, b);
+    cache.computeValues(a, b);
+    Eigen::setNbThreads(nbThreads);
+
+    VERIFY_IS_EQUAL(parallel.nonZeros(), serial.nonZeros());
+    VERIFY_IS_APPROX(parallel, serial);
+    VERIFY_IS_EQUAL(cache.result().nonZeros(), serialCache.result().nonZeros());
+    VERIFY_IS_APPROX(cache.result(), serialCache.result());
+    VERIFY_IS_APPROX(cache.result(), serial);
+    if(k==0)
+      VERIFY_IS_APPROX(parallel, refA*refB);
+  }
+}
+
 // New test for Bug in SparseTimeDenseProduct
 template<typename SparseMatrixType, typename DenseMatrixType> void sparse_product_regression_test()
 {
@@ -318,5 +397,7 @@ void test_sparse_product()
     CALL_SUBTEST_2( (sparse_product<SparseMatrix<std::complex<double>, RowMajor > >()) );
     CALL_SUBTEST_3( (sparse_product<SparseMatrix<float,ColMajor,long int> >()) );
     CALL_SUBTEST_4( (sparse_product_regression_test<SparseMatrix<double,RowMajor>, Matrix<double, Dynamic, Dynamic, RowMajor> >()) );
+    CALL_SUBTEST_5( (sparse_product_parallel<SparseMatrix<double,ColMajor> >()) );
+    CALL_SUBTEST_5( (sparse_product_parallel<SparseMatrix<double,RowMajor> >()) );
   }
 }
@@ -101,6 +101,123 @@ template<typename Scalar> void sparse_solvers(int rows, int cols)
   }
 }
 
+template<typename SparseMatrixType, typename DenseMatrix>
+void check_level_scheduled_solvers(const SparseMatrixType& spd, const DenseMatrix& b)
+{
+  typedef typename SparseMatrixType::Scalar Scalar;
+  // the level schedules are built and used only with several threads
+  int threads = nbThreads();
+  setNbThreads(4);
+  SimplicialLDLT<SparseMatrixType> ldlt(spd);
+  SimplicialLLT<SparseMatrixType> llt(spd);
+  IncompleteLUT<Scalar> ilut(spd);
+  DenseMatrix xldlt = ldlt.solve(b), xllt = llt.solve(b), xilut = ilut.solve(b);
+  VERIFY_IS_APPROX(spd*xldlt, b);
+  VERIFY_IS_APPROX(spd*xllt, b);
+  setNbThreads(1);
+  VERIFY_IS_APPROX(ldlt.solve(b), xldlt);
+  VERIFY_IS_APPROX(llt.solve(b), xllt);
+  VERIFY_IS_APPROX(ilut.solve(b), xilut);
+  setNbThreads(threads);
+}
+
+template<typename Scalar> void sparse_level_solvers(int size)
+{
+  double density = (std::max)(8./(size*size), 0.01);
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef SparseMatrix<Scalar> SparseMatrixType;
+  DenseMatrix refMat(size, size);
+  DenseMatrix rhs = DenseMatrix::Random(size, 3);
+  DenseMatrix x;
+  SparseMatrixType m(size, size);
+
+  // lower
+  initSparse<Scalar>(density, refMat, m, ForceNonZeroDiag|MakeLowerTriangular);
+  SparseTriangularLevelSolver<Scalar,Lower> lower(m);
+  x = rhs;
+  lower.solveInPlace(x);
+  VERIFY_IS_APPROX(x, refMat.template triangularView<Lower>().solve(rhs));
+
+  // upper, from the adjoint
+  SparseTriangularLevelSolver<Scalar,Upper> upper(m.adjoint());
+  x = rhs;
+  upper.solveInPlace(x);
+  VERIFY_IS_APPROX(x, refMat.adjoint().template triangularView<Upper>().solve(rhs));
+
+  // triangular parts of a general row major matrix
+  initSparse<Scalar>(density, refMat, m, ForceNonZeroDiag);
+  SparseMatrix<Scalar,RowMajor> rm(m);
+  SparseTriangularLevelSolver<Scalar,UnitLower> unitLower(rm);
+  x = rhs;
+  unitLower.solveInPlace(x);
+  VERIFY_IS_APPROX(x, refMat.template triangularView<UnitLower>().solve(rhs));
+  upper.compute(rm);
+  Matrix<Scalar,Dynamic,1> v = rhs.col(0);
+  upper.solveInPlace(v);
+  VERIFY_IS_APPROX(v, refMat.template triangularView<Upper>().solve(rhs.col(0)));
+
+  // factor of a 2D grid, whose levels are large
+  int g = 100;
+  std::vector<Triplet<Scalar> > triplets;
+  for(int i=0; i<g*g; ++i)
+  {
+    triplets.push_back(Triplet<Scalar>(i, i, Scalar(4)));
+    if(i%g>0)  triplets.push_back(Triplet<Scalar>(i, i-1, internal::random<Scalar>()));
+    if(i>=g)   triplets.push_back(Triplet<Scalar>(i, i-g, internal::random<Scalar>()));
+  }
+  SparseMatrixType grid(g*g, g*g);
+  grid.setFromTriplets(triplets.begin(), triplets.end());
+  DenseMatrix b = DenseMatrix::Random(g*g, 2);
+  lower.compute(grid);
+  VERIFY_IS_EQUAL(lower.levels(), 2*g-1);
+  x = b;
+  lower.solveInPlace(x);
+  VERIFY_IS_APPROX(x, grid.template triangularView<Lower>().solve(b));
+  upper.compute(grid.transpose());
+  VERIFY_IS_EQUAL(upper.levels(), 2*g-1);
+  x = b;
+  upper.solveInPlace(x);
+  VERIFY_IS_APPROX(x, grid.transpose().template triangularView<Upper>().solve(b));
+
+  // level schedule run directly on the storage of a row major factor, sequentially and with all the threads
+  SparseMatrix<Scalar,RowMajor> rgrid(grid);
+  Matrix<int,Dynamic,1> level;
+  internal::sparse_row_levels<Lower>(rgrid.rows(), rgrid.outerIndexPtr(), rgrid.innerIndexPtr(), level);
+  internal::sparse_level_schedule<int> schedule;
+  schedule.compute(level);
+  VERIFY_IS_EQUAL(schedule.levels(), 2*g-1);
+  DenseMatrix ref = grid.template triangularView<Lower>().solve(b);
+  x = b;
+  schedule.run(internal::sparse_level_row_kernel<Lower,Scalar,int,DenseMatrix>(rgrid.outerIndexPtr(), rgrid.innerIndexPtr(), rgrid.valuePtr(), x), 1);
+  VERIFY_IS_APPROX(x, ref);
+  x = b;
+  schedule.run(internal::sparse_level_row_kernel<Lower,Scalar,int,DenseMatrix>(rgrid.outerIndexPtr(), rgrid.innerIndexPtr(), rgrid.valuePtr(), x), nbThreads());
+  VERIFY_IS_APPROX(x, ref);
+
+  // solvers scheduling the solves over their own factors: a grid, and independent chains whose elimination
+  // tree is a forest of large levels
+  for(int k=0; k<2; ++k)
+  {
+    triplets.clear();
+    for(int i=0; i<g*g; ++i)
+    {
+      triplets.push_back(Triplet<Scalar>(i, i, Scalar(8)));
+      int chain = k==0 ? g : 4;
+      int below[2] = { i%chain>0 ? i-1 : -1, k==0 && i>=g ? i-g : -1 };
+      for(int l=0; l<2; ++l)
+        if(below[l]>=0)
+        {
+          Scalar v = internal::random<Scalar>();
+          triplets.push_back(Triplet<Scalar>(i, below[l], v));
+          triplets.push_back(Triplet<Scalar>(below[l], i, numext::conj(v)));
+        }
+    }
+    SparseMatrixType spd(g*g, g*g);
+    spd.setFromTriplets(triplets.begin(), triplets.end());
+    check_level_scheduled_solvers(spd, b);
+  }
+}
+
 void test_sparse_solvers()
 {
   for(int i = 0; i < g_repeat; i++) {
@@ -109,4 +226,6 @@ void test_sparse_solvers()
     CALL_SUBTEST_2(sparse_solvers<std::complex<double> >(s,s) );
     CALL_SUBTEST_1(sparse_solvers<double>(s,s) );
   }
+  CALL_SUBTEST_1(sparse_level_solvers<double>(internal::random<int>(1,300)) );
+  CALL_SUBTEST_2(sparse_level_solvers<std::complex<double> >(internal::random<int>(1,300)) );
 }
@@ -39,10 +39,12 @@ template<typename T> void test_sparselu_T()
 {
   SparseLU<SparseMatrix<T, ColMajor> /*, COLAMDOrdering<int>*/ > sparselu_colamd; // COLAMDOrdering is the default
   SparseLU<SparseMatrix<T, ColMajor>, AMDOrdering<int> > sparselu_amd; 
+  SparseLU<SparseMatrix<T, ColMajor>, NestedDissectionOrdering<int> > sparselu_nd;
   SparseLU<SparseMatrix<T, ColMajor, long int>, NaturalOrdering<long int> > sparselu_natural;
   
   check_sparse_square_solving(sparselu_colamd); 
   check_sparse_square_solving(sparselu_amd, 300, 2000);
+  check_sparse_square_solving(sparselu_nd, 300, 2000);
   check_sparse_square_solving(sparselu_natural, 300, 2000);
   
   check_sparse_square_abs_determinant(sparselu_colamd);
@@ -52,10 +54,79 @@ template<typename T> void test_sparselu_T()
   check_sparse_square_determinant(sparselu_amd);
 }
 
+template<typename T> void test_sparselu_refactorize()
+{
+  typedef SparseMatrix<T, ColMajor> SpMat;
+  typedef Matrix<T,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<T,Dynamic,1> DenseVector;
+  typedef typename NumTraits<T>::Real RealScalar;
+  
+  SparseLU<SpMat> lu;
+  SpMat A;
+  DenseMatrix dA;
+  Index size = generate_sparse_square_problem(lu, A, dA, 300);
+  // strictly diagonally dominant columns, which keep the diagonal pivots when the values change by 10%
+  for(Index j = 0; j < size; ++j)
+    A.coeffRef(j,j) = T(2*A.col(j).cwiseAbs().sum() + 1);
+  A.makeCompressed();
+  lu.compute(A);
+  VERIFY(lu.info()==Success);
+  typename SparseLU<SpMat>::PermutationType::IndicesType perm = lu.rowsPermutation().indices();
+  
+  // new values with the same pattern, factorized with the previous structure and pivots
+  for(int k = 0; k < 4; ++k)
+  {
+    SpMat B = A;
+    for(Index i = 0; i < B.nonZeros(); ++i)
+      B.valuePtr()[i] *= internal::random<RealScalar>(RealScalar(0.9),RealScalar(1.1));
+    lu.refactorize(B);
+    VERIFY(lu.info()==Success);
+    // the pivots were reused rather than searched again by factorize()
+    VERIFY_IS_EQUAL(lu.rowsPermutation().indices(), perm);
+    DenseVector b = DenseVector::Random(size);
+    DenseVector x = lu.solve(b);
+    DenseVector refx = DenseMatrix(B).lu().solve(b);
+    VERIFY_IS_APPROX(x, refx);
+  }
+  
+  // a pivot which factorize() would not choose anymore, but which refactorize() still accepts
+  SpMat D(2,2);
+  D.insert(0,0) = T(2); D.insert(1,0) = T(1); D.insert(0,1) = T(1); D.insert(1,1) = T(4);
+  D.makeCompressed();
+  lu.compute(D);
+  VERIFY(lu.info()==Success);
+  perm = lu.rowsPermutation().indices();
+  D.coeffRef(0,0) = T(0.5);
+  SparseLU<SpMat> pivotingLu(D);
+  VERIFY(pivotingLu.rowsPermutation().indices() != perm);
+  lu.refactorize(D);
+  VERIFY(lu.info()==Success);
+  VERIFY_IS_EQUAL(lu.rowsPermutation().indices(), perm);
+  DenseVector d = DenseVector::Random(2);
+  DenseVector y = lu.solve(d);
+  VERIFY_IS_APPROX(DenseVector(D*y), d);
+  
+  // the previous pivots are not acceptable anymore: refactorize() falls back to a full factorization
+  SpMat C(2,2);
+  C.insert(0,0) = T(2); C.insert(1,0) = T(1); C.insert(0,1) = T(1); C.insert(1,1) = T(2);
+  C.makeCompressed();
+  lu.compute(C);
+  VERIFY(lu.info()==Success);
+  C.coeffRef(0,0) = C.coeffRef(1,1) = T(1e-6);
+  lu.refactorize(C);
+  VERIFY(lu.info()==Success);
+  DenseVector b = DenseVector::Random(2);
+  DenseVector x = lu.solve(b);
+  VERIFY_IS_APPROX(DenseVector(C*x), b);
+}
+
 void test_sparselu()
 {
   CALL_SUBTEST_1(test_sparselu_T<float>()); 
+  CALL_SUBTEST_1(test_sparselu_refactorize<float>());
   CALL_SUBTEST_2(test_sparselu_T<double>());
+  CALL_SUBTEST_2(test_sparselu_refactorize<double>());
   CALL_SUBTEST_3(test_sparselu_T<std::complex<float> >()); 
   CALL_SUBTEST_4(test_sparselu_T<std::complex<double> >());
+  CALL_SUBTEST_4(test_sparselu_refactorize<std::complex<double> >());
 }
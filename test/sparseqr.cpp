@@ -95,12 +95,63 @@ template<typename Scalar> void test_sparseqr_scalar()
   dQ = solver.matrixQ();
   VERIFY_IS_APPROX(Q, dQ);
 }
+
+template<typename Scalar> void test_sparse_multifrontal_qr_scalar()
+{
+  typedef SparseMatrix<Scalar,ColMajor> MatrixType;
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMat;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+  MatrixType A;
+  DenseMat dA;
+  DenseVector refX,x,b;
+
+  // a random least-squares problem of full column rank
+  int cols = internal::random<int>(1,150);
+  int rows = internal::random<int>(cols,300);
+  A.resize(rows,cols);
+  dA.resize(rows,cols);
+  initSparse<Scalar>((std::max)(8./(rows*cols), 0.01), dA, A, ForceNonZeroDiag);
+  A.makeCompressed();
+
+  SparseMultifrontalQR<MatrixType, COLAMDOrdering<int> > solver;
+  if(internal::random<float>(0,1)>0.5)
+    solver.setRelaxation(internal::random<int>(0,20));
+  solver.compute(A);
+  if(internal::random<float>(0,1)>0.5)
+    solver.factorize(A);  // this checks that calling analyzePattern is not needed if the pattern do not change.
+  VERIFY_IS_EQUAL(solver.info(), Success);
+  VERIFY_IS_EQUAL(solver.rank(), A.cols());
+
+  // R^* R = P^T A^* A P
+  DenseMat dR = solver.matrixR().topRows(cols);
+  DenseMat AP = dA * solver.colsPermutation();
+  VERIFY(dR.isUpperTriangular());
+  VERIFY_IS_APPROX(dR.adjoint() * dR, AP.adjoint() * AP);
+
+  // Compare with a dense QR solver
+  b = DenseVector::Random(rows);
+  x = solver.solve(b);
+  refX = dA.colPivHouseholderQr().solve(b);
+  VERIFY_IS_APPROX(x, refX);
+
+  // Rank deficient matrices are detected
+  if(cols>1)
+  {
+    A.col(0) = A.col(cols-1);
+    solver.compute(A);
+    VERIFY_IS_EQUAL(solver.info(), NumericalIssue);
+    VERIFY(solver.rank() < A.cols());
+  }
+}
+
 void test_sparseqr()
 {
   for(int i=0; i<g_repeat; ++i)
   {
     CALL_SUBTEST_1(test_sparseqr_scalar<double>());
     CALL_SUBTEST_2(test_sparseqr_scalar<std::complex<double> >());
+    CALL_SUBTEST_3(test_sparse_multifrontal_qr_scalar<double>());
+    CALL_SUBTEST_4(test_sparse_multifrontal_qr_scalar<std::complex<double> >());
   }
 }
 
@@ -110,6 +110,101 @@ template<typename VectorType> void vectorVisitor(const VectorType& w)
   VERIFY(eigen_maxidx == (std::min)(idx0,idx2));
 }
 
+template<typename MatrixType> void largeVisitor(typename MatrixType::Index rows, typename MatrixType::Index cols)
+{
+  typedef typename MatrixType::Scalar Scalar;
+  typedef typename MatrixType::Index Index;
+
+  // the values are within [-1,1], so the planted extrema are unique up to the duplicates
+  MatrixType m(rows, cols);
+  Index size = m.size();
+  for(Index k = 0; k < size; ++k)
+    m(k) = internal::random<Scalar>(Scalar(-1),Scalar(1));
+  Index i0 = internal::random<Index>(0,size-1), i1 = internal::random<Index>(0,size-1);
+  Index i2 = internal::random<Index>(0,size-1), i3 = internal::random<Index>(0,size-1);
+  m(i0) = m(i1) = Scalar(2);
+  m(i2) = m(i3) = Scalar(-2);
+  Index imax = (std::min)(i0,i1), imin = (std::min)(i2,i3);
+  if(imin==imax) return;
+
+  Index eigen_row, eigen_col;
+  VERIFY_IS_EQUAL(m.maxCoeff(&eigen_row,&eigen_col), Scalar(2));
+  VERIFY_IS_EQUAL(eigen_row + eigen_col*rows, imax);
+  VERIFY_IS_EQUAL(m.minCoeff(&eigen_row,&eigen_col), Scalar(-2));
+  VERIFY_IS_EQUAL(eigen_row + eigen_col*rows, imin);
+
+  // through an expression
+  VERIFY_IS_EQUAL((m*Scalar(3)).maxCoeff(&eigen_row,&eigen_col), Scalar(6));
+  VERIFY_IS_EQUAL(eigen_row + eigen_col*rows, imax);
+  VERIFY_IS_EQUAL((-m).maxCoeff(&eigen_row,&eigen_col), Scalar(2));
+  VERIFY_IS_EQUAL(eigen_row + eigen_col*rows, imin);
+}
+
+// compares the vectorized min/max visitors with the scalar traversal in the presence of NaN
+template<typename VectorType> void nanVisitor(typename VectorType::Index size)
+{
+  typedef typename VectorType::Scalar Scalar;
+  typedef typename VectorType::Index Index;
+  typedef internal::min_coeff_visitor<VectorType> MinVisitor;
+  typedef internal::max_coeff_visitor<VectorType> MaxVisitor;
+  const Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+
+  VectorType v = VectorType::Random(size);
+  // scattered NaNs, with one just before the extrema, and possibly one at the start
+  for(Index k = 0; k < size/64; ++k)
+    v(internal::random<Index>(0,size-1)) = nan;
+  Index i0 = internal::random<Index>(1,size-1), i1 = internal::random<Index>(1,size-1);
+  v(i0) = Scalar(-2);
+  v(i1) = Scalar(2);
+  if(i0>1 && i1>1)
+    v(i0-1) = v(i1-1) = nan;
+  if(internal::random<bool>())
+    v(0) = nan;
+
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    MinVisitor minRef; internal::visitor_impl<MinVisitor, VectorType, Dynamic>::run(v, minRef);
+    MaxVisitor maxRef; internal::visitor_impl<MaxVisitor, VectorType, Dynamic>::run(v, maxRef);
+    Index eigen_minidx, eigen_maxidx;
+    Scalar eigen_min = v.minCoeff(&eigen_minidx);
+    Scalar eigen_max = v.maxCoeff(&eigen_maxidx);
+    VERIFY_IS_EQUAL(eigen_minidx, minRef.row);
+    VERIFY_IS_EQUAL(eigen_maxidx, maxRef.row);
+    VERIFY((numext::isnan)(minRef.res) ? (numext::isnan)(eigen_min) : eigen_min==minRef.res);
+    VERIFY((numext::isnan)(maxRef.res) ? (numext::isnan)(eigen_max) : eigen_max==maxRef.res);
+    // a NaN at the start of the ranges of the threads, but not at the start of the vector
+    v(0) = Scalar(0);
+    for(Index t = 2; t <= 8; ++t)
+      for(Index k = 1; k < t; ++k)
+        v(k*(size/t)) = nan;
+  }
+}
+
+// a user visitor whose functor_traits only define Cost, as before the vectorized visitors
+template<typename Scalar>
+struct count_positive_visitor
+{
+  Index count;
+  void init(const Scalar& value, Index, Index) { count = value>Scalar(0) ? 1 : 0; }
+  void operator()(const Scalar& value, Index, Index) { if(value>Scalar(0)) ++count; }
+};
+
+namespace Eigen {
+namespace internal {
+template<typename Scalar>
+struct functor_traits<count_positive_visitor<Scalar> > { enum { Cost = NumTraits<Scalar>::AddCost }; };
+}
+}
+
+template<typename MatrixType> void userVisitor(typename MatrixType::Index rows, typename MatrixType::Index cols)
+{
+  typedef typename MatrixType::Scalar Scalar;
+  MatrixType m = MatrixType::Random(rows, cols);
+  count_positive_visitor<Scalar> visitor;
+  m.visit(visitor);
+  VERIFY_IS_EQUAL(visitor.count, Index((m.array()>Scalar(0)).count()));
+}
+
 void test_visitor()
 {
   for(int i = 0; i < g_repeat; i++) {
@@ -127,4 +222,13 @@ void test_visitor()
     CALL_SUBTEST_9( vectorVisitor(RowVectorXd(10)) );
     CALL_SUBTEST_10( vectorVisitor(VectorXf(33)) );
   }
+  for(int i = 0; i < g_repeat; i++) {
+    CALL_SUBTEST_11(( largeVisitor<VectorXf>(internal::random<int>(1,300000),1) ));
+    CALL_SUBTEST_11(( largeVisitor<MatrixXd>(internal::random<int>(1,1000),internal::random<int>(1,300)) ));
+    CALL_SUBTEST_12(( largeVisitor<RowVectorXi>(1,internal::random<int>(1,300000)) ));
+    CALL_SUBTEST_13(( nanVisitor<VectorXf>(internal::random<int>(64,300000)) ));
+    CALL_SUBTEST_13(( nanVisitor<VectorXd>(internal::random<int>(64,300000)) ));
+    CALL_SUBTEST_11(( userVisitor<VectorXf>(internal::random<int>(1,1000),1) ));
+    CALL_SUBTEST_11(( userVisitor<MatrixXd>(internal::random<int>(1,100),internal::random<int>(1,100)) ));
+  }
 }
@@ -13,7 +13,14 @@
 namespace Eigen
 {
 
-template<typename Functor> class AutoDiffJacobian : public Functor
+/** \class AutoDiffJacobian
+  * \brief Computes the jacobian of a functor by forward automatic differentiation
+  *
+  * \tparam Functor the functor, whose operator() must be templated on the scalar type
+  * \tparam MaxInputs an upper bound of the number of inputs when it is only known at runtime. The derivatives
+  *         are then stored inline, so that evaluating the functor on AutoDiffScalar's does not allocate.
+  */
+template<typename Functor, int MaxInputs = Functor::InputsAtCompileTime> class AutoDiffJacobian : public Functor
 {
 public:
   AutoDiffJacobian() : Functor() {}
@@ -38,7 +45,7 @@ public:
   typedef typename JacobianType::Scalar Scalar;
   typedef typename JacobianType::Index Index;
 
-  typedef Matrix<Scalar,InputsAtCompileTime,1> DerivativeType;
+  typedef Matrix<Scalar,InputsAtCompileTime,1,0,MaxInputs,1> DerivativeType;
   typedef AutoDiffScalar<DerivativeType> ActiveScalar;
 
 
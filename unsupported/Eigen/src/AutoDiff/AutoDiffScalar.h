@@ -42,6 +42,11 @@ template<typename _DerType, bool Enable> struct auto_diff_special_op;
   *                 existing vector into an AutoDiffScalar.
   *                 Finally, _DerType can also be any Eigen compatible expression.
   *
+  * When the number of derivatives is only known at runtime but is bounded, a vector type with a
+  * compile-time maximal size such as \c Matrix<double,Dynamic,1,0,16,1> stores the derivatives inline.
+  * All the operations and math functions below then propagate the derivatives without any heap
+  * allocation, while VectorXd requires one for every temporary AutoDiffScalar.
+  *
   * This class represents a scalar value while tracking its respective derivatives using Eigen's expression
   * template mechanism.
   *
@@ -589,13 +594,14 @@ pow(const Eigen::AutoDiffScalar<DerType>& x, typename Eigen::internal::traits<De
 
 
 template<typename DerTypeA,typename DerTypeB>
-inline const AutoDiffScalar<Matrix<typename internal::traits<DerTypeA>::Scalar,Dynamic,1> >
+inline const AutoDiffScalar<typename internal::remove_all<DerTypeA>::type::PlainObject>
 atan2(const AutoDiffScalar<DerTypeA>& a, const AutoDiffScalar<DerTypeB>& b)
 {
   using std::atan2;
-  typedef typename internal::traits<DerTypeA>::Scalar Scalar;
-  typedef AutoDiffScalar<Matrix<Scalar,Dynamic,1> > PlainADS;
+  typedef typename internal::traits<typename internal::remove_all<DerTypeA>::type>::Scalar Scalar;
+  typedef AutoDiffScalar<typename internal::remove_all<DerTypeA>::type::PlainObject> PlainADS;
   PlainADS ret;
+  internal::make_coherent(a.derivatives(), b.derivatives());
   ret.value() = atan2(a.value(), b.value());
   
   Scalar squared_hypot = a.value() * a.value() + b.value() * b.value();
@@ -626,7 +632,9 @@ EIGEN_AUTODIFF_DECLARE_GLOBAL_UNARY(acos,
 template<typename DerType> struct NumTraits<AutoDiffScalar<DerType> >
   : NumTraits< typename NumTraits<typename DerType::Scalar>::Real >
 {
-  typedef AutoDiffScalar<Matrix<typename NumTraits<typename DerType::Scalar>::Real,DerType::RowsAtCompileTime,DerType::ColsAtCompileTime> > Real;
+  typedef AutoDiffScalar<Matrix<typename NumTraits<typename DerType::Scalar>::Real,DerType::RowsAtCompileTime,DerType::ColsAtCompileTime,
+                                (DerType::RowsAtCompileTime==1 && DerType::ColsAtCompileTime!=1) ? RowMajor : ColMajor,
+                                DerType::MaxRowsAtCompileTime,DerType::MaxColsAtCompileTime> > Real;
   typedef AutoDiffScalar<DerType> NonInteger;
   typedef AutoDiffScalar<DerType>& Nested;
   enum{
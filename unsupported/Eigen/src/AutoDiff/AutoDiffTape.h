@@ -0,0 +1,672 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_AUTODIFF_TAPE_H
+#define EIGEN_AUTODIFF_TAPE_H
+
+namespace Eigen {
+
+template<typename _Scalar> class AutoDiffTape;
+
+namespace internal {
+
+// An operation recorded on the tape at the matrix level. Its outputs are the contiguous nodes [begin, end) of
+// the tape, and backward() adds the contribution of their adjoints to the adjoints of its inputs.
+template<typename Scalar>
+class autodiff_tape_operation
+{
+  public:
+    autodiff_tape_operation() : begin(0), end(0) {}
+    virtual ~autodiff_tape_operation() {}
+    virtual void backward(Scalar* adjoints) const = 0;
+
+    Index begin, end;
+
+  protected:
+    typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+    typedef Matrix<Index,Dynamic,Dynamic> IndexMatrix;
+
+    // extracts the values and tape indices of a matrix of active scalars, and returns whether one of them is not a constant
+    template<typename Derived>
+    static bool extract(const Derived& m, DenseMatrix& values, IndexMatrix& indices)
+    {
+      values.resize(m.rows(), m.cols());
+      indices.resize(m.rows(), m.cols());
+      bool active = false;
+      for(Index j=0; j<m.cols(); ++j)
+        for(Index i=0; i<m.rows(); ++i)
+        {
+          values(i,j) = m.coeff(i,j).value();
+          indices(i,j) = m.coeff(i,j).index();
+          active = active || indices(i,j)>=0;
+        }
+      return active;
+    }
+
+    static void scatter(Scalar* adjoints, const IndexMatrix& indices, const DenseMatrix& values)
+    {
+      for(Index j=0; j<indices.cols(); ++j)
+        for(Index i=0; i<indices.rows(); ++i)
+          if(indices(i,j)>=0)
+            adjoints[indices(i,j)] += values(i,j);
+    }
+
+    Map<const DenseMatrix> outputAdjoints(const Scalar* adjoints, Index rows, Index cols) const
+    {
+      return Map<const DenseMatrix>(adjoints + begin, rows, cols);
+    }
+};
+
+// C = A * B, whose adjoints are A' += C' B^T and B' += A^T C'
+template<typename Scalar>
+class autodiff_tape_product : public autodiff_tape_operation<Scalar>
+{
+    typedef autodiff_tape_operation<Scalar> Base;
+    typedef typename Base::DenseMatrix DenseMatrix;
+    typedef typename Base::IndexMatrix IndexMatrix;
+  public:
+    template<typename Lhs, typename Rhs>
+    autodiff_tape_product(const Lhs& lhs, const Rhs& rhs)
+    {
+      m_lhsActive = Base::extract(lhs, m_lhs, m_lhsIndices);
+      m_rhsActive = Base::extract(rhs, m_rhs, m_rhsIndices);
+    }
+
+    DenseMatrix result() const { return m_lhs * m_rhs; }
+
+    virtual void backward(Scalar* adjoints) const
+    {
+      Map<const DenseMatrix> resAdj = this->outputAdjoints(adjoints, m_lhs.rows(), m_rhs.cols());
+      if(m_lhsActive)
+        Base::scatter(adjoints, m_lhsIndices, DenseMatrix(resAdj * m_rhs.transpose()));
+      if(m_rhsActive)
+        Base::scatter(adjoints, m_rhsIndices, DenseMatrix(m_lhs.transpose() * resAdj));
+    }
+
+  protected:
+    DenseMatrix m_lhs, m_rhs;
+    IndexMatrix m_lhsIndices, m_rhsIndices;
+    bool m_lhsActive, m_rhsActive;
+};
+
+// X = A^-1 B computed by a PartialPivLU, whose adjoints are B' += A^-T X' and A' -= A^-T X' X^T
+template<typename Scalar>
+class autodiff_tape_solve : public autodiff_tape_operation<Scalar>
+{
+    typedef autodiff_tape_operation<Scalar> Base;
+    typedef typename Base::DenseMatrix DenseMatrix;
+    typedef typename Base::IndexMatrix IndexMatrix;
+  public:
+    template<typename Lhs, typename Rhs>
+    autodiff_tape_solve(const Lhs& lhs, const Rhs& rhs)
+    {
+      DenseMatrix a, b;
+      m_lhsActive = Base::extract(lhs, a, m_lhsIndices);
+      m_rhsActive = Base::extract(rhs, b, m_rhsIndices);
+      m_lu.compute(a);
+      m_solution = m_lu.solve(b);
+    }
+
+    const DenseMatrix& result() const { return m_solution; }
+
+    virtual void backward(Scalar* adjoints) const
+    {
+      // PA = LU, so that A^-T = P^T L^-T U^-T
+      DenseMatrix rhsAdj = m_lu.matrixLU().template triangularView<Upper>().transpose()
+                             .solve(this->outputAdjoints(adjoints, m_solution.rows(), m_solution.cols()));
+      m_lu.matrixLU().template triangularView<UnitLower>().transpose().solveInPlace(rhsAdj);
+      rhsAdj = m_lu.permutationP().transpose() * rhsAdj;
+      if(m_rhsActive)
+        Base::scatter(adjoints, m_rhsIndices, rhsAdj);
+      if(m_lhsActive)
+        Base::scatter(adjoints, m_lhsIndices, DenseMatrix(-rhsAdj * m_solution.transpose()));
+    }
+
+  protected:
+    PartialPivLU<DenseMatrix> m_lu;
+    DenseMatrix m_solution;
+    IndexMatrix m_lhsIndices, m_rhsIndices;
+    bool m_lhsActive, m_rhsActive;
+};
+
+} // end namespace internal
+
+/** \class AutoDiffReverseScalar
+  * \brief A scalar type replacement recording its operations on a tape for reverse mode automatic differentiation
+  *
+  * \param _Scalar the type of the values
+  *
+  * An AutoDiffReverseScalar is either a constant, or the result of an operation recorded on an AutoDiffTape,
+  * of which it only stores the position. Unlike AutoDiffScalar, its size does not depend on the number of
+  * variables, and the derivatives with respect to all the variables are obtained at once by a single backward
+  * sweep of the tape (see AutoDiffTape::gradient()).
+  *
+  * It supports the arithmetic operators and the same math functions as AutoDiffScalar, so that it can be used as
+  * the scalar type of an Eigen::Matrix. Such matrix expressions are however recorded coefficient by coefficient;
+  * AutoDiffTape::product() and AutoDiffTape::solve() record a whole matrix operation at once instead.
+  *
+  * \sa class AutoDiffTape, class AutoDiffGradient
+  */
+template<typename _Scalar>
+class AutoDiffReverseScalar
+{
+  public:
+    typedef _Scalar Scalar;
+    typedef AutoDiffTape<Scalar> Tape;
+
+    /** Default constructor: a constant zero */
+    AutoDiffReverseScalar() : m_value(0), m_index(-1), m_tape(0) {}
+
+    /** Conversion from a scalar constant */
+    /*explicit*/ AutoDiffReverseScalar(const Scalar& value) : m_value(value), m_index(-1), m_tape(0) {}
+
+    /** Constructs the active scalar of \a value recorded at position \a index of \a tape */
+    AutoDiffReverseScalar(const Scalar& value, Index index, Tape* tape) : m_value(value), m_index(index), m_tape(tape) {}
+
+    inline const Scalar& value() const { return m_value; }
+
+    /** \returns the position of this scalar on its tape, or -1 for a constant */
+    inline Index index() const { return m_index; }
+
+    /** \returns the tape recording this scalar, or 0 for a constant */
+    inline Tape* tape() const { return m_tape; }
+
+    inline bool isConstant() const { return m_tape==0; }
+
+    friend std::ostream & operator << (std::ostream & s, const AutoDiffReverseScalar& a)
+    {
+      return s << a.value();
+    }
+
+    friend inline bool operator< (const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b) { return a.m_value <  b.m_value; }
+    friend inline bool operator<=(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b) { return a.m_value <= b.m_value; }
+    friend inline bool operator> (const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b) { return a.m_value >  b.m_value; }
+    friend inline bool operator>=(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b) { return a.m_value >= b.m_value; }
+    friend inline bool operator==(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b) { return a.m_value == b.m_value; }
+    friend inline bool operator!=(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b) { return a.m_value != b.m_value; }
+
+    friend inline bool operator< (const AutoDiffReverseScalar& a, const Scalar& b) { return a.m_value <  b; }
+    friend inline bool operator<=(const AutoDiffReverseScalar& a, const Scalar& b) { return a.m_value <= b; }
+    friend inline bool operator> (const AutoDiffReverseScalar& a, const Scalar& b) { return a.m_value >  b; }
+    friend inline bool operator>=(const AutoDiffReverseScalar& a, const Scalar& b) { return a.m_value >= b; }
+    friend inline bool operator==(const AutoDiffReverseScalar& a, const Scalar& b) { return a.m_value == b; }
+    friend inline bool operator!=(const AutoDiffReverseScalar& a, const Scalar& b) { return a.m_value != b; }
+
+    friend inline bool operator< (const Scalar& a, const AutoDiffReverseScalar& b) { return a <  b.m_value; }
+    friend inline bool operator<=(const Scalar& a, const AutoDiffReverseScalar& b) { return a <= b.m_value; }
+    friend inline bool operator> (const Scalar& a, const AutoDiffReverseScalar& b) { return a >  b.m_value; }
+    friend inline bool operator>=(const Scalar& a, const AutoDiffReverseScalar& b) { return a >= b.m_value; }
+    friend inline bool operator==(const Scalar& a, const AutoDiffReverseScalar& b) { return a == b.m_value; }
+    friend inline bool operator!=(const Scalar& a, const AutoDiffReverseScalar& b) { return a != b.m_value; }
+
+    friend inline AutoDiffReverseScalar operator+(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b)
+    { return record(a.m_value + b.m_value, a, Scalar(1), b, Scalar(1)); }
+    friend inline AutoDiffReverseScalar operator+(const AutoDiffReverseScalar& a, const Scalar& b)
+    { return record(a.m_value + b, a, Scalar(1)); }
+    friend inline AutoDiffReverseScalar operator+(const Scalar& a, const AutoDiffReverseScalar& b)
+    { return record(a + b.m_value, b, Scalar(1)); }
+
+    friend inline AutoDiffReverseScalar operator-(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b)
+    { return record(a.m_value - b.m_value, a, Scalar(1), b, Scalar(-1)); }
+    friend inline AutoDiffReverseScalar operator-(const AutoDiffReverseScalar& a, const Scalar& b)
+    { return record(a.m_value - b, a, Scalar(1)); }
+    friend inline AutoDiffReverseScalar operator-(const Scalar& a, const AutoDiffReverseScalar& b)
+    { return record(a - b.m_value, b, Scalar(-1)); }
+
+    friend inline AutoDiffReverseScalar operator*(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b)
+    { return record(a.m_value * b.m_value, a, b.m_value, b, a.m_value); }
+    friend inline AutoDiffReverseScalar operator*(const AutoDiffReverseScalar& a, const Scalar& b)
+    { return record(a.m_value * b, a, b); }
+    friend inline AutoDiffReverseScalar operator*(const Scalar& a, const AutoDiffReverseScalar& b)
+    { return record(a * b.m_value, b, a); }
+
+    friend inline AutoDiffReverseScalar operator/(const AutoDiffReverseScalar& a, const AutoDiffReverseScalar& b)
+    {
+      Scalar inv = Scalar(1) / b.m_value;
+      return record(a.m_value * inv, a, inv, b, -a.m_value * inv * inv);
+    }
+    friend inline AutoDiffReverseScalar operator/(const AutoDiffReverseScalar& a, const Scalar& b)
+    { return record(a.m_value / b, a, Scalar(1) / b); }
+    friend inline AutoDiffReverseScalar operator/(const Scalar& a, const AutoDiffReverseScalar& b)
+    { return record(a / b.m_value, b, -a / (b.m_value * b.m_value)); }
+
+    inline AutoDiffReverseScalar operator-() const { return record(-m_value, *this, Scalar(-1)); }
+    inline const AutoDiffReverseScalar& operator+() const { return *this; }
+
+    inline AutoDiffReverseScalar& operator+=(const AutoDiffReverseScalar& other) { return *this = *this + other; }
+    inline AutoDiffReverseScalar& operator-=(const AutoDiffReverseScalar& other) { return *this = *this - other; }
+    inline AutoDiffReverseScalar& operator*=(const AutoDiffReverseScalar& other) { return *this = *this * other; }
+    inline AutoDiffReverseScalar& operator/=(const AutoDiffReverseScalar& other) { return *this = *this / other; }
+    inline AutoDiffReverseScalar& operator+=(const Scalar& other) { return *this = *this + other; }
+    inline AutoDiffReverseScalar& operator-=(const Scalar& other) { return *this = *this - other; }
+    inline AutoDiffReverseScalar& operator*=(const Scalar& other) { return *this = *this * other; }
+    inline AutoDiffReverseScalar& operator/=(const Scalar& other) { return *this = *this / other; }
+
+    /** \internal records the result \a value of a unary operation of local derivative \a da */
+    static AutoDiffReverseScalar record(const Scalar& value, const AutoDiffReverseScalar& a, const Scalar& da)
+    {
+      if(a.m_tape==0)
+        return AutoDiffReverseScalar(value);
+      return AutoDiffReverseScalar(value, a.m_tape->pushNode(a.m_index, da, -1, Scalar(0)), a.m_tape);
+    }
+
+    /** \internal records the result \a value of a binary operation of local derivatives \a da and \a db */
+    static AutoDiffReverseScalar record(const Scalar& value, const AutoDiffReverseScalar& a, const Scalar& da,
+                                        const AutoDiffReverseScalar& b, const Scalar& db)
+    {
+      Tape* tape = a.m_tape ? a.m_tape : b.m_tape;
+      eigen_assert((a.m_tape==0 || b.m_tape==0 || a.m_tape==b.m_tape) && "the operands must be recorded on the same tape");
+      if(tape==0)
+        return AutoDiffReverseScalar(value);
+      return AutoDiffReverseScalar(value, tape->pushNode(a.m_index, da, b.m_index, db), tape);
+    }
+
+  protected:
+    Scalar m_value;
+    Index m_index;
+    Tape* m_tape;
+};
+
+/** \class AutoDiffTape
+  * \brief The tape recording the operations on AutoDiffReverseScalar's
+  *
+  * \param _Scalar the type of the values
+  *
+  * Every operation on active scalars appends one node to the tape, which stores the positions of its (at most two)
+  * operands and the local partial derivatives with respect to them. The nodes are stored contiguously, and clear()
+  * keeps the memory of a tape so that recording the same function again does not allocate.
+  * A typical use is:
+  * \code
+  * AutoDiffTape<double> tape;
+  * Matrix<AutoDiffReverseScalar<double>,Dynamic,1> ax = tape.variables(x);
+  * AutoDiffReverseScalar<double> y = f(ax);
+  * VectorXd grad = tape.gradient(y, ax);
+  * \endcode
+  * The cost of the gradient is a small multiple of the cost of \c f, whatever the number of variables, while the
+  * forward mode of AutoDiffScalar multiplies that cost by the number of variables.
+  *
+  * A tape is not thread safe: each thread must record its operations on its own tape.
+  *
+  * \sa class AutoDiffReverseScalar, class AutoDiffGradient
+  */
+template<typename _Scalar>
+class AutoDiffTape
+{
+  public:
+    typedef _Scalar Scalar;
+    typedef AutoDiffReverseScalar<Scalar> ActiveScalar;
+
+    AutoDiffTape() {}
+
+    ~AutoDiffTape() { clear(); }
+
+    /** \returns the number of nodes recorded on the tape */
+    Index size() const { return Index(m_nodes.size()); }
+
+    /** Reserves the memory for \a size nodes */
+    void reserve(Index size) { m_nodes.reserve(size); }
+
+    /** Removes all the recorded operations. The memory of the tape is kept for the next recording. */
+    void clear()
+    {
+      for(size_t k=0; k<m_operations.size(); ++k)
+        delete m_operations[k];
+      m_operations.clear();
+      m_nodes.clear();
+    }
+
+    /** \returns a new variable of value \a value */
+    ActiveScalar variable(const Scalar& value)
+    {
+      return ActiveScalar(value, pushNode(-1, Scalar(0), -1, Scalar(0)), this);
+    }
+
+    /** \returns a matrix of new variables initialized from \a values */
+    template<typename Derived>
+    Matrix<ActiveScalar,Derived::RowsAtCompileTime,Derived::ColsAtCompileTime> variables(const MatrixBase<Derived>& values)
+    {
+      Matrix<ActiveScalar,Derived::RowsAtCompileTime,Derived::ColsAtCompileTime> res(values.rows(), values.cols());
+      for(Index j=0; j<values.cols(); ++j)
+        for(Index i=0; i<values.rows(); ++i)
+          res.coeffRef(i,j) = variable(values.coeff(i,j));
+      return res;
+    }
+
+    /** Computes the adjoints of all the nodes recorded before \a y, i.e., the derivatives of \a y with respect to them.
+      * \sa adjoint(), gradient()
+      */
+    void backward(const ActiveScalar& y)
+    {
+      eigen_assert((y.tape()==0 || y.tape()==this) && "y is recorded on another tape");
+      m_adjoints.assign(m_nodes.size(), Scalar(0));
+      if(y.index()<0)
+        return;
+      m_adjoints[y.index()] = Scalar(1);
+      sweep(y.index());
+    }
+
+    /** Computes the adjoints of all the nodes for the linear combination of the entries of \a y weighted by \a seeds,
+      * i.e., the product of \a seeds by the jacobian of \a y in a single backward sweep.
+      */
+    template<typename Derived, typename SeedDerived>
+    void backward(const MatrixBase<Derived>& y, const MatrixBase<SeedDerived>& seeds)
+    {
+      eigen_assert(y.rows()==seeds.rows() && y.cols()==seeds.cols());
+      m_adjoints.assign(m_nodes.size(), Scalar(0));
+      Index last = -1;
+      for(Index j=0; j<y.cols(); ++j)
+        for(Index i=0; i<y.rows(); ++i)
+        {
+          const ActiveScalar& yij = y.coeff(i,j);
+          eigen_assert((yij.tape()==0 || yij.tape()==this) && "y is recorded on another tape");
+          if(yij.index()<0)
+            continue;
+          m_adjoints[yij.index()] += seeds.coeff(i,j);
+          last = (std::max)(last, yij.index());
+        }
+      if(last>=0)
+        sweep(last);
+    }
+
+    /** \returns the adjoint of \a x computed by the last call to backward() */
+    Scalar adjoint(const ActiveScalar& x) const
+    {
+      return (x.index()>=0 && x.index()<Index(m_adjoints.size())) ? m_adjoints[x.index()] : Scalar(0);
+    }
+
+    /** \returns the adjoints of the entries of \a x computed by the last call to backward() */
+    template<typename Derived>
+    Matrix<Scalar,Derived::RowsAtCompileTime,Derived::ColsAtCompileTime> adjoints(const MatrixBase<Derived>& x) const
+    {
+      Matrix<Scalar,Derived::RowsAtCompileTime,Derived::ColsAtCompileTime> res(x.rows(), x.cols());
+      for(Index j=0; j<x.cols(); ++j)
+        for(Index i=0; i<x.rows(); ++i)
+          res.coeffRef(i,j) = adjoint(x.coeff(i,j));
+      return res;
+    }
+
+    /** \returns the gradient of \a y with respect to the entries of \a x, computed by a single backward sweep */
+    template<typename Derived>
+    Matrix<Scalar,Derived::RowsAtCompileTime,Derived::ColsAtCompileTime> gradient(const ActiveScalar& y, const MatrixBase<Derived>& x)
+    {
+      backward(y);
+      return adjoints(x);
+    }
+
+    /** \returns the product \a lhs * \a rhs recorded as a single operation on the tape.
+      *
+      * The plain product of two matrices of active scalars records two nodes per multiply-add, while this one only
+      * keeps a copy of the values of the operands and computes their adjoints by two matrix products.
+      */
+    template<typename Lhs, typename Rhs>
+    Matrix<ActiveScalar,Lhs::RowsAtCompileTime,Rhs::ColsAtCompileTime> product(const MatrixBase<Lhs>& lhs, const MatrixBase<Rhs>& rhs)
+    {
+      eigen_assert(lhs.cols()==rhs.rows() && "invalid matrix product");
+      internal::autodiff_tape_product<Scalar>* op = new internal::autodiff_tape_product<Scalar>(lhs.derived(), rhs.derived());
+      return pushOperation(op, op->result());
+    }
+
+    /** \returns the solution X of \a lhs * X = \a rhs computed by a PartialPivLU and recorded as a single operation on the tape.
+      *
+      * The adjoints are obtained by solving with the transposed factors, which costs much less than recording the
+      * factorization coefficient by coefficient. As for PartialPivLU, \a lhs must be invertible.
+      */
+    template<typename Lhs, typename Rhs>
+    Matrix<ActiveScalar,Lhs::ColsAtCompileTime,Rhs::ColsAtCompileTime> solve(const MatrixBase<Lhs>& lhs, const MatrixBase<Rhs>& rhs)
+    {
+      eigen_assert(lhs.rows()==lhs.cols() && lhs.rows()==rhs.rows() && "invalid linear system");
+      internal::autodiff_tape_solve<Scalar>* op = new internal::autodiff_tape_solve<Scalar>(lhs.derived(), rhs.derived());
+      return pushOperation(op, op->result());
+    }
+
+    /** \internal appends a node of operands \a a and \a b (-1 if none) of partial derivatives \a da and \a db */
+    Index pushNode(Index a, const Scalar& da, Index b, const Scalar& db)
+    {
+      Node node;
+      node.operands[0] = a;
+      node.operands[1] = b;
+      node.partials[0] = da;
+      node.partials[1] = db;
+      m_nodes.push_back(node);
+      return Index(m_nodes.size()) - 1;
+    }
+
+  protected:
+    struct Node
+    {
+      Index operands[2];
+      Scalar partials[2];
+    };
+    typedef internal::autodiff_tape_operation<Scalar> Operation;
+
+    // the results of the operation are new nodes without operands
+    template<typename ResultType>
+    Matrix<ActiveScalar,Dynamic,Dynamic> pushOperation(Operation* op, const ResultType& result)
+    {
+      op->begin = size();
+      Matrix<ActiveScalar,Dynamic,Dynamic> res(result.rows(), result.cols());
+      for(Index j=0; j<result.cols(); ++j)
+        for(Index i=0; i<result.rows(); ++i)
+          res(i,j) = ActiveScalar(result(i,j), pushNode(-1, Scalar(0), -1, Scalar(0)), this);
+      op->end = size();
+      m_operations.push_back(op);
+      return res;
+    }
+
+    // propagates the adjoints from the node last down to the first one
+    void sweep(Index last)
+    {
+      Scalar* adjoints = &m_adjoints[0];
+      Index k = Index(m_operations.size()) - 1;
+      Index i = last;
+      while(i>=0)
+      {
+        while(k>=0 && m_operations[k]->begin>i)
+          --k;
+        if(k>=0 && i<m_operations[k]->end)
+        {
+          // all the nodes using the results of the operation have been processed
+          m_operations[k]->backward(adjoints);
+          i = m_operations[k]->begin - 1;
+          --k;
+          continue;
+        }
+        const Node& node = m_nodes[i];
+        Scalar a = adjoints[i];
+        if(a!=Scalar(0))
+        {
+          if(node.operands[0]>=0) adjoints[node.operands[0]] += node.partials[0] * a;
+          if(node.operands[1]>=0) adjoints[node.operands[1]] += node.partials[1] * a;
+        }
+        --i;
+      }
+    }
+
+    std::vector<Node> m_nodes;
+    std::vector<Scalar> m_adjoints;
+    std::vector<Operation*> m_operations;
+
+  private:
+    AutoDiffTape(const AutoDiffTape&);
+    AutoDiffTape& operator=(const AutoDiffTape&);
+};
+
+/** \class AutoDiffGradient
+  * \brief Computes the gradient of a scalar functor by reverse automatic differentiation
+  *
+  * The functor must define \c InputsAtCompileTime and \c InputType, and provide a templated evaluation operator
+  * \code
+  * template<typename T> T operator()(const Matrix<T,InputsAtCompileTime,1>& x) const;
+  * \endcode
+  * which is called with T = AutoDiffReverseScalar<Scalar>. The tape is kept between the evaluations.
+  *
+  * \sa class AutoDiffTape, class AutoDiffJacobian
+  */
+template<typename Functor> class AutoDiffGradient : public Functor
+{
+public:
+  AutoDiffGradient() : Functor() {}
+  AutoDiffGradient(const Functor& f) : Functor(f) {}
+  AutoDiffGradient(const AutoDiffGradient& other) : Functor(other) {}
+
+  // forward constructors
+  template<typename T0>
+  AutoDiffGradient(const T0& a0) : Functor(a0) {}
+  template<typename T0, typename T1>
+  AutoDiffGradient(const T0& a0, const T1& a1) : Functor(a0, a1) {}
+  template<typename T0, typename T1, typename T2>
+  AutoDiffGradient(const T0& a0, const T1& a1, const T2& a2) : Functor(a0, a1, a2) {}
+
+  enum {
+    InputsAtCompileTime = Functor::InputsAtCompileTime
+  };
+
+  typedef typename Functor::InputType InputType;
+  typedef typename InputType::Scalar Scalar;
+  typedef AutoDiffTape<Scalar> Tape;
+  typedef typename Tape::ActiveScalar ActiveScalar;
+  typedef Matrix<ActiveScalar, InputsAtCompileTime, 1> ActiveInput;
+
+  /** \returns the value of the functor at \a x, and stores its gradient in \a grad if it is not null */
+  Scalar operator() (const InputType& x, InputType* grad = 0) const
+  {
+    m_tape.clear();
+    ActiveInput ax = m_tape.variables(x);
+    ActiveScalar y = Functor::operator()(ax);
+    if(grad)
+      *grad = m_tape.gradient(y, ax);
+    return y.value();
+  }
+
+  /** \returns the tape of the last evaluation */
+  const Tape& tape() const { return m_tape; }
+
+protected:
+  mutable Tape m_tape;
+};
+
+template<typename _Scalar>
+inline const AutoDiffReverseScalar<_Scalar>& conj(const AutoDiffReverseScalar<_Scalar>& x)  { return x; }
+template<typename _Scalar>
+inline const AutoDiffReverseScalar<_Scalar>& real(const AutoDiffReverseScalar<_Scalar>& x)  { return x; }
+template<typename _Scalar>
+inline _Scalar imag(const AutoDiffReverseScalar<_Scalar>&)    { return 0.; }
+template<typename _Scalar>
+inline AutoDiffReverseScalar<_Scalar> (min)(const AutoDiffReverseScalar<_Scalar>& x, const AutoDiffReverseScalar<_Scalar>& y) { return (x <= y ? x : y); }
+template<typename _Scalar>
+inline AutoDiffReverseScalar<_Scalar> (max)(const AutoDiffReverseScalar<_Scalar>& x, const AutoDiffReverseScalar<_Scalar>& y) { return (x >= y ? x : y); }
+
+#define EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(FUNC,CODE) \
+  template<typename _Scalar> \
+  inline Eigen::AutoDiffReverseScalar<_Scalar> FUNC(const Eigen::AutoDiffReverseScalar<_Scalar>& x) { \
+    using namespace Eigen; \
+    typedef _Scalar Scalar; \
+    typedef AutoDiffReverseScalar<Scalar> ReturnType; \
+    CODE; \
+  }
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(abs,
+  using std::abs;
+  return ReturnType::record(abs(x.value()), x, Scalar(x.value()<0 ? -1 : 1));)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(abs2,
+  using numext::abs2;
+  return ReturnType::record(abs2(x.value()), x, Scalar(2)*x.value());)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(sqrt,
+  using std::sqrt;
+  Scalar sqrtx = sqrt(x.value());
+  return ReturnType::record(sqrtx, x, Scalar(0.5) / sqrtx);)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(cos,
+  using std::cos;
+  using std::sin;
+  return ReturnType::record(cos(x.value()), x, -sin(x.value()));)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(sin,
+  using std::sin;
+  using std::cos;
+  return ReturnType::record(sin(x.value()), x, cos(x.value()));)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(exp,
+  using std::exp;
+  Scalar expx = exp(x.value());
+  return ReturnType::record(expx, x, expx);)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(log,
+  using std::log;
+  return ReturnType::record(log(x.value()), x, Scalar(1)/x.value());)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(tan,
+  using std::tan;
+  using std::cos;
+  return ReturnType::record(tan(x.value()), x, Scalar(1)/numext::abs2(cos(x.value())));)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(asin,
+  using std::sqrt;
+  using std::asin;
+  return ReturnType::record(asin(x.value()), x, Scalar(1)/sqrt(1-numext::abs2(x.value())));)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(acos,
+  using std::sqrt;
+  using std::acos;
+  return ReturnType::record(acos(x.value()), x, Scalar(-1)/sqrt(1-numext::abs2(x.value())));)
+
+EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY(atan,
+  using std::atan;
+  return ReturnType::record(atan(x.value()), x, Scalar(1)/(1+numext::abs2(x.value())));)
+
+#undef EIGEN_AUTODIFF_REVERSE_DECLARE_GLOBAL_UNARY
+
+template<typename _Scalar>
+inline AutoDiffReverseScalar<_Scalar> pow(const AutoDiffReverseScalar<_Scalar>& x, const typename AutoDiffReverseScalar<_Scalar>::Scalar& y)
+{
+  using std::pow;
+  return AutoDiffReverseScalar<_Scalar>::record(pow(x.value(),y), x, y * pow(x.value(),y-1));
+}
+
+template<typename _Scalar>
+inline AutoDiffReverseScalar<_Scalar> atan2(const AutoDiffReverseScalar<_Scalar>& a, const AutoDiffReverseScalar<_Scalar>& b)
+{
+  using std::atan2;
+  // if (squared_hypot==0) the derivation is undefined and the following results in a NaN:
+  _Scalar squared_hypot = a.value() * a.value() + b.value() * b.value();
+  return AutoDiffReverseScalar<_Scalar>::record(atan2(a.value(), b.value()), a, b.value() / squared_hypot, b, -a.value() / squared_hypot);
+}
+
+template<typename _Scalar> struct NumTraits<AutoDiffReverseScalar<_Scalar> >
+  : NumTraits<_Scalar>
+{
+  typedef AutoDiffReverseScalar<typename NumTraits<_Scalar>::Real> Real;
+  typedef AutoDiffReverseScalar<_Scalar> NonInteger;
+  typedef AutoDiffReverseScalar<_Scalar> Nested;
+  enum{
+    RequireInitialization = 1
+  };
+};
+
+namespace internal {
+
+template<typename _Scalar>
+struct scalar_product_traits<AutoDiffReverseScalar<_Scalar>,_Scalar>
+{
+  enum { Defined = 1 };
+  typedef AutoDiffReverseScalar<_Scalar> ReturnType;
+};
+
+template<typename _Scalar>
+struct scalar_product_traits<_Scalar,AutoDiffReverseScalar<_Scalar> >
+{
+  enum { Defined = 1 };
+  typedef AutoDiffReverseScalar<_Scalar> ReturnType;
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_AUTODIFF_TAPE_H
@@ -43,6 +43,38 @@ bool intersect_helper(const BVH &tree, Intersector &intersector, typename BVH::I
 }
 #endif //not EIGEN_PARSED_BY_DOXYGEN
 
+//The size of a bounding volume, which tells which hierarchy to descend first in queries over the cartesian product of two hierarchies.
+//It is negative when it is unknown, in which case both hierarchies are descended simultaneously.
+template<typename Volume>
+struct bv_volume_size
+{
+  static double run(const Volume &) { return -1.; }
+};
+
+template<typename Scalar, int Dim>
+struct bv_volume_size<AlignedBox<Scalar, Dim> >
+{
+  static double run(const AlignedBox<Scalar, Dim> &box) { return box.isEmpty() ? 0. : static_cast<double>(box.diagonal().squaredNorm()); }
+};
+
+//a pair of nodes of two hierarchies, with the sizes of their volumes if they are known
+template<typename Index1, typename Index2>
+struct bv_node_pair
+{
+  bv_node_pair(Index1 i1, Index2 i2, double s1 = -1., double s2 = -1.) : first(i1), second(i2), size1(s1), size2(s2) {}
+  bool sizesKnown() const { return size1 >= 0. && size2 >= 0.; }
+  Index1 first;
+  Index2 second;
+  double size1, size2;
+};
+
+//orders the elements of a priority queue by their first member only, the smallest being at the top
+template<typename QueueElement>
+struct bv_queue_greater
+{
+  bool operator()(const QueueElement &a, const QueueElement &b) const { return b.first < a.first; }
+};
+
 template<typename Volume1, typename Object1, typename Object2, typename Intersector>
 struct intersector_helper1
 {
@@ -90,12 +122,17 @@ void BVIntersect(const BVH &tree, Intersector &intersector)
   \endcode
   */
 template<typename BVH1, typename BVH2, typename Intersector>
-void BVIntersect(const BVH1 &tree1, const BVH2 &tree2, Intersector &intersector) //TODO: tandem descent when it makes sense
+void BVIntersect(const BVH1 &tree1, const BVH2 &tree2, Intersector &intersector)
 {
   typedef typename BVH1::Index Index1;
   typedef typename BVH2::Index Index2;
-  typedef internal::intersector_helper1<typename BVH1::Volume, typename BVH1::Object, typename BVH2::Object, Intersector> Helper1;
-  typedef internal::intersector_helper2<typename BVH2::Volume, typename BVH2::Object, typename BVH1::Object, Intersector> Helper2;
+  typedef typename BVH1::Volume Volume1;
+  typedef typename BVH2::Volume Volume2;
+  typedef internal::intersector_helper1<Volume1, typename BVH1::Object, typename BVH2::Object, Intersector> Helper1;
+  typedef internal::intersector_helper2<Volume2, typename BVH2::Object, typename BVH1::Object, Intersector> Helper2;
+  typedef internal::bv_volume_size<Volume1> VolumeSize1;
+  typedef internal::bv_volume_size<Volume2> VolumeSize2;
+  typedef internal::bv_node_pair<Index1, Index2> NodePair;
   typedef typename BVH1::VolumeIterator VolIter1;
   typedef typename BVH1::ObjectIterator ObjIter1;
   typedef typename BVH2::VolumeIterator VolIter2;
@@ -106,18 +143,62 @@ void BVIntersect(const BVH1 &tree1, const BVH2 &tree2, Intersector &intersector)
   VolIter2 vBegin2 = VolIter2(), vEnd2 = VolIter2(), vCur2 = VolIter2();
   ObjIter2 oBegin2 = ObjIter2(), oEnd2 = ObjIter2(), oCur2 = ObjIter2();
 
-  std::vector<std::pair<Index1, Index2> > todo(1, std::make_pair(tree1.getRootIndex(), tree2.getRootIndex()));
+  std::vector<NodePair> todo(1, NodePair(tree1.getRootIndex(), tree2.getRootIndex()));
 
   while(!todo.empty()) {
-    tree1.getChildren(todo.back().first, vBegin1, vEnd1, oBegin1, oEnd1);
-    tree2.getChildren(todo.back().second, vBegin2, vEnd2, oBegin2, oEnd2);
+    NodePair cur = todo.back();
     todo.pop_back();
 
+    if(cur.sizesKnown()) { //tandem descent: only the larger of the two volumes is split
+      if(cur.size1 >= cur.size2) {
+        const Volume2 &vol2 = tree2.getVolume(cur.second);
+        tree1.getChildren(cur.first, vBegin1, vEnd1, oBegin1, oEnd1);
+
+        for(; vBegin1 != vEnd1; ++vBegin1) { //go through child volumes of first tree
+          const Volume1 &vol1 = tree1.getVolume(*vBegin1);
+          if(intersector.intersectVolumeVolume(vol1, vol2))
+            todo.push_back(NodePair(*vBegin1, cur.second, VolumeSize1::run(vol1), cur.size2));
+        }
+
+        for(; oBegin1 != oEnd1; ++oBegin1) { //go through child objects of first tree
+          if(!intersector.intersectObjectVolume(*oBegin1, vol2))
+            continue;
+          Helper2 helper(*oBegin1, intersector);
+          if(internal::intersect_helper(tree2, helper, cur.second))
+            return; //intersector said to stop query
+        }
+      }
+      else {
+        const Volume1 &vol1 = tree1.getVolume(cur.first);
+        tree2.getChildren(cur.second, vBegin2, vEnd2, oBegin2, oEnd2);
+
+        for(; vBegin2 != vEnd2; ++vBegin2) { //go through child volumes of second tree
+          const Volume2 &vol2 = tree2.getVolume(*vBegin2);
+          if(intersector.intersectVolumeVolume(vol1, vol2))
+            todo.push_back(NodePair(cur.first, *vBegin2, cur.size1, VolumeSize2::run(vol2)));
+        }
+
+        for(; oBegin2 != oEnd2; ++oBegin2) { //go through child objects of second tree
+          if(!intersector.intersectVolumeObject(vol1, *oBegin2))
+            continue;
+          Helper1 helper(*oBegin2, intersector);
+          if(internal::intersect_helper(tree1, helper, cur.first))
+            return; //intersector said to stop query
+        }
+      }
+      continue;
+    }
+
+    //the sizes of the volumes are unknown: both hierarchies are descended simultaneously
+    tree1.getChildren(cur.first, vBegin1, vEnd1, oBegin1, oEnd1);
+    tree2.getChildren(cur.second, vBegin2, vEnd2, oBegin2, oEnd2);
+
     for(; vBegin1 != vEnd1; ++vBegin1) { //go through child volumes of first tree
-      const typename BVH1::Volume &vol1 = tree1.getVolume(*vBegin1);
+      const Volume1 &vol1 = tree1.getVolume(*vBegin1);
       for(vCur2 = vBegin2; vCur2 != vEnd2; ++vCur2) { //go through child volumes of second tree
-        if(intersector.intersectVolumeVolume(vol1, tree2.getVolume(*vCur2)))
-          todo.push_back(std::make_pair(*vBegin1, *vCur2));
+        const Volume2 &vol2 = tree2.getVolume(*vCur2);
+        if(intersector.intersectVolumeVolume(vol1, vol2))
+          todo.push_back(NodePair(*vBegin1, *vCur2, VolumeSize1::run(vol1), VolumeSize2::run(vol2)));
       }
 
       for(oCur2 = oBegin2; oCur2 != oEnd2; ++oCur2) {//go through child objects of second tree
@@ -161,6 +242,8 @@ typename Minimizer::Scalar minimize_helper(const BVH &tree, Minimizer &minimizer
   todo.push(std::make_pair(Scalar(), root));
 
   while(!todo.empty()) {
+    if(todo.top().second != root && !(todo.top().first < minimum))
+      break; //none of the remaining volumes can lower the minimum (the priority of the root is not a bound)
     tree.getChildren(todo.top().second, vBegin, vEnd, oBegin, oEnd);
     todo.pop();
 
@@ -237,9 +320,14 @@ typename Minimizer::Scalar BVMinimize(const BVH1 &tree1, const BVH2 &tree2, Mini
   typedef typename Minimizer::Scalar Scalar;
   typedef typename BVH1::Index Index1;
   typedef typename BVH2::Index Index2;
-  typedef internal::minimizer_helper1<typename BVH1::Volume, typename BVH1::Object, typename BVH2::Object, Minimizer> Helper1;
-  typedef internal::minimizer_helper2<typename BVH2::Volume, typename BVH2::Object, typename BVH1::Object, Minimizer> Helper2;
-  typedef std::pair<Scalar, std::pair<Index1, Index2> > QueueElement; //first element is priority
+  typedef typename BVH1::Volume Volume1;
+  typedef typename BVH2::Volume Volume2;
+  typedef internal::minimizer_helper1<Volume1, typename BVH1::Object, typename BVH2::Object, Minimizer> Helper1;
+  typedef internal::minimizer_helper2<Volume2, typename BVH2::Object, typename BVH1::Object, Minimizer> Helper2;
+  typedef internal::bv_volume_size<Volume1> VolumeSize1;
+  typedef internal::bv_volume_size<Volume2> VolumeSize2;
+  typedef internal::bv_node_pair<Index1, Index2> NodePair;
+  typedef std::pair<Scalar, NodePair> QueueElement; //first element is priority
   typedef typename BVH1::VolumeIterator VolIter1;
   typedef typename BVH1::ObjectIterator ObjIter1;
   typedef typename BVH2::VolumeIterator VolIter2;
@@ -249,16 +337,61 @@ typename Minimizer::Scalar BVMinimize(const BVH1 &tree1, const BVH2 &tree2, Mini
   ObjIter1 oBegin1 = ObjIter1(), oEnd1 = ObjIter1();
   VolIter2 vBegin2 = VolIter2(), vEnd2 = VolIter2(), vCur2 = VolIter2();
   ObjIter2 oBegin2 = ObjIter2(), oEnd2 = ObjIter2(), oCur2 = ObjIter2();
-  std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement> > todo; //smallest is at the top
+  std::priority_queue<QueueElement, std::vector<QueueElement>, internal::bv_queue_greater<QueueElement> > todo; //smallest is at the top
 
   Scalar minimum = (std::numeric_limits<Scalar>::max)();
-  todo.push(std::make_pair(Scalar(), std::make_pair(tree1.getRootIndex(), tree2.getRootIndex())));
+  const Index1 root1 = tree1.getRootIndex();
+  const Index2 root2 = tree2.getRootIndex();
+  todo.push(std::make_pair(Scalar(), NodePair(root1, root2)));
 
   while(!todo.empty()) {
-    tree1.getChildren(todo.top().second.first, vBegin1, vEnd1, oBegin1, oEnd1);
-    tree2.getChildren(todo.top().second.second, vBegin2, vEnd2, oBegin2, oEnd2);
+    NodePair cur = todo.top().second;
+    if((cur.first != root1 || cur.second != root2) && !(todo.top().first < minimum))
+      break; //none of the remaining pairs of volumes can lower the minimum (the priority of the roots is not a bound)
     todo.pop();
 
+    if(cur.sizesKnown()) { //tandem descent: only the larger of the two volumes is split
+      if(cur.size1 >= cur.size2) {
+        const Volume2 &vol2 = tree2.getVolume(cur.second);
+        tree1.getChildren(cur.first, vBegin1, vEnd1, oBegin1, oEnd1);
+
+        for(; oBegin1 != oEnd1; ++oBegin1) { //go through child objects of first tree
+          Helper2 helper(*oBegin1, minimizer);
+          if(minimizer.minimumOnObjectVolume(*oBegin1, vol2) < minimum)
+            minimum = (std::min)(minimum, internal::minimize_helper(tree2, helper, cur.second, minimum));
+        }
+
+        for(; vBegin1 != vEnd1; ++vBegin1) { //go through child volumes of first tree
+          const Volume1 &vol1 = tree1.getVolume(*vBegin1);
+          Scalar val = minimizer.minimumOnVolumeVolume(vol1, vol2);
+          if(val < minimum)
+            todo.push(std::make_pair(val, NodePair(*vBegin1, cur.second, VolumeSize1::run(vol1), cur.size2)));
+        }
+      }
+      else {
+        const Volume1 &vol1 = tree1.getVolume(cur.first);
+        tree2.getChildren(cur.second, vBegin2, vEnd2, oBegin2, oEnd2);
+
+        for(; oBegin2 != oEnd2; ++oBegin2) { //go through child objects of second tree
+          Helper1 helper(*oBegin2, minimizer);
+          if(minimizer.minimumOnVolumeObject(vol1, *oBegin2) < minimum)
+            minimum = (std::min)(minimum, internal::minimize_helper(tree1, helper, cur.first, minimum));
+        }
+
+        for(; vBegin2 != vEnd2; ++vBegin2) { //go through child volumes of second tree
+          const Volume2 &vol2 = tree2.getVolume(*vBegin2);
+          Scalar val = minimizer.minimumOnVolumeVolume(vol1, vol2);
+          if(val < minimum)
+            todo.push(std::make_pair(val, NodePair(cur.first, *vBegin2, cur.size1, VolumeSize2::run(vol2))));
+        }
+      }
+      continue;
+    }
+
+    //the sizes of the volumes are unknown: both hierarchies are descended simultaneously
+    tree1.getChildren(cur.first, vBegin1, vEnd1, oBegin1, oEnd1);
+    tree2.getChildren(cur.second, vBegin2, vEnd2, oBegin2, oEnd2);
+
     for(; oBegin1 != oEnd1; ++oBegin1) { //go through child objects of first tree
       for(oCur2 = oBegin2; oCur2 != oEnd2; ++oCur2) {//go through child objects of second tree
         minimum = (std::min)(minimum, minimizer.minimumOnObjectObject(*oBegin1, *oCur2));
@@ -271,7 +404,7 @@ typename Minimizer::Scalar BVMinimize(const BVH1 &tree1, const BVH2 &tree2, Mini
     }
 
     for(; vBegin1 != vEnd1; ++vBegin1) { //go through child volumes of first tree
-      const typename BVH1::Volume &vol1 = tree1.getVolume(*vBegin1);
+      const Volume1 &vol1 = tree1.getVolume(*vBegin1);
 
       for(oCur2 = oBegin2; oCur2 != oEnd2; ++oCur2) {//go through child objects of second tree
         Helper1 helper(*oCur2, minimizer);
@@ -279,15 +412,53 @@ typename Minimizer::Scalar BVMinimize(const BVH1 &tree1, const BVH2 &tree2, Mini
       }
 
       for(vCur2 = vBegin2; vCur2 != vEnd2; ++vCur2) { //go through child volumes of second tree
-        Scalar val = minimizer.minimumOnVolumeVolume(vol1, tree2.getVolume(*vCur2));
+        const Volume2 &vol2 = tree2.getVolume(*vCur2);
+        Scalar val = minimizer.minimumOnVolumeVolume(vol1, vol2);
         if(val < minimum)
-          todo.push(std::make_pair(val, std::make_pair(*vBegin1, *vCur2)));
+          todo.push(std::make_pair(val, NodePair(*vBegin1, *vCur2, VolumeSize1::run(vol1), VolumeSize2::run(vol2))));
       }
     }
   }
   return minimum;
 }
 
+/**  Runs the queries encapsulated by the intersectors of the range [\a begin, \a end) on \a tree.
+  *  This is equivalent to calling BVIntersect(tree, *it) for each intersector of the range, but the queries are shared
+  *  among the threads when OpenMP is enabled. The intersectors must therefore not share any mutable state.
+  *  \a IntersectorIterator must be a random access iterator.
+  */
+template<typename BVH, typename IntersectorIterator>
+void BVIntersectBatch(const BVH &tree, IntersectorIterator begin, IntersectorIterator end)
+{
+  std::ptrdiff_t size = end - begin;
+#ifdef EIGEN_HAS_OPENMP
+  Eigen::initParallel();
+  int threads = Eigen::nbThreads();
+  #pragma omp parallel for schedule(dynamic,16) num_threads(threads) if(threads > 1 && size > 1)
+#endif
+  for(std::ptrdiff_t i = 0; i < size; ++i)
+    internal::intersect_helper(tree, begin[i], tree.getRootIndex());
+}
+
+/**  Runs the queries encapsulated by the minimizers of the range [\a begin, \a end) on \a tree, and writes the minimum
+  *  value of each query to the range starting at \a minima.
+  *  This is equivalent to calling BVMinimize(tree, *it) for each minimizer of the range, but the queries are shared
+  *  among the threads when OpenMP is enabled. The minimizers must therefore not share any mutable state.
+  *  \a MinimizerIterator and \a OutputIterator must be random access iterators.
+  */
+template<typename BVH, typename MinimizerIterator, typename OutputIterator>
+void BVMinimizeBatch(const BVH &tree, MinimizerIterator begin, MinimizerIterator end, OutputIterator minima)
+{
+  std::ptrdiff_t size = end - begin;
+#ifdef EIGEN_HAS_OPENMP
+  Eigen::initParallel();
+  int threads = Eigen::nbThreads();
+  #pragma omp parallel for schedule(dynamic,16) num_threads(threads) if(threads > 1 && size > 1)
+#endif
+  for(std::ptrdiff_t i = 0; i < size; ++i)
+    minima[i] = BVMinimize(tree, begin[i]);
+}
+
 } // end namespace Eigen
 
 #endif // EIGEN_BVALGORITHMS_H
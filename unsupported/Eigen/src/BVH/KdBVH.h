@@ -14,19 +14,6 @@ namespace Eigen {
 
 namespace internal {
 
-//internal pair class for the BVH--used instead of std::pair because of alignment
-template<typename Scalar, int Dim>
-struct vector_int_pair
-{
-EIGEN_MAKE_ALIGNED_OPERATOR_NEW_IF_VECTORIZABLE_FIXED_SIZE(Scalar, Dim)
-  typedef Matrix<Scalar, Dim, 1> VectorType;
-
-  vector_int_pair(const VectorType &v, int i) : first(v), second(i) {}
-
-  VectorType first;
-  int second;
-};
-
 //these templates help the tree initializer get the bounding boxes either from a provided
 //iterator range or using bounding_box in a unified way
 template<typename ObjectList, typename VolumeList, typename BoxIter>
@@ -48,26 +35,54 @@ struct get_boxes_helper<ObjectList, VolumeList, int> {
   }
 };
 
+//the measure of a box used by the surface area heuristic: half of its surface area (its half perimeter in 2D),
+//or the sum of its sizes when the boxes are flat
+template<typename Scalar, int Dim>
+Scalar kdbvh_box_measure(const AlignedBox<Scalar, Dim> &box, bool flat)
+{
+  if(box.isEmpty())
+    return Scalar(0);
+  typename AlignedBox<Scalar, Dim>::VectorType sizes = box.sizes();
+  if(flat)
+    return sizes.sum();
+  Scalar res(0);
+  for(Index i = 0; i < sizes.size(); ++i) {
+    Scalar face(1);
+    for(Index j = 0; j < sizes.size(); ++j)
+      if(j != i)
+        face *= sizes[j];
+    res += face;
+  }
+  return res;
+}
+
 } // end namespace internal
 
 
 /** \class KdBVH
- *  \brief A simple bounding volume hierarchy based on AlignedBox
+ *  \brief A bounding volume hierarchy based on AlignedBox
  *
  *  \param _Scalar The underlying scalar type of the bounding boxes
  *  \param _Dim The dimension of the space in which the hierarchy lives
  *  \param _Object The object type that lives in the hierarchy.  It must have value semantics.  Either bounding_box(_Object) must
  *                 be defined and return an AlignedBox<_Scalar, _Dim> or bounding boxes must be provided to the tree initializer.
  *
- *  This class provides a simple (as opposed to optimized) implementation of a bounding volume hierarchy analogous to a Kd-tree.
- *  Given a sequence of objects, it computes their bounding boxes, constructs a Kd-tree of their centers
- *  and builds a BVH with the structure of that Kd-tree.  When the elements of the tree are too expensive to be copied around,
- *  it is useful for _Object to be a pointer.
+ *  This class provides a binary bounding volume hierarchy analogous to a Kd-tree.  Given a sequence of objects, it computes their
+ *  bounding boxes and recursively splits them with the surface area heuristic (SAH): the centers of the boxes are binned along each
+ *  axis, and the split minimizing the expected cost of a query, estimated from the surface areas and the object counts of the two
+ *  halves, is chosen.  Groups of at most \c MaxLeafSize objects which are cheaper to test directly become leaves.  When the elements of
+ *  the tree are too expensive to be copied around, it is useful for _Object to be a pointer.
+ *
+ *  The nodes are stored depth-first, so that the first child of a node immediately follows it in memory, and the objects of each leaf are
+ *  contiguous.  When OpenMP is enabled, the lower parts of the hierarchy of large sets of objects are built in parallel.
  */
 template<typename _Scalar, int _Dim, typename _Object> class KdBVH
 {
 public:
-  enum { Dim = _Dim };
+  enum {
+    Dim = _Dim,
+    MaxLeafSize = 4 //!< the maximal number of objects in a leaf
+  };
   typedef _Object Object;
   typedef std::vector<Object, aligned_allocator<Object> > ObjectList;
   typedef _Scalar Scalar;
@@ -100,32 +115,64 @@ public:
     objects.insert(objects.end(), begin, end);
     int n = static_cast<int>(objects.size());
 
-    if(n < 2)
-      return; //if we have at most one object, we don't need any internal nodes
+    if(n == 0)
+      return;
 
     VolumeList objBoxes;
-    VIPairList objCenters;
 
     //compute the bounding boxes depending on BIter type
     internal::get_boxes_helper<ObjectList, VolumeList, BIter>()(objects, boxBegin, boxEnd, objBoxes);
 
-    objCenters.reserve(n);
-    boxes.reserve(n - 1);
-    children.reserve(2 * n - 2);
-
-    for(int i = 0; i < n; ++i)
-      objCenters.push_back(VIPair(objBoxes[i].center(), i));
-
-    build(objCenters, 0, n, objBoxes, 0); //the recursive part of the algorithm
+    BuildData data;
+    data.items.resize(n);
+    for(int i = 0; i < n; ++i) {
+      data.items[i].box = objBoxes[i];
+      data.items[i].center = objBoxes[i].center();
+      data.items[i].index = i;
+    }
+    VolumeList().swap(objBoxes);
+
+    //the top of the hierarchy is built sequentially and its subtrees in parallel
+    data.grainSize = n;
+#ifdef EIGEN_HAS_OPENMP
+    Eigen::initParallel();
+    int threads = Eigen::nbThreads();
+    if(threads > 1 && n > 20000)
+      data.grainSize = (std::max)(n / (8 * threads), 4096);
+#endif
+    BuildNodeList top;
+    int root = build(data, top, 0, n, data.grainSize < n);
+    if(root == LeafChild)
+      return; //a few objects are better tested without any volume
+
+    int numSubtrees = static_cast<int>(data.subtrees.size());
+    std::vector<BuildNodeList> subtrees(numSubtrees);
+#ifdef EIGEN_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(threads) if(numSubtrees > 1)
+#endif
+    for(int i = 0; i < numSubtrees; ++i)
+      build(data, subtrees[i], data.subtrees[i].first, data.subtrees[i].second, false);
+
+    //flatten the hierarchy depth-first
+    int numNodes = static_cast<int>(top.size());
+    for(int i = 0; i < numSubtrees; ++i)
+      numNodes += static_cast<int>(subtrees[i].size());
+    boxes.resize(numNodes);
+    children.resize(4 * numNodes);
+    int next = 0;
+    if(root >= 0)
+      flatten(top, subtrees, root, next);
+    else
+      flatten(subtrees[-root - 2], subtrees, 0, next);
 
     ObjectList tmp(n);
     tmp.swap(objects);
     for(int i = 0; i < n; ++i)
-      objects[i] = tmp[objCenters[i].second];
+      objects[i] = tmp[data.items[i].index];
   }
 
   /** \returns the index of the root of the hierarchy */
-  inline Index getRootIndex() const { return (int)boxes.size() - 1; }
+  inline Index getRootIndex() const { return boxes.empty() ? -1 : 0; }
 
   /** Given an \a index of a node, on exit, \a outVBegin and \a outVEnd range over the indices of the volume children of the node
     * and \a outOBegin and \a outOEnd range over the object children of the node */
@@ -136,28 +183,15 @@ public:
       outVBegin = outVEnd;
       if(!objects.empty())
         outOBegin = &(objects[0]);
-      outOEnd = outOBegin + objects.size(); //output all objects--necessary when the tree has only one object
+      outOEnd = outOBegin + objects.size(); //output all objects--necessary when the tree has no node
       return;
     }
 
-    int numBoxes = static_cast<int>(boxes.size());
-
-    int idx = index * 2;
-    if(children[idx + 1] < numBoxes) { //second index is always bigger
-      outVBegin = &(children[idx]);
-      outVEnd = outVBegin + 2;
-      outOBegin = outOEnd;
-    }
-    else if(children[idx] >= numBoxes) { //if both children are objects
-      outVBegin = outVEnd;
-      outOBegin = &(objects[children[idx] - numBoxes]);
-      outOEnd = outOBegin + 2;
-    } else { //if the first child is a volume and the second is an object
-      outVBegin = &(children[idx]);
-      outVEnd = outVBegin + 1;
-      outOBegin = &(objects[children[idx + 1] - numBoxes]);
-      outOEnd = outOBegin + 1;
-    }
+    const int *c = &(children[index * 4]);
+    outVBegin = c;
+    outVEnd = c + (c[1] >= 0 ? 2 : (c[0] >= 0 ? 1 : 0));
+    outOBegin = &(objects[0]) + c[2];
+    outOEnd = &(objects[0]) + c[3];
   }
 
   /** \returns the bounding box of the node at \a index */
@@ -167,52 +201,179 @@ public:
   }
 
 private:
-  typedef internal::vector_int_pair<Scalar, Dim> VIPair;
-  typedef std::vector<VIPair, aligned_allocator<VIPair> > VIPairList;
   typedef Matrix<Scalar, Dim, 1> VectorType;
-  struct VectorComparator //compares vectors, or, more specificall, VIPairs along a particular dimension
+
+  enum {
+    NumBins = 16,
+    LeafChild = -1
+  };
+
+  //a node of the hierarchy under construction.  Its k-th child is either the objects [first[k], first[k] + count[k]) of the build
+  //items, or the node child[k] of the same list, or, if child[k] < LeafChild, the root of the subtree -child[k]-2 built in parallel
+  struct BuildNode
   {
-    VectorComparator(int inDim) : dim(inDim) {}
-    inline bool operator()(const VIPair &v1, const VIPair &v2) const { return v1.first[dim] < v2.first[dim]; }
-    int dim;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW_IF_VECTORIZABLE_FIXED_SIZE(Scalar, Dim)
+    Volume box;
+    int child[2];
+    int first[2], count[2];
   };
+  typedef std::vector<BuildNode, aligned_allocator<BuildNode> > BuildNodeList;
 
-  //Build the part of the tree between objects[from] and objects[to] (not including objects[to]).
-  //This routine partitions the objCenters in [from, to) along the dimension dim, recursively constructs
-  //the two halves, and adds their parent node.  TODO: a cache-friendlier layout
-  void build(VIPairList &objCenters, int from, int to, const VolumeList &objBoxes, int dim)
+  //the objects are sorted in place during the build, so that each node reads a contiguous range of them
+  struct BuildItem
   {
-    eigen_assert(to - from > 1);
-    if(to - from == 2) {
-      boxes.push_back(objBoxes[objCenters[from].second].merged(objBoxes[objCenters[from + 1].second]));
-      children.push_back(from + (int)objects.size() - 1); //there are objects.size() - 1 tree nodes
-      children.push_back(from + (int)objects.size());
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW_IF_VECTORIZABLE_FIXED_SIZE(Scalar, Dim)
+    Volume box;
+    VectorType center;
+    int index;
+  };
+
+  struct BuildData
+  {
+    BuildData() : grainSize(0) {}
+    std::vector<BuildItem, aligned_allocator<BuildItem> > items;
+    std::vector<std::pair<int, int> > subtrees; //ranges of objects left to the parallel phase
+    int grainSize;
+  };
+
+  //Build the part of the tree between items[from] and items[to] (not including items[to]) and returns the index of its root in
+  //nodes, or LeafChild if these objects should rather be direct children of the parent node.  On the top of the hierarchy, the ranges
+  //of at most grainSize objects are left to the parallel phase.
+  int build(BuildData &data, BuildNodeList &nodes, int from, int to, bool top)
+  {
+    eigen_assert(to > from);
+    if(top && to - from <= data.grainSize && to - from > MaxLeafSize) {
+      data.subtrees.push_back(std::make_pair(from, to));
+      return -static_cast<int>(data.subtrees.size()) - 1;
+    }
+
+    Volume box, centerBox;
+    for(int k = from; k < to; ++k) {
+      box.extend(data.items[k].box);
+      centerBox.extend(data.items[k].center);
+    }
+
+    int mid = split(data, from, to, box, centerBox);
+    if(mid < 0)
+      return LeafChild;
+
+    int index = static_cast<int>(nodes.size());
+    nodes.push_back(BuildNode());
+    nodes[index].box = box;
+    int bounds[3] = { from, mid, to };
+    for(int k = 0; k < 2; ++k) {
+      int child = build(data, nodes, bounds[k], bounds[k + 1], top);
+      nodes[index].child[k] = child;
+      nodes[index].first[k] = bounds[k];
+      nodes[index].count[k] = child == LeafChild ? bounds[k + 1] - bounds[k] : 0;
+    }
+    return index;
+  }
+
+  //Partitions items[from, to) by the best SAH split and returns the beginning of the second half, or -1 if the objects should
+  //rather become a leaf.
+  int split(BuildData &data, int from, int to, const Volume &box, const Volume &centerBox)
+  {
+    int count = to - from;
+    if(count == 1)
+      return -1;
+
+    bool flat = internal::kdbvh_box_measure(box, false) <= Scalar(0);
+    Scalar parentMeasure = internal::kdbvh_box_measure(box, flat);
+
+    //the objects are binned along the axis of largest extent of their centers
+    int axis;
+    Scalar extent = centerBox.sizes().maxCoeff(&axis);
+    if(!(extent > Scalar(0))) //all centers coincide
+      return count <= MaxLeafSize ? -1 : from + count / 2;
+
+    int numBins = (std::min)(count, int(NumBins)); //small ranges do not need more bins than objects
+    Scalar axisMin = (centerBox.min)()[axis], axisScale = Scalar(numBins) / extent;
+    Volume binBoxes[NumBins];
+    int binCounts[NumBins];
+    std::fill(binCounts, binCounts + numBins, 0);
+    for(int k = from; k < to; ++k) {
+      int bin = binIndex(data.items[k].center[axis], axisMin, axisScale, numBins);
+      ++binCounts[bin];
+      binBoxes[bin].extend(data.items[k].box);
+    }
+
+    //sweep the bins from the right, then from the left
+    Scalar rightCosts[NumBins];
+    Volume acc;
+    int accCount = 0;
+    for(int bin = numBins - 1; bin > 0; --bin) {
+      acc.extend(binBoxes[bin]);
+      accCount += binCounts[bin];
+      rightCosts[bin] = internal::kdbvh_box_measure(acc, flat) * Scalar(accCount);
+    }
+    acc.setEmpty();
+    accCount = 0;
+    Scalar bestCost = NumTraits<Scalar>::highest();
+    int bestBin = -1;
+    for(int bin = 0; bin < numBins - 1; ++bin) {
+      acc.extend(binBoxes[bin]);
+      accCount += binCounts[bin];
+      Scalar cost = internal::kdbvh_box_measure(acc, flat) * Scalar(accCount) + rightCosts[bin + 1];
+      if(accCount > 0 && accCount < count && cost < bestCost) {
+        bestCost = cost;
+        bestBin = bin;
+      }
     }
-    else if(to - from == 3) {
-      int mid = from + 2;
-      std::nth_element(objCenters.begin() + from, objCenters.begin() + mid,
-                        objCenters.begin() + to, VectorComparator(dim)); //partition
-      build(objCenters, from, mid, objBoxes, (dim + 1) % Dim);
-      int idx1 = (int)boxes.size() - 1;
-      boxes.push_back(boxes[idx1].merged(objBoxes[objCenters[mid].second]));
-      children.push_back(idx1);
-      children.push_back(mid + (int)objects.size() - 1);
+    if(bestBin < 0) //all centers fall in one bin
+      return count <= MaxLeafSize ? -1 : from + count / 2;
+
+    //a query costs one traversal step plus one object test per object it reaches
+    Scalar splitCost = parentMeasure > Scalar(0) ? Scalar(1) + bestCost / parentMeasure : Scalar(count);
+    if(count <= MaxLeafSize && Scalar(count) <= splitCost)
+      return -1;
+
+    BuildItem *mid = std::partition(&data.items[0] + from, &data.items[0] + to,
+                                    BinPredicate(axis, bestBin, axisMin, axisScale, numBins));
+    return static_cast<int>(mid - &data.items[0]);
+  }
+
+  static int binIndex(Scalar x, Scalar origin, Scalar scale, int numBins)
+  {
+    return (std::min)(static_cast<int>((x - origin) * scale), numBins - 1);
+  }
+
+  struct BinPredicate //tells whether an object goes to the first half of a split
+  {
+    BinPredicate(int a, int b, Scalar m, Scalar s, int n) : axis(a), bin(b), origin(m), scale(s), numBins(n) {}
+    inline bool operator()(const BuildItem &item) const { return binIndex(item.center[axis], origin, scale, numBins) <= bin; }
+    int axis, bin;
+    Scalar origin, scale;
+    int numBins;
+  };
+
+  //Copy the subtree rooted at nodes[index] at position next of the depth-first layout and returns that position
+  int flatten(const BuildNodeList &nodes, const std::vector<BuildNodeList> &subtrees, int index, int &next)
+  {
+    int pos = next++;
+    const BuildNode &node = nodes[index];
+    boxes[pos] = node.box;
+    int *c = &(children[pos * 4]);
+    c[0] = c[1] = -1;
+    c[2] = c[3] = 0;
+    for(int k = 0; k < 2; ++k) { //the objects of the two children are contiguous
+      if(node.count[k] > 0) {
+        if(c[2] == c[3])
+          c[2] = node.first[k];
+        c[3] = node.first[k] + node.count[k];
+      }
     }
-    else {
-      int mid = from + (to - from) / 2;
-      nth_element(objCenters.begin() + from, objCenters.begin() + mid,
-                  objCenters.begin() + to, VectorComparator(dim)); //partition
-      build(objCenters, from, mid, objBoxes, (dim + 1) % Dim);
-      int idx1 = (int)boxes.size() - 1;
-      build(objCenters, mid, to, objBoxes, (dim + 1) % Dim);
-      int idx2 = (int)boxes.size() - 1;
-      boxes.push_back(boxes[idx1].merged(boxes[idx2]));
-      children.push_back(idx1);
-      children.push_back(idx2);
+    int numVolumes = 0;
+    for(int k = 0; k < 2; ++k) {
+      int child = node.child[k];
+      if(node.count[k] == 0)
+        c[numVolumes++] = child >= 0 ? flatten(nodes, subtrees, child, next) : flatten(subtrees[-child - 2], subtrees, 0, next);
     }
+    return pos;
   }
 
-  std::vector<int> children; //children of x are children[2x] and children[2x+1], indices bigger than boxes.size() index into objects.
+  std::vector<int> children; //node x has children[4x] and children[4x+1] as volume children (or -1 if it has less than two) and
+                             //the objects [children[4x+2], children[4x+3]) as object children
   VolumeList boxes;
   ObjectList objects;
 };
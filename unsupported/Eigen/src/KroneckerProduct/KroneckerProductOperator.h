@@ -0,0 +1,196 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef KRONECKER_PRODUCT_OPERATOR_H
+#define KRONECKER_PRODUCT_OPERATOR_H
+
+namespace Eigen {
+
+template<typename Lhs, typename Rhs> class KroneckerProductOperator;
+
+namespace internal {
+
+template<typename _Lhs, typename _Rhs>
+struct traits<KroneckerProductOperator<_Lhs,_Rhs> >
+ : traits<SparseMatrix<typename remove_all<_Lhs>::type::Scalar> >
+{
+  // nested by value, so that the chains of operators can be built from temporaries
+  enum { Flags = 0 };
+};
+
+} // end namespace internal
+
+/*!
+ * \ingroup KroneckerProduct_Module
+ *
+ * \brief Kronecker tensor product operator, whose products are computed without forming the product
+ *
+ * This class represents \f$ A \otimes B \f$ as a matrix-free operator. Its product with a vector \f$ x \f$ is
+ * computed as the product of matrices
+ * \f[ (A \otimes B)\, x = \mathrm{vec}(B X A^T), \quad \mathrm{vec}(X) = x, \f]
+ * which costs two matrix products of the size of the factors instead of a product with a matrix of
+ * size \f$ (m_A m_B) \times (n_A n_B) \f$. The products with several vectors are computed column by column.
+ *
+ * The factors can be dense matrices, sparse matrices, or other matrix-free operators, including other
+ * Kronecker product operators to represent chains of Kronecker products:
+ * \code
+ * MatrixXd A, B, C;
+ * VectorXd y = kroneckerProductOperator(A, kroneckerProductOperator(B, C)) * x;
+ * \endcode
+ *
+ * It can be used as the matrix type of the iterative solvers, with the IdentityPreconditioner. With
+ * ConjugateGradient, \c Lower|Upper has to be passed as the \c _UpLo template parameter:
+ * \code
+ * typedef KroneckerProductOperator<MatrixXd,MatrixXd> Operator;
+ * Operator op(A, B);
+ * ConjugateGradient<Operator, Lower|Upper, IdentityPreconditioner> cg(op);
+ * x = cg.solve(b);
+ * \endcode
+ *
+ * The SparseCore module has to be included to use this class.
+ *
+ * \tparam Lhs  Type of the left-hand side factor \f$ A \f$.
+ * \tparam Rhs  Type of the right-hand side factor \f$ B \f$.
+ *
+ * \sa kroneckerProductOperator(), class KroneckerProduct
+ */
+template<typename Lhs, typename Rhs>
+class KroneckerProductOperator : public EigenBase<KroneckerProductOperator<Lhs,Rhs> >
+{
+  public:
+    typedef typename internal::remove_all<Lhs>::type::Scalar Scalar;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    typedef typename SparseMatrix<Scalar>::StorageIndex StorageIndex;
+
+    enum {
+      RowsAtCompileTime = Dynamic,
+      ColsAtCompileTime = Dynamic,
+      MaxColsAtCompileTime = Dynamic,
+      IsRowMajor = false
+    };
+
+    /*! \brief Constructor. */
+    KroneckerProductOperator(const Lhs& A, const Rhs& B)
+      : m_A(A), m_B(B)
+    {}
+
+    inline Index rows() const { return m_A.rows() * m_B.rows(); }
+    inline Index cols() const { return m_A.cols() * m_B.cols(); }
+
+    /*! \returns the left-hand side factor \f$ A \f$ */
+    const typename internal::remove_all<typename internal::ref_selector<Lhs>::type>::type& lhs() const { return m_A; }
+    /*! \returns the right-hand side factor \f$ B \f$ */
+    const typename internal::remove_all<typename internal::ref_selector<Rhs>::type>::type& rhs() const { return m_B; }
+
+    template<typename Dest>
+    Product<KroneckerProductOperator,Dest,AliasFreeProduct> operator*(const MatrixBase<Dest>& x) const
+    {
+      return Product<KroneckerProductOperator,Dest,AliasFreeProduct>(*this, x.derived());
+    }
+
+  protected:
+    typename internal::ref_selector<Lhs>::type m_A;
+    typename internal::ref_selector<Rhs>::type m_B;
+};
+
+namespace internal {
+
+// dst = factor * x, for dense, sparse and matrix-free factors
+template<typename Factor, typename Dest>
+void kronecker_factor_product(const MatrixBase<Factor>& factor, const Ref<const Matrix<typename Dest::Scalar,Dynamic,Dynamic> >& x, Dest& dst)
+{
+  dst.noalias() = factor.derived() * x;
+}
+
+template<typename Factor, typename Dest>
+void kronecker_factor_product(const EigenBase<Factor>& factor, const Ref<const Matrix<typename Dest::Scalar,Dynamic,Dynamic> >& x, Dest& dst)
+{
+  dst = factor.derived() * x;
+}
+
+// dst = x * factor^T, for dense, sparse and matrix-free factors
+template<typename Factor, typename Dest>
+void kronecker_factor_product_transposed(const MatrixBase<Factor>& factor, const Ref<const Matrix<typename Dest::Scalar,Dynamic,Dynamic> >& x, Dest& dst)
+{
+  dst.noalias() = x * factor.derived().transpose();
+}
+
+template<typename Factor, typename Dest>
+void kronecker_factor_product_transposed(const SparseMatrixBase<Factor>& factor, const Ref<const Matrix<typename Dest::Scalar,Dynamic,Dynamic> >& x, Dest& dst)
+{
+  dst = x * factor.derived().transpose();
+}
+
+template<typename Factor, typename Dest>
+void kronecker_factor_product_transposed(const EigenBase<Factor>& factor, const Ref<const Matrix<typename Dest::Scalar,Dynamic,Dynamic> >& x, Dest& dst)
+{
+  Dest tmp = factor.derived() * x.transpose();
+  dst = tmp.transpose();
+}
+
+template<typename LhsFactor, typename RhsFactor, typename Rhs, int ProductType>
+struct generic_product_impl<KroneckerProductOperator<LhsFactor,RhsFactor>, Rhs, SparseShape, DenseShape, ProductType>
+ : generic_product_impl_base<KroneckerProductOperator<LhsFactor,RhsFactor>,Rhs,
+                             generic_product_impl<KroneckerProductOperator<LhsFactor,RhsFactor>,Rhs,SparseShape,DenseShape,ProductType> >
+{
+  typedef KroneckerProductOperator<LhsFactor,RhsFactor> Lhs;
+  typedef typename Lhs::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  typedef Ref<const MatrixType> RhsRef;
+
+  template<typename Dest>
+  static void scaleAndAddTo(Dest& dst, const Lhs& lhs, const Rhs& rhs, const Scalar& alpha)
+  {
+    // the columns of the right hand side are reshaped with a unit inner stride
+    RhsRef actualRhs(rhs);
+    const Index mA = lhs.lhs().rows(), nA = lhs.lhs().cols();
+    const Index mB = lhs.rhs().rows(), nB = lhs.rhs().cols();
+
+    // the cheapest order of the two products, counted for dense factors
+    const bool rhsFirst = mB*nB*nA + mB*nA*mA <= nB*nA*mA + mB*nB*mA;
+    MatrixType tmp, res;
+    for(Index j=0; j<actualRhs.cols(); ++j)
+    {
+      Map<const MatrixType> x(actualRhs.col(j).data(), nB, nA);
+      if(rhsFirst)
+      {
+        kronecker_factor_product(lhs.rhs(), x, tmp);
+        kronecker_factor_product_transposed(lhs.lhs(), tmp, res);
+      }
+      else
+      {
+        kronecker_factor_product_transposed(lhs.lhs(), x, tmp);
+        kronecker_factor_product(lhs.rhs(), tmp, res);
+      }
+      dst.col(j) += alpha * Map<const Matrix<Scalar,Dynamic,1> >(res.data(), res.size());
+    }
+  }
+};
+
+} // end namespace internal
+
+/*!
+ * \ingroup KroneckerProduct_Module
+ *
+ * Builds the Kronecker tensor product operator of two dense, sparse or matrix-free operators, whose products
+ * are computed without forming the Kronecker product.
+ *
+ * \param a  Matrix or operator a
+ * \param b  Matrix or operator b
+ * \return   Kronecker tensor product operator of a and b
+ *
+ * \sa class KroneckerProductOperator
+ */
+template<typename A, typename B>
+KroneckerProductOperator<A,B> kroneckerProductOperator(const EigenBase<A>& a, const EigenBase<B>& b)
+{
+  return KroneckerProductOperator<A,B>(a.derived(), b.derived());
+}
+
+} // end namespace Eigen
+
+#endif // KRONECKER_PRODUCT_OPERATOR_H
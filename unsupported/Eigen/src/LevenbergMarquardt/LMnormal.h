@@ -0,0 +1,369 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_LMNORMAL_H
+#define EIGEN_LMNORMAL_H
+
+namespace Eigen {
+
+/**
+  * \ingroup LevenbergMarquardt_Module
+  * \brief Solves the damped normal equations of the Levenberg-Marquardt steps with a sparse Cholesky factorization
+  *
+  * By default, LevenbergMarquardt computes its steps from a QR factorization of the Jacobian \f$ J \f$, which is
+  * updated for each trial value of the damping parameter. This class instead forms the normal equations
+  * \f[ (J^T J + \lambda D^2)\, p = -J^T f \f]
+  * once per Jacobian and solves them with a SimplicialLDLT factorization. The symbolic analysis of the factorization
+  * only depends on the sparsity pattern of \f$ J \f$: it is computed once and reused as long as this pattern does not
+  * change, and each trial value of \f$ \lambda \f$ only changes the diagonal of the factorized matrix.
+  * This is much faster than the QR factorization for large sparse problems, at the price of squaring the condition
+  * number of the problem, so that the default QR solver remains preferable for small ill-conditioned problems.
+  *
+  * It is selected by the second template parameter of LevenbergMarquardt:
+  * \code
+  * typedef LevenbergMarquardtNormalSolver<MyFunctor::JacobianType> Solver;
+  * LevenbergMarquardt<MyFunctor, Solver> lm(functor);
+  * lm.minimize(x);
+  * \endcode
+  *
+  * When the unknowns are made of a first set of unknowns followed by groups of unknowns which are never coupled
+  * together by a residual, like the cameras and the points of a bundle adjustment, setSchurComplement() makes the
+  * solver eliminate these groups first: the matrix factorized by SimplicialLDLT is then the much smaller Schur
+  * complement of the block diagonal part of \f$ J^T J \f$.
+  *
+  * \tparam _MatrixType the type of the Jacobian matrix, a SparseMatrix
+  * \tparam _Ordering the fill-in reducing ordering of the SimplicialLDLT factorization
+  *
+  * \sa class LevenbergMarquardt, class SimplicialLDLT
+  */
+template<typename _MatrixType, typename _Ordering = AMDOrdering<typename _MatrixType::StorageIndex> >
+class LevenbergMarquardtNormalSolver
+{
+  public:
+    typedef _MatrixType MatrixType;
+    typedef typename MatrixType::Scalar Scalar;
+    typedef typename MatrixType::RealScalar RealScalar;
+    typedef typename MatrixType::StorageIndex StorageIndex;
+    typedef Matrix<Scalar,Dynamic,1> VectorType;
+    typedef SparseMatrix<Scalar,ColMajor,StorageIndex> NormalMatrixType;
+
+    LevenbergMarquardtNormalSolver()
+      : m_keptSize(0), m_blockSize(0), m_analysisCount(0), m_needAnalysis(true), m_info(InvalidInput)
+    {}
+
+    /** Eliminates the unknowns of indices \a keptSize to n-1 by groups of \a blockSize unknowns before factorizing
+      * the normal equations. The residuals must depend on the unknowns of at most one of these groups, so that the
+      * corresponding part of \f$ J^T J \f$ is block diagonal. A \a blockSize of 0 disables the elimination.
+      */
+    LevenbergMarquardtNormalSolver& setSchurComplement(Index keptSize, Index blockSize)
+    {
+      eigen_assert(keptSize>=0 && blockSize>=0);
+      m_keptSize = keptSize;
+      m_blockSize = blockSize;
+      m_needAnalysis = true;
+      return *this;
+    }
+
+    /** Forms the normal equations of the Jacobian \a jac and of the vector function \a fvec */
+    LevenbergMarquardtNormalSolver& compute(const MatrixType& jac, const VectorType& fvec)
+    {
+      const Index n = jac.cols();
+      NormalMatrixType jacT = jac.transpose();
+      m_gradient = jacT * fvec;
+
+      // the lower triangular part of J^T J, with its whole diagonal explicitly stored
+      NormalMatrixType zeroDiagonal(n,n);
+      zeroDiagonal.reserve(VectorXi::Constant(n,1));
+      for(Index j=0; j<n; ++j)
+        zeroDiagonal.insert(j,j) = Scalar(0);
+      NormalMatrixType full = jacT * jac + zeroDiagonal;
+      m_normal = full.template triangularView<Lower>();
+      m_normal.makeCompressed();
+      using std::sqrt;
+      m_columnNorms.resize(n);
+      for(Index j=0; j<n; ++j)
+        m_columnNorms(j) = sqrt(numext::real(m_normal.coeff(j,j)));
+
+      if(m_blockSize>0)
+        m_info = splitSchurComplement();
+      else
+      {
+        m_info = Success;
+        updatePattern(m_normal);
+        diagonalPositions(m_normal, m_diagonal);
+      }
+      return *this;
+    }
+
+    /** Computes in \a step the solution of \f$ (J^T J + par\, diag^2)\, step = -J^T f \f$
+      * \returns \c Success, or \c NumericalIssue if the damped normal equations could not be factorized
+      */
+    ComputationInfo solve(const VectorType& diag, RealScalar par, VectorType& step)
+    {
+      eigen_assert(m_info==Success && "LevenbergMarquardtNormalSolver::solve(): the normal equations are not computed");
+      eigen_assert(diag.size()==m_gradient.size());
+      step.resize(m_gradient.size());
+      return m_blockSize>0 ? solveSchurComplement(diag, par, step) : solveNormal(diag, par, step);
+    }
+
+    /** \returns \c Success if the normal equations are successfully formed, and \c InvalidInput if the Jacobian
+      * does not match the structure given to setSchurComplement() */
+    ComputationInfo info() const { return m_info; }
+
+    /** \returns the gradient \f$ J^T f \f$ of the half squared norm of the vector function */
+    const VectorType& gradient() const { return m_gradient; }
+
+    /** \returns the norms of the columns of the Jacobian */
+    const VectorType& columnNorms() const { return m_columnNorms; }
+
+    /** \returns the number of symbolic analyses performed so far */
+    Index analysisCount() const { return m_analysisCount; }
+
+  protected:
+    typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrixType;
+    typedef Matrix<StorageIndex,Dynamic,1> IndexVector;
+
+    ComputationInfo solveNormal(const VectorType& diag, RealScalar par, VectorType& step)
+    {
+      m_shifted = m_normal;
+      for(Index j=0; j<diag.size(); ++j)
+        m_shifted.valuePtr()[m_diagonal(j)] += par * numext::abs2(diag(j));
+      if(!factorize(m_shifted))
+        return NumericalIssue;
+      step = -m_ldlt.solve(m_gradient);
+      return Success;
+    }
+
+    // Splits J^T J into the kept part, the coupling blocks and the block diagonal part, and computes the pattern of
+    // the Schur complement.
+    ComputationInfo splitSchurComplement()
+    {
+      const Index n = m_normal.cols(), r = m_keptSize, bs = m_blockSize;
+      if(r>n || (n-r)%bs!=0)
+        return InvalidInput;
+      const Index nbBlocks = (n-r)/bs;
+
+      m_blocks.setZero(bs, n-r);
+      SparseMatrix<Scalar,RowMajor,StorageIndex> coupling(n-r, r);
+      std::vector<Triplet<Scalar,StorageIndex> > kept, coupled;
+      for(Index j=0; j<n; ++j)
+      {
+        for(typename NormalMatrixType::InnerIterator it(m_normal,j); it; ++it)
+        {
+          Index i = it.row();
+          if(j>=r)
+          {
+            if((i-r)/bs!=(j-r)/bs)
+              return InvalidInput;
+            // the entry (p,q) of the k-th diagonal block is stored at (p, k*bs+q)
+            Index offset = r+(j-r)/bs*bs;
+            m_blocks(i-offset, j-r) = it.value();
+            m_blocks(j-offset, i-r) = numext::conj(it.value());
+          }
+          else if(i<r)
+            kept.push_back(Triplet<Scalar,StorageIndex>(StorageIndex(i), StorageIndex(j), it.value()));
+          else
+            coupled.push_back(Triplet<Scalar,StorageIndex>(StorageIndex(i-r), StorageIndex(j), it.value()));
+        }
+      }
+      coupling.setFromTriplets(coupled.begin(), coupled.end());
+      m_keptGradient = m_gradient.head(r);
+
+      // the columns of the kept unknowns coupled to each block, and the dense coupling blocks
+      m_blockStart.resize(nbBlocks+1);
+      m_blockStart(0) = 0;
+      std::vector<StorageIndex> cols;
+      std::vector<char> mark(r, 0);
+      for(Index k=0; k<nbBlocks; ++k)
+      {
+        Index first = cols.size();
+        for(Index i=k*bs; i<(k+1)*bs; ++i)
+          for(typename SparseMatrix<Scalar,RowMajor,StorageIndex>::InnerIterator it(coupling,i); it; ++it)
+            if(!mark[it.col()])
+            {
+              mark[it.col()] = 1;
+              cols.push_back(StorageIndex(it.col()));
+            }
+        std::sort(cols.begin()+first, cols.end());
+        for(Index c=first; c<Index(cols.size()); ++c)
+          mark[cols[c]] = 0;
+        m_blockStart(k+1) = StorageIndex(cols.size());
+      }
+      m_blockCols = Map<IndexVector>(cols.empty() ? 0 : &cols[0], cols.size());
+      m_coupling.setZero(bs, cols.size());
+      for(Index k=0; k<nbBlocks; ++k)
+      {
+        const StorageIndex* blockCols = m_blockCols.data()+m_blockStart(k);
+        Index size = m_blockStart(k+1)-m_blockStart(k);
+        for(Index i=0; i<bs; ++i)
+          for(typename SparseMatrix<Scalar,RowMajor,StorageIndex>::InnerIterator it(coupling,k*bs+i); it; ++it)
+            m_coupling(i, m_blockStart(k) + (std::lower_bound(blockCols, blockCols+size, StorageIndex(it.col()))-blockCols)) = it.value();
+      }
+
+      // the pattern of the Schur complement, whose entries which do not come from the kept part are zero
+      for(Index k=0; k<nbBlocks; ++k)
+        for(Index a=m_blockStart(k); a<m_blockStart(k+1); ++a)
+          for(Index b=m_blockStart(k); b<=a; ++b)
+            kept.push_back(Triplet<Scalar,StorageIndex>(m_blockCols(a), m_blockCols(b), Scalar(0)));
+      for(Index j=0; j<r; ++j)
+        kept.push_back(Triplet<Scalar,StorageIndex>(StorageIndex(j), StorageIndex(j), Scalar(0)));
+      m_reduced.resize(r, r);
+      m_reduced.setFromTriplets(kept.begin(), kept.end());
+      m_reduced.makeCompressed();
+      updatePattern(m_reduced);
+      diagonalPositions(m_reduced, m_diagonal);
+
+      // the positions of the contributions of the blocks in the Schur complement
+      Index count = 0;
+      for(Index k=0; k<nbBlocks; ++k)
+      {
+        Index size = m_blockStart(k+1)-m_blockStart(k);
+        count += size*(size+1)/2;
+      }
+      m_scatter.resize(count);
+      count = 0;
+      for(Index k=0; k<nbBlocks; ++k)
+        for(Index a=m_blockStart(k); a<m_blockStart(k+1); ++a)
+          for(Index b=m_blockStart(k); b<=a; ++b)
+          {
+            const StorageIndex* begin = m_reduced.innerIndexPtr()+m_reduced.outerIndexPtr()[m_blockCols(b)];
+            const StorageIndex* end = m_reduced.innerIndexPtr()+m_reduced.outerIndexPtr()[m_blockCols(b)+1];
+            m_scatter(count++) = StorageIndex(std::lower_bound(begin, end, m_blockCols(a)) - m_reduced.innerIndexPtr());
+          }
+      return Success;
+    }
+
+    ComputationInfo solveSchurComplement(const VectorType& diag, RealScalar par, VectorType& step)
+    {
+      const Index r = m_keptSize, bs = m_blockSize;
+      const Index nbBlocks = m_blockStart.size()-1;
+
+      m_shifted = m_reduced;
+      for(Index j=0; j<r; ++j)
+        m_shifted.valuePtr()[m_diagonal(j)] += par * numext::abs2(diag(j));
+      VectorType rhs = -m_keptGradient;
+
+      // invert the damped diagonal blocks and subtract their contributions
+      m_invBlocks.resize(bs, nbBlocks*bs);
+      DenseMatrixType block(bs,bs), product;
+      Index count = 0;
+      for(Index k=0; k<nbBlocks; ++k)
+      {
+        block = m_blocks.middleCols(k*bs, bs);
+        block.diagonal() += par * diag.segment(r+k*bs, bs).cwiseAbs2();
+        LLT<DenseMatrixType> llt(block);
+        if(llt.info()!=Success)
+          return NumericalIssue;
+        m_invBlocks.middleCols(k*bs, bs) = llt.solve(DenseMatrixType::Identity(bs,bs));
+
+        Index start = m_blockStart(k), size = m_blockStart(k+1)-start;
+        product.noalias() = m_invBlocks.middleCols(k*bs, bs) * m_coupling.middleCols(start, size);
+        VectorType reduced = product.adjoint() * m_gradient.segment(r+k*bs, bs);
+        for(Index a=0; a<size; ++a)
+        {
+          rhs(m_blockCols(start+a)) += reduced(a);
+          for(Index b=0; b<=a; ++b)
+            m_shifted.valuePtr()[m_scatter(count++)] -= m_coupling.col(start+a).dot(product.col(b));
+        }
+      }
+      if(!factorize(m_shifted))
+        return NumericalIssue;
+      step.head(r) = m_ldlt.solve(rhs);
+
+      // back substitution of the eliminated unknowns
+      for(Index k=0; k<nbBlocks; ++k)
+      {
+        Index start = m_blockStart(k), size = m_blockStart(k+1)-start;
+        VectorType tmp = m_gradient.segment(r+k*bs, bs);
+        for(Index a=0; a<size; ++a)
+          tmp += m_coupling.col(start+a) * step(m_blockCols(start+a));
+        step.segment(r+k*bs, bs).noalias() = -(m_invBlocks.middleCols(k*bs, bs) * tmp);
+      }
+      return Success;
+    }
+
+    bool factorize(const NormalMatrixType& mat)
+    {
+      if(m_needAnalysis)
+      {
+        m_ldlt.analyzePattern(mat);
+        ++m_analysisCount;
+        m_needAnalysis = false;
+      }
+      m_ldlt.factorize(mat);
+      return m_ldlt.info()==Success;
+    }
+
+    // Requests a new symbolic analysis if the pattern of mat differs from the previous one
+    void updatePattern(const NormalMatrixType& mat)
+    {
+      Index nnz = mat.nonZeros();
+      bool same = m_outerPattern.size()==mat.cols()+1 && m_innerPattern.size()==nnz
+               && m_outerPattern==Map<const IndexVector>(mat.outerIndexPtr(), mat.cols()+1)
+               && m_innerPattern==Map<const IndexVector>(mat.innerIndexPtr(), nnz);
+      if(!same)
+      {
+        m_outerPattern = Map<const IndexVector>(mat.outerIndexPtr(), mat.cols()+1);
+        m_innerPattern = Map<const IndexVector>(mat.innerIndexPtr(), nnz);
+        m_needAnalysis = true;
+      }
+    }
+
+    // Stores the position of the diagonal entries of the lower triangular matrix mat
+    static void diagonalPositions(const NormalMatrixType& mat, IndexVector& positions)
+    {
+      positions.resize(mat.cols());
+      for(Index j=0; j<mat.cols(); ++j)
+      {
+        const StorageIndex* begin = mat.innerIndexPtr()+mat.outerIndexPtr()[j];
+        const StorageIndex* end = mat.innerIndexPtr()+mat.outerIndexPtr()[j+1];
+        positions(j) = StorageIndex(std::lower_bound(begin, end, StorageIndex(j)) - mat.innerIndexPtr());
+      }
+    }
+
+    Index m_keptSize, m_blockSize;
+    NormalMatrixType m_normal, m_reduced, m_shifted;
+    VectorType m_gradient, m_keptGradient, m_columnNorms;
+    IndexVector m_diagonal, m_outerPattern, m_innerPattern;
+    // Schur complement: the diagonal blocks and their damped inverses stored side by side, the columns of the
+    // kept unknowns coupled to each block with the corresponding dense coupling blocks, and the positions of the
+    // contributions of the blocks in m_reduced
+    DenseMatrixType m_blocks, m_invBlocks, m_coupling;
+    IndexVector m_blockStart, m_blockCols, m_scatter;
+    SimplicialLDLT<NormalMatrixType, Lower, _Ordering> m_ldlt;
+    Index m_analysisCount;
+    bool m_needAnalysis;
+    ComputationInfo m_info;
+};
+
+namespace internal {
+
+template<typename Solver> struct is_lm_normal_solver : false_type {};
+
+template<typename MatrixType, typename Ordering>
+struct is_lm_normal_solver<LevenbergMarquardtNormalSolver<MatrixType,Ordering> > : true_type {};
+
+// Base of LevenbergMarquardt storing its step solver. The QR factorizations are local to each step,
+// so that only the normal equation solvers, which keep their symbolic analysis, are stored.
+template<typename Solver, bool IsNormalSolver = is_lm_normal_solver<Solver>::value>
+class lm_solver_storage {};
+
+template<typename Solver>
+class lm_solver_storage<Solver,true>
+{
+  public:
+    /** \returns a reference to the normal equation solver, to set its options */
+    Solver& solver() { return m_solver; }
+  protected:
+    Solver m_solver;
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_LMNORMAL_H
@@ -16,9 +16,9 @@
 
 namespace Eigen {
 
-template<typename FunctorType>
+template<typename FunctorType, typename Solver>
 LevenbergMarquardtSpace::Status
-LevenbergMarquardt<FunctorType>::minimizeOneStep(FVectorType  &x)
+LevenbergMarquardt<FunctorType,Solver>::minimizeOneStep(FVectorType  &x, internal::false_type)
 {
   using std::abs;
   using std::sqrt;
@@ -40,7 +40,7 @@ LevenbergMarquardt<FunctorType>::minimizeOneStep(FVectorType  &x)
   /* compute the qr factorization of the jacobian. */
   for (int j = 0; j < x.size(); ++j)
     m_wa2(j) = m_fjac.col(j).blueNorm();
-  QRSolver qrfac(m_fjac);
+  Solver qrfac(m_fjac);
   if(qrfac.info() != Success) {
     m_info = NumericalIssue;
     return LevenbergMarquardtSpace::ImproperInputParameters;
@@ -196,7 +196,184 @@ LevenbergMarquardt<FunctorType>::minimizeOneStep(FVectorType  &x)
   return LevenbergMarquardtSpace::Running;
 }
 
-  
+template<typename FunctorType, typename Solver>
+LevenbergMarquardtSpace::Status
+LevenbergMarquardt<FunctorType,Solver>::minimizeOneStep(FVectorType  &x, internal::true_type)
+{
+  using std::abs;
+  using std::sqrt;
+  RealScalar temp, temp1,temp2; 
+  RealScalar ratio; 
+  RealScalar pnorm, xnorm, fnorm1, actred, dirder, prered;
+  eigen_assert(x.size()==n); // check the caller is not cheating us
+
+  temp = 0.0; xnorm = 0.0;
+  /* calculate the jacobian matrix. */
+  Index df_ret = m_functor.df(x, m_fjac);
+  if (df_ret<0)
+      return LevenbergMarquardtSpace::UserAsked;
+  if (df_ret>0)
+      // numerical diff, we evaluated the function df_ret times
+      m_nfev += df_ret;
+  else m_njev++;
+
+  /* form the normal equations. */
+  this->m_solver.compute(m_fjac, m_fvec);
+  if(this->m_solver.info() != Success) {
+    m_info = this->m_solver.info();
+    return LevenbergMarquardtSpace::ImproperInputParameters;
+  }
+  m_wa2 = this->m_solver.columnNorms();
+
+  /* on the first iteration and if external scaling is not used, scale according */
+  /* to the norms of the columns of the initial jacobian. */
+  if (m_iter == 1) {
+      if (!m_useExternalScaling)
+          for (Index j = 0; j < n; ++j)
+              m_diag[j] = (m_wa2[j]==0.)? 1. : m_wa2[j];
+
+      /* on the first iteration, calculate the norm of the scaled x, */
+      /* initialize the step bound m_delta, and the damping parameter */
+      /* relatively to the diagonal of the scaled normal equations. */
+      xnorm = m_diag.cwiseProduct(x).stableNorm();
+      m_delta = m_factor * xnorm;
+      if (m_delta == 0.)
+          m_delta = m_factor;
+      m_par = RealScalar(1e-3) * m_wa2.cwiseQuotient(m_diag).cwiseAbs2().maxCoeff();
+      if (m_par == 0.)
+          m_par = RealScalar(1e-3);
+  }
+
+  /* compute the norm of the scaled gradient. */
+  m_gnorm = 0.;
+  if (m_fnorm != 0.)
+      for (Index j = 0; j < n; ++j)
+          if (m_wa2[j] != 0.)
+              m_gnorm = (std::max)(m_gnorm, abs(this->m_solver.gradient()[j] / m_fnorm / m_wa2[j]));
+
+  /* test for convergence of the gradient norm. */
+  if (m_gnorm <= m_gtol) {
+    m_info = Success;
+    return LevenbergMarquardtSpace::CosinusTooSmall;
+  }
+
+  /* rescale if necessary. */
+  if (!m_useExternalScaling)
+      m_diag = m_diag.cwiseMax(m_wa2);
+
+  do {
+    /* solve the damped normal equations for the current levenberg-marquardt parameter. */
+    if (this->m_solver.solve(m_diag, m_par, m_wa1) != Success) {
+      m_info = NumericalIssue;
+      return LevenbergMarquardtSpace::ImproperInputParameters;
+    }
+
+    /* store x + p and calculate the norm of the scaled direction p. */
+    m_wa2 = x + m_wa1;
+    pnorm = m_diag.cwiseProduct(m_wa1).stableNorm();
+
+    /* on the first iteration, adjust the initial step bound. */
+    if (m_iter == 1)
+        m_delta = (std::min)(m_delta,pnorm);
+
+    /* evaluate the function at x + p and calculate its norm. */
+    if ( m_functor(m_wa2, m_wa4) < 0)
+        return LevenbergMarquardtSpace::UserAsked;
+    ++m_nfev;
+    fnorm1 = m_wa4.stableNorm();
+
+    /* compute the scaled actual reduction. */
+    actred = -1.;
+    if (Scalar(.1) * fnorm1 < m_fnorm)
+        actred = 1. - numext::abs2(fnorm1 / m_fnorm);
+
+    /* compute the scaled predicted reduction and */
+    /* the scaled directional derivative. */
+    m_wa3 = m_fjac * m_wa1;
+    temp1 = numext::abs2(m_wa3.stableNorm() / m_fnorm);
+    temp2 = numext::abs2(sqrt(m_par) * pnorm / m_fnorm);
+    prered = temp1 + temp2 / Scalar(.5);
+    dirder = -(temp1 + temp2);
+
+    /* compute the ratio of the actual to the predicted */
+    /* reduction. */
+    ratio = 0.;
+    if (prered != 0.)
+        ratio = actred / prered;
+
+    /* update the step bound and the levenberg-marquardt parameter, */
+    /* which is kept large enough for the damped normal equations */
+    /* to remain numerically positive definite. */
+    if (ratio <= Scalar(.25)) {
+        if (actred >= 0.)
+            temp = RealScalar(.5);
+        if (actred < 0.)
+            temp = RealScalar(.5) * dirder / (dirder + RealScalar(.5) * actred);
+        if (RealScalar(.1) * fnorm1 >= m_fnorm || temp < RealScalar(.1))
+            temp = Scalar(.1);
+        /* Computing MIN */
+        m_delta = temp * (std::min)(m_delta, pnorm / RealScalar(.1));
+        m_par /= temp;
+    } else if (ratio >= RealScalar(.75)) {
+        m_delta = pnorm / RealScalar(.5);
+        m_par = (std::max)(RealScalar(.5) * m_par, NumTraits<RealScalar>::epsilon());
+    }
+
+    /* test for successful iteration. */
+    if (ratio >= RealScalar(1e-4)) {
+        /* successful iteration. update x, m_fvec, and their norms. */
+        x = m_wa2;
+        m_wa2 = m_diag.cwiseProduct(x);
+        m_fvec = m_wa4;
+        xnorm = m_wa2.stableNorm();
+        m_fnorm = fnorm1;
+        ++m_iter;
+    }
+
+    /* tests for convergence. */
+    if (abs(actred) <= m_ftol && prered <= m_ftol && Scalar(.5) * ratio <= 1. && m_delta <= m_xtol * xnorm)
+    {
+       m_info = Success;
+      return LevenbergMarquardtSpace::RelativeErrorAndReductionTooSmall;
+    }
+    if (abs(actred) <= m_ftol && prered <= m_ftol && Scalar(.5) * ratio <= 1.) 
+    {
+      m_info = Success;
+      return LevenbergMarquardtSpace::RelativeReductionTooSmall;
+    }
+    if (m_delta <= m_xtol * xnorm)
+    {
+      m_info = Success;
+      return LevenbergMarquardtSpace::RelativeErrorTooSmall;
+    }
+
+    /* tests for termination and stringent tolerances. */
+    if (m_nfev >= m_maxfev) 
+    {
+      m_info = NoConvergence;
+      return LevenbergMarquardtSpace::TooManyFunctionEvaluation;
+    }
+    if (abs(actred) <= NumTraits<Scalar>::epsilon() && prered <= NumTraits<Scalar>::epsilon() && Scalar(.5) * ratio <= 1.)
+    {
+      m_info = Success;
+      return LevenbergMarquardtSpace::FtolTooSmall;
+    }
+    if (m_delta <= NumTraits<Scalar>::epsilon() * xnorm) 
+    {
+      m_info = Success;
+      return LevenbergMarquardtSpace::XtolTooSmall;
+    }
+    if (m_gnorm <= NumTraits<Scalar>::epsilon())
+    {
+      m_info = Success;
+      return LevenbergMarquardtSpace::GtolTooSmall;
+    }
+
+  } while (ratio < Scalar(1e-4));
+
+  return LevenbergMarquardtSpace::Running;
+}
+
 } // end namespace Eigen
 
 #endif // EIGEN_LMONESTEP_H
@@ -105,17 +105,26 @@ void lmpar2(const QRSolver &qr, const VectorType  &diag, const VectorType  &qtb,
   *
   * Check wikipedia for more information.
   * http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm
+  *
+  * \tparam _FunctorType the functor computing the vector function and its Jacobian
+  * \tparam _Solver the solver of the linear least squares problem of each step. It is by default the QR
+  *         factorization given by the functor, \c FunctorType::QRSolver. For large sparse problems, a
+  *         LevenbergMarquardtNormalSolver solves the normal equations with a sparse Cholesky factorization instead;
+  *         it is then accessible through solver() to set its options. In that case, the damping parameter is
+  *         updated directly from the ratio of the actual to the predicted reductions rather than from the step bound,
+  *         and matrixR() and permutation() are not computed.
   */
-template<typename _FunctorType>
-class LevenbergMarquardt : internal::no_assignment_operator
+template<typename _FunctorType, typename _Solver = typename _FunctorType::QRSolver>
+class LevenbergMarquardt : internal::no_assignment_operator, public internal::lm_solver_storage<_Solver>
 {
   public:
     typedef _FunctorType FunctorType;
     typedef typename FunctorType::QRSolver QRSolver;
+    typedef _Solver Solver;
     typedef typename FunctorType::JacobianType JacobianType;
     typedef typename JacobianType::Scalar Scalar;
     typedef typename JacobianType::RealScalar RealScalar; 
-    typedef typename QRSolver::StorageIndex PermIndex;
+    typedef typename Solver::StorageIndex PermIndex;
     typedef Matrix<Scalar,Dynamic,1> FVectorType;
     typedef PermutationMatrix<Dynamic,Dynamic> PermutationType;
   public:
@@ -129,7 +138,10 @@ class LevenbergMarquardt : internal::no_assignment_operator
     
     LevenbergMarquardtSpace::Status minimize(FVectorType &x);
     LevenbergMarquardtSpace::Status minimizeInit(FVectorType &x);
-    LevenbergMarquardtSpace::Status minimizeOneStep(FVectorType &x);
+    LevenbergMarquardtSpace::Status minimizeOneStep(FVectorType &x)
+    {
+      return minimizeOneStep(x, internal::is_lm_normal_solver<Solver>());
+    }
     LevenbergMarquardtSpace::Status lmder1(
       FVectorType  &x, 
       const Scalar tol = std::sqrt(NumTraits<Scalar>::epsilon())
@@ -228,6 +240,9 @@ class LevenbergMarquardt : internal::no_assignment_operator
       return m_info;
     }
   private:
+    LevenbergMarquardtSpace::Status minimizeOneStep(FVectorType &x, internal::false_type);
+    LevenbergMarquardtSpace::Status minimizeOneStep(FVectorType &x, internal::true_type);
+
     JacobianType m_fjac; 
     JacobianType m_rfactor; // The triangular matrix R from the QR of the jacobian matrix m_fjac
     FunctorType &m_functor;
@@ -254,9 +269,9 @@ class LevenbergMarquardt : internal::no_assignment_operator
     ComputationInfo m_info; 
 };
 
-template<typename FunctorType>
+template<typename FunctorType, typename Solver>
 LevenbergMarquardtSpace::Status
-LevenbergMarquardt<FunctorType>::minimize(FVectorType  &x)
+LevenbergMarquardt<FunctorType,Solver>::minimize(FVectorType  &x)
 {
     LevenbergMarquardtSpace::Status status = minimizeInit(x);
     if (status==LevenbergMarquardtSpace::ImproperInputParameters) {
@@ -271,9 +286,9 @@ LevenbergMarquardt<FunctorType>::minimize(FVectorType  &x)
      return status;
 }
 
-template<typename FunctorType>
+template<typename FunctorType, typename Solver>
 LevenbergMarquardtSpace::Status
-LevenbergMarquardt<FunctorType>::minimizeInit(FVectorType  &x)
+LevenbergMarquardt<FunctorType,Solver>::minimizeInit(FVectorType  &x)
 {
     n = x.size();
     m = m_functor.values();
@@ -321,9 +336,9 @@ LevenbergMarquardt<FunctorType>::minimizeInit(FVectorType  &x)
     return LevenbergMarquardtSpace::NotStarted;
 }
 
-template<typename FunctorType>
+template<typename FunctorType, typename Solver>
 LevenbergMarquardtSpace::Status
-LevenbergMarquardt<FunctorType>::lmder1(
+LevenbergMarquardt<FunctorType,Solver>::lmder1(
         FVectorType  &x,
         const Scalar tol
         )
@@ -344,9 +359,9 @@ LevenbergMarquardt<FunctorType>::lmder1(
 }
 
 
-template<typename FunctorType>
+template<typename FunctorType, typename Solver>
 LevenbergMarquardtSpace::Status
-LevenbergMarquardt<FunctorType>::lmdif1(
+LevenbergMarquardt<FunctorType,Solver>::lmdif1(
         FunctorType &functor,
         FVectorType  &x,
         Index *nfev,
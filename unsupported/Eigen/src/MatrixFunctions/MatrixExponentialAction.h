@@ -0,0 +1,323 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_MATRIX_EXPONENTIAL_ACTION
+#define EIGEN_MATRIX_EXPONENTIAL_ACTION
+
+namespace Eigen {
+
+template<typename Derived> class SparseMatrixBase;
+
+namespace internal {
+
+/** \brief Bounds \f$ \theta_m \f$ of the truncated Taylor series of the exponential.
+  *
+  * The m-th entry is the largest \f$ \theta \f$ such that the Taylor polynomial of degree 5(m+1), applied
+  * \f$ s \f$ times to \f$ A/s \f$ with \f$ \|A/s\|_1 \le \theta \f$, computes \f$ \exp(A) \f$ with a backward error
+  * not larger than the unit roundoff (Al-Mohy and Higham, 2011). Scalar types without a table use the values of
+  * double.
+  */
+template <typename RealScalar>
+struct matrix_exp_taylor_theta
+{
+  enum { Size = 11 };
+  static RealScalar run(Index i)
+  {
+    static const double theta[Size] = {
+      2.400876357887274e-03, 1.441829761614378e-01, 6.410835233041199e-01, 1.438252596804337e+00,
+      2.428582524442827e+00, 3.539666348743689e+00, 4.728347345793539e+00, 5.968802630041849e+00,
+      7.245068429597951e+00, 8.546902045684933e+00, 9.867496675753401e+00 };
+    return RealScalar(theta[i]);
+  }
+};
+
+template <>
+struct matrix_exp_taylor_theta<float>
+{
+  enum { Size = 11 };
+  static float run(Index i)
+  {
+    static const float theta[Size] = {
+      1.308487164599470e-01f, 9.951840790004457e-01f, 2.217044394974721e+00f, 3.550926214706495e+00f,
+      4.926899843755911e+00f, 6.321082126301961e+00f, 7.723803811553991e+00f, 9.130653881090101e+00f,
+      1.053944673424217e+01f, 1.194903664242897e+01f, 1.335880114249307e+01f };
+    return theta[i];
+  }
+};
+
+template <>
+struct matrix_exp_taylor_theta<long double>
+{
+  enum { Size = 11 };
+  static long double run(Index i)
+  {
+#if   LDBL_MANT_DIG == 53   // double precision
+    return matrix_exp_taylor_theta<double>::run(i);
+#else
+    static const long double theta[Size] = {
+#if LDBL_MANT_DIG <= 64     // extended precision
+      5.226893365979027e-04L, 6.773706591273536e-02L, 3.917110656121748e-01L, 1.003022712370239e+00L,
+      1.831922664109381e+00L, 2.810827562719984e+00L, 3.892423503682005e+00L, 5.045627717934694e+00L,
+      6.250015816789783e+00L, 7.491906459892037e+00L, 8.761910038156007e+00L
+#elif LDBL_MANT_DIG <= 106  // double-double
+      1.547499352577563e-06L, 3.707234258741084e-03L, 5.743774136991078e-02L, 2.426208114957799e-01L,
+      5.995483065918511e-01L, 1.124808920556912e+00L, 1.796140771741390e+00L, 2.587821678934107e+00L,
+      3.476698344433906e+00L, 4.443703340671521e+00L, 5.473682709675593e+00L
+#else                       // quadruple precision
+      5.863926979562056e-07L, 2.282368465861117e-03L, 4.160525533415063e-02L, 1.908277628266408e-01L,
+      4.957619546207589e-01L, 9.618899870927874e-01L, 1.573356553450521e+00L, 2.307939124577350e+00L,
+      3.144030265502240e+00L, 4.063015975075497e+00L, 5.049647706378093e+00L
+#endif
+    };
+    return theta[i];
+#endif
+  }
+};
+
+/** \internal Computes the shift \f$ \mu = \mathrm{trace}(A)/n \f$, and the 1-norm of \f$ A - \mu I \f$, which is
+  * used instead of \f$ A \f$ when it has a smaller norm. The shift is zero when it does not reduce the norm. */
+template<typename Derived>
+void matrix_exp_action_norm(const MatrixBase<Derived>& A, typename Derived::Scalar& shift,
+                            typename NumTraits<typename Derived::Scalar>::Real& norm)
+{
+  typedef typename Derived::Scalar Scalar;
+  const typename nested_eval<Derived,2>::type a(A.derived());
+  norm = a.cwiseAbs().colwise().sum().maxCoeff();
+  shift = a.trace() / Scalar(a.rows());
+  typename NumTraits<Scalar>::Real shiftedNorm = (a - shift*Derived::PlainObject::Identity(a.rows(),a.cols())).cwiseAbs().colwise().sum().maxCoeff();
+  if(shiftedNorm < norm)
+    norm = shiftedNorm;
+  else
+    shift = Scalar(0);
+}
+
+template<typename Derived>
+void matrix_exp_action_norm(const SparseMatrixBase<Derived>& A, typename Derived::Scalar& shift,
+                            typename NumTraits<typename Derived::Scalar>::Real& norm)
+{
+  using std::abs;
+  typedef typename Derived::Scalar Scalar;
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+  const Index n = A.cols();
+  Matrix<Scalar,Dynamic,1> diag = Matrix<Scalar,Dynamic,1>::Zero(n);
+  Matrix<RealScalar,Dynamic,1> colSums = Matrix<RealScalar,Dynamic,1>::Zero(n);
+  evaluator<Derived> thisEval(A.derived());
+  for(Index j=0; j<A.outerSize(); ++j)
+    for(typename evaluator<Derived>::InnerIterator it(thisEval,j); it; ++it)
+    {
+      colSums(it.col()) += abs(it.value());
+      if(it.row()==it.col())
+        diag(it.col()) += it.value();
+    }
+  shift = diag.sum() / Scalar(n);
+  norm = colSums.maxCoeff();
+  // only the diagonal entries change with the shift
+  RealScalar shiftedNorm = (colSums - diag.cwiseAbs() + (diag.array()-shift).abs().matrix()).maxCoeff();
+  if(shiftedNorm < norm)
+    norm = shiftedNorm;
+  else
+    shift = Scalar(0);
+}
+
+// The norm of a matrix-free operator is unknown, and must be given by the user
+template<typename Derived>
+void matrix_exp_action_norm(const EigenBase<Derived>&, typename Derived::Scalar& shift,
+                            typename NumTraits<typename Derived::Scalar>::Real& norm)
+{
+  shift = typename Derived::Scalar(0);
+  norm = -1;
+}
+
+/** \internal Computes \a dst = \a A * \a src */
+template<typename Derived, typename MatrixType>
+void matrix_exp_action_product(const MatrixBase<Derived>& A, const MatrixType& src, MatrixType& dst)
+{
+  dst.noalias() = A.derived() * src;
+}
+
+template<typename Derived, typename MatrixType>
+void matrix_exp_action_product(const SparseMatrixBase<Derived>& A, const MatrixType& src, MatrixType& dst)
+{
+  dst.noalias() = A.derived() * src;
+}
+
+// A matrix-free operator is only required to be applicable to vectors
+template<typename Derived, typename MatrixType>
+void matrix_exp_action_product(const EigenBase<Derived>& A, const MatrixType& src, MatrixType& dst)
+{
+  typedef Matrix<typename MatrixType::Scalar,Dynamic,1> VectorType;
+  VectorType x, y;
+  dst.resize(A.rows(), src.cols());
+  for(Index j=0; j<src.cols(); ++j)
+  {
+    x = src.col(j);
+    y.noalias() = A.derived() * x;
+    dst.col(j) = y;
+  }
+}
+
+} // end namespace internal
+
+/** \ingroup MatrixFunctions_Module
+  *
+  * \brief Computes the action of the matrix exponential on vectors
+  *
+  * \tparam _OperatorType the type of the square matrix \f$ A \f$: a dense matrix, a SparseMatrix, or a matrix-free
+  *         operator whose product with a vector is defined, as the operators used by the iterative solvers.
+  *
+  * This class computes \f$ \exp(tA)\, B \f$ for a matrix \f$ B \f$ of one or several vectors without forming
+  * \f$ \exp(tA) \f$, so that it only costs a number of products of \f$ A \f$ by \f$ B \f$ and the storage of a
+  * few matrices of the size of \f$ B \f$. It implements the truncated Taylor series of Al-Mohy and Higham
+  * (Computing the action of the matrix exponential, SIAM J. Sci. Comput., 2011): the interval \f$ [0,t] \f$ is
+  * split into \f$ s \f$ steps, and the degree of the Taylor polynomial of each step and \f$ s \f$ are chosen from
+  * \f$ \|A\|_1 \f$ so that the truncation error does not exceed the unit roundoff while minimizing the number of
+  * products. The series of a step is truncated early when its terms become negligible, and \f$ A \f$ is shifted
+  * by \f$ \mathrm{trace}(A)/n \f$ when this reduces its norm.
+  *
+  * \code
+  * SparseMatrix<double> A = ...;   // e.g. the generator of a Markov chain
+  * VectorXd p = ...;
+  * MatrixExponentialAction<SparseMatrix<double> > expA(A);
+  * VectorXd q = expA.apply(p, 0.5);                  // exp(0.5 A) p
+  * MatrixXd Q = expA.apply(p, VectorXd::LinSpaced(10, 0.1, 1.0));  // exp(t_i A) p for 10 time points
+  * \endcode
+  *
+  * The 1-norm of a matrix-free operator cannot be computed from its products with vectors: an upper bound of it
+  * must be given by setOneNorm().
+  *
+  * \sa MatrixBase::exp()
+  */
+template<typename _OperatorType>
+class MatrixExponentialAction
+{
+  public:
+    typedef _OperatorType OperatorType;
+    typedef typename OperatorType::Scalar Scalar;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+
+    /** \brief Constructor.
+      *
+      * \param[in] op  the matrix \f$ A \f$, which is referenced and must outlive this object.
+      */
+    explicit MatrixExponentialAction(const OperatorType& op) : m_op(op), m_productCount(0)
+    {
+      eigen_assert(op.rows()==op.cols());
+      internal::matrix_exp_action_norm(op, m_shift, m_norm);
+    }
+
+    /** Sets an upper bound of \f$ \|A\|_1 \f$. This is required for matrix-free operators, and disables the shift. */
+    MatrixExponentialAction& setOneNorm(const RealScalar& norm)
+    {
+      eigen_assert(norm>=RealScalar(0));
+      m_norm = norm;
+      m_shift = Scalar(0);
+      return *this;
+    }
+
+    /** \returns \f$ \exp(tA)\, B \f$, for the vector or the matrix of vectors \a b */
+    template<typename Rhs>
+    MatrixType apply(const MatrixBase<Rhs>& b, const RealScalar& t = RealScalar(1))
+    {
+      eigen_assert(b.rows()==m_op.rows());
+      m_productCount = 0;
+      MatrixType res = b;
+      run(res, t);
+      return res;
+    }
+
+    /** \returns the matrix \f$ [\exp(t_0 A)\, B, \exp(t_1 A)\, B, \ldots] \f$ for the times \f$ t_i \f$ given by
+      * \a times. The result at each time is computed from the previous one, so that the cost is the one of the
+      * largest time when the times are sorted in increasing order. */
+    template<typename Rhs, typename Times>
+    MatrixType apply(const MatrixBase<Rhs>& b, const DenseBase<Times>& times)
+    {
+      eigen_assert(b.rows()==m_op.rows());
+      const Index p = b.cols();
+      m_productCount = 0;
+      MatrixType res(b.rows(), p*times.size()), current = b;
+      RealScalar previous(0);
+      for(Index i=0; i<times.size(); ++i)
+      {
+        run(current, RealScalar(times.coeff(i))-previous);
+        res.middleCols(i*p, p) = current;
+        previous = RealScalar(times.coeff(i));
+      }
+      return res;
+    }
+
+    /** \returns the number of products of \f$ A \f$ by a matrix of vectors performed by the last call to apply() */
+    Index productCount() const { return m_productCount; }
+
+  protected:
+    // Computes f = exp(t A) f in place
+    void run(MatrixType& f, const RealScalar& t)
+    {
+      using std::abs;
+      using std::ceil;
+      using std::exp;
+      typedef internal::matrix_exp_taylor_theta<RealScalar> Theta;
+      eigen_assert(m_norm>=RealScalar(0) && "The 1-norm of matrix-free operators must be set with setOneNorm()");
+
+      // the degree m and the number of steps s minimizing the number m*s of products
+      const RealScalar tnorm = abs(t) * m_norm;
+      Index m = 0, s = 1;
+      if(tnorm > RealScalar(0))
+      {
+        RealScalar bestCost = NumTraits<RealScalar>::highest();
+        for(Index i=0; i<Theta::Size; ++i)
+        {
+          RealScalar steps = (std::max)(ceil(tnorm / Theta::run(i)), RealScalar(1));
+          RealScalar cost = RealScalar(5*(i+1)) * steps;
+          if(cost < bestCost)
+          {
+            bestCost = cost;
+            m = 5*(i+1);
+            s = Index(steps);
+          }
+        }
+      }
+
+      const Scalar eta = exp(Scalar(t/RealScalar(s)) * m_shift);
+      const RealScalar tol = NumTraits<RealScalar>::epsilon();
+      MatrixType b = f;
+      for(Index i=0; i<s; ++i)
+      {
+        RealScalar c1 = infNorm(b);
+        for(Index k=1; k<=m; ++k)
+        {
+          internal::matrix_exp_action_product(m_op, b, m_product);
+          ++m_productCount;
+          if(m_shift!=Scalar(0))
+            m_product -= m_shift * b;
+          b = (t / RealScalar(s*k)) * m_product;
+          RealScalar c2 = infNorm(b);
+          f += b;
+          if(c1 + c2 <= tol * infNorm(f))
+            break;
+          c1 = c2;
+        }
+        f *= eta;
+        b = f;
+      }
+    }
+
+    static RealScalar infNorm(const MatrixType& x)
+    {
+      return x.size()==0 ? RealScalar(0) : x.cwiseAbs().rowwise().sum().maxCoeff();
+    }
+
+    const OperatorType& m_op;
+    Scalar m_shift;
+    RealScalar m_norm;
+    MatrixType m_product;
+    Index m_productCount;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_MATRIX_EXPONENTIAL_ACTION
@@ -31,6 +31,14 @@ enum NumericalDiffMode {
   * http://en.wikipedia.org/wiki/Numerical_differentiation
   *
   * Currently only "Forward" and "Central" scheme are implemented.
+  *
+  * When the jacobian is sparse, setSparsityPattern() colors its columns such that two
+  * columns of the same color never have a nonzero on the same row. The columns of a
+  * color are then perturbed together, so that df() evaluates the functor once per color
+  * (twice in Central mode) instead of once per column, and directly fills a SparseMatrix.
+  *
+  * With setParallelEvaluation(), the evaluations of df() are shared among the threads
+  * when OpenMP is enabled.
   */
 template<typename _Functor, NumericalDiffMode mode=Forward>
 class NumericalDiff : public _Functor
@@ -42,83 +50,240 @@ public:
     typedef typename Functor::ValueType ValueType;
     typedef typename Functor::JacobianType JacobianType;
 
-    NumericalDiff(Scalar _epsfcn=0.) : Functor(), epsfcn(_epsfcn) {}
-    NumericalDiff(const Functor& f, Scalar _epsfcn=0.) : Functor(f), epsfcn(_epsfcn) {}
+    NumericalDiff(Scalar _epsfcn=0.) : Functor(), epsfcn(_epsfcn), m_parallel(false) {}
+    NumericalDiff(const Functor& f, Scalar _epsfcn=0.) : Functor(f), epsfcn(_epsfcn), m_parallel(false) {}
 
     // forward constructors
     template<typename T0>
-        NumericalDiff(const T0& a0) : Functor(a0), epsfcn(0) {}
+        NumericalDiff(const T0& a0) : Functor(a0), epsfcn(0), m_parallel(false) {}
     template<typename T0, typename T1>
-        NumericalDiff(const T0& a0, const T1& a1) : Functor(a0, a1), epsfcn(0) {}
+        NumericalDiff(const T0& a0, const T1& a1) : Functor(a0, a1), epsfcn(0), m_parallel(false) {}
     template<typename T0, typename T1, typename T2>
-        NumericalDiff(const T0& a0, const T1& a1, const T2& a2) : Functor(a0, a1, a2), epsfcn(0) {}
+        NumericalDiff(const T0& a0, const T1& a1, const T2& a2) : Functor(a0, a1, a2), epsfcn(0), m_parallel(false) {}
 
     enum {
         InputsAtCompileTime = Functor::InputsAtCompileTime,
         ValuesAtCompileTime = Functor::ValuesAtCompileTime
     };
 
+    /**
+      * Allows df() to evaluate the functor concurrently from several threads
+      * when OpenMP is enabled. The evaluation operator of the functor must then
+      * be safe to call concurrently, which is why this is disabled by default.
+      */
+    void setParallelEvaluation(bool enable) { m_parallel = enable; }
+
+    /**
+      * Sets the sparsity pattern of the jacobian, and computes a coloring of its columns
+      * by a greedy algorithm visiting the columns by decreasing number of nonzeros.
+      * Only the structure of \a pattern is used.
+      */
+    template<typename PatternScalar, int PatternOptions, typename PatternIndex>
+    void setSparsityPattern(const SparseMatrix<PatternScalar,PatternOptions,PatternIndex>& pattern)
+    {
+        typedef SparseMatrix<PatternScalar,PatternOptions,PatternIndex> PatternType;
+        std::vector<Triplet<Scalar,int> > entries;
+        entries.reserve(pattern.nonZeros());
+        for (Index k = 0; k < pattern.outerSize(); ++k)
+            for (typename PatternType::InnerIterator it(pattern, k); it; ++it)
+                entries.push_back(Triplet<Scalar,int>(int(it.row()), int(it.col()), Scalar(1)));
+        m_pattern.resize(pattern.rows(), pattern.cols());
+        m_pattern.setFromTriplets(entries.begin(), entries.end());
+        m_pattern.makeCompressed();
+
+        const Index n = m_pattern.cols();
+        SparseMatrix<Scalar,RowMajor,int> rowPattern = m_pattern;
+        std::vector<std::pair<Index,Index> > order(n);
+        for (Index j = 0; j < n; ++j)
+            order[j] = std::make_pair(-Index(m_pattern.innerVector(j).nonZeros()), j);
+        std::stable_sort(order.begin(), order.end());
+
+        // forbidden[c]==j when the color c is used by a column sharing a row with the column j
+        std::vector<Index> colors(n, -1), forbidden(n, -1);
+        Index colorCount = 0;
+        for (Index k = 0; k < n; ++k) {
+            const Index j = order[k].second;
+            for (typename SparseMatrix<Scalar,ColMajor,int>::InnerIterator it(m_pattern, j); it; ++it)
+                for (typename SparseMatrix<Scalar,RowMajor,int>::InnerIterator it2(rowPattern, it.row()); it2; ++it2)
+                    if (colors[it2.col()] >= 0)
+                        forbidden[colors[it2.col()]] = j;
+            Index c = 0;
+            while (forbidden[c] == j)
+                ++c;
+            colors[j] = c;
+            colorCount = (std::max)(colorCount, c+1);
+        }
+
+        // the columns are grouped by color
+        m_colorStart.setZero(colorCount+1);
+        for (Index j = 0; j < n; ++j)
+            ++m_colorStart[colors[j]+1];
+        for (Index c = 0; c < colorCount; ++c)
+            m_colorStart[c+1] += m_colorStart[c];
+        m_colorColumns.resize(n);
+        IndexVector next = m_colorStart.head(colorCount);
+        for (Index j = 0; j < n; ++j)
+            m_colorColumns[next[colors[j]]++] = j;
+    }
+
+    /**
+      * \returns the number of colors of the sparsity pattern, i.e., the number of
+      * columns of the jacobian which are computed at once by df()
+      */
+    Index colorCount() const { return m_colorStart.size() > 0 ? m_colorStart.size()-1 : 0; }
+
     /**
       * return the number of evaluation of functor
      */
     int df(const InputType& _x, JacobianType &jac) const
+    {
+        return differentiate(_x, jac);
+    }
+
+    /**
+      * Computes the sparse jacobian whose sparsity pattern has been given to
+      * setSparsityPattern(). The structure of \a jac is set to that pattern.
+      *
+      * return the number of evaluation of functor
+     */
+    template<typename StorageIndex>
+    int df(const InputType& _x, SparseMatrix<Scalar,ColMajor,StorageIndex> &jac) const
+    {
+        return differentiate(_x, jac);
+    }
+
+private:
+    typedef Matrix<Index,Dynamic,1> IndexVector;
+
+    template<typename Derived>
+    int differentiate(const InputType& _x, MatrixBase<Derived> &jac) const
+    {
+        return evaluate(_x, jac.derived(), _x.size(), 0, 0);
+    }
+
+    template<typename StorageIndex>
+    int differentiate(const InputType& _x, SparseMatrix<Scalar,ColMajor,StorageIndex> &jac) const
+    {
+        eigen_assert(m_pattern.cols() == _x.size() && m_pattern.rows() == Functor::values()
+                     && "NumericalDiff: the sparsity pattern must be set by setSparsityPattern()");
+        jac = m_pattern;
+        return evaluate(_x, jac, colorCount(), m_colorStart.data(), m_colorColumns.data());
+    }
+
+    // Computes the columns of the groups of columns [0, groups), where the group g is made
+    // of the columns groupColumns[groupStart[g]...groupStart[g+1]-1], or only of the column g
+    // if groupStart is null.
+    template<typename Jacobian>
+    int evaluate(const InputType& _x, Jacobian &jac, Index groups, const Index* groupStart, const Index* groupColumns) const
     {
         using std::sqrt;
         using std::abs;
-        /* Local variables */
-        Scalar h;
-        int nfev=0;
-        const typename InputType::Index n = _x.size();
+        const Index n = _x.size();
         const Scalar eps = sqrt(((std::max)(epsfcn,NumTraits<Scalar>::epsilon() )));
-        ValueType val1, val2;
-        InputType x = _x;
-        // TODO : we should do this only if the size is not already known
-        val1.resize(Functor::values());
-        val2.resize(Functor::values());
+        ValueType val0;
+        int nfev = 0;
+
+        // the steps
+        InputType h(n);
+        for (Index j = 0; j < n; ++j) {
+            h[j] = eps * abs(_x[j]);
+            if (h[j] == 0.) {
+                h[j] = eps;
+            }
+        }
 
         // initialization
         switch(mode) {
             case Forward:
                 // compute f(x)
-                Functor::operator()(x, val1); nfev++;
+                val0.resize(Functor::values());
+                Functor::operator()(_x, val0); nfev++;
+                nfev += int(groups);
                 break;
             case Central:
                 // do nothing
+                nfev += 2*int(groups);
                 break;
             default:
                 eigen_assert(false);
         };
 
         // Function Body
-        for (int j = 0; j < n; ++j) {
-            h = eps * abs(x[j]);
-            if (h == 0.) {
-                h = eps;
+#ifdef EIGEN_HAS_OPENMP
+        Eigen::initParallel();
+        int threads = Eigen::nbThreads();
+        if (m_parallel && threads > 1 && groups > 1)
+        {
+            #pragma omp parallel num_threads(threads)
+            {
+                InputType x = _x;
+                ValueType val1, val2;
+                #pragma omp for schedule(dynamic)
+                for (Index g = 0; g < groups; ++g)
+                    evaluateGroup(_x, x, h, val0, val1, val2, jac, groupStart, groupColumns, g);
             }
-            switch(mode) {
-                case Forward:
-                    x[j] += h;
-                    Functor::operator()(x, val2);
-                    nfev++;
-                    x[j] = _x[j];
-                    jac.col(j) = (val2-val1)/h;
-                    break;
-                case Central:
-                    x[j] += h;
-                    Functor::operator()(x, val2); nfev++;
-                    x[j] -= 2*h;
-                    Functor::operator()(x, val1); nfev++;
-                    x[j] = _x[j];
-                    jac.col(j) = (val2-val1)/(2*h);
-                    break;
-                default:
-                    eigen_assert(false);
-            };
+        }
+        else
+#endif
+        {
+            InputType x = _x;
+            ValueType val1, val2;
+            for (Index g = 0; g < groups; ++g)
+                evaluateGroup(_x, x, h, val0, val1, val2, jac, groupStart, groupColumns, g);
         }
         return nfev;
     }
-private:
+
+    template<typename Jacobian>
+    void evaluateGroup(const InputType& _x, InputType& x, const InputType& h, const ValueType& val0,
+                       ValueType& val1, ValueType& val2, Jacobian& jac,
+                       const Index* groupStart, const Index* groupColumns, Index g) const
+    {
+        const Index* begin = groupStart ? groupColumns + groupStart[g] : &g;
+        const Index* end = groupStart ? groupColumns + groupStart[g+1] : &g + 1;
+        val1.resize(Functor::values());
+        val2.resize(Functor::values());
+        for (const Index* j = begin; j != end; ++j)
+            x[*j] += h[*j];
+        Functor::operator()(x, val2);
+        switch(mode) {
+            case Forward:
+                for (const Index* j = begin; j != end; ++j) {
+                    x[*j] = _x[*j];
+                    setColumn(jac, *j, val2, val0, h[*j]);
+                }
+                break;
+            case Central:
+                for (const Index* j = begin; j != end; ++j)
+                    x[*j] -= 2*h[*j];
+                Functor::operator()(x, val1);
+                for (const Index* j = begin; j != end; ++j) {
+                    x[*j] = _x[*j];
+                    setColumn(jac, *j, val2, val1, 2*h[*j]);
+                }
+                break;
+            default:
+                eigen_assert(false);
+        };
+    }
+
+    template<typename Derived>
+    static void setColumn(MatrixBase<Derived>& jac, Index j, const ValueType& val2, const ValueType& val1, Scalar h)
+    {
+        jac.col(j) = (val2-val1)/h;
+    }
+
+    template<typename StorageIndex>
+    static void setColumn(SparseMatrix<Scalar,ColMajor,StorageIndex>& jac, Index j, const ValueType& val2, const ValueType& val1, Scalar h)
+    {
+        for (typename SparseMatrix<Scalar,ColMajor,StorageIndex>::InnerIterator it(jac, j); it; ++it)
+            it.valueRef() = (val2[it.row()]-val1[it.row()])/h;
+    }
+
     Scalar epsfcn;
+    bool m_parallel;
+    SparseMatrix<Scalar,ColMajor,int> m_pattern;
+    IndexVector m_colorStart, m_colorColumns;
 
     NumericalDiff& operator=(const NumericalDiff&);
 };
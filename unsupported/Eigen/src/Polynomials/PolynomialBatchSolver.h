@@ -0,0 +1,261 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_POLYNOMIAL_BATCH_SOLVER_H
+#define EIGEN_POLYNOMIAL_BATCH_SOLVER_H
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal
+  * Aberth-Ehrlich iterations on a packet of polynomials of degree \a deg, one per entry of the packets.
+  * The complex numbers are stored as pairs of packets of real and imaginary parts.
+  */
+template< typename Scalar, typename Packet, int _Deg >
+struct polynomial_batch_kernel
+{
+  enum { PacketSize = unpacket_traits<Packet>::size };
+
+  // a/b, where the division by zero gives zero
+  static EIGEN_STRONG_INLINE void cdiv( const Packet& ar, const Packet& ai, const Packet& br, const Packet& bi,
+                                        const Packet& tiny, Packet& resr, Packet& resi )
+  {
+    Packet inv = pdiv( pset1<Packet>(Scalar(1)), padd( pmadd(br, br, pmul(bi, bi)), tiny ) );
+    resr = pmul( pmadd(ar, br, pmul(ai, bi)), inv );
+    resi = pmul( psub(pmul(ai, br), pmul(ar, bi)), inv );
+  }
+
+  /** Computes the roots of the polynomials whose coefficient k is stored at \a coeffs + k + j * \a coeffStride
+    * for the j-th entry of the packets. The real and imaginary parts of the root k are stored at
+    * \a roots + k * \a rootRowStride + j * \a rootStride.
+    * \returns the number of iterations
+    */
+  static Index run( const Scalar* coeffs, Index coeffStride, Scalar* roots, Index rootRowStride, Index rootStride, Index deg,
+                    Index maxIterations, Scalar* buffer )
+  {
+    using std::cos;
+    using std::sin;
+    const Scalar pi = Scalar(EIGEN_PI);
+    const Packet tiny = pset1<Packet>( (std::numeric_limits<Scalar>::min)() );
+    const Scalar tolerance = Scalar(16) * numext::abs2( NumTraits<Scalar>::epsilon() );
+    Scalar* c = buffer;
+    Scalar* zr = buffer + deg*PacketSize;
+    Scalar* zi = buffer + 2*deg*PacketSize;
+
+    // the monic polynomials
+    Packet lead = pgather<Scalar,Packet>( coeffs + deg, coeffStride );
+    Packet invLead = pdiv( pset1<Packet>(Scalar(1)), lead );
+    for( Index k=0; k<deg; ++k )
+      pstore( c + k*PacketSize, pmul( pgather<Scalar,Packet>(coeffs + k, coeffStride), invLead ) );
+
+    // the initial roots are spread on the circle of radius max_i |c_{deg-i}|^(1/i), which contains the roots
+    // within a factor 2
+    Packet radius = pset1<Packet>(Scalar(0));
+    for( Index i=1; i<=deg; ++i )
+    {
+      Packet a = pabs( pload<Packet>(c + (deg-i)*PacketSize) );
+      radius = pmax( radius, pexp( pmul( plog(a), pset1<Packet>(Scalar(1)/Scalar(i)) ) ) );
+    }
+    for( Index k=0; k<deg; ++k )
+    {
+      Scalar angle = Scalar(2)*pi*Scalar(k)/Scalar(deg) + Scalar(0.4);
+      pstore( zr + k*PacketSize, pmul( radius, pset1<Packet>(cos(angle)) ) );
+      pstore( zi + k*PacketSize, pmul( radius, pset1<Packet>(sin(angle)) ) );
+    }
+
+    Index iter = 0;
+    while( iter < maxIterations )
+    {
+      ++iter;
+      Packet maxStep = pset1<Packet>(Scalar(0));
+      for( Index i=0; i<deg; ++i )
+      {
+        const Packet xr = pload<Packet>(zr + i*PacketSize), xi = pload<Packet>(zi + i*PacketSize);
+
+        // p(z) and p'(z) with the Horner scheme
+        Packet pr = pset1<Packet>(Scalar(1)), pi_ = pset1<Packet>(Scalar(0));
+        Packet dr = pset1<Packet>(Scalar(0)), di = pset1<Packet>(Scalar(0));
+        for( Index k=deg-1; k>=0; --k )
+        {
+          Packet tr = psub( pmul(dr, xr), pmul(di, xi) );
+          di = padd( pmadd(dr, xi, pmul(di, xr)), pi_ );
+          dr = padd( tr, pr );
+          tr = padd( psub( pmul(pr, xr), pmul(pi_, xi) ), pload<Packet>(c + k*PacketSize) );
+          pi_ = pmadd( pr, xi, pmul(pi_, xr) );
+          pr = tr;
+        }
+
+        // the Newton correction w = p/p', and the sum of the 1/(z_i-z_j)
+        Packet wr, wi;
+        cdiv( pr, pi_, dr, di, tiny, wr, wi );
+        Packet sr = pset1<Packet>(Scalar(0)), si = pset1<Packet>(Scalar(0));
+        for( Index j=0; j<deg; ++j )
+        {
+          if( j==i ) continue;
+          Packet er = psub( xr, pload<Packet>(zr + j*PacketSize) );
+          Packet ei = psub( xi, pload<Packet>(zi + j*PacketSize) );
+          Packet inv = pdiv( pset1<Packet>(Scalar(1)), padd( pmadd(er, er, pmul(ei, ei)), tiny ) );
+          sr = pmadd( er, inv, sr );
+          si = psub( si, pmul(ei, inv) );
+        }
+
+        // the Aberth correction w / (1 - w * sum)
+        Packet qr = psub( pset1<Packet>(Scalar(1)), psub( pmul(wr, sr), pmul(wi, si) ) );
+        Packet qi = pnegate( pmadd( wr, si, pmul(wi, sr) ) );
+        Packet stepr, stepi;
+        cdiv( wr, wi, qr, qi, tiny, stepr, stepi );
+        Packet nr = psub( xr, stepr ), ni = psub( xi, stepi );
+        pstore( zr + i*PacketSize, nr );
+        pstore( zi + i*PacketSize, ni );
+
+        Packet step = pmadd( stepr, stepr, pmul(stepi, stepi) );
+        Packet size = padd( pmadd(nr, nr, pmul(ni, ni)), tiny );
+        maxStep = pmax( maxStep, pdiv(step, size) );
+      }
+      if( !(predux_max(maxStep) > tolerance) )
+        break;
+    }
+
+    for( Index k=0; k<deg; ++k )
+    {
+      pscatter( roots + k*rootRowStride, pload<Packet>(zr + k*PacketSize), rootStride );
+      pscatter( roots + k*rootRowStride + 1, pload<Packet>(zi + k*PacketSize), rootStride );
+    }
+    return iter;
+  }
+};
+
+} // end namespace internal
+
+/** \ingroup Polynomials_Module
+  *
+  * \class PolynomialBatchSolver
+  *
+  * \brief Computes the complex roots of many real polynomials of the same degree
+  *
+  * \param _Scalar the scalar type, i.e., the type of the polynomial coefficients
+  * \param _Deg the degree of the polynomials, can be a compile time value or Dynamic.
+  *
+  * The polynomials are given by the columns of a matrix of coefficients, the coefficient of \f$ x^k \f$ being
+  * stored on the row k, and their roots are written into the columns of a matrix of complex numbers given by
+  * the caller, so that solving a batch does not allocate memory:
+  * \code
+  * Matrix<double,4,Dynamic> cubics(4, n);             // a_0 + a_1 x + a_2 x^2 + a_3 x^3 in each column
+  * Matrix<std::complex<double>,3,Dynamic> roots(3, n);
+  * PolynomialBatchSolver<double,3> solver;
+  * solver.compute(cubics, roots);
+  * \endcode
+  *
+  * Instead of computing the eigenvalues of a companion matrix per polynomial as PolynomialSolver, this class runs
+  * Aberth-Ehrlich iterations, i.e. simultaneous Newton iterations on all the roots, on packets of polynomials:
+  * each entry of a SIMD packet belongs to another polynomial, so that the iterations are vectorized across the
+  * batch. The iterations of a packet stop when the relative corrections of all its roots are of the order of the
+  * machine precision, or after maxIterations() iterations. They converge cubically to the simple roots, and
+  * linearly to the multiple roots which are then only computed with an accuracy of \f$ \epsilon^{1/m} \f$ for a
+  * root of multiplicity m. The real roots have imaginary parts of the order of the machine precision.
+  * Large batches are shared among the threads.
+  *
+  * The leading coefficients must not be zero.
+  *
+  * \sa class PolynomialSolver
+  */
+template< typename _Scalar, int _Deg = Dynamic >
+class PolynomialBatchSolver
+{
+  public:
+    typedef _Scalar                                     Scalar;
+    typedef std::complex<Scalar>                        RootType;
+    typedef Matrix<Scalar, _Deg==Dynamic ? Dynamic : _Deg+1, Dynamic> CoefficientsType;
+
+  protected:
+    typedef typename internal::packet_traits<Scalar>::type VectorPacket;
+    enum {
+      Vectorized = internal::packet_traits<Scalar>::Vectorizable && internal::packet_traits<Scalar>::HasDiv
+                && internal::packet_traits<Scalar>::HasLog && internal::packet_traits<Scalar>::HasExp,
+      PacketSize = Vectorized ? int(internal::packet_traits<Scalar>::size) : 1
+    };
+    typedef typename internal::conditional<Vectorized, VectorPacket, Scalar>::type Packet;
+
+  public:
+    PolynomialBatchSolver() : m_maxIterations(100) {}
+
+    /** Sets the maximal number of iterations on each packet of polynomials. The default is 100. */
+    PolynomialBatchSolver& setMaxIterations( Index maxIterations )
+    {
+      m_maxIterations = maxIterations;
+      return *this;
+    }
+
+    /** \returns the maximal number of iterations */
+    Index maxIterations() const { return m_maxIterations; }
+
+    /** Computes in the columns of \a roots the roots of the polynomials given by the columns of \a coeffs.
+      * \a roots is a matrix or a block of complex numbers with direct access, with the number of columns of
+      * \a coeffs and one row less.
+      *
+      * \a coeffs is read in place if its columns are contiguous, as for column major matrices and their blocks,
+      * whatever the number of rows of their type. Otherwise, e.g. for row major matrices, it is copied into a
+      * temporary matrix.
+      */
+    template<typename RootsDerived>
+    void compute( const Ref<const Matrix<Scalar,Dynamic,Dynamic> >& coeffs, const MatrixBase<RootsDerived>& roots ) const
+    {
+      EIGEN_STATIC_ASSERT((internal::is_same<typename RootsDerived::Scalar, RootType>::value),
+                          YOU_MIXED_DIFFERENT_NUMERIC_TYPES__YOU_NEED_TO_USE_THE_CAST_METHOD_OF_MATRIXBASE_TO_CAST_NUMERIC_TYPES_EXPLICITLY)
+      EIGEN_STATIC_ASSERT((int(internal::traits<RootsDerived>::Flags)&DirectAccessBit), THIS_METHOD_IS_ONLY_FOR_EXPRESSIONS_WITH_DIRECT_MEMORY_ACCESS_SUCH_AS_MAP_OR_PLAIN_MATRICES)
+      const Index deg = coeffs.rows()-1, size = coeffs.cols();
+      eigen_assert( deg >= 1 && (_Deg==Dynamic || deg==_Deg) );
+      eigen_assert( roots.rows()==deg && roots.cols()==size );
+#ifndef NDEBUG
+      for( Index j=0; j<size; ++j )
+        eigen_assert( Scalar(0) != coeffs(deg,j) && "PolynomialBatchSolver: the leading coefficients must not be zero" );
+#endif
+      const Scalar* coeffData = coeffs.data();
+      Scalar* rootData = reinterpret_cast<Scalar*>(roots.const_cast_derived().data());
+      const Index coeffStride = coeffs.outerStride(), rootRowStride = 2*roots.rowStride(), rootStride = 2*roots.colStride();
+
+      // chunks of packets shared among the threads
+      const Index chunkSize = 256*PacketSize;
+      const Index chunks = (size+chunkSize-1)/chunkSize;
+#ifdef EIGEN_HAS_OPENMP
+      Eigen::initParallel();
+      Index threads = Eigen::nbThreads();
+      if( threads>1 && chunks>1 )
+      {
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for( Index c=0; c<chunks; ++c )
+          runChunk( coeffData, coeffStride, rootData, rootRowStride, rootStride, deg, c*chunkSize, (std::min)(size,(c+1)*chunkSize) );
+      }
+      else
+#endif
+      {
+        for( Index c=0; c<chunks; ++c )
+          runChunk( coeffData, coeffStride, rootData, rootRowStride, rootStride, deg, c*chunkSize, (std::min)(size,(c+1)*chunkSize) );
+      }
+    }
+
+  protected:
+    void runChunk( const Scalar* coeffs, Index coeffStride, Scalar* roots, Index rootRowStride, Index rootStride, Index deg,
+                   Index begin, Index end ) const
+    {
+      ei_declare_aligned_stack_constructed_variable( Scalar, buffer, 3*deg*PacketSize, 0 );
+      Index j = begin;
+      for( ; j+PacketSize<=end; j+=PacketSize )
+        internal::polynomial_batch_kernel<Scalar,Packet,_Deg>::run( coeffs + j*coeffStride, coeffStride,
+            roots + j*rootStride, rootRowStride, rootStride, deg, m_maxIterations, buffer );
+      for( ; j<end; ++j )
+        internal::polynomial_batch_kernel<Scalar,Scalar,_Deg>::run( coeffs + j*coeffStride, coeffStride,
+            roots + j*rootStride, rootRowStride, rootStride, deg, m_maxIterations, buffer );
+    }
+
+    Index m_maxIterations;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_POLYNOMIAL_BATCH_SOLVER_H
@@ -0,0 +1,166 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_BLOCK_JACOBI_PRECONDITIONER_H
+#define EIGEN_BLOCK_JACOBI_PRECONDITIONER_H
+
+namespace Eigen {
+
+/** \ingroup SparseExtra_Module
+  * \brief A preconditioner based on the diagonal blocks
+  *
+  * This class approximately solves for A.x = b problems by neglecting all the entries of A outside of its diagonal
+  * blocks of size \a _BlockSize x \a _BlockSize. The diagonal blocks are inverted once by factorize(), so that each
+  * application of the preconditioner only costs a small product per block.
+  *
+  * It is the natural preconditioner for the systems whose unknowns come by groups, such as the displacements of the
+  * nodes in elasticity, and is typically combined with a BlockSparseMatrix:
+  * \code
+  * BlockSparseMatrix<double,3,RowMajor> A(A_scalar);
+  * ConjugateGradient<BlockSparseMatrix<double,3,RowMajor>, Lower|Upper, BlockJacobiPreconditioner<double,3> > cg(A);
+  * x = cg.solve(b);
+  * \endcode
+  * It can also be computed from any other sparse matrix, whose size must then be a multiple of the block size.
+  *
+  * \tparam _Scalar the type of the scalar.
+  * \tparam _BlockSize the size of the diagonal blocks. If it is \c Dynamic, it has to be set with setBlockSize().
+  *
+  * A diagonal block which is not invertible is replaced by the identity.
+  *
+  * \sa class DiagonalPreconditioner, class BlockSparseMatrix, class ConjugateGradient
+  */
+template <typename _Scalar, int _BlockSize = Dynamic>
+class BlockJacobiPreconditioner
+{
+    typedef _Scalar Scalar;
+    typedef Matrix<Scalar,Dynamic,1> Vector;
+  public:
+    typedef typename Vector::StorageIndex StorageIndex;
+    // this typedef is only to export the scalar type and compile-time dimensions to solve_retval
+    typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+    enum { BlockSize = _BlockSize };
+    typedef Matrix<Scalar,BlockSize,BlockSize> BlockType;
+
+    BlockJacobiPreconditioner() : m_blockSize(BlockSize), m_isInitialized(false) {}
+
+    template<typename MatType>
+    explicit BlockJacobiPreconditioner(const MatType& mat) : m_blockSize(BlockSize), m_isInitialized(false)
+    {
+      compute(mat);
+    }
+
+    Index rows() const { return m_invBlocks.cols(); }
+    Index cols() const { return m_invBlocks.cols(); }
+
+    /** Sets the size of the diagonal blocks when \a _BlockSize is \c Dynamic */
+    BlockJacobiPreconditioner& setBlockSize(Index blockSize)
+    {
+      eigen_assert((BlockSize==Dynamic || blockSize==BlockSize) && blockSize>0);
+      m_blockSize = blockSize;
+      return *this;
+    }
+
+    /** \returns the size of the diagonal blocks */
+    Index blockSize() const { return m_blockSize; }
+
+    template<typename MatType>
+    BlockJacobiPreconditioner& analyzePattern(const MatType& )
+    {
+      return *this;
+    }
+
+    template<typename MatType>
+    BlockJacobiPreconditioner& factorize(const MatType& mat)
+    {
+      eigen_assert(m_blockSize!=Dynamic && "You must first call setBlockSize()");
+      eigen_assert(mat.cols()%m_blockSize==0 && "The size of the matrix must be a multiple of the block size");
+      // the entry (i,j) of the k-th diagonal block is stored at (i, k*blockSize+j)
+      m_invBlocks.setZero(m_blockSize, mat.cols());
+      for(Index j=0; j<mat.outerSize(); ++j)
+        for(typename MatType::InnerIterator it(mat,j); it; ++it)
+          if(it.row()/m_blockSize == it.col()/m_blockSize)
+            m_invBlocks(it.row()%m_blockSize, it.col()) = it.value();
+      invertBlocks();
+      return *this;
+    }
+
+    template<typename OtherScalar, int OtherBlockSize, int Options, typename OtherIndex>
+    BlockJacobiPreconditioner& factorize(const BlockSparseMatrix<OtherScalar,OtherBlockSize,Options,OtherIndex>& mat)
+    {
+      typedef BlockSparseMatrix<OtherScalar,OtherBlockSize,Options,OtherIndex> BlockMatrixType;
+      if(BlockSize==Dynamic && mat.outerBlocks()>0)
+        m_blockSize = mat.blockOuterSize(0);
+      eigen_assert(mat.cols()==mat.outerBlocks()*m_blockSize && "The blocks of the matrix must all have the same size");
+      m_invBlocks.setZero(m_blockSize, mat.cols());
+      for(Index bj=0; bj<mat.outerBlocks(); ++bj)
+        for(typename BlockMatrixType::BlockInnerIterator it(mat,bj); it; ++it)
+          if(it.index()==bj)
+            diagonalBlock(bj) = it.value();
+      invertBlocks();
+      return *this;
+    }
+
+    template<typename MatType>
+    BlockJacobiPreconditioner& compute(const MatType& mat)
+    {
+      return factorize(mat);
+    }
+
+    /** \internal */
+    template<typename Rhs, typename Dest>
+    void _solve_impl(const Rhs& b, Dest& x) const
+    {
+      Index nbBlocks = m_invBlocks.cols()/m_blockSize;
+      for(Index j=0; j<b.cols(); ++j)
+        for(Index k=0; k<nbBlocks; ++k)
+          x.col(j).segment(k*m_blockSize,m_blockSize) = diagonalBlock(k) * b.col(j).segment(k*m_blockSize,m_blockSize);
+    }
+
+    template<typename Rhs> inline const Solve<BlockJacobiPreconditioner, Rhs>
+    solve(const MatrixBase<Rhs>& b) const
+    {
+      eigen_assert(m_isInitialized && "BlockJacobiPreconditioner is not initialized.");
+      eigen_assert(m_invBlocks.cols()==b.rows()
+                && "BlockJacobiPreconditioner::solve(): invalid number of rows of the right hand side matrix b");
+      return Solve<BlockJacobiPreconditioner, Rhs>(*this, b.derived());
+    }
+
+  protected:
+    typedef Matrix<Scalar,BlockSize,Dynamic> BlockStorage;
+
+    Block<BlockStorage,BlockSize,BlockSize> diagonalBlock(Index k)
+    {
+      return Block<BlockStorage,BlockSize,BlockSize>(m_invBlocks, 0, k*m_blockSize, m_blockSize, m_blockSize);
+    }
+
+    Block<const BlockStorage,BlockSize,BlockSize> diagonalBlock(Index k) const
+    {
+      return Block<const BlockStorage,BlockSize,BlockSize>(m_invBlocks, 0, k*m_blockSize, m_blockSize, m_blockSize);
+    }
+
+    void invertBlocks()
+    {
+      Index nbBlocks = m_invBlocks.cols()/m_blockSize;
+      for(Index k=0; k<nbBlocks; ++k)
+      {
+        FullPivLU<BlockType> lu(diagonalBlock(k));
+        if(lu.isInvertible())
+          diagonalBlock(k) = lu.inverse();
+        else
+          diagonalBlock(k).setIdentity();
+      }
+      m_isInitialized = true;
+    }
+
+    BlockStorage m_invBlocks;
+    Index m_blockSize;
+    bool m_isInitialized;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_BLOCK_JACOBI_PRECONDITIONER_H
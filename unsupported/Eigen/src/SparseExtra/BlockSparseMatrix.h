@@ -61,6 +61,7 @@ struct traits<BlockSparseMatrix<_Scalar,_BlockAtCompileTime,_Options, _Index> >
 {
   typedef _Scalar Scalar;
   typedef _Index Index;
+  typedef _Index StorageIndex;
   typedef Sparse StorageKind; // FIXME Where is it used ??
   typedef MatrixXpr XprKind;
   enum {
@@ -236,50 +237,6 @@ class BlockVectorReturn
     VectorType& m_vec;
 };
 
-// Block version of the sparse dense product
-template<typename Lhs, typename Rhs>
-class BlockSparseTimeDenseProduct;
-
-namespace internal {
-
-template<typename BlockSparseMatrixT, typename VecType>
-struct traits<BlockSparseTimeDenseProduct<BlockSparseMatrixT, VecType> >
-{
-  typedef Dense StorageKind;
-  typedef MatrixXpr XprKind;
-  typedef typename BlockSparseMatrixT::Scalar Scalar;
-  typedef typename BlockSparseMatrixT::Index Index;
-  enum {
-    RowsAtCompileTime = Dynamic,
-    ColsAtCompileTime = Dynamic,
-    MaxRowsAtCompileTime = Dynamic,
-    MaxColsAtCompileTime = Dynamic,
-    Flags = 0,
-    CoeffReadCost = internal::traits<BlockSparseMatrixT>::CoeffReadCost
-  };
-};
-} // end namespace internal
-
-template<typename Lhs, typename Rhs>
-class BlockSparseTimeDenseProduct
-  : public ProductBase<BlockSparseTimeDenseProduct<Lhs,Rhs>, Lhs, Rhs>
-{
-  public:
-    EIGEN_PRODUCT_PUBLIC_INTERFACE(BlockSparseTimeDenseProduct)
-
-    BlockSparseTimeDenseProduct(const Lhs& lhs, const Rhs& rhs) : Base(lhs,rhs)
-    {}
-
-    template<typename Dest> void scaleAndAddTo(Dest& dest, const typename Rhs::Scalar& alpha) const
-    {
-      BlockVectorReturn<Lhs,Dest> tmpDest(m_lhs, dest);
-      internal::sparse_time_dense_product( BlockSparseMatrixView<Lhs>(m_lhs),  BlockVectorView<Lhs, Rhs>(m_lhs, m_rhs), tmpDest, alpha);
-    }
-
-  private:
-    BlockSparseTimeDenseProduct& operator=(const BlockSparseTimeDenseProduct&);
-};
-
 template<typename _Scalar, int _BlockAtCompileTime, int _Options, typename _StorageIndex>
 class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_BlockAtCompileTime, _Options,_StorageIndex> >
 {
@@ -308,7 +265,7 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
     // Default constructor
     BlockSparseMatrix()
     : m_innerBSize(0),m_outerBSize(0),m_innerOffset(0),m_outerOffset(0),
-      m_nonzerosblocks(0),m_values(0),m_blockPtr(0),m_indices(0),
+      m_nonzerosblocks(0),m_nonzeros(0),m_values(0),m_blockPtr(0),m_indices(0),
       m_outerIndex(0),m_blockSize(BlockSize)
     { }
 
@@ -320,7 +277,7 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
     BlockSparseMatrix(Index brow, Index bcol)
       : m_innerBSize(IsColMajor ? brow : bcol),
         m_outerBSize(IsColMajor ? bcol : brow),
-        m_innerOffset(0),m_outerOffset(0),m_nonzerosblocks(0),
+        m_innerOffset(0),m_outerOffset(0),m_nonzerosblocks(0),m_nonzeros(0),
         m_values(0),m_blockPtr(0),m_indices(0),
         m_outerIndex(0),m_blockSize(BlockSize)
     { }
@@ -330,21 +287,32 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
      */
     BlockSparseMatrix(const BlockSparseMatrix& other)
       : m_innerBSize(other.m_innerBSize),m_outerBSize(other.m_outerBSize),
+        m_innerOffset(0),m_outerOffset(0),
         m_nonzerosblocks(other.m_nonzerosblocks),m_nonzeros(other.m_nonzeros),
-        m_blockPtr(0),m_blockSize(other.m_blockSize)
+        m_values(0),m_blockPtr(0),m_indices(0),m_outerIndex(0),
+        m_blockSize(other.m_blockSize)
     {
-      // should we allow copying between variable-size blocks and fixed-size blocks ??
-      eigen_assert(m_blockSize == BlockSize && " CAN NOT COPY BETWEEN FIXED-SIZE AND VARIABLE-SIZE BLOCKS");
-
-      std::copy(other.m_innerOffset, other.m_innerOffset+m_innerBSize+1, m_innerOffset);
-      std::copy(other.m_outerOffset, other.m_outerOffset+m_outerBSize+1, m_outerOffset);
-      std::copy(other.m_values, other.m_values+m_nonzeros, m_values);
-
-      if(m_blockSize != Dynamic)
-        std::copy(other.m_blockPtr, other.m_blockPtr+m_nonzerosblocks, m_blockPtr);
-
-      std::copy(other.m_indices, other.m_indices+m_nonzerosblocks, m_indices);
-      std::copy(other.m_outerIndex, other.m_outerIndex+m_outerBSize, m_outerIndex);
+      if(other.m_innerOffset)
+      {
+        m_innerOffset = new StorageIndex[m_innerBSize+1];
+        m_outerOffset = new StorageIndex[m_outerBSize+1];
+        std::copy(other.m_innerOffset, other.m_innerOffset+m_innerBSize+1, m_innerOffset);
+        std::copy(other.m_outerOffset, other.m_outerOffset+m_outerBSize+1, m_outerOffset);
+      }
+      if(other.m_outerIndex)
+      {
+        m_outerIndex = new StorageIndex[m_outerBSize+1];
+        m_indices = new StorageIndex[m_nonzerosblocks+1];
+        m_values = new Scalar[m_nonzeros];
+        std::copy(other.m_outerIndex, other.m_outerIndex+m_outerBSize+1, m_outerIndex);
+        std::copy(other.m_indices, other.m_indices+m_nonzerosblocks, m_indices);
+        std::copy(other.m_values, other.m_values+m_nonzeros, m_values);
+      }
+      if(other.m_blockPtr)
+      {
+        m_blockPtr = new StorageIndex[m_nonzerosblocks+1];
+        std::copy(other.m_blockPtr, other.m_blockPtr+m_nonzerosblocks+1, m_blockPtr);
+      }
     }
 
     friend void swap(BlockSparseMatrix& first, BlockSparseMatrix& second)
@@ -359,7 +327,7 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
       std::swap(first.m_blockPtr, second.m_blockPtr);
       std::swap(first.m_indices, second.m_indices);
       std::swap(first.m_outerIndex, second.m_outerIndex);
-      std::swap(first.m_BlockSize, second.m_blockSize);
+      std::swap(first.m_blockSize, second.m_blockSize);
     }
 
     BlockSparseMatrix& operator=(BlockSparseMatrix other)
@@ -386,10 +354,14 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
       *
       */
     template<typename MatrixType>
-    inline BlockSparseMatrix(const MatrixType& spmat) : m_blockSize(BlockSize)
+    inline explicit BlockSparseMatrix(const MatrixType& spmat)
+      : m_innerBSize(0),m_outerBSize(0),m_innerOffset(0),m_outerOffset(0),
+        m_nonzerosblocks(0),m_nonzeros(0),m_values(0),m_blockPtr(0),m_indices(0),
+        m_outerIndex(0),m_blockSize(BlockSize)
     {
-      EIGEN_STATIC_ASSERT((m_blockSize != Dynamic), THIS_METHOD_IS_ONLY_FOR_FIXED_SIZE);
-
+      EIGEN_STATIC_ASSERT((BlockSize != Dynamic), THIS_METHOD_IS_ONLY_FOR_FIXED_SIZE);
+      eigen_assert(spmat.rows()%BlockSize==0 && spmat.cols()%BlockSize==0 && "THE SIZES MUST BE MULTIPLES OF THE BLOCK SIZE");
+      resize(spmat.rows()/BlockSize, spmat.cols()/BlockSize);
       *this = spmat;
     }
 
@@ -568,6 +540,8 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
       eigen_assert(m_outerBSize == outerBlocks.size() && "CHECK THE NUMBER OF ROW OR COLUMN BLOCKS");
       m_outerBSize = outerBlocks.size();
       //  starting index of blocks... cumulative sums
+      delete[] m_innerOffset;
+      delete[] m_outerOffset;
       m_innerOffset = new StorageIndex[m_innerBSize+1];
       m_outerOffset = new StorageIndex[m_outerBSize+1];
       m_innerOffset[0] = 0;
@@ -598,7 +572,10 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
       eigen_assert((m_innerBSize != 0 && m_outerBSize != 0) &&
           "TRYING TO RESERVE ZERO-SIZE MATRICES, CALL resize() first");
 
-      //FIXME Should free if already allocated
+      delete[] m_outerIndex;
+      delete[] m_blockPtr;
+      delete[] m_indices;
+      delete[] m_values;
       m_outerIndex = new StorageIndex[m_outerBSize+1];
 
       m_nonzerosblocks = nonzerosblocks;
@@ -849,11 +826,15 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
         eigen_assert("NOT YET SUPPORTED");
     }
 
-    // Block Matrix times vector product
-    template<typename VecType>
-    BlockSparseTimeDenseProduct<BlockSparseMatrix, VecType> operator*(const VecType& lhs) const
+    /** \returns an expression of the product of the block sparse matrix with the dense vector or matrix \a rhs
+      *
+      * The product is computed block per block with kernels specialized for the compile-time block size.
+      * For row-major matrices, the block rows are processed in parallel when OpenMP is enabled.
+      */
+    template<typename Rhs>
+    Product<BlockSparseMatrix,Rhs,AliasFreeProduct> operator*(const MatrixBase<Rhs>& rhs) const
     {
-      return BlockSparseTimeDenseProduct<BlockSparseMatrix, VecType>(*this, lhs);
+      return Product<BlockSparseMatrix,Rhs,AliasFreeProduct>(*this, rhs.derived());
     }
 
     /** \returns the number of nonzero blocks */
@@ -861,8 +842,9 @@ class BlockSparseMatrix : public SparseMatrixBase<BlockSparseMatrix<_Scalar,_Blo
     /** \returns the total number of nonzero elements, including eventual explicit zeros in blocks */
     inline Index nonZeros() const { return m_nonzeros; }
 
-    inline BlockScalarReturnType *valuePtr() {return static_cast<BlockScalarReturnType *>(m_values);}
-//    inline Scalar *valuePtr(){ return m_values; }
+    /** \returns a pointer to the values, the blocks being stored one after the other */
+    inline Scalar *valuePtr() { return m_values; }
+    inline const Scalar *valuePtr() const { return m_values; }
     inline StorageIndex *innerIndexPtr() {return m_indices; }
     inline const StorageIndex *innerIndexPtr() const {return m_indices; }
     inline StorageIndex *outerIndexPtr() {return m_outerIndex; }
@@ -1074,6 +1056,175 @@ class BlockSparseMatrix<_Scalar, _BlockAtCompileTime, _Options, _StorageIndex>::
     Index m_end; // starting inner index of the next block
 
 };
+namespace internal {
+
+template<typename BlockSparseMatrixT, typename Rhs, typename Dest,
+         int BlockSize = BlockSparseMatrixT::BlockSize,
+         bool IsColMajor = BlockSparseMatrixT::IsColMajor>
+struct block_sparse_time_dense_product_impl;
+
+// Row-major matrices: each block row is accumulated in a small dense matrix and written once,
+// such that the block rows are independent.
+// The columns of the right hand side are processed by groups of 4, such that the matrix is read once per group.
+// The rows of each group are first copied contiguously, so that the segments matching a block are contiguous.
+template<typename BlockSparseMatrixT, typename Rhs, typename Dest, int BlockSize>
+struct block_sparse_row_major_product
+{
+  typedef typename BlockSparseMatrixT::Scalar Scalar;
+  typedef block_sparse_time_dense_product_impl<BlockSparseMatrixT,Rhs,Dest,BlockSize,false> Impl;
+  typedef Matrix<Scalar,Dynamic,4,RowMajor> Panel;
+
+  static void run(const BlockSparseMatrixT& lhs, const Rhs& rhs, Dest& dst, const Scalar& alpha)
+  {
+    Index n = lhs.outerBlocks();
+#ifdef EIGEN_HAS_OPENMP
+    Eigen::initParallel();
+    Index threads = Eigen::nbThreads();
+#endif
+    Index j = 0;
+    if(rhs.cols()>=4)
+    {
+      Panel panel(rhs.rows(),4);
+      for(; j+3<rhs.cols(); j+=4)
+      {
+        panel = rhs.middleCols(j,4);
+#ifdef EIGEN_HAS_OPENMP
+        if(threads>1 && lhs.nonZeros() > 20000)
+        {
+          #pragma omp parallel for schedule(static) num_threads(threads)
+          for(Index bi=0; bi<n; ++bi)
+            Impl::processBlockRow4(lhs,panel,dst,alpha,bi,j);
+        }
+        else
+#endif
+        {
+          for(Index bi=0; bi<n; ++bi)
+            Impl::processBlockRow4(lhs,panel,dst,alpha,bi,j);
+        }
+      }
+    }
+    for(; j<rhs.cols(); ++j)
+    {
+#ifdef EIGEN_HAS_OPENMP
+      // same threshold as for the regular sparse matrices
+      if(threads>1 && lhs.nonZeros() > 20000)
+      {
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(Index bi=0; bi<n; ++bi)
+          Impl::processBlockRow(lhs,rhs,dst,alpha,bi,j);
+      }
+      else
+#endif
+      {
+        for(Index bi=0; bi<n; ++bi)
+          Impl::processBlockRow(lhs,rhs,dst,alpha,bi,j);
+      }
+    }
+  }
+};
+
+// Fixed-size blocks: the blocks and the segments of the right hand side are accessed through fixed-size maps
+template<typename BlockSparseMatrixT, typename Rhs, typename Dest, int BlockSize>
+struct block_sparse_time_dense_product_impl<BlockSparseMatrixT,Rhs,Dest,BlockSize,false>
+  : block_sparse_row_major_product<BlockSparseMatrixT,Rhs,Dest,BlockSize>
+{
+  typedef typename BlockSparseMatrixT::Scalar Scalar;
+  typedef typename BlockSparseMatrixT::StorageIndex StorageIndex;
+  typedef Map<const typename BlockSparseMatrixT::BlockScalar> BlockMap;
+  typedef Matrix<Scalar,BlockSize,1> BlockVector;
+  typedef Matrix<Scalar,BlockSize,4,RowMajor> BlockPanel;
+  typedef Matrix<Scalar,Dynamic,4,RowMajor> Panel;
+
+  static void processBlockRow4(const BlockSparseMatrixT& lhs, const Panel& rhs, Dest& dst, const Scalar& alpha, Index bi, Index j)
+  {
+    const Scalar* values = lhs.valuePtr();
+    const StorageIndex* indices = lhs.innerIndexPtr();
+    BlockPanel acc = BlockPanel::Zero();
+    for(Index k=lhs.outerIndexPtr()[bi]; k<lhs.outerIndexPtr()[bi+1]; ++k)
+      acc.noalias() += BlockMap(values+k*BlockSize*BlockSize) * Map<const BlockPanel>(rhs.data()+indices[k]*BlockSize*4);
+    dst.block(bi*BlockSize,j,BlockSize,4) += alpha * acc;
+  }
+
+  static void processBlockRow(const BlockSparseMatrixT& lhs, const Rhs& rhs, Dest& dst, const Scalar& alpha, Index bi, Index j)
+  {
+    const Scalar* values = lhs.valuePtr();
+    const StorageIndex* indices = lhs.innerIndexPtr();
+    const Scalar* x = rhs.data()+j*rhs.outerStride();
+    BlockVector acc = BlockVector::Zero();
+    for(Index k=lhs.outerIndexPtr()[bi]; k<lhs.outerIndexPtr()[bi+1]; ++k)
+      acc.noalias() += BlockMap(values+k*BlockSize*BlockSize) * Map<const BlockVector>(x+indices[k]*BlockSize);
+    dst.col(j).segment(bi*BlockSize,BlockSize) += alpha * acc;
+  }
+};
+
+// Blocks whose size is only known at runtime
+template<typename BlockSparseMatrixT, typename Rhs, typename Dest>
+struct block_sparse_time_dense_product_impl<BlockSparseMatrixT,Rhs,Dest,Dynamic,false>
+  : block_sparse_row_major_product<BlockSparseMatrixT,Rhs,Dest,Dynamic>
+{
+  typedef typename BlockSparseMatrixT::Scalar Scalar;
+  typedef typename BlockSparseMatrixT::BlockInnerIterator BlockInnerIterator;
+  typedef Matrix<Scalar,Dynamic,4,RowMajor> Panel;
+
+  static void processBlockRow4(const BlockSparseMatrixT& lhs, const Panel& rhs, Dest& dst, const Scalar& alpha, Index bi, Index j)
+  {
+    Matrix<Scalar,Dynamic,4> acc = Matrix<Scalar,Dynamic,4>::Zero(lhs.blockOuterSize(bi),4);
+    for(BlockInnerIterator it(lhs,bi); it; ++it)
+      acc.noalias() += it.value() * rhs.middleRows(lhs.blockInnerIndex(it.index()), it.cols());
+    dst.block(lhs.blockOuterIndex(bi),j,acc.rows(),4) += alpha * acc;
+  }
+
+  static void processBlockRow(const BlockSparseMatrixT& lhs, const Rhs& rhs, Dest& dst, const Scalar& alpha, Index bi, Index j)
+  {
+    Matrix<Scalar,Dynamic,1> acc = Matrix<Scalar,Dynamic,1>::Zero(lhs.blockOuterSize(bi));
+    for(BlockInnerIterator it(lhs,bi); it; ++it)
+      acc.noalias() += it.value() * rhs.col(j).segment(lhs.blockInnerIndex(it.index()), it.cols());
+    dst.col(j).segment(lhs.blockOuterIndex(bi),acc.size()) += alpha * acc;
+  }
+};
+
+// Column-major matrices: the blocks of a block column are scattered into the result.
+template<typename BlockSparseMatrixT, typename Rhs, typename Dest, int BlockSize>
+struct block_sparse_time_dense_product_impl<BlockSparseMatrixT,Rhs,Dest,BlockSize,true>
+{
+  typedef typename BlockSparseMatrixT::Scalar Scalar;
+  typedef typename BlockSparseMatrixT::BlockInnerIterator BlockInnerIterator;
+  typedef Matrix<Scalar,BlockSize,1> BlockVector;
+
+  static void run(const BlockSparseMatrixT& lhs, const Rhs& rhs, Dest& dst, const Scalar& alpha)
+  {
+    for(Index j=0; j<rhs.cols(); ++j)
+    {
+      for(Index bj=0; bj<lhs.outerBlocks(); ++bj)
+      {
+        BlockVector rhs_j(alpha * rhs.col(j).segment(lhs.blockOuterIndex(bj), lhs.blockOuterSize(bj)));
+        for(BlockInnerIterator it(lhs,bj); it; ++it)
+          dst.col(j).segment(lhs.blockInnerIndex(it.index()),it.rows()).noalias() += it.value() * rhs_j;
+      }
+    }
+  }
+};
+
+template<typename _Scalar, int _BlockAtCompileTime, int _Options, typename _StorageIndex, typename Rhs, int ProductType>
+struct generic_product_impl<BlockSparseMatrix<_Scalar,_BlockAtCompileTime,_Options,_StorageIndex>, Rhs, SparseShape, DenseShape, ProductType>
+ : generic_product_impl_base<BlockSparseMatrix<_Scalar,_BlockAtCompileTime,_Options,_StorageIndex>,Rhs,
+                             generic_product_impl<BlockSparseMatrix<_Scalar,_BlockAtCompileTime,_Options,_StorageIndex>,Rhs,SparseShape,DenseShape,ProductType> >
+{
+  typedef BlockSparseMatrix<_Scalar,_BlockAtCompileTime,_Options,_StorageIndex> Lhs;
+  typedef typename Product<Lhs,Rhs>::Scalar Scalar;
+
+  template<typename Dest>
+  static void scaleAndAddTo(Dest& dst, const Lhs& lhs, const Rhs& rhs, const Scalar& alpha)
+  {
+    // the kernels read the segments of the right hand side through fixed-size maps
+    typedef Ref<const Matrix<Scalar,Dynamic,Dynamic> > RhsRef;
+    RhsRef actualRhs(rhs);
+    block_sparse_time_dense_product_impl<Lhs,RhsRef,Dest>::run(lhs, actualRhs, dst, alpha);
+  }
+};
+
+} // end namespace internal
+
 } // end namespace Eigen
 
 #endif // EIGEN_SPARSEBLOCKMATRIX_H
@@ -0,0 +1,361 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_SELL_C_SIGMA_MATRIX_H
+#define EIGEN_SELL_C_SIGMA_MATRIX_H
+
+namespace Eigen {
+
+template<typename _Scalar, int _ChunkSize = 8, typename _StorageIndex = int> class SellCSigmaMatrix;
+
+namespace internal {
+template<typename _Scalar, int _ChunkSize, typename _StorageIndex>
+struct traits<SellCSigmaMatrix<_Scalar,_ChunkSize,_StorageIndex> >
+ : traits<SparseMatrix<_Scalar,RowMajor,_StorageIndex> >
+{};
+}
+
+/** \ingroup SparseExtra_Module
+  * \class SellCSigmaMatrix
+  *
+  * \brief A read-only sparse matrix stored in the sliced ELLPACK format (SELL-C-\f$ \sigma \f$)
+  *
+  * The rows of the matrix are grouped into chunks of \a _ChunkSize consecutive rows. Within a chunk, all the rows are
+  * padded with zeros to the length of the longest one, and the entries are stored column after column, such that the
+  * k-th entries of all the rows of a chunk are contiguous in memory. The matrix-vector product can thus process the
+  * rows of a chunk together using SIMD instructions, which is not possible with the short and irregular rows of the
+  * compressed formats.
+  *
+  * To limit the amount of padding, the rows are sorted by decreasing number of nonzeros within windows of
+  * \f$ \sigma \f$ consecutive rows before being grouped into chunks. A larger window reduces the padding,
+  * but the entries of the result vector are written in a more scattered order.
+  *
+  * This class only supports the products with a dense vector or matrix, and is built from any sparse matrix:
+  * \code
+  * SparseMatrix<double> A;
+  * // fill A
+  * SellCSigmaMatrix<double> B(A);
+  * VectorXd y = B * x;
+  * \endcode
+  * It can be used as the matrix type of the iterative solvers, with the DiagonalPreconditioner or the
+  * IdentityPreconditioner. With ConjugateGradient, the full matrix has to be stored and \c Lower|Upper passed as the
+  * \c _UpLo template parameter:
+  * \code
+  * ConjugateGradient<SellCSigmaMatrix<double>, Lower|Upper> cg(B);
+  * x = cg.solve(b);
+  * \endcode
+  *
+  * \tparam _Scalar the scalar type, i.e. the type of the coefficients
+  * \tparam _ChunkSize the number of rows per chunk. The products are vectorized when it is a multiple of the packet
+  *                    size of \a _Scalar. Default is 8.
+  * \tparam _StorageIndex the type of the indices. It has to be a \b signed type (e.g., short, int, std::ptrdiff_t).
+  *                       Default is \c int.
+  *
+  * \sa class SparseMatrix
+  */
+template<typename _Scalar, int _ChunkSize, typename _StorageIndex>
+class SellCSigmaMatrix : public EigenBase<SellCSigmaMatrix<_Scalar,_ChunkSize,_StorageIndex> >
+{
+  public:
+    typedef _Scalar Scalar;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    typedef _StorageIndex StorageIndex;
+
+    enum {
+      ChunkSize = _ChunkSize,
+      RowsAtCompileTime = Dynamic,
+      ColsAtCompileTime = Dynamic,
+      MaxColsAtCompileTime = Dynamic,
+      IsRowMajor = true
+    };
+
+    class InnerIterator;
+
+    /** Default constructor yielding an empty \c 0 \c x \c 0 matrix */
+    SellCSigmaMatrix()
+      : m_rows(0), m_cols(0), m_nonZeros(0), m_sigma(DefaultSigma)
+    {}
+
+    /** Constructs a SELL-C-\f$ \sigma \f$ copy of the sparse matrix \a other, sorting the rows within windows of
+      * \a sigma rows. */
+    template<typename OtherDerived>
+    explicit SellCSigmaMatrix(const SparseMatrixBase<OtherDerived>& other, Index sigma = DefaultSigma)
+      : m_rows(0), m_cols(0), m_nonZeros(0), m_sigma(sigma)
+    {
+      *this = other.derived();
+    }
+
+    /** Copies the sparse matrix \a other using the current sorting scope. \sa setSortingScope() */
+    template<typename OtherDerived>
+    SellCSigmaMatrix& operator=(const SparseMatrixBase<OtherDerived>& other);
+
+    inline Index rows() const { return m_rows; }
+    inline Index cols() const { return m_cols; }
+    /** \returns the number of rows, for the compatibility with the sparse matrices */
+    inline Index outerSize() const { return m_rows; }
+    /** \returns the number of nonzeros, not including the padding */
+    inline Index nonZeros() const { return m_nonZeros; }
+    /** \returns the number of stored coefficients, including the padding */
+    inline Index storedSize() const { return m_values.size(); }
+    /** \returns the number of chunks */
+    inline Index chunks() const { return m_chunkPtr.size()-1; }
+
+    /** \returns the size of the windows in which the rows are sorted */
+    inline Index sortingScope() const { return m_sigma; }
+    /** Sets the size of the windows in which the rows are sorted by the next conversion. A value of 1 disables the
+      * sorting, and a value larger than the number of rows sorts the whole matrix. */
+    void setSortingScope(Index sigma)
+    {
+      eigen_assert(sigma>=1);
+      m_sigma = sigma;
+    }
+
+    /** \returns the original index of the row stored at the position \a slot */
+    inline StorageIndex rowOfSlot(Index slot) const { return m_perm.coeff(slot); }
+
+    /** \internal */
+    inline const Scalar* valuePtr() const { return m_values.data(); }
+    /** \internal */
+    inline const StorageIndex* innerIndexPtr() const { return m_indices.data(); }
+    /** \internal */
+    inline const StorageIndex* chunkPtr() const { return m_chunkPtr.data(); }
+
+    template<typename Rhs>
+    Product<SellCSigmaMatrix,Rhs,AliasFreeProduct> operator*(const MatrixBase<Rhs>& x) const
+    {
+      return Product<SellCSigmaMatrix,Rhs,AliasFreeProduct>(*this, x.derived());
+    }
+
+  protected:
+    enum { DefaultSigma = 32*ChunkSize };
+
+    Index m_rows;
+    Index m_cols;
+    Index m_nonZeros;
+    Index m_sigma;
+    Matrix<Scalar,Dynamic,1> m_values;         // the padded chunks, each of them stored column after column
+    Matrix<StorageIndex,Dynamic,1> m_indices;  // the column index of each entry of m_values
+    Matrix<StorageIndex,Dynamic,1> m_chunkPtr; // the offset of each chunk in m_values
+    Matrix<StorageIndex,Dynamic,1> m_perm;     // the original row stored in each slot
+    Matrix<StorageIndex,Dynamic,1> m_slot;     // the slot of each original row
+    Matrix<StorageIndex,Dynamic,1> m_rowNnz;   // the number of nonzeros of each original row
+};
+
+template<typename Scalar, int _ChunkSize, typename _StorageIndex>
+template<typename OtherDerived>
+SellCSigmaMatrix<Scalar,_ChunkSize,_StorageIndex>&
+SellCSigmaMatrix<Scalar,_ChunkSize,_StorageIndex>::operator=(const SparseMatrixBase<OtherDerived>& other)
+{
+  const SparseMatrix<Scalar,RowMajor,StorageIndex> mat(other.derived());
+  m_rows = mat.rows();
+  m_cols = mat.cols();
+  m_nonZeros = mat.nonZeros();
+
+  m_rowNnz.resize(m_rows);
+  for(Index i=0; i<m_rows; ++i)
+  {
+    Index nnz = 0;
+    for(typename SparseMatrix<Scalar,RowMajor,StorageIndex>::InnerIterator it(mat,i); it; ++it)
+      ++nnz;
+    m_rowNnz(i) = internal::convert_index<StorageIndex>(nnz);
+  }
+
+  // sort the rows by decreasing number of nonzeros within each window of m_sigma rows
+  m_perm.resize(m_rows);
+  for(Index i=0; i<m_rows; ++i)
+    m_perm(i) = internal::convert_index<StorageIndex>(i);
+  for(Index start=0; start<m_rows && m_sigma>1; start+=m_sigma)
+  {
+    Index end = (std::min)(start+m_sigma, m_rows);
+    std::vector<std::pair<StorageIndex,StorageIndex> > keys(end-start);
+    for(Index i=start; i<end; ++i)
+      keys[i-start] = std::make_pair(StorageIndex(-m_rowNnz(i)), StorageIndex(i));
+    std::sort(keys.begin(), keys.end());
+    for(Index i=start; i<end; ++i)
+      m_perm(i) = keys[i-start].second;
+  }
+  m_slot.resize(m_rows);
+  for(Index s=0; s<m_rows; ++s)
+    m_slot(m_perm(s)) = internal::convert_index<StorageIndex>(s);
+
+  // the width of each chunk is the length of its longest row
+  Index nbChunks = (m_rows+ChunkSize-1)/ChunkSize;
+  m_chunkPtr.resize(nbChunks+1);
+  m_chunkPtr(0) = 0;
+  for(Index c=0; c<nbChunks; ++c)
+  {
+    Index width = 0;
+    for(Index s=c*ChunkSize; s<(std::min)((c+1)*ChunkSize, m_rows); ++s)
+      width = (std::max)(width, Index(m_rowNnz(m_perm(s))));
+    m_chunkPtr(c+1) = internal::convert_index<StorageIndex>(m_chunkPtr(c) + width*ChunkSize);
+  }
+
+  // the padding entries are zeros pointing to the first column, so that the products can process them blindly
+  m_values.setZero(m_chunkPtr(nbChunks));
+  m_indices.setZero(m_chunkPtr(nbChunks));
+  for(Index s=0; s<m_rows; ++s)
+  {
+    Index p = m_chunkPtr(s/ChunkSize) + s%ChunkSize;
+    for(typename SparseMatrix<Scalar,RowMajor,StorageIndex>::InnerIterator it(mat,m_perm(s)); it; ++it, p+=ChunkSize)
+    {
+      m_values(p) = it.value();
+      m_indices(p) = internal::convert_index<StorageIndex>(it.index());
+    }
+  }
+  return *this;
+}
+
+/** \class SellCSigmaMatrix::InnerIterator
+  * \brief Iterates over the nonzeros of a row of a SellCSigmaMatrix, skipping the padding
+  */
+template<typename Scalar, int _ChunkSize, typename _StorageIndex>
+class SellCSigmaMatrix<Scalar,_ChunkSize,_StorageIndex>::InnerIterator
+{
+  public:
+    InnerIterator(const SellCSigmaMatrix& mat, Index outer)
+      : m_values(mat.m_values.data()), m_indices(mat.m_indices.data()), m_outer(outer), m_id(0), m_end(0)
+    {
+      Index slot = mat.m_slot(outer);
+      m_id = mat.m_chunkPtr(slot/ChunkSize) + slot%ChunkSize;
+      m_end = m_id + Index(mat.m_rowNnz(outer))*ChunkSize;
+    }
+
+    inline InnerIterator& operator++() { m_id += ChunkSize; return *this; }
+
+    inline const Scalar& value() const { return m_values[m_id]; }
+    inline StorageIndex index() const { return m_indices[m_id]; }
+    inline Index outer() const { return m_outer; }
+    inline Index row() const { return m_outer; }
+    inline Index col() const { return index(); }
+
+    inline operator bool() const { return (m_id < m_end); }
+
+  protected:
+    const Scalar* m_values;
+    const StorageIndex* m_indices;
+    const Index m_outer;
+    Index m_id;
+    Index m_end;
+};
+
+namespace internal {
+
+// computes the products of the ChunkSize rows of a chunk with Cols consecutive columns of x,
+// the result of the column j being stored in res[j*ChunkSize ... (j+1)*ChunkSize-1]
+template<typename Scalar, typename StorageIndex, int ChunkSize, int Cols,
+         bool Vectorized = packet_traits<Scalar>::Vectorizable && (ChunkSize%packet_traits<Scalar>::size)==0>
+struct sell_chunk_product
+{
+  static void run(const Scalar* values, const StorageIndex* indices, Index width, const Scalar* x, Index xStride, Scalar* res)
+  {
+    for(Index i=0; i<ChunkSize*Cols; ++i)
+      res[i] = Scalar(0);
+    for(Index k=0; k<width; ++k, values+=ChunkSize, indices+=ChunkSize)
+      for(Index j=0; j<Cols; ++j)
+        for(Index i=0; i<ChunkSize; ++i)
+          res[j*ChunkSize+i] += values[i] * x[j*xStride+indices[i]];
+  }
+};
+
+template<typename Scalar, typename StorageIndex, int ChunkSize, int Cols>
+struct sell_chunk_product<Scalar,StorageIndex,ChunkSize,Cols,true>
+{
+  typedef typename packet_traits<Scalar>::type Packet;
+  enum {
+    PacketSize = packet_traits<Scalar>::size,
+    NbPackets = ChunkSize/PacketSize
+  };
+
+  static void run(const Scalar* values, const StorageIndex* indices, Index width, const Scalar* x, Index xStride, Scalar* res)
+  {
+    // The entries of x are gathered into an aligned buffer, and then multiplied by the contiguous values of the chunk
+    // with one packet multiply-add per group of PacketSize rows.
+    EIGEN_ALIGN_DEFAULT Scalar gathered[ChunkSize*Cols];
+    Packet acc[NbPackets*Cols];
+    for(Index p=0; p<NbPackets*Cols; ++p)
+      acc[p] = pset1<Packet>(Scalar(0));
+    for(Index k=0; k<width; ++k, values+=ChunkSize, indices+=ChunkSize)
+    {
+      for(Index j=0; j<Cols; ++j)
+        for(Index i=0; i<ChunkSize; ++i)
+          gathered[j*ChunkSize+i] = x[j*xStride+indices[i]];
+      for(Index p=0; p<NbPackets; ++p)
+      {
+        Packet v = pload<Packet>(values+p*PacketSize);
+        for(Index j=0; j<Cols; ++j)
+          acc[j*NbPackets+p] = pmadd(v, pload<Packet>(gathered+j*ChunkSize+p*PacketSize), acc[j*NbPackets+p]);
+      }
+    }
+    for(Index p=0; p<NbPackets*Cols; ++p)
+      pstoreu(res+p*PacketSize, acc[p]);
+  }
+};
+
+template<typename Scalar, int ChunkSize, typename StorageIndex, typename Rhs, int ProductType>
+struct generic_product_impl<SellCSigmaMatrix<Scalar,ChunkSize,StorageIndex>, Rhs, SparseShape, DenseShape, ProductType>
+ : generic_product_impl_base<SellCSigmaMatrix<Scalar,ChunkSize,StorageIndex>,Rhs,
+                             generic_product_impl<SellCSigmaMatrix<Scalar,ChunkSize,StorageIndex>,Rhs,SparseShape,DenseShape,ProductType> >
+{
+  typedef SellCSigmaMatrix<Scalar,ChunkSize,StorageIndex> Lhs;
+  typedef Ref<const Matrix<Scalar,Dynamic,Dynamic> > RhsRef;
+
+  template<typename Dest>
+  static void scaleAndAddTo(Dest& dst, const Lhs& lhs, const Rhs& rhs, const Scalar& alpha)
+  {
+    // the kernel needs the columns of the right hand side with a unit inner stride
+    RhsRef actualRhs(rhs);
+    Index n = lhs.chunks();
+#ifdef EIGEN_HAS_OPENMP
+    Eigen::initParallel();
+    Index threads = Eigen::nbThreads();
+    if(threads>1 && lhs.storedSize() > 20000)
+    {
+      #pragma omp parallel for schedule(static) num_threads(threads)
+      for(Index c=0; c<n; ++c)
+        processChunk(lhs,actualRhs,dst,alpha,c);
+    }
+    else
+#endif
+    {
+      for(Index c=0; c<n; ++c)
+        processChunk(lhs,actualRhs,dst,alpha,c);
+    }
+  }
+
+  // all the columns of the right hand side are processed while the chunk is in cache, by groups of 4 columns
+  // such that the indices are read once per group
+  template<typename Dest>
+  static void processChunk(const Lhs& lhs, const RhsRef& rhs, Dest& dst, const Scalar& alpha, Index c)
+  {
+    Index start = lhs.chunkPtr()[c];
+    Index width = (lhs.chunkPtr()[c+1]-start)/ChunkSize;
+    Index size = (std::min)(Index(ChunkSize), lhs.rows()-c*ChunkSize);
+    const Scalar* values = lhs.valuePtr()+start;
+    const StorageIndex* indices = lhs.innerIndexPtr()+start;
+    Scalar res[4*ChunkSize];
+    Index j = 0;
+    for(; j+3<rhs.cols(); j+=4)
+    {
+      sell_chunk_product<Scalar,StorageIndex,ChunkSize,4>::run(values, indices, width, rhs.col(j).data(), rhs.outerStride(), res);
+      for(Index k=0; k<4; ++k)
+        for(Index i=0; i<size; ++i)
+          dst.coeffRef(lhs.rowOfSlot(c*ChunkSize+i),j+k) += alpha * res[k*ChunkSize+i];
+    }
+    for(; j<rhs.cols(); ++j)
+    {
+      sell_chunk_product<Scalar,StorageIndex,ChunkSize,1>::run(values, indices, width, rhs.col(j).data(), rhs.outerStride(), res);
+      for(Index i=0; i<size; ++i)
+        dst.coeffRef(lhs.rowOfSlot(c*ChunkSize+i),j) += alpha * res[i];
+    }
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_SELL_C_SIGMA_MATRIX_H
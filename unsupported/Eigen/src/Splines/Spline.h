@@ -111,6 +111,23 @@ namespace Eigen
      **/
     PointType operator()(Scalar u) const;
 
+    /**
+     * \brief Returns the spline values at many sites.
+     *
+     * The function stores \f$C(u_i)\f$ in the i-th column of \a values, which is
+     * resized to Dimension x u.size() when needed.
+     *
+     * Consecutive sites falling into the same knot span share their knots and control
+     * points and are evaluated together with SIMD instructions, without any heap allocation.
+     * Sorting the sites therefore makes the evaluation much faster. Large sets of sites
+     * are shared among the threads.
+     *
+     * \param u The sites \f$u_i \in [0;1]\f$ at which the spline is evaluated.
+     * \param values The array receiving the spline values.
+     **/
+    template <typename ParameterArrayType, typename ValueArrayType>
+    void evaluate(const DenseBase<ParameterArrayType>& u, const DenseBase<ValueArrayType>& values) const;
+
     /**
      * \brief Evaluation of spline derivatives of up-to given order.
      *
@@ -221,6 +238,9 @@ namespace Eigen
     KnotVectorType m_knots; /*!< Knot vector. */
     ControlPointVectorType  m_ctrls; /*!< Control points. */
 
+    template <typename ParameterArrayType, typename ValueArrayType>
+    void evaluateRange(const ParameterArrayType& u, ValueArrayType& values, DenseIndex begin, DenseIndex end) const;
+
     template <typename DerivativeType>
     static void BasisFunctionDerivativesImpl(
       const typename Spline<_Scalar, _Dim, _Degree>::Scalar u,
@@ -307,6 +327,125 @@ namespace Eigen
     return (ctrl_weights * ctrl_pts).rowwise().sum();
   }
 
+  namespace internal {
+    /**
+     * \internal
+     * Evaluates a spline at a packet of sites falling into the knot span \a span,
+     * with the algorithm of Spline::BasisFunctions. The work buffer holds 3*(p+1)
+     * packets and the value of the dimension d is stored at \a res + d*PacketSize.
+     **/
+    template <typename Packet, typename Scalar, typename ControlPointVectorType>
+    void spline_evaluate_packet(const Scalar* u, DenseIndex span, DenseIndex p, const Scalar* U,
+                                const ControlPointVectorType& ctrls, Scalar* work, Scalar* res)
+    {
+      enum { PacketSize = unpacket_traits<Packet>::size };
+      Scalar* N = work;
+      Scalar* left = work + (p+1)*PacketSize;
+      Scalar* right = work + 2*(p+1)*PacketSize;
+
+      const Packet pu = ploadu<Packet>(u);
+      pstore(N, pset1<Packet>(Scalar(1)));
+      for (DenseIndex j=1; j<=p; ++j)
+      {
+        pstore(left + j*PacketSize, psub(pu, pset1<Packet>(U[span+1-j])));
+        pstore(right + j*PacketSize, psub(pset1<Packet>(U[span+j]), pu));
+        Packet saved = pset1<Packet>(Scalar(0));
+        for (DenseIndex r=0; r<j; ++r)
+        {
+          const Packet rr = pload<Packet>(right + (r+1)*PacketSize);
+          const Packet ll = pload<Packet>(left + (j-r)*PacketSize);
+          const Packet tmp = pdiv(pload<Packet>(N + r*PacketSize), padd(rr, ll));
+          pstore(N + r*PacketSize, pmadd(rr, tmp, saved));
+          saved = pmul(ll, tmp);
+        }
+        pstore(N + j*PacketSize, saved);
+      }
+
+      for (DenseIndex d=0; d<ctrls.rows(); ++d)
+      {
+        Packet acc = pset1<Packet>(Scalar(0));
+        for (DenseIndex r=0; r<=p; ++r)
+          acc = pmadd(pload<Packet>(N + r*PacketSize), pset1<Packet>(ctrls.coeff(d, span-p+r)), acc);
+        pstore(res + d*PacketSize, acc);
+      }
+    }
+  }
+
+  template <typename _Scalar, int _Dim, int _Degree>
+  template <typename ParameterArrayType, typename ValueArrayType>
+  void Spline<_Scalar, _Dim, _Degree>::evaluate(const DenseBase<ParameterArrayType>& u, const DenseBase<ValueArrayType>& values) const
+  {
+    ValueArrayType& res = values.const_cast_derived();
+    const DenseIndex n = u.size();
+    res.resize(Dimension, n);
+
+    // chunks of sites shared among the threads
+    const DenseIndex chunkSize = 4096;
+    const DenseIndex chunks = (n+chunkSize-1)/chunkSize;
+#ifdef EIGEN_HAS_OPENMP
+    Eigen::initParallel();
+    Index threads = Eigen::nbThreads();
+    if (threads>1 && chunks>1)
+    {
+      #pragma omp parallel for schedule(static) num_threads(threads)
+      for (DenseIndex c=0; c<chunks; ++c)
+        evaluateRange(u.derived(), res, c*chunkSize, (std::min)(n, (c+1)*chunkSize));
+    }
+    else
+#endif
+    {
+      for (DenseIndex c=0; c<chunks; ++c)
+        evaluateRange(u.derived(), res, c*chunkSize, (std::min)(n, (c+1)*chunkSize));
+    }
+  }
+
+  template <typename _Scalar, int _Dim, int _Degree>
+  template <typename ParameterArrayType, typename ValueArrayType>
+  void Spline<_Scalar, _Dim, _Degree>::evaluateRange(const ParameterArrayType& u, ValueArrayType& values,
+                                                     DenseIndex begin, DenseIndex end) const
+  {
+    typedef typename internal::packet_traits<Scalar>::type VectorPacket;
+    enum {
+      Vectorized = internal::packet_traits<Scalar>::Vectorizable && internal::packet_traits<Scalar>::HasDiv,
+      PacketSize = Vectorized ? int(internal::packet_traits<Scalar>::size) : 1
+    };
+    typedef typename internal::conditional<Vectorized, VectorPacket, Scalar>::type Packet;
+
+    const DenseIndex p = degree();
+    const DenseIndex lastSpan = m_knots.size()-p-2;
+    const Scalar* U = m_knots.data();
+    ei_declare_aligned_stack_constructed_variable(Scalar, work, (3*(p+1)+Dimension+1)*PacketSize, 0);
+    Scalar* sites = work + 3*(p+1)*PacketSize;
+    Scalar* res = sites + PacketSize;
+
+    DenseIndex i = begin;
+    while (i<end)
+    {
+      // the run of consecutive sites falling into the knot span of u(i)
+      const DenseIndex span = Spline::Span(u.coeff(i), p, m_knots);
+      DenseIndex runEnd = i+1;
+      while (runEnd<end && (span==p || u.coeff(runEnd)>=U[span]) && (span==lastSpan || u.coeff(runEnd)<U[span+1]))
+        ++runEnd;
+
+      for (; i+PacketSize<=runEnd; i+=PacketSize)
+      {
+        for (DenseIndex k=0; k<PacketSize; ++k)
+          sites[k] = u.coeff(i+k);
+        internal::spline_evaluate_packet<Packet>(sites, span, p, U, m_ctrls, work, res);
+        for (DenseIndex d=0; d<Dimension; ++d)
+          for (DenseIndex k=0; k<PacketSize; ++k)
+            values.coeffRef(d, i+k) = res[d*PacketSize+k];
+      }
+      for (; i<runEnd; ++i)
+      {
+        sites[0] = u.coeff(i);
+        internal::spline_evaluate_packet<Scalar>(sites, span, p, U, m_ctrls, work, res);
+        for (DenseIndex d=0; d<Dimension; ++d)
+          values.coeffRef(d, i) = res[d];
+      }
+    }
+  }
+
   /* --------------------------------------------------------------------------------------------- */
 
   template <typename SplineType, typename DerivativeType>
@@ -22,6 +22,77 @@
 
 namespace Eigen
 {
+  namespace internal
+  {
+    /**
+     * \internal
+     * \brief A square banded linear system solved by Gaussian elimination with partial pivoting.
+     *
+     * The matrix has kl sub-diagonals and ku super-diagonals, and is stored by columns in
+     * the LAPACK band layout with kl additional super-diagonals receiving the fill-in of the
+     * row interchanges. The factorization and the solve cost \f$O(n\,kl\,(kl+ku))\f$
+     * operations, instead of \f$O(n^3)\f$ for a dense solver.
+     **/
+    template <typename Scalar>
+    class spline_band_system
+    {
+    public:
+      spline_band_system(DenseIndex n, DenseIndex kl, DenseIndex ku)
+        : m_kl(kl), m_ku(kl+ku), m_band(Matrix<Scalar,Dynamic,Dynamic>::Zero(2*kl+ku+1, n))
+      {}
+
+      Scalar& operator()(DenseIndex i, DenseIndex j)
+      {
+        eigen_assert(j-i<=m_ku && i-j<=m_kl);
+        return m_band(m_ku+i-j, j);
+      }
+
+      /** Overwrites \a rhs by the solution of the system, and returns false if the matrix is singular. */
+      template <typename RhsType>
+      bool solve(RhsType& rhs)
+      {
+        using std::abs;
+        const DenseIndex n = m_band.cols();
+        for (DenseIndex k=0; k<n; ++k)
+        {
+          const DenseIndex last = (std::min)(n-1, k+m_kl), lastCol = (std::min)(n-1, k+m_ku);
+          DenseIndex pivot = k;
+          for (DenseIndex r=k+1; r<=last; ++r)
+            if (abs((*this)(r,k)) > abs((*this)(pivot,k)))
+              pivot = r;
+          if ((*this)(pivot,k) == Scalar(0))
+            return false;
+          if (pivot != k)
+          {
+            for (DenseIndex j=k; j<=lastCol; ++j)
+              std::swap((*this)(k,j), (*this)(pivot,j));
+            rhs.row(k).swap(rhs.row(pivot));
+          }
+          for (DenseIndex r=k+1; r<=last; ++r)
+          {
+            const Scalar l = (*this)(r,k) / (*this)(k,k);
+            if (l == Scalar(0)) continue;
+            for (DenseIndex j=k+1; j<=lastCol; ++j)
+              (*this)(r,j) -= l * (*this)(k,j);
+            rhs.row(r) -= l * rhs.row(k);
+          }
+        }
+        for (DenseIndex k=n-1; k>=0; --k)
+        {
+          const DenseIndex lastCol = (std::min)(n-1, k+m_ku);
+          for (DenseIndex j=k+1; j<=lastCol; ++j)
+            rhs.row(k) -= (*this)(k,j) * rhs.row(j);
+          rhs.row(k) /= (*this)(k,k);
+        }
+        return true;
+      }
+
+    private:
+      DenseIndex m_kl, m_ku;
+      Matrix<Scalar,Dynamic,Dynamic> m_band;
+    };
+  }
+
   /**
    * \brief Computes knot averages.
    * \ingroup Splines_Module
@@ -298,21 +369,32 @@ namespace Eigen
     KnotAveraging(knot_parameters, degree, knots);
 
     DenseIndex n = pts.cols();
-    MatrixType A = MatrixType::Zero(n,n);
+
+    // The collocation matrix is banded: the row i is non-zero from the column span(i)-degree to span(i).
+    Matrix<DenseIndex,Dynamic,1> spans(n);
+    DenseIndex kl = 0, ku = 0;
     for (DenseIndex i=1; i<n-1; ++i)
     {
-      const DenseIndex span = SplineType::Span(knot_parameters[i], degree, knots);
+      spans(i) = SplineType::Span(knot_parameters[i], degree, knots);
+      kl = (std::max)(kl, i-spans(i)+degree);
+      ku = (std::max)(ku, spans(i)-i);
+    }
 
-      // The segment call should somehow be told the spline order at compile time.
-      A.row(i).segment(span-degree, degree+1) = SplineType::BasisFunctions(knot_parameters[i], degree, knots);
+    internal::spline_band_system<Scalar> A(n, kl, ku);
+    for (DenseIndex i=1; i<n-1; ++i)
+    {
+      const typename SplineType::BasisVectorType basis = SplineType::BasisFunctions(knot_parameters[i], degree, knots);
+      for (DenseIndex j=0; j<=degree; ++j)
+        A(i, spans(i)-degree+j) = basis(j);
     }
     A(0,0) = 1.0;
     A(n-1,n-1) = 1.0;
 
-    HouseholderQR<MatrixType> qr(A);
-
-    // Here, we are creating a temporary due to an Eigen issue.
-    ControlPointVectorType ctrls = qr.solve(MatrixType(pts.transpose())).transpose();
+    MatrixType b = pts.transpose();
+    const bool solved = A.solve(b);
+    eigen_assert(solved && "SplineFitting::Interpolate: the interpolation system is singular");
+    EIGEN_ONLY_USED_FOR_DEBUG(solved);
+    ControlPointVectorType ctrls = b.transpose();
 
     return SplineType(knots, ctrls);
   }
@@ -346,11 +428,12 @@ namespace Eigen
 
     KnotAveragingWithDerivatives(parameters, degree, derivativeIndices, knots);
     
-    // fill matrix
-    MatrixType A = MatrixType::Zero(n, n);
-
-    // Use these dimensions for quicker populating, then transpose for solving.
-    MatrixType b(points.rows(), n);
+    // The rows of the collocation matrix and their first non-zero columns: the end derivative
+    // rows, then the interior points and their derivatives, which are non-zero from the column
+    // span-degree to span.
+    Matrix<DenseIndex,Dynamic,1> firstCols(n), lastCols(n), spans(parameters.size());
+    firstCols(0) = lastCols(0) = 0;
+    firstCols(n-1) = lastCols(n-1) = n-1;
 
     DenseIndex startRow;
     DenseIndex derivativeStart;
@@ -358,11 +441,7 @@ namespace Eigen
     // End derivatives.
     if (derivativeIndices[0] == 0)
     {
-      A.template block<1, 2>(1, 0) << -1, 1;
-      
-      Scalar y = (knots(degree + 1) - knots(0)) / degree;
-      b.col(1) = y*derivatives.col(0);
-      
+      firstCols(1) = 0; lastCols(1) = 1;
       startRow = 2;
       derivativeStart = 1;
     }
@@ -371,32 +450,83 @@ namespace Eigen
       startRow = 1;
       derivativeStart = 0;
     }
-    if (derivativeIndices[derivatives.cols() - 1] == points.cols() - 1)
+    const bool endDerivative = derivativeIndices[derivatives.cols() - 1] == points.cols() - 1;
+    if (endDerivative)
+    {
+      firstCols(n-2) = n-2; lastCols(n-2) = n-1;
+    }
+
+    DenseIndex row = startRow;
+    DenseIndex derivativeIndex = derivativeStart;
+    for (DenseIndex i = 1; i < parameters.size() - 1; ++i)
+    {
+      spans(i) = SplineType::Span(parameters[i], degree, knots);
+      const DenseIndex rows = derivativeIndex < derivatives.cols() && derivativeIndices[derivativeIndex] == i ? 2 : 1;
+      if (rows == 2) ++derivativeIndex;
+      for (DenseIndex k = 0; k < rows; ++k, ++row)
+      {
+        firstCols(row) = spans(i) - degree;
+        lastCols(row) = spans(i);
+      }
+    }
+
+    DenseIndex kl = 0, ku = 0;
+    for (DenseIndex i = 0; i < n; ++i)
     {
-      A.template block<1, 2>(n - 2, n - 2) << -1, 1;
+      kl = (std::max)(kl, i - firstCols(i));
+      ku = (std::max)(ku, lastCols(i) - i);
+    }
+
+    // fill matrix
+    internal::spline_band_system<Scalar> A(n, kl, ku);
+
+    // Use these dimensions for quicker populating, then transpose for solving.
+    MatrixType b(points.rows(), n);
+
+    if (derivativeStart == 1)
+    {
+      A(1, 0) = -1;
+      A(1, 1) = 1;
+
+      Scalar y = (knots(degree + 1) - knots(0)) / degree;
+      b.col(1) = y*derivatives.col(0);
+    }
+    if (endDerivative)
+    {
+      A(n - 2, n - 2) = -1;
+      A(n - 2, n - 1) = 1;
 
       Scalar y = (knots(knots.size() - 1) - knots(knots.size() - (degree + 2))) / degree;
       b.col(b.cols() - 2) = y*derivatives.col(derivatives.cols() - 1);
     }
-    
-    DenseIndex row = startRow;
-    DenseIndex derivativeIndex = derivativeStart;
+
+    row = startRow;
+    derivativeIndex = derivativeStart;
     for (DenseIndex i = 1; i < parameters.size() - 1; ++i)
     {
-      const DenseIndex span = SplineType::Span(parameters[i], degree, knots);
+      const DenseIndex span = spans(i);
 
-      if (derivativeIndices[derivativeIndex] == i)
+      if (derivativeIndex < derivatives.cols() && derivativeIndices[derivativeIndex] == i)
       {
-        A.block(row, span - degree, 2, degree + 1)
+        const typename SplineType::BasisDerivativeType ders
           = SplineType::BasisFunctionDerivatives(parameters[i], 1, degree, knots);
+        for (DenseIndex j = 0; j <= DenseIndex(degree); ++j)
+        {
+          A(row, span - degree + j) = ders(0, j);
+          A(row + 1, span - degree + j) = ders(1, j);
+        }
+        row += 2;
 
-        b.col(row++) = points.col(i);
-        b.col(row++) = derivatives.col(derivativeIndex++);
+        b.col(row - 2) = points.col(i);
+        b.col(row - 1) = derivatives.col(derivativeIndex++);
       }
       else
       {
-        A.row(row++).segment(span - degree, degree + 1)
+        const typename SplineType::BasisVectorType basis
           = SplineType::BasisFunctions(parameters[i], degree, knots);
+        for (DenseIndex j = 0; j <= DenseIndex(degree); ++j)
+          A(row, span - degree + j) = basis(j);
+        ++row;
       }
     }
     b.col(0) = points.col(0);
@@ -405,8 +535,11 @@ namespace Eigen
     A(n - 1, n - 1) = 1;
     
     // Solve
-    FullPivLU<MatrixType> lu(A);
-    ControlPointVectorType controlPoints = lu.solve(MatrixType(b.transpose())).transpose();
+    MatrixType x = b.transpose();
+    const bool solved = A.solve(x);
+    eigen_assert(solved && "SplineFitting::InterpolateWithDerivatives: the interpolation system is singular");
+    EIGEN_ONLY_USED_FOR_DEBUG(solved);
+    ControlPointVectorType controlPoints = x.transpose();
 
     SplineType spline(knots, controlPoints);
     
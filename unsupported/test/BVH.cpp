@@ -189,6 +189,91 @@ struct TreeTest
 
     VERIFY_IS_APPROX(m1, m2);
   }
+
+  //checks point queries on a tree of the balls b against brute force, both one at a time and in batches
+  void checkPointQueries(const KdBVH<double, Dim, BallType> &tree, const BallTypeList &b, int nbQueries)
+  {
+    typedef std::vector<BallPointStuff<Dim>, aligned_allocator<BallPointStuff<Dim> > > QueryList;
+    QueryList intersectors, minimizers;
+    for(int k = 0; k < nbQueries; ++k)
+      intersectors.push_back(BallPointStuff<Dim>(VectorType::Random()));
+    minimizers = intersectors;
+
+    std::vector<double> minima(minimizers.size());
+    BVIntersectBatch(tree, intersectors.begin(), intersectors.end());
+    BVMinimizeBatch(tree, minimizers.begin(), minimizers.end(), minima.begin());
+
+    for(int k = 0; k < nbQueries; ++k) {
+      BallPointStuff<Dim> i1(intersectors[k].p), i2(intersectors[k].p);
+      double m1 = (std::numeric_limits<double>::max)();
+      for(int i = 0; i < (int)b.size(); ++i) {
+        i1.intersectObject(b[i]);
+        m1 = (std::min)(m1, i1.minimumOnObject(b[i]));
+      }
+      BVIntersect(tree, i2);
+
+      VERIFY(i1.count == i2.count);
+      VERIFY(i1.count == intersectors[k].count);
+      VERIFY_IS_APPROX(m1, BVMinimize(tree, i2));
+      VERIFY_IS_APPROX(m1, minima[k]);
+    }
+  }
+
+  void testLarge()
+  {
+    BallTypeList b;
+    std::vector<BoxType, aligned_allocator<BoxType> > boxes;
+    for(int i = 0; i < 25000; ++i) {
+      //some of the balls share their center to exercise the degenerate splits
+      VectorType center = (i % 5 == 1) ? b.back().center : VectorType(VectorType::Random());
+      b.push_back(BallType(center, 0.05 * internal::random(0., 1.)));
+      boxes.push_back(bounding_box(b.back()));
+    }
+    KdBVH<double, Dim, BallType> tree(b.begin(), b.end(), boxes.begin(), boxes.end());
+    checkPointQueries(tree, b, 20);
+
+    //balls which all have the same center
+    BallTypeList c(300, BallType(VectorType::Random(), 0.3));
+    tree.init(c.begin(), c.end());
+    checkPointQueries(tree, c, 5);
+  }
+
+  //the subtrees of the hierarchies of more than 20000 objects are built by several threads, like the batched queries
+  void testLargeParallel()
+  {
+    const int nbThreads = Eigen::nbThreads();
+    Eigen::setNbThreads(4);
+    testLarge();
+    Eigen::setNbThreads(nbThreads);
+  }
+
+  void testSmall()
+  {
+    for(int n = 1; n <= 5; ++n) {
+      BallTypeList b;
+      VectorTypeList v;
+      for(int i = 0; i < n; ++i)
+        b.push_back(BallType(VectorType::Random(), 0.5 * internal::random(0., 1.)));
+      for(int j = 0; j < 200; ++j)
+        v.push_back(VectorType::Random());
+
+      KdBVH<double, Dim, BallType> tree(b.begin(), b.end());
+      KdBVH<double, Dim, VectorType> vTree(v.begin(), v.end());
+      checkPointQueries(tree, b, 5);
+
+      BallPointStuff<Dim> i1, i2, i3;
+      double m1 = (std::numeric_limits<double>::max)();
+      for(int i = 0; i < (int)b.size(); ++i)
+        for(int j = 0; j < (int)v.size(); ++j) {
+          i1.intersectObjectObject(b[i], v[j]);
+          m1 = (std::min)(m1, i1.minimumOnObjectObject(b[i], v[j]));
+        }
+
+      BVIntersect(tree, vTree, i2);
+      VERIFY(i1.count == i2.count);
+      VERIFY_IS_APPROX(m1, BVMinimize(tree, vTree, i3));
+    }
+  }
 };
 
 
@@ -201,6 +286,9 @@ void test_BVH()
     CALL_SUBTEST(test2.testMinimize1());
     CALL_SUBTEST(test2.testIntersect2());
     CALL_SUBTEST(test2.testMinimize2());
+    CALL_SUBTEST(test2.testLarge());
+    CALL_SUBTEST(test2.testSmall());
+    CALL_SUBTEST(test2.testLargeParallel());
 #endif
 
 #ifdef EIGEN_TEST_PART_2
@@ -209,6 +297,9 @@ void test_BVH()
     CALL_SUBTEST(test3.testMinimize1());
     CALL_SUBTEST(test3.testIntersect2());
     CALL_SUBTEST(test3.testMinimize2());
+    CALL_SUBTEST(test3.testLarge());
+    CALL_SUBTEST(test3.testSmall());
+    CALL_SUBTEST(test3.testLargeParallel());
 #endif
 
 #ifdef EIGEN_TEST_PART_3
@@ -217,6 +308,9 @@ void test_BVH()
     CALL_SUBTEST(test4.testMinimize1());
     CALL_SUBTEST(test4.testIntersect2());
     CALL_SUBTEST(test4.testMinimize2());
+    CALL_SUBTEST(test4.testLarge());
+    CALL_SUBTEST(test4.testSmall());
+    CALL_SUBTEST(test4.testLargeParallel());
 #endif
   }
 }
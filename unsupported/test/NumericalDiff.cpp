@@ -107,8 +107,110 @@ void test_central()
     VERIFY_IS_APPROX(jac, actual_jac);
 }
 
+// f_i(x) = sum_j a_ij sin(x_j), whose jacobian has the sparsity pattern of a
+struct sparse_functor : Functor<double>
+{
+    sparse_functor(const SparseMatrix<double>& a) : Functor<double>(int(a.cols()), int(a.rows())), m_a(a) {}
+    int operator()(const VectorXd &x, VectorXd &fvec) const
+    {
+        fvec = m_a * x.array().sin().matrix();
+        return 0;
+    }
+
+    void actual_df(const VectorXd &x, MatrixXd &fjac) const
+    {
+        fjac = MatrixXd(m_a) * x.array().cos().matrix().asDiagonal();
+    }
+
+    SparseMatrix<double> m_a;
+};
+
+struct sparse_jacobian_functor : sparse_functor
+{
+    typedef SparseMatrix<double> JacobianType;
+    sparse_jacobian_functor(const SparseMatrix<double>& a) : sparse_functor(a) {}
+};
+
+// a tridiagonal plus a random sparse matrix
+SparseMatrix<double> sparse_pattern(int n, int m)
+{
+    std::vector<Triplet<double> > entries;
+    for (int i = 0; i < m; ++i) {
+        for (int j = (std::max)(0,i-1); j <= (std::min)(n-1,i+1); ++j)
+            entries.push_back(Triplet<double>(i, j, internal::random<double>(0.5,1)));
+        if (internal::random<int>(0,3) == 0)
+            entries.push_back(Triplet<double>(i, internal::random<int>(0,n-1), 1.));
+    }
+    SparseMatrix<double> a(m, n);
+    a.setFromTriplets(entries.begin(), entries.end());
+    return a;
+}
+
+// compares the jacobian computed with the coloring of the sparsity pattern to the dense finite difference one,
+// checks the number of evaluations of both, and returns the number of colors
+template<NumericalDiffMode mode>
+int check_colored_jacobian(const SparseMatrix<double>& pattern, const VectorXd& x, bool parallel)
+{
+    int n = int(pattern.cols());
+    sparse_functor functor(pattern);
+    NumericalDiff<sparse_functor,mode> denseDiff(functor);
+    denseDiff.setParallelEvaluation(parallel);
+    MatrixXd jac_dense(pattern.rows(), n);
+    int nfev = denseDiff.df(x, jac_dense);
+    VERIFY_IS_EQUAL(nfev, mode==Forward ? n+1 : 2*n);
+
+    NumericalDiff<sparse_jacobian_functor,mode> sparseDiff(pattern);
+    sparseDiff.setSparsityPattern(pattern);
+    sparseDiff.setParallelEvaluation(parallel);
+    SparseMatrix<double> jac_sparse;
+    nfev = sparseDiff.df(x, jac_sparse);
+    VERIFY_IS_EQUAL(nfev, int(mode==Forward ? sparseDiff.colorCount()+1 : 2*sparseDiff.colorCount()));
+    VERIFY_IS_EQUAL(jac_sparse.nonZeros(), pattern.nonZeros());
+    VERIFY_IS_APPROX(MatrixXd(jac_sparse), jac_dense);
+    return int(sparseDiff.colorCount());
+}
+
+template<NumericalDiffMode mode>
+void test_sparse(int n, int m)
+{
+    SparseMatrix<double> a = sparse_pattern(n, m);
+    // away from 0, where the steps proportional to x would be too small
+    VectorXd x = VectorXd::Random(n).array() + 2.;
+    MatrixXd actual_jac;
+    sparse_functor(a).actual_df(x, actual_jac);
+
+    NumericalDiff<sparse_jacobian_functor,mode> numDiff(a);
+    numDiff.setSparsityPattern(a);
+    VERIFY(numDiff.colorCount() >= 3 || n < 3 || m < 2); // the row 1 has three nonzeros
+    VERIFY(numDiff.colorCount() <= n);
+    SparseMatrix<double> jac;
+    numDiff.df(x, jac);
+    VERIFY(MatrixXd(jac).isApprox(actual_jac, 1e-6));
+
+    // a purely tridiagonal pattern only needs three colors
+    SparseMatrix<double> tridiagonal = a;
+    for (int j = 0; j < n; ++j)
+        for (SparseMatrix<double>::InnerIterator it(tridiagonal, j); it; ++it)
+            if (std::abs(int(it.row())-j) > 1)
+                it.valueRef() = 0.;
+    tridiagonal.prune(0.);
+
+    // sequential evaluations, and evaluations of the colors shared among 4 threads
+    const int nbThreads = Eigen::nbThreads();
+    Eigen::setNbThreads(4);
+    for (int parallel = 0; parallel < 2; ++parallel) {
+        check_colored_jacobian<mode>(a, x, parallel==1);
+        VERIFY(check_colored_jacobian<mode>(tridiagonal, x, parallel==1) <= 3);
+    }
+    Eigen::setNbThreads(nbThreads);
+}
+
 void test_NumericalDiff()
 {
     CALL_SUBTEST(test_forward());
     CALL_SUBTEST(test_central());
+    for(int i = 0; i < g_repeat; i++) {
+        CALL_SUBTEST(test_sparse<Forward>(internal::random<int>(1,200), internal::random<int>(1,200)));
+        CALL_SUBTEST(test_sparse<Central>(internal::random<int>(1,200), internal::random<int>(1,200)));
+    }
 }
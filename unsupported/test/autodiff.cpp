@@ -7,6 +7,7 @@
 // Public License v. 2.0. If a copy of the MPL was not distributed
 // with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#define EIGEN_RUNTIME_NO_MALLOC
 #include "main.h"
 #include <unsupported/Eigen/AutoDiff>
 
@@ -104,7 +105,7 @@ struct TestFunc1
   }
 };
 
-template<typename Func> void forward_jacobian(const Func& f)
+template<int MaxInputs, typename Func> void forward_jacobian(const Func& f)
 {
     typename Func::InputType x = Func::InputType::Random(f.inputs());
     typename Func::ValueType y(f.values()), yref(f.values());
@@ -118,7 +119,7 @@ template<typename Func> void forward_jacobian(const Func& f)
 
     j.setZero();
     y.setZero();
-    AutoDiffJacobian<Func> autoj(f);
+    AutoDiffJacobian<Func,MaxInputs> autoj(f);
     autoj(x, &y, &j);
 //     std::cerr << y.transpose() << "\n\n";;
 //     std::cerr << j << "\n\n";;
@@ -128,6 +129,11 @@ template<typename Func> void forward_jacobian(const Func& f)
 }
 
 
+template<typename Func> void forward_jacobian(const Func& f)
+{
+  forward_jacobian<Func::InputsAtCompileTime>(f);
+}
+
 // TODO also check actual derivatives!
 void test_autodiff_scalar()
 {
@@ -160,6 +166,37 @@ void test_autodiff_jacobian()
   CALL_SUBTEST(( forward_jacobian(TestFunc1<double,3,2>()) ));
   CALL_SUBTEST(( forward_jacobian(TestFunc1<double,3,3>()) ));
   CALL_SUBTEST(( forward_jacobian(TestFunc1<double>(3,3)) ));
+  CALL_SUBTEST(( forward_jacobian<4>(TestFunc1<double>(3,3)) ));
+  CALL_SUBTEST(( forward_jacobian<3>(TestFunc1<double>(2,3)) ));
+}
+
+// derivatives whose number is bounded at compile time are propagated without heap allocation
+template<int MaxDer>
+void test_autodiff_bounded_derivatives()
+{
+  typedef Matrix<double,Dynamic,1,0,MaxDer,1> DerType;
+  typedef AutoDiffScalar<DerType> AD;
+  typedef AutoDiffScalar<VectorXd> ADX;
+  int n = internal::random<int>(2,MaxDer);
+  Vector2d p = Vector2d::Random();
+
+  ADX xx(p.x(),n,0), yx(p.y(),n,n-1);
+  ADX refx = foo<ADX>(xx,yx);
+  refx = atan2(refx,xx) * tan(yx) / (ADX(2.) + abs(xx)) - pow(yx,3);
+
+  AD x(p.x(),n,0), y(p.y(),n,n-1);
+  internal::set_is_malloc_allowed(false);
+  AD res = foo<AD>(x,y);
+  res = atan2(res,x) * tan(y) / (AD(2.) + abs(x)) - pow(y,3);
+  Matrix<AD,2,1> v(x,y);
+  AD nrm = v.norm();
+  internal::set_is_malloc_allowed(true);
+
+  VERIFY_IS_APPROX(res.value(), refx.value());
+  VERIFY_IS_APPROX(VectorXd(res.derivatives()), refx.derivatives());
+  VERIFY_IS_APPROX(nrm.value(), p.norm());
+  VERIFY_IS_APPROX(nrm.derivatives()(0), p.x()/p.norm());
+  VERIFY_IS_APPROX(nrm.derivatives()(n-1), p.y()/p.norm());
 }
 
 void test_autodiff()
@@ -168,6 +205,8 @@ void test_autodiff()
     CALL_SUBTEST_1( test_autodiff_scalar() );
     CALL_SUBTEST_2( test_autodiff_vector() );
     CALL_SUBTEST_3( test_autodiff_jacobian() );
+    CALL_SUBTEST_4( test_autodiff_bounded_derivatives<4>() );
+    CALL_SUBTEST_4( test_autodiff_bounded_derivatives<16>() );
   }
 }
 
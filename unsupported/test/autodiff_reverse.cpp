@@ -0,0 +1,147 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "main.h"
+#include <unsupported/Eigen/AutoDiff>
+
+template<typename Scalar>
+Scalar scalar_function(const Scalar& x, const Scalar& y)
+{
+  using namespace std;
+  Scalar t = x*2 - pow(x,2.) + 2*sqrt(y*y) - 4 * sin(x) + 2 * cos(y) - exp(-0.5*x*x);
+  return t / (1. + abs2(y)) + atan2(x, y) * tan(x) + log(2. + x) - abs(y) + asin(0.25*x*y) - acos(0.5*y);
+}
+
+// a chain of coupled terms, whose gradient has no zero entry
+template<typename Scalar, int N=Dynamic>
+struct ChainFunc
+{
+  enum { InputsAtCompileTime = N };
+  typedef Matrix<Scalar,N,1> InputType;
+
+  template<typename T>
+  T operator()(const Matrix<T,N,1>& x) const
+  {
+    using std::log;
+    using std::sin;
+    T res(0.);
+    for(Index i=0; i+1<x.size(); ++i)
+      res += numext::abs2(x(i+1) - x(i)) + log(Scalar(1) + x(i)*x(i)) * sin(x(i+1));
+    return res + x.squaredNorm() / Scalar(x.size());
+  }
+};
+
+void check_scalar_functions()
+{
+  typedef double Scalar;
+  typedef AutoDiffScalar<Matrix<Scalar,2,1> > ForwardAD;
+  typedef AutoDiffReverseScalar<Scalar> AD;
+
+  Scalar px = internal::random<Scalar>(Scalar(0.1),Scalar(1)), py = internal::random<Scalar>(Scalar(0.1),Scalar(1));
+  ForwardAD fx(px, Matrix<Scalar,2,1>::UnitX()), fy(py, Matrix<Scalar,2,1>::UnitY());
+  ForwardAD ref = scalar_function(fx, fy);
+
+  AutoDiffTape<Scalar> tape;
+  AD x = tape.variable(px), y = tape.variable(py);
+  AD res = scalar_function(x, y);
+  VERIFY_IS_APPROX(res.value(), ref.value());
+  tape.backward(res);
+  VERIFY_IS_APPROX(tape.adjoint(x), ref.derivatives()(0));
+  VERIFY_IS_APPROX(tape.adjoint(y), ref.derivatives()(1));
+
+  tape.clear();
+  x = tape.variable(px);
+  VERIFY_IS_APPROX(tape.gradient(atan(x), Matrix<AD,1,1>(x))(0), Scalar(1)/(1+px*px));
+  // integer exponent, converted to the scalar type
+  VERIFY_IS_APPROX(tape.gradient(pow(x,3), Matrix<AD,1,1>(x))(0), Scalar(3)*px*px);
+
+  // constants are not recorded
+  Index size = tape.size();
+  AD c = AD(px) * AD(py) + Scalar(2);
+  VERIFY(c.isConstant());
+  VERIFY_IS_EQUAL(tape.size(), size);
+  VERIFY_IS_EQUAL(tape.adjoint(c), Scalar(0));
+}
+
+template<typename Scalar, int N> void check_gradient(Index n)
+{
+  typedef Matrix<Scalar,N,1> VectorType;
+  typedef AutoDiffScalar<Matrix<Scalar,Dynamic,1> > ForwardAD;
+  ChainFunc<Scalar,N> f;
+  VectorType x = VectorType::Random(n);
+
+  // forward mode reference
+  Matrix<ForwardAD,N,1> fx(n);
+  for(Index i=0; i<n; ++i)
+    fx(i) = ForwardAD(x(i), int(n), int(i));
+  ForwardAD ref = f(fx);
+
+  AutoDiffGradient<ChainFunc<Scalar,N> > grad(f);
+  VectorType g(n);
+  VERIFY_IS_APPROX(grad(x, &g), ref.value());
+  VERIFY_IS_APPROX(g, VectorType(ref.derivatives()));
+  VERIFY_IS_APPROX(grad(x), ref.value());
+
+  // the recording is repeated on the same tape
+  x = VectorType::Random(n);
+  for(Index i=0; i<n; ++i)
+    fx(i) = ForwardAD(x(i), int(n), int(i));
+  ref = f(fx);
+  VERIFY_IS_APPROX(grad(x, &g), ref.value());
+  VERIFY_IS_APPROX(g, VectorType(ref.derivatives()));
+}
+
+template<typename Scalar> void check_matrix_operations(Index rows, Index depth, Index cols)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> MatrixType;
+  typedef AutoDiffReverseScalar<Scalar> AD;
+  typedef Matrix<AD,Dynamic,Dynamic> ADMatrix;
+
+  MatrixType a = MatrixType::Random(rows, depth), b = MatrixType::Random(depth, cols), w = MatrixType::Random(rows, cols);
+  MatrixType s = MatrixType::Random(depth, depth) + MatrixType::Identity(depth, depth) * Scalar(depth);
+
+  // matrix level operations against the same operations recorded coefficient by coefficient
+  AutoDiffTape<Scalar> tape1, tape2;
+  ADMatrix a1 = tape1.variables(a), b1 = tape1.variables(b), s1 = tape1.variables(s);
+  ADMatrix a2 = tape2.variables(a), b2 = tape2.variables(b), s2 = tape2.variables(s);
+
+  ADMatrix c1 = tape1.product(a1, tape1.solve(s1, b1));
+  ADMatrix c2 = a2 * PartialPivLU<ADMatrix>(s2).solve(b2);
+  AD y1 = (c1.array() * w.template cast<AD>().array()).sum() + c1(0,0) * c1(rows-1,cols-1);
+  AD y2 = (c2.array() * w.template cast<AD>().array()).sum() + c2(0,0) * c2(rows-1,cols-1);
+  VERIFY_IS_APPROX(y1.value(), y2.value());
+  VERIFY(tape1.size() < tape2.size());
+
+  tape1.backward(y1);
+  tape2.backward(y2);
+  VERIFY_IS_APPROX(tape1.adjoints(a1), tape2.adjoints(a2));
+  VERIFY_IS_APPROX(tape1.adjoints(b1), tape2.adjoints(b2));
+  VERIFY_IS_APPROX(tape1.adjoints(s1), tape2.adjoints(s2));
+
+  // seeded backward sweep: product of a vector by the jacobian of c with respect to a, which is w_i. b^T
+  tape1.backward(c1, w);
+  tape2.backward(c2, w);
+  VERIFY_IS_APPROX(tape1.adjoints(a1), tape2.adjoints(a2));
+
+  // constant operands
+  tape1.clear();
+  b1 = tape1.variables(b);
+  c1 = tape1.product(a.template cast<AD>(), b1);
+  VERIFY_IS_APPROX(MatrixType(tape1.gradient(c1(0,0), b1)).col(0), MatrixType(a.row(0).transpose()));
+}
+
+void test_autodiff_reverse()
+{
+  for(int i = 0; i < g_repeat; i++) {
+    CALL_SUBTEST_1( check_scalar_functions() );
+    CALL_SUBTEST_1(( check_gradient<double,Dynamic>(internal::random<Index>(2,200)) ));
+    CALL_SUBTEST_1(( check_gradient<double,5>(5) ));
+    CALL_SUBTEST_2(( check_gradient<float,Dynamic>(internal::random<Index>(2,50)) ));
+    CALL_SUBTEST_1(( check_matrix_operations<double>(internal::random<Index>(2,20), internal::random<Index>(2,20), internal::random<Index>(2,20)) ));
+    CALL_SUBTEST_2(( check_matrix_operations<float>(internal::random<Index>(2,10), internal::random<Index>(2,10), internal::random<Index>(2,10)) ));
+  }
+}
@@ -83,6 +83,55 @@ void check_sparse_kronecker_product(const MatrixType& ab)
 }
 
 
+template<typename Scalar>
+void check_kronecker_product_operator()
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+  typedef SparseMatrix<Scalar> SparseMatrixType;
+
+  Index ra = internal::random<Index>(1,20), ca = internal::random<Index>(1,20);
+  Index rb = internal::random<Index>(1,20), cb = internal::random<Index>(1,20);
+  Index rc = internal::random<Index>(1,10), cc = internal::random<Index>(1,10);
+  DenseMatrix dA = DenseMatrix::Random(ra,ca), dB(rb,cb), dC = DenseMatrix::Random(rc,cc);
+  SparseMatrixType sB(rb,cb);
+  initSparse(Scalar(0.3), dB, sB);
+
+  // products with vectors, matrices and blocks, for dense, sparse and nested factors
+  DenseMatrix dAB = kroneckerProduct(dA,dB);
+  DenseVector x = DenseVector::Random(ca*cb);
+  DenseMatrix X = DenseMatrix::Random(ca*cb, 3), Y = DenseMatrix::Random(ca*cb+2, 4);
+  VERIFY_IS_APPROX(DenseVector(kroneckerProductOperator(dA,dB) * x), DenseVector(dAB * x));
+  VERIFY_IS_APPROX(DenseMatrix(kroneckerProductOperator(dA,sB) * X), DenseMatrix(dAB * X));
+  VERIFY_IS_APPROX(DenseMatrix(kroneckerProductOperator(dA,dB) * Y.block(1,1,ca*cb,3)), DenseMatrix(dAB * Y.block(1,1,ca*cb,3)));
+  DenseMatrix W = DenseMatrix::Random(rb*ca, 2);
+  VERIFY_IS_APPROX(DenseMatrix(kroneckerProductOperator(sB.transpose(),dA) * W), DenseMatrix(kroneckerProduct(dB.transpose(),dA) * W));
+
+  DenseVector y = DenseVector::Random(ra*rb), ref = y;
+  y += kroneckerProductOperator(dA,sB) * x;
+  ref += dAB * x;
+  VERIFY_IS_APPROX(y, ref);
+
+  // chain of Kronecker products
+  DenseMatrix dABC = kroneckerProduct(dAB,dC);
+  DenseVector z = DenseVector::Random(ca*cb*cc);
+  VERIFY_IS_APPROX(DenseVector(kroneckerProductOperator(dA, kroneckerProductOperator(sB,dC)) * z), DenseVector(dABC * z));
+  VERIFY_IS_APPROX(DenseVector(kroneckerProductOperator(kroneckerProductOperator(dA,sB), dC) * z), DenseVector(dABC * z));
+
+  // matrix-free operator of the iterative solvers
+  Index na = internal::random<Index>(2,10), nb = internal::random<Index>(2,10);
+  DenseMatrix pA = DenseMatrix::Random(na,na), pB = DenseMatrix::Random(nb,nb);
+  pA = (pA * pA.adjoint()).eval() + DenseMatrix::Identity(na,na);
+  pB = (pB * pB.adjoint()).eval() + DenseMatrix::Identity(nb,nb);
+  typedef KroneckerProductOperator<DenseMatrix,DenseMatrix> Operator;
+  Operator op(pA, pB);
+  DenseVector b = DenseVector::Random(na*nb);
+  ConjugateGradient<Operator, Lower|Upper, IdentityPreconditioner> cg(op);
+  cg.setTolerance(NumTraits<Scalar>::epsilon()*Scalar(16));
+  DenseVector sol = cg.solve(b);
+  VERIFY_IS_APPROX(sol, DenseVector(kroneckerProduct(pA,pB).eval().llt().solve(b)));
+}
+
 void test_kronecker_product()
 {
   // DM = dense matrix; SM = sparse matrix
@@ -228,5 +277,8 @@ void test_kronecker_product()
     sC2 = kroneckerProduct(2*sA,sB);
     dC = kroneckerProduct(2*dA,dB);
     VERIFY_IS_APPROX(MatrixXf(sC2),dC);
+
+    CALL_SUBTEST(check_kronecker_product_operator<double>());
+    CALL_SUBTEST(check_kronecker_product_operator<float>());
   }
 }
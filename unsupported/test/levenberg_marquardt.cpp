@@ -1425,8 +1425,172 @@ void testNistEckerle4(void)
   VERIFY_IS_APPROX(x[2], 4.5154121844E+02);
 }
 
+// A small bundle adjustment like problem: cameras made of an angle and a translation observe 2D points, and the first
+// camera is fixed. The unknowns are the other cameras followed by the points, so that the normal equations have a
+// block diagonal part of 2x2 blocks for the points.
+struct bundle_functor : SparseFunctor<double,int>
+{
+    bundle_functor(int cameras, int points, int observations)
+      : SparseFunctor<double,int>(3*(cameras-1)+2*points, 2*points*observations), m_cameras(cameras), m_points(points)
+    {
+      // each point is observed by the fixed camera and by observations-1 consecutive other cameras, so that each
+      // of them observes several points when points >= 2*(cameras-1)
+      for(int k=0; k<points; ++k)
+      {
+        m_obs.push_back(std::make_pair(0,k));
+        for(int o=1; o<observations; ++o)
+          m_obs.push_back(std::make_pair(1+(k+o)%(cameras-1),k));
+      }
+      m_truth = VectorXd::Random(inputs());
+      m_z.resize(values());
+      m_z.setZero();
+      VectorXd f(values());
+      (*this)(m_truth, f);
+      m_z = f + 0.01*VectorXd::Random(values());
+    }
+
+    int operator()(const VectorXd &x, VectorXd &fvec) const
+    {
+      for(size_t o=0; o<m_obs.size(); ++o)
+      {
+        int i = m_obs[o].first, k = m_obs[o].second;
+        Vector2d p = x.segment<2>(3*(m_cameras-1)+2*k);
+        if(i>0)
+          p = rotation(x(3*(i-1))) * p + x.segment<2>(3*(i-1)+1);
+        fvec.segment<2>(2*o) = p - m_z.segment<2>(2*o);
+      }
+      return 0;
+    }
+
+    int df(const VectorXd &x, JacobianType &fjac) const
+    {
+      std::vector<Triplet<double> > triplets;
+      for(size_t o=0; o<m_obs.size(); ++o)
+      {
+        int i = m_obs[o].first, k = m_obs[o].second;
+        int row = 2*int(o), col = 3*(m_cameras-1)+2*k;
+        Matrix2d rot = Matrix2d::Identity();
+        if(i>0)
+        {
+          int cam = 3*(i-1);
+          rot = rotation(x(cam));
+          Vector2d dp = rot * Vector2d(-x(col+1), x(col));
+          for(int r=0; r<2; ++r)
+          {
+            triplets.push_back(Triplet<double>(row+r, cam, dp(r)));
+            triplets.push_back(Triplet<double>(row+r, cam+1+r, 1.));
+          }
+        }
+        for(int r=0; r<2; ++r)
+          for(int c=0; c<2; ++c)
+            triplets.push_back(Triplet<double>(row+r, col+c, rot(r,c)));
+      }
+      fjac.setFromTriplets(triplets.begin(), triplets.end());
+      return 0;
+    }
+
+    static Matrix2d rotation(double angle)
+    {
+      Matrix2d rot;
+      rot << std::cos(angle), -std::sin(angle), std::sin(angle), std::cos(angle);
+      return rot;
+    }
+
+    int m_cameras, m_points;
+    std::vector<std::pair<int,int> > m_obs;
+    VectorXd m_truth, m_z;
+};
+
+// the same problem with a dense jacobian, solved with the default QR factorization
+struct dense_bundle_functor : DenseFunctor<double>
+{
+    dense_bundle_functor(const bundle_functor& sparse) : DenseFunctor<double>(sparse.inputs(), sparse.values()), m_sparse(sparse) {}
+    int operator()(const VectorXd &x, VectorXd &fvec) const { return m_sparse(x, fvec); }
+    int df(const VectorXd &x, MatrixXd &fjac) const
+    {
+      bundle_functor::JacobianType jac(values(), inputs());
+      m_sparse.df(x, jac);
+      fjac = jac;
+      return 0;
+    }
+    const bundle_functor& m_sparse;
+};
+
+void testNormalSolver()
+{
+  typedef LevenbergMarquardtNormalSolver<bundle_functor::JacobianType> Solver;
+  const int cameras = internal::random<int>(3,8), points = internal::random<int>(14,40), observations = 3;
+  bundle_functor functor(cameras, points, observations);
+  const int n = functor.inputs(), kept = 3*(cameras-1);
+
+  // the steps against the dense solution of the damped normal equations
+  VectorXd x = functor.m_truth + 0.1*VectorXd::Random(n), fvec(functor.values());
+  bundle_functor::JacobianType jac(functor.values(), n);
+  functor(x, fvec);
+  functor.df(x, jac);
+  MatrixXd jtj = MatrixXd(jac).transpose() * MatrixXd(jac);
+  VectorXd diag = VectorXd::Random(n).cwiseAbs() + VectorXd::Constant(n, 0.5), step, ref;
+  double par = internal::random<double>(0.01,1.);
+  ref = (jtj + par*MatrixXd(diag.cwiseAbs2().asDiagonal())).ldlt().solve(-MatrixXd(jac).transpose()*fvec);
+
+  Solver solver;
+  solver.compute(jac, fvec);
+  VERIFY(solver.info()==Success);
+  VERIFY_IS_APPROX(solver.gradient(), VectorXd(MatrixXd(jac).transpose()*fvec));
+  VERIFY(solver.solve(diag, par, step)==Success);
+  VERIFY_IS_APPROX(step, ref);
+
+  Solver schur;
+  schur.setSchurComplement(kept, 2);
+  schur.compute(jac, fvec);
+  VERIFY(schur.info()==Success);
+  VERIFY(schur.solve(diag, par, step)==Success);
+  VERIFY_IS_APPROX(step, ref);
+
+  // the symbolic analysis is reused for a jacobian of the same pattern
+  x += 0.01*VectorXd::Random(n);
+  functor(x, fvec);
+  functor.df(x, jac);
+  jtj = MatrixXd(jac).transpose() * MatrixXd(jac);
+  ref = (jtj + par*MatrixXd(diag.cwiseAbs2().asDiagonal())).ldlt().solve(-MatrixXd(jac).transpose()*fvec);
+  schur.compute(jac, fvec);
+  VERIFY(schur.solve(diag, 2*par, step)==Success);
+  VERIFY(schur.solve(diag, par, step)==Success);
+  VERIFY_IS_APPROX(step, ref);
+  VERIFY_IS_EQUAL(schur.analysisCount(), 1);
+
+  // coupled eliminated unknowns are rejected: the translation of the last camera and the points it observes
+  schur.setSchurComplement(kept-2, 2);
+  schur.compute(jac, fvec);
+  VERIFY(schur.info()==InvalidInput);
+
+  // the minimization with the normal equations, with and without Schur complement, against the QR factorization
+  VectorXd x0 = functor.m_truth + 0.1*VectorXd::Random(n), xqr = x0, xnormal = x0, xschur = x0;
+  dense_bundle_functor denseFunctor(functor);
+  LevenbergMarquardt<dense_bundle_functor> lmqr(denseFunctor);
+  lmqr.minimize(xqr);
+  VERIFY(lmqr.info()==Success);
+
+  LevenbergMarquardt<bundle_functor, Solver> lmnormal(functor);
+  lmnormal.minimize(xnormal);
+  VERIFY(lmnormal.info()==Success);
+  VERIFY(xnormal.isApprox(xqr, 1e-6));
+  VERIFY_IS_APPROX(lmnormal.fnorm(), lmqr.fnorm());
+
+  LevenbergMarquardt<bundle_functor, Solver> lmschur(functor);
+  lmschur.solver().setSchurComplement(kept, 2);
+  lmschur.minimize(xschur);
+  VERIFY(lmschur.info()==Success);
+  VERIFY(xschur.isApprox(xqr, 1e-6));
+  VERIFY_IS_EQUAL(lmschur.solver().analysisCount(), 1);
+}
+
 void test_levenberg_marquardt()
 {
+    // sparse normal equations, first so that they run even if one of the NIST tests below fails
+    for(int i = 0; i < g_repeat; i++)
+      CALL_SUBTEST(testNormalSolver());
+
     // Tests using the examples provided by (c)minpack
     CALL_SUBTEST(testLmder1());
     CALL_SUBTEST(testLmder());
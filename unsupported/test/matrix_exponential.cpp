@@ -8,6 +8,7 @@
 // with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "matrix_functions.h"
+#include <Eigen/SparseCore>
 
 double binom(int n, int k)
 {
@@ -119,6 +120,108 @@ void randomTest(const MatrixType& m, double tol)
   }
 }
 
+// The second difference operator, applied without storing it
+struct LaplacianOperator;
+namespace Eigen { namespace internal {
+template<> struct traits<LaplacianOperator> : traits<MatrixXd> {};
+} }
+
+struct LaplacianOperator : EigenBase<LaplacianOperator>
+{
+  typedef double Scalar;
+  typedef double RealScalar;
+  explicit LaplacianOperator(Index n) : m_size(n) {}
+  Index rows() const { return m_size; }
+  Index cols() const { return m_size; }
+  VectorXd operator*(const VectorXd& x) const
+  {
+    VectorXd y = -2*x;
+    y.head(m_size-1) += x.tail(m_size-1);
+    y.tail(m_size-1) += x.head(m_size-1);
+    return y;
+  }
+  MatrixXd toDense() const
+  {
+    MatrixXd a = MatrixXd::Zero(m_size, m_size);
+    a.diagonal().setConstant(-2);
+    a.diagonal(1).setOnes();
+    a.diagonal(-1).setOnes();
+    return a;
+  }
+  Index m_size;
+};
+
+template<typename Scalar>
+void testExponentialAction(Index n, double tol)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+
+  // dense matrix, several vectors, and times of both signs
+  DenseMatrix a = DenseMatrix::Random(n,n), b = DenseMatrix::Random(n,3);
+  a.diagonal().array() += Scalar(internal::random<RealScalar>(-5,5));
+  MatrixExponentialAction<DenseMatrix> expa(a);
+  for(int k=0; k<3; ++k)
+  {
+    RealScalar t = internal::random<RealScalar>(-2,2);
+    DenseMatrix ref = (t*a).exp() * b;
+    VERIFY(expa.apply(b, t).isApprox(ref, RealScalar(tol)));
+  }
+  VERIFY_IS_EQUAL(expa.apply(b, RealScalar(0)), b);
+  VERIFY_IS_EQUAL(expa.productCount(), 0);
+
+  // sparse matrix with a large norm, which requires several steps
+  SparseMatrix<Scalar> sa(n,n);
+  std::vector<Triplet<Scalar> > triplets;
+  for(Index j=0; j<n; ++j)
+  {
+    triplets.push_back(Triplet<Scalar>(j, j, internal::random<Scalar>() * RealScalar(10)));
+    triplets.push_back(Triplet<Scalar>(internal::random<Index>(0,n-1), j, internal::random<Scalar>() * RealScalar(10)));
+  }
+  sa.setFromTriplets(triplets.begin(), triplets.end());
+  MatrixExponentialAction<SparseMatrix<Scalar> > expsa(sa);
+  DenseMatrix dsa = DenseMatrix(sa);
+  Matrix<RealScalar,Dynamic,1> times = Matrix<RealScalar,Dynamic,1>::LinSpaced(4, RealScalar(0.1), RealScalar(1));
+  DenseMatrix res = expsa.apply(b, times);
+  VERIFY(n==1 || expsa.productCount() > 0);
+  for(Index i=0; i<times.size(); ++i)
+    VERIFY(res.middleCols(3*i,3).isApprox((times(i)*dsa).exp()*b, RealScalar(tol)));
+  SparseMatrix<Scalar,RowMajor> sarm = sa;
+  MatrixExponentialAction<SparseMatrix<Scalar,RowMajor> > expsarm(sarm);
+  VERIFY(expsarm.apply(b.col(0), times(2)).isApprox(res.col(6), RealScalar(tol)));
+}
+
+void testExponentialActionOperator(Index n)
+{
+  // matrix-free operator
+  LaplacianOperator op(n);
+  MatrixExponentialAction<LaplacianOperator> expop(op);
+  expop.setOneNorm(4);
+  VectorXd b = VectorXd::Random(n);
+  VERIFY_IS_APPROX(VectorXd(expop.apply(b, 3.)), VectorXd((3.*op.toDense()).exp()*b));
+
+  // the transition matrix of a continuous time Markov chain preserves probabilities
+  SparseMatrix<double> q(n,n);
+  for(Index j=0; j<n; ++j)
+  {
+    Index i = (j+1)%n, k = internal::random<Index>(0,n-1);
+    double rate1 = internal::random<double>(0,5), rate2 = k==j ? 0 : internal::random<double>(0,5);
+    q.insert(i,j) = rate1;
+    if(k!=j && k!=i)
+      q.insert(k,j) = rate2;
+    else
+      rate2 = 0;
+    q.insert(j,j) = -rate1-rate2;
+  }
+  VectorXd p = VectorXd::Random(n).cwiseAbs();
+  p /= p.sum();
+  MatrixExponentialAction<SparseMatrix<double> > expq(q);
+  VectorXd pt = expq.apply(p, 10.);
+  VERIFY_IS_APPROX(pt.sum(), 1.);
+  VERIFY(pt.minCoeff() > -1e-12);
+  VERIFY_IS_APPROX(pt, VectorXd((10.*MatrixXd(q)).exp()*p));
+}
+
 void test_matrix_exponential()
 {
   CALL_SUBTEST_2(test2dRotation<double>(1e-13));
@@ -138,4 +241,10 @@ void test_matrix_exponential()
   CALL_SUBTEST_1(randomTest(Matrix4f(), 1e-4));
   CALL_SUBTEST_6(randomTest(MatrixXf(8,8), 1e-4));
   CALL_SUBTEST_9(randomTest(Matrix<long double,Dynamic,Dynamic>(7,7), 1e-13));
+  for(int i = 0; i < g_repeat; i++) {
+    CALL_SUBTEST_4(testExponentialAction<double>(internal::random<Index>(1,40), 1e-11));
+    CALL_SUBTEST_3(testExponentialAction<std::complex<double> >(internal::random<Index>(1,40), 1e-11));
+    CALL_SUBTEST_6(testExponentialAction<float>(internal::random<Index>(1,20), 1e-3));
+    CALL_SUBTEST_4(testExponentialActionOperator(internal::random<Index>(2,40)));
+  }
 }
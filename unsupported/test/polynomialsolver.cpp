@@ -194,6 +194,78 @@ void polynomialsolver(int deg)
       realRoots );
 }
 
+template<typename _Scalar, int _Deg>
+void polynomialbatchsolver(int deg, Index batch)
+{
+  typedef _Scalar                                     Scalar;
+  typedef std::complex<Scalar>                        RootType;
+  typedef PolynomialBatchSolver<Scalar,_Deg>          Solver;
+  typedef Matrix<RootType,Dynamic,1>                  RootVector;
+  const Scalar pi = Scalar(EIGEN_PI);
+
+  // well separated roots: conjugate pairs spread around the origin, and a real root for the odd degrees
+  Matrix<Scalar,Dynamic,Dynamic> coeffs(deg+1, batch);
+  Matrix<RootType,Dynamic,Dynamic> expected(deg, batch);
+  for( Index j=0; j<batch; ++j )
+  {
+    for( int k=0; k+1<deg; k+=2 )
+    {
+      Scalar angle = pi*(Scalar(k+1) + internal::random<Scalar>(Scalar(-0.25),Scalar(0.25)))/Scalar(deg);
+      RootType r = std::polar( internal::random<Scalar>(Scalar(0.5),Scalar(1.5)), angle );
+      expected(k,j) = r;
+      expected(k+1,j) = numext::conj(r);
+    }
+    if( deg%2 )
+      expected(deg-1,j) = RootType( -internal::random<Scalar>(Scalar(0.5),Scalar(1.5)), 0 );
+    Matrix<RootType,Dynamic,1> poly;
+    roots_to_monicPolynomial( RootVector(expected.col(j)), poly );
+    coeffs.col(j) = poly.real() * internal::random<Scalar>(Scalar(0.5),Scalar(2)) * (internal::random<bool>() ? 1 : -1);
+  }
+
+  // the roots are written into a block with an outer stride
+  Matrix<RootType,Dynamic,Dynamic> storage( deg+2, batch );
+  Solver solver;
+  solver.compute( coeffs, storage.topRows(deg) );
+
+  const Scalar prec = test_precision<Scalar>();
+  PolynomialSolver<Scalar,_Deg> reference;
+  for( Index j=0; j<batch; ++j )
+  {
+    RootVector found = storage.col(j).head(deg);
+    reference.compute( coeffs.col(j) );
+    for( int k=0; k<deg; ++k )
+    {
+      Index i;
+      (found.array() - expected(k,j)).abs().minCoeff(&i);
+      VERIFY( std::abs(found(i) - expected(k,j)) <= prec );
+      found(i) = RootType( NumTraits<Scalar>::highest() );
+      VERIFY( (reference.roots().array() - expected(k,j)).abs().minCoeff() <= prec );
+    }
+  }
+
+  // row major coefficients are copied, and give the same roots
+  Matrix<Scalar,Dynamic,Dynamic,RowMajor> rowMajorCoeffs = coeffs;
+  Matrix<RootType,Dynamic,Dynamic> rowMajorRoots( deg, batch );
+  solver.compute( rowMajorCoeffs, rowMajorRoots );
+  VERIFY_IS_EQUAL( rowMajorRoots, storage.topRows(deg) );
+
+  // x^deg, whose roots are all zero
+  coeffs.setZero();
+  coeffs.row(deg).setConstant( Scalar(3) );
+  solver.compute( coeffs, storage.topRows(deg) );
+  VERIFY( storage.topRows(deg).cwiseAbs().maxCoeff() <= prec );
+}
+
+// the batches of more than 256 packets of polynomials are split between the threads
+template<typename _Scalar, int _Deg>
+void polynomialbatchsolver_parallel(int deg)
+{
+  const int nbThreads = Eigen::nbThreads();
+  Eigen::setNbThreads(4);
+  polynomialbatchsolver<_Scalar,_Deg>( deg, internal::random<Index>(10000,12000) );
+  Eigen::setNbThreads(nbThreads);
+}
+
 void test_polynomialsolver()
 {
   for(int i = 0; i < g_repeat; i++)
@@ -214,5 +286,17 @@ void test_polynomialsolver()
             internal::random<int>(9,13)
             )) );
     CALL_SUBTEST_11((polynomialsolver<float,Dynamic>(1)) );
+
+    CALL_SUBTEST_1( (polynomialbatchsolver<float,1>(1, internal::random<Index>(1,50))) );
+    CALL_SUBTEST_2( (polynomialbatchsolver<double,2>(2, internal::random<Index>(1,50))) );
+    CALL_SUBTEST_3( (polynomialbatchsolver<double,3>(3, internal::random<Index>(1,3000))) );
+    CALL_SUBTEST_4( (polynomialbatchsolver<float,4>(4, internal::random<Index>(1,50))) );
+    CALL_SUBTEST_5( (polynomialbatchsolver<double,5>(5, internal::random<Index>(1,50))) );
+    CALL_SUBTEST_6( (polynomialbatchsolver<float,6>(6, internal::random<Index>(1,50))) );
+    CALL_SUBTEST_7( (polynomialbatchsolver<float,3>(3, internal::random<Index>(1,3000))) );
+    CALL_SUBTEST_8( (polynomialbatchsolver<double,8>(8, internal::random<Index>(1,50))) );
+    CALL_SUBTEST_10((polynomialbatchsolver<double,Dynamic>(internal::random<int>(9,13), internal::random<Index>(1,50))) );
   }
+  CALL_SUBTEST_3( (polynomialbatchsolver_parallel<double,3>(3)) );
+  CALL_SUBTEST_7( (polynomialbatchsolver_parallel<float,3>(3)) );
 }
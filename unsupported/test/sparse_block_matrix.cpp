@@ -0,0 +1,163 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "sparse.h"
+#include <Eigen/SparseExtra>
+
+// returns a random matrix made of dense bs x bs blocks with nonzero diagonal blocks
+template<typename Scalar>
+Matrix<Scalar,Dynamic,Dynamic> random_block_matrix(Index nbBlocks, Index bs)
+{
+  Matrix<Scalar,Dynamic,Dynamic> m = Matrix<Scalar,Dynamic,Dynamic>::Zero(nbBlocks*bs, nbBlocks*bs);
+  for(Index i=0; i<nbBlocks; ++i)
+    for(Index j=0; j<nbBlocks; ++j)
+      if(i==j || internal::random<int>(0,5)==0)
+        m.block(i*bs,j*bs,bs,bs).setRandom();
+  return m;
+}
+
+template<typename BlockMatrixType, typename DenseMatrix>
+void check_block_sparse_product(const BlockMatrixType& bm, const DenseMatrix& refMat)
+{
+  typedef typename DenseMatrix::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+  Index n = refMat.cols();
+
+  DenseVector x = DenseVector::Random(n);
+  DenseVector y = DenseVector::Random(n);
+  DenseMatrix X = DenseMatrix::Random(n, 6);
+  DenseMatrix Y = DenseMatrix::Random(n, 6);
+  Matrix<Scalar,Dynamic,Dynamic,RowMajor> Xrm = X;
+
+  VERIFY_IS_APPROX(DenseVector(bm*x), refMat*x);
+  VERIFY_IS_APPROX(y += bm*x, (y + refMat*x).eval());
+  VERIFY_IS_APPROX(y -= bm*x, (y - refMat*x).eval());
+  VERIFY_IS_APPROX(DenseMatrix(bm*X), refMat*X);
+  VERIFY_IS_APPROX(DenseMatrix(bm*Xrm), refMat*X);
+  VERIFY_IS_APPROX(Y -= bm*X, (Y - refMat*X).eval());
+  VERIFY_IS_APPROX(DenseVector(bm*X.col(1)), refMat*X.col(1));
+}
+
+template<typename Scalar, int BlockSize> void block_sparse_product(Index nbBlocks)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  DenseMatrix refMat = random_block_matrix<Scalar>(nbBlocks, BlockSize);
+  SparseMatrix<Scalar,RowMajor> mrm = refMat.sparseView();
+  SparseMatrix<Scalar,ColMajor> mcm = refMat.sparseView();
+
+  BlockSparseMatrix<Scalar,BlockSize,RowMajor> brm(mrm);
+  BlockSparseMatrix<Scalar,BlockSize,ColMajor> bcm(mcm);
+  VERIFY_IS_EQUAL(brm.rows(), refMat.rows());
+  VERIFY_IS_EQUAL(brm.blockRows(), nbBlocks);
+  check_block_sparse_product(brm, refMat);
+  check_block_sparse_product(bcm, refMat);
+
+  BlockSparseMatrix<Scalar,BlockSize,RowMajor> copy(brm);
+  check_block_sparse_product(copy, refMat);
+
+  // block size given at runtime
+  BlockSparseMatrix<Scalar,Dynamic,RowMajor> drm(nbBlocks, nbBlocks);
+  drm.setBlockSize(BlockSize);
+  drm = mrm;
+  check_block_sparse_product(drm, refMat);
+  BlockSparseMatrix<Scalar,Dynamic,ColMajor> dcm(nbBlocks, nbBlocks);
+  dcm.setBlockSize(BlockSize);
+  dcm = mcm;
+  check_block_sparse_product(dcm, refMat);
+}
+
+// the row-major products are split between the threads when the matrix has more than 20000 nonzeros
+template<typename Scalar, int BlockSize> void block_sparse_product_parallel()
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  const int nbThreads = Eigen::nbThreads();
+  Index nbBlocks = internal::random<Index>(300,400);
+  DenseMatrix refMat = random_block_matrix<Scalar>(nbBlocks, BlockSize);
+  SparseMatrix<Scalar,RowMajor> mrm = refMat.sparseView();
+
+  BlockSparseMatrix<Scalar,BlockSize,RowMajor> brm(mrm);
+  BlockSparseMatrix<Scalar,Dynamic,RowMajor> drm(nbBlocks, nbBlocks);
+  drm.setBlockSize(BlockSize);
+  drm = mrm;
+  VERIFY(brm.nonZeros() > 20000);
+
+  Eigen::setNbThreads(4);
+  check_block_sparse_product(brm, refMat);
+  check_block_sparse_product(drm, refMat);
+  Eigen::setNbThreads(nbThreads);
+}
+
+template<typename Scalar, int BlockSize> void block_jacobi_solvers(Index nbBlocks)
+{
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+  typedef BlockSparseMatrix<Scalar,BlockSize,RowMajor> BlockMatrixType;
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+
+  DenseMatrix m = random_block_matrix<Scalar>(nbBlocks, BlockSize);
+  DenseMatrix spd = m.adjoint()*m;
+  spd.diagonal().array() += RealScalar(1);
+  SparseMatrix<Scalar,RowMajor> spdSparse = spd.sparseView();
+  BlockMatrixType bspd(spdSparse);
+
+  // the preconditioner applies the inverse of the diagonal blocks
+  BlockJacobiPreconditioner<Scalar,BlockSize> bj(bspd);
+  DenseVector b = DenseVector::Random(spd.rows());
+  DenseVector z = bj.solve(b);
+  for(Index k=0; k<nbBlocks; ++k)
+    VERIFY_IS_APPROX((spd.block(k*BlockSize,k*BlockSize,BlockSize,BlockSize)*z.segment(k*BlockSize,BlockSize)).eval(),
+                     b.segment(k*BlockSize,BlockSize));
+  BlockJacobiPreconditioner<Scalar> bjDyn;
+  bjDyn.setBlockSize(BlockSize).compute(spdSparse);
+  VERIFY_IS_APPROX(DenseVector(bjDyn.solve(b)), z);
+
+  RealScalar tol = test_precision<Scalar>();
+  ConjugateGradient<BlockMatrixType, Lower|Upper, BlockJacobiPreconditioner<Scalar,BlockSize> > cg(bspd);
+  cg.setTolerance(tol);
+  DenseVector x = cg.solve(b);
+  VERIFY(cg.info() == Success);
+  VERIFY((spd*x - b).norm() <= RealScalar(10)*tol*b.norm());
+
+  ConjugateGradient<SparseMatrix<Scalar,RowMajor>, Lower|Upper, BlockJacobiPreconditioner<Scalar,BlockSize> > cgSparse(spdSparse);
+  cgSparse.setTolerance(tol);
+  x = cgSparse.solve(b);
+  VERIFY(cgSparse.info() == Success);
+  VERIFY((spd*x - b).norm() <= RealScalar(10)*tol*b.norm());
+
+  DenseMatrix B = DenseMatrix::Random(spd.rows(), 3);
+  DenseMatrix X = cg.solve(B);
+  VERIFY(cg.info() == Success);
+  VERIFY_IS_APPROX(spd*X, B);
+
+  // a general matrix with a dominant block diagonal
+  DenseMatrix g = m;
+  for(Index k=0; k<nbBlocks; ++k)
+    g.block(k*BlockSize,k*BlockSize,BlockSize,BlockSize) += RealScalar(4*nbBlocks)*DenseMatrix::Identity(BlockSize,BlockSize);
+  SparseMatrix<Scalar,RowMajor> gSparse = g.sparseView();
+  BlockMatrixType bg(gSparse);
+  BiCGSTAB<BlockMatrixType, BlockJacobiPreconditioner<Scalar,BlockSize> > bicg(bg);
+  bicg.setTolerance(tol);
+  x = bicg.solve(b);
+  VERIFY(bicg.info() == Success);
+  VERIFY((g*x - b).norm() <= RealScalar(10)*tol*b.norm());
+}
+
+void test_sparse_block_matrix()
+{
+  for(int i = 0; i < g_repeat; i++) {
+    CALL_SUBTEST_1(( block_sparse_product<double,3>(internal::random<int>(1,60)) ));
+    CALL_SUBTEST_1(( block_sparse_product<double,6>(internal::random<int>(1,30)) ));
+    CALL_SUBTEST_2(( block_sparse_product<float,4>(internal::random<int>(1,40)) ));
+    CALL_SUBTEST_3(( block_sparse_product<std::complex<double>,2>(internal::random<int>(1,40)) ));
+    CALL_SUBTEST_1(( block_jacobi_solvers<double,3>(internal::random<int>(2,60)) ));
+    CALL_SUBTEST_1(( block_jacobi_solvers<double,6>(internal::random<int>(2,30)) ));
+    CALL_SUBTEST_2(( block_jacobi_solvers<float,4>(internal::random<int>(2,40)) ));
+  }
+  CALL_SUBTEST_1(( block_sparse_product_parallel<double,3>() ));
+  CALL_SUBTEST_2(( block_sparse_product_parallel<float,4>() ));
+  CALL_SUBTEST_3(( block_sparse_product_parallel<std::complex<double>,2>() ));
+}
@@ -0,0 +1,168 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "sparse.h"
+#include <Eigen/SparseExtra>
+
+template<typename Scalar, int ChunkSize> void sparse_sell_product(Index rows, Index cols)
+{
+  typedef SparseMatrix<Scalar> SparseMatrixType;
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+  typedef SellCSigmaMatrix<Scalar,ChunkSize> SellMatrix;
+
+  double density = (std::max)(8./(rows*cols), 0.05);
+  DenseMatrix refMat(rows, cols);
+  SparseMatrixType m(rows, cols);
+  initSparse<Scalar>(density, refMat, m);
+  // make a few rows empty and a few others much longer
+  for(Index i=0; i<rows; i+=7)
+    refMat.row(i).setZero();
+  for(Index i=3; i<rows; i+=11)
+    refMat.row(i).setRandom();
+  m = refMat.sparseView();
+
+  SparseMatrix<Scalar,RowMajor> mrm(m);
+
+  Index sigmas[] = { 1, ChunkSize, 4*ChunkSize, rows+1 };
+  for(int k=0; k<4; ++k)
+  {
+    SellMatrix s(m, sigmas[k]);
+    VERIFY_IS_EQUAL(s.rows(), rows);
+    VERIFY_IS_EQUAL(s.cols(), cols);
+    VERIFY_IS_EQUAL(s.nonZeros(), m.nonZeros());
+    VERIFY(s.storedSize() >= s.nonZeros());
+    VERIFY(s.storedSize() % ChunkSize == 0);
+
+    // each row can be iterated in the original order
+    for(Index i=0; i<rows; ++i)
+    {
+      typename SellMatrix::InnerIterator it(s,i);
+      for(typename SparseMatrix<Scalar,RowMajor>::InnerIterator refIt(mrm,i); refIt; ++refIt, ++it)
+      {
+        VERIFY(it);
+        VERIFY_IS_EQUAL(it.index(), refIt.index());
+        VERIFY_IS_EQUAL(it.value(), refIt.value());
+      }
+      VERIFY(!it);
+    }
+
+    DenseVector x = DenseVector::Random(cols);
+    DenseVector y = DenseVector::Random(rows);
+    DenseMatrix X = DenseMatrix::Random(cols, 5);
+    DenseMatrix Y = DenseMatrix::Random(rows, 5);
+    Matrix<Scalar,Dynamic,Dynamic,RowMajor> Xrm = X;
+
+    VERIFY_IS_APPROX(DenseVector(s*x), refMat*x);
+    VERIFY_IS_APPROX(y += s*x, (y + refMat*x).eval());
+    VERIFY_IS_APPROX(y -= s*x, (y - refMat*x).eval());
+    VERIFY_IS_APPROX(DenseMatrix(s*X), refMat*X);
+    VERIFY_IS_APPROX(DenseMatrix(s*Xrm), refMat*X);
+    VERIFY_IS_APPROX(Y -= s*X, (Y - refMat*X).eval());
+    VERIFY_IS_APPROX(DenseVector(s*X.col(2)), refMat*X.col(2));
+  }
+
+  // assignment from another sparse matrix
+  SellMatrix s;
+  s.setSortingScope(2*ChunkSize);
+  s = m.transpose();
+  VERIFY_IS_EQUAL(s.sortingScope(), 2*ChunkSize);
+  DenseVector x = DenseVector::Random(rows);
+  VERIFY_IS_APPROX(DenseVector(s*x), refMat.transpose()*x);
+}
+
+// the products are split between the threads when the matrix stores more than 20000 coefficients
+template<typename Scalar, int ChunkSize> void sparse_sell_product_parallel()
+{
+  typedef SparseMatrix<Scalar> SparseMatrixType;
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+
+  const int nbThreads = Eigen::nbThreads();
+  Index rows = internal::random<Index>(2000,3000), cols = internal::random<Index>(1000,2000);
+  std::vector<Triplet<Scalar> > triplets;
+  for(Index i=0; i<rows; ++i)
+  {
+    int count = internal::random<int>(1,20);
+    for(int l=0; l<count; ++l)
+      triplets.push_back(Triplet<Scalar>(i, internal::random<Index>(0,cols-1), internal::random<Scalar>()));
+  }
+  SparseMatrixType m(rows, cols);
+  m.setFromTriplets(triplets.begin(), triplets.end());
+
+  SellCSigmaMatrix<Scalar,ChunkSize> s(m, 4*ChunkSize);
+  VERIFY(s.storedSize() > 20000);
+  DenseVector x = DenseVector::Random(cols);
+  DenseMatrix X = DenseMatrix::Random(cols, 5);
+
+  Eigen::setNbThreads(4);
+  DenseVector y = s*x;
+  DenseMatrix Y = s*X;
+  Eigen::setNbThreads(nbThreads);
+
+  VERIFY_IS_APPROX(y, DenseVector(m*x));
+  VERIFY_IS_APPROX(Y, DenseMatrix(m*X));
+}
+
+template<typename Scalar> void sparse_sell_solvers(Index size)
+{
+  typedef SparseMatrix<Scalar> SparseMatrixType;
+  typedef Matrix<Scalar,Dynamic,Dynamic> DenseMatrix;
+  typedef Matrix<Scalar,Dynamic,1> DenseVector;
+  typedef SellCSigmaMatrix<Scalar> SellMatrix;
+  typedef typename NumTraits<Scalar>::Real RealScalar;
+
+  DenseMatrix refMat(size, size);
+  SparseMatrixType m(size, size);
+  initSparse<Scalar>(0.1, refMat, m, ForceNonZeroDiag);
+  SparseMatrixType spd = m.adjoint() * m;
+  spd.diagonal().array() += RealScalar(1);
+  SellMatrix s(spd);
+
+  DenseVector b = DenseVector::Random(size);
+  DenseMatrix B = DenseMatrix::Random(size, 3);
+  RealScalar tol = test_precision<Scalar>();
+
+  ConjugateGradient<SellMatrix, Lower|Upper> cg(s);
+  cg.setTolerance(tol);
+  DenseVector x = cg.solve(b);
+  VERIFY(cg.info() == Success);
+  VERIFY((spd*x - b).norm() <= RealScalar(10)*tol*b.norm());
+  DenseMatrix X = cg.solve(B);
+  VERIFY(cg.info() == Success);
+  VERIFY_IS_APPROX(spd*X, B);
+
+  ConjugateGradient<SellMatrix, Lower|Upper, IdentityPreconditioner> cgId(s);
+  cgId.setTolerance(tol);
+  x = cgId.solve(b);
+  VERIFY(cgId.info() == Success);
+  VERIFY((spd*x - b).norm() <= RealScalar(10)*tol*b.norm());
+
+  SellMatrix g(m);
+  BiCGSTAB<SellMatrix> bicg(g);
+  bicg.setTolerance(tol);
+  x = bicg.solve(b);
+  VERIFY(bicg.info() == Success);
+  VERIFY((m*x - b).norm() <= RealScalar(10)*tol*b.norm());
+}
+
+void test_sparse_sell()
+{
+  for(int i = 0; i < g_repeat; i++) {
+    int s = Eigen::internal::random<int>(1,200);
+    CALL_SUBTEST_1(( sparse_sell_product<double,8>(s, Eigen::internal::random<int>(1,200)) ));
+    CALL_SUBTEST_1(( sparse_sell_product<double,3>(s, Eigen::internal::random<int>(1,200)) ));
+    CALL_SUBTEST_2(( sparse_sell_product<float,16>(s, s) ));
+    CALL_SUBTEST_3(( sparse_sell_product<std::complex<double>,4>(s, s) ));
+    CALL_SUBTEST_1( sparse_sell_solvers<double>(Eigen::internal::random<int>(10,300)) );
+    CALL_SUBTEST_2( sparse_sell_solvers<float>(Eigen::internal::random<int>(10,300)) );
+    CALL_SUBTEST_3( sparse_sell_solvers<std::complex<double> >(Eigen::internal::random<int>(10,300)) );
+  }
+  CALL_SUBTEST_1(( sparse_sell_product_parallel<double,8>() ));
+  CALL_SUBTEST_2(( sparse_sell_product_parallel<float,16>() ));
+  CALL_SUBTEST_3(( sparse_sell_product_parallel<std::complex<double>,4>() ));
+}
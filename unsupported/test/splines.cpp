@@ -268,6 +268,92 @@ void check_global_interpolation_with_derivatives2d()
   }
 }
 
+template <typename SplineType>
+void check_batch_evaluation(DenseIndex numSites)
+{
+  typedef typename SplineType::Scalar Scalar;
+  typedef typename SplineType::PointType PointType;
+  typedef typename SplineType::KnotVectorType KnotVectorType;
+  typedef typename SplineType::ControlPointVectorType ControlPointVectorType;
+  enum { Dimension = SplineType::Dimension };
+
+  const DenseIndex degree = SplineType::Degree==Dynamic ? internal::random<DenseIndex>(1,5) : DenseIndex(SplineType::Degree);
+  const DenseIndex numCtrls = internal::random<DenseIndex>(degree+1, 60);
+  KnotVectorType knots(numCtrls+degree+1);
+  knots.head(degree+1).setZero();
+  knots.tail(degree+1).setOnes();
+  KnotVectorType inner = (KnotVectorType::Random(numCtrls-degree-1) + Scalar(1)) / Scalar(2);
+  std::sort(inner.data(), inner.data()+inner.size());
+  knots.segment(degree+1, inner.size()) = inner;
+  const SplineType spline(knots, ControlPointVectorType::Random(Dimension, numCtrls));
+
+  // unsorted sites, including the end points
+  Array<Scalar,1,Dynamic> u = (Array<Scalar,1,Dynamic>::Random(numSites) + Scalar(1)) / Scalar(2);
+  u(0) = Scalar(0);
+  u(numSites-1) = Scalar(1);
+  ControlPointVectorType values;
+  spline.evaluate(u, values);
+  VERIFY_IS_EQUAL(values.cols(), numSites);
+  for (DenseIndex i=0; i<numSites; ++i)
+  {
+    PointType ref = spline(u(i));
+    VERIFY_IS_APPROX(PointType(values.col(i)), ref);
+  }
+
+  // sorted sites, into a block
+  std::sort(u.data(), u.data()+u.size());
+  Array<Scalar,Dynamic,Dynamic> storage = Array<Scalar,Dynamic,Dynamic>::Zero(Dimension+1, numSites);
+  spline.evaluate(u, storage.topRows(Dimension));
+  VERIFY( (storage.row(Dimension) == Scalar(0)).all() );
+  for (DenseIndex i=0; i<numSites; ++i)
+  {
+    PointType ref = spline(u(i));
+    VERIFY_IS_APPROX(PointType(storage.col(i).head(Dimension)), ref);
+  }
+}
+
+// the sites are split between the threads by chunks of 4096
+template <typename SplineType>
+void check_batch_evaluation_parallel()
+{
+  const int nbThreads = Eigen::nbThreads();
+  Eigen::setNbThreads(4);
+  check_batch_evaluation<SplineType>(internal::random<DenseIndex>(10000,20000));
+  Eigen::setNbThreads(nbThreads);
+}
+
+void check_large_interpolation2d()
+{
+  typedef Spline2d::PointType PointType;
+  typedef Spline2d::KnotVectorType KnotVectorType;
+  typedef Spline2d::ControlPointVectorType ControlPointVectorType;
+
+  const DenseIndex numPoints = 20000;
+  ControlPointVectorType points = ControlPointVectorType::Random(2,numPoints);
+  KnotVectorType chord_lengths;
+  Eigen::ChordLengths(points, chord_lengths);
+
+  const Spline2d spline = SplineFitting<Spline2d>::Interpolate(points,3);
+  ControlPointVectorType values;
+  spline.evaluate(chord_lengths, values);
+  VERIFY( (values - points).matrix().colwise().norm().maxCoeff() < 1e-10 );
+
+  // derivatives at all the points
+  ControlPointVectorType derivatives = ControlPointVectorType::Random(2, numPoints);
+  VectorXd derivativeIndices = VectorXd::LinSpaced(numPoints, 0, double(numPoints-1));
+
+  const Spline2d derSpline = SplineFitting<Spline2d>::InterpolateWithDerivatives(
+    points, derivatives, derivativeIndices, 3);
+  derSpline.evaluate(chord_lengths, values);
+  VERIFY( (values - points).matrix().colwise().norm().maxCoeff() < 1e-10 );
+  for (DenseIndex i=0; i<numPoints; i+=97)
+  {
+    PointType derivative = derSpline.derivatives(chord_lengths(i), 1).col(1);
+    PointType referenceDerivative = derivatives.col(i);
+    VERIFY_IS_APPROX(derivative, referenceDerivative);
+  }
+}
+
 void test_splines()
 {
   for (int i = 0; i < g_repeat; ++i)
@@ -277,5 +363,11 @@ void test_splines()
     CALL_SUBTEST( eval_closed_spline2d() );
     CALL_SUBTEST( check_global_interpolation2d() );
     CALL_SUBTEST( check_global_interpolation_with_derivatives2d() );
+    CALL_SUBTEST( check_batch_evaluation<Spline2d>(internal::random<DenseIndex>(1,2000)) );
+    CALL_SUBTEST( (check_batch_evaluation<Spline<float,3,3> >(internal::random<DenseIndex>(1,2000))) );
+    CALL_SUBTEST( (check_batch_evaluation<Spline<double,1,2> >(internal::random<DenseIndex>(1,2000))) );
   }
+  CALL_SUBTEST( check_large_interpolation2d() );
+  CALL_SUBTEST( check_batch_evaluation_parallel<Spline2d>() );
+  CALL_SUBTEST( (check_batch_evaluation_parallel<Spline<float,3,3> >()) );
 }